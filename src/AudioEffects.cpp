@@ -0,0 +1,643 @@
+//
+//  AudioEffects.cpp
+//  MSRLWeb
+//
+//  Native audio effects implementation
+//
+
+#include "AudioEffects.h"
+#include "MiniscriptInterpreter.h"
+#include <emscripten.h>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+using namespace MiniScript;
+
+static const float kPi = 3.14159265358979f;
+
+// Sample rate of the audio device; miniaudio's web backend keeps its
+// AudioContext in the global `miniaudio` object.
+EM_JS(int, _GetAudioDeviceSampleRate, (), {
+	if (typeof miniaudio !== "undefined" && miniaudio.devices) {
+		for (const device of miniaudio.devices) {
+			if (device && device.webaudio) return device.webaudio.sampleRate;
+		}
+	}
+	return 0;
+});
+
+static int DeviceSampleRate() {
+	static int sampleRate = 0;
+	if (sampleRate == 0) sampleRate = _GetAudioDeviceSampleRate();
+	return sampleRate > 0 ? sampleRate : 48000;
+}
+
+// Read a number from a parameter map, or return the current value
+static float Param(ValueDict params, const char* key, float current) {
+	Value v = params.Lookup(String(key), Value::null);
+	return v.IsNull() ? current : v.FloatValue();
+}
+
+//--------------------------------------------------------------------------------
+// Vector kernels (wasm SIMD when available, scalar otherwise)
+//--------------------------------------------------------------------------------
+
+// dest = dest * (1 - mix) + wet * mix
+static void MixInto(float* dest, const float* wet, int count, float mix) {
+	int i = 0;
+#if defined(__wasm_simd128__)
+	v128_t vDry = wasm_f32x4_splat(1 - mix);
+	v128_t vWet = wasm_f32x4_splat(mix);
+	for (; i + 4 <= count; i += 4) {
+		v128_t d = wasm_v128_load(dest + i);
+		v128_t w = wasm_v128_load(wet + i);
+		wasm_v128_store(dest + i, wasm_f32x4_add(wasm_f32x4_mul(d, vDry), wasm_f32x4_mul(w, vWet)));
+	}
+#endif
+	for (; i < count; i++) dest[i] = dest[i] * (1 - mix) + wet[i] * mix;
+}
+
+// Soft clip: y = out * (x*drive) / (1 + |x*drive|), blended with the dry signal
+static void SoftClip(float* samples, int count, float drive, float out, float mix) {
+	int i = 0;
+#if defined(__wasm_simd128__)
+	v128_t vDrive = wasm_f32x4_splat(drive);
+	v128_t vOne = wasm_f32x4_splat(1.0f);
+	v128_t vWet = wasm_f32x4_splat(out * mix);
+	v128_t vDry = wasm_f32x4_splat(1 - mix);
+	for (; i + 4 <= count; i += 4) {
+		v128_t x = wasm_v128_load(samples + i);
+		v128_t d = wasm_f32x4_mul(x, vDrive);
+		v128_t y = wasm_f32x4_div(d, wasm_f32x4_add(vOne, wasm_f32x4_abs(d)));
+		wasm_v128_store(samples + i, wasm_f32x4_add(wasm_f32x4_mul(y, vWet), wasm_f32x4_mul(x, vDry)));
+	}
+#endif
+	for (; i < count; i++) {
+		float x = samples[i];
+		float d = x * drive;
+		samples[i] = d / (1 + fabsf(d)) * out * mix + x * (1 - mix);
+	}
+}
+
+// Quantize to the given number of levels, blended with the dry signal
+static void Quantize(float* samples, int count, float levels, float mix) {
+	int i = 0;
+	float inv = 1.0f / levels;
+#if defined(__wasm_simd128__)
+	v128_t vLevels = wasm_f32x4_splat(levels);
+	v128_t vInv = wasm_f32x4_splat(inv);
+	v128_t vWet = wasm_f32x4_splat(mix);
+	v128_t vDry = wasm_f32x4_splat(1 - mix);
+	for (; i + 4 <= count; i += 4) {
+		v128_t x = wasm_v128_load(samples + i);
+		v128_t q = wasm_f32x4_mul(wasm_f32x4_nearest(wasm_f32x4_mul(x, vLevels)), vInv);
+		wasm_v128_store(samples + i, wasm_f32x4_add(wasm_f32x4_mul(q, vWet), wasm_f32x4_mul(x, vDry)));
+	}
+#endif
+	for (; i < count; i++) {
+		float x = samples[i];
+		samples[i] = rintf(x * levels) * inv * mix + x * (1 - mix);
+	}
+}
+
+// Scratch buffer for wet signals (processors run one at a time)
+static float* WetBuffer(int count) {
+	static std::vector<float> buffer;
+	if ((int)buffer.size() < count) buffer.resize(count);
+	return buffer.data();
+}
+
+//--------------------------------------------------------------------------------
+// AudioEffect base
+//--------------------------------------------------------------------------------
+
+AudioEffect::AudioEffect(Type type)
+	: type(type), bypass(false), processMs(0), framesProcessed(0), lastSampleRate(0) {
+}
+
+void AudioEffect::Configure(ValueDict params) {
+	bypass = Param(params, "bypass", bypass ? 1 : 0) != 0;
+}
+
+void AudioEffect::Process(float* samples, int frameCount, int sampleRate) {
+	if (bypass) return;
+	double start = emscripten_get_now();
+	Run(samples, frameCount, sampleRate);
+	processMs += emscripten_get_now() - start;
+	framesProcessed += frameCount;
+	lastSampleRate = sampleRate;
+}
+
+double AudioEffect::CpuPercent() const {
+	if (framesProcessed <= 0 || lastSampleRate <= 0) return 0;
+	double audioMs = framesProcessed * 1000.0 / lastSampleRate;
+	return processMs / audioMs * 100;
+}
+
+static const char* kTypeNames[] = {
+	"lowpass", "highpass", "bandpass", "notch", "peak", "lowshelf", "highshelf",
+	"delay", "reverb", "distortion", "bitcrush", "compressor"
+};
+
+const char* AudioEffect::TypeName() const {
+	return kTypeNames[type];
+}
+
+//--------------------------------------------------------------------------------
+// Biquad filters (RBJ cookbook).  The recursion makes these inherently
+// sequential per channel, so they stay scalar.
+//--------------------------------------------------------------------------------
+
+class BiquadEffect : public AudioEffect {
+public:
+	BiquadEffect(Type type) : AudioEffect(type), frequency(1000), q(0.7071f), gain(0), designedRate(0) { Reset(); }
+
+	void Configure(ValueDict params) override {
+		AudioEffect::Configure(params);
+		frequency = Param(params, "frequency", frequency);
+		q = Param(params, "q", q);
+		gain = Param(params, "gain", gain);
+		if (q < 0.01f) q = 0.01f;
+		designedRate = 0;  // recompute coefficients on next Run
+	}
+
+	void Reset() override { memset(z, 0, sizeof(z)); }
+
+protected:
+	void Run(float* samples, int frameCount, int sampleRate) override {
+		if (designedRate != sampleRate) Design(sampleRate);
+		for (int c = 0; c < 2; c++) {
+			float z1 = z[c][0], z2 = z[c][1];
+			for (int i = 0; i < frameCount; i++) {
+				float x = samples[i * 2 + c];
+				float y = b0 * x + z1;
+				z1 = b1 * x - a1 * y + z2;
+				z2 = b2 * x - a2 * y;
+				samples[i * 2 + c] = y;
+			}
+			z[c][0] = z1; z[c][1] = z2;
+		}
+	}
+
+private:
+	void Design(int sampleRate) {
+		float f = frequency;
+		if (f > sampleRate * 0.49f) f = sampleRate * 0.49f;
+		if (f < 1) f = 1;
+		float w0 = 2 * kPi * f / sampleRate;
+		float cosw = cosf(w0), sinw = sinf(w0);
+		float alpha = sinw / (2 * q);
+		float A = powf(10, gain / 40);
+		float nb0, nb1, nb2, na0, na1, na2;
+		switch (type) {
+			case HIGHPASS:
+				nb0 = (1 + cosw) / 2; nb1 = -(1 + cosw); nb2 = (1 + cosw) / 2;
+				na0 = 1 + alpha; na1 = -2 * cosw; na2 = 1 - alpha;
+				break;
+			case BANDPASS:
+				nb0 = alpha; nb1 = 0; nb2 = -alpha;
+				na0 = 1 + alpha; na1 = -2 * cosw; na2 = 1 - alpha;
+				break;
+			case NOTCH:
+				nb0 = 1; nb1 = -2 * cosw; nb2 = 1;
+				na0 = 1 + alpha; na1 = -2 * cosw; na2 = 1 - alpha;
+				break;
+			case PEAK:
+				nb0 = 1 + alpha * A; nb1 = -2 * cosw; nb2 = 1 - alpha * A;
+				na0 = 1 + alpha / A; na1 = -2 * cosw; na2 = 1 - alpha / A;
+				break;
+			case LOWSHELF: {
+				float s = 2 * sqrtf(A) * alpha;
+				nb0 = A * ((A + 1) - (A - 1) * cosw + s);
+				nb1 = 2 * A * ((A - 1) - (A + 1) * cosw);
+				nb2 = A * ((A + 1) - (A - 1) * cosw - s);
+				na0 = (A + 1) + (A - 1) * cosw + s;
+				na1 = -2 * ((A - 1) + (A + 1) * cosw);
+				na2 = (A + 1) + (A - 1) * cosw - s;
+				break;
+			}
+			case HIGHSHELF: {
+				float s = 2 * sqrtf(A) * alpha;
+				nb0 = A * ((A + 1) + (A - 1) * cosw + s);
+				nb1 = -2 * A * ((A - 1) + (A + 1) * cosw);
+				nb2 = A * ((A + 1) + (A - 1) * cosw - s);
+				na0 = (A + 1) - (A - 1) * cosw + s;
+				na1 = 2 * ((A - 1) - (A + 1) * cosw);
+				na2 = (A + 1) - (A - 1) * cosw - s;
+				break;
+			}
+			default:  // LOWPASS
+				nb0 = (1 - cosw) / 2; nb1 = 1 - cosw; nb2 = (1 - cosw) / 2;
+				na0 = 1 + alpha; na1 = -2 * cosw; na2 = 1 - alpha;
+				break;
+		}
+		b0 = nb0 / na0; b1 = nb1 / na0; b2 = nb2 / na0;
+		a1 = na1 / na0; a2 = na2 / na0;
+		designedRate = sampleRate;
+	}
+
+	float frequency, q, gain;
+	int designedRate;
+	float b0, b1, b2, a1, a2;
+	float z[2][2];
+};
+
+//--------------------------------------------------------------------------------
+// Delay / echo
+//--------------------------------------------------------------------------------
+
+class DelayEffect : public AudioEffect {
+public:
+	DelayEffect() : AudioEffect(DELAY), time(0.25f), feedback(0.4f), mix(0.35f), pos(0) {}
+
+	void Configure(ValueDict params) override {
+		AudioEffect::Configure(params);
+		time = Param(params, "time", time);
+		feedback = Param(params, "feedback", feedback);
+		mix = Param(params, "mix", mix);
+		if (time < 0.001f) time = 0.001f;
+		if (time > kMaxSeconds) time = kMaxSeconds;
+		if (feedback > 0.98f) feedback = 0.98f;
+	}
+
+	void Reset() override { std::fill(line.begin(), line.end(), 0.0f); pos = 0; }
+
+protected:
+	void Run(float* samples, int frameCount, int sampleRate) override {
+		int lineFrames = (int)(kMaxSeconds * sampleRate) + 1;
+		if ((int)line.size() != lineFrames * 2) { line.assign(lineFrames * 2, 0.0f); pos = 0; }
+		int delayFrames = (int)(time * sampleRate);
+		if (delayFrames < 1) delayFrames = 1;
+
+		// Pass 1 (sequential): read the echoes and feed the line
+		float* wet = WetBuffer(frameCount * 2);
+		for (int i = 0; i < frameCount; i++) {
+			int readPos = pos - delayFrames;
+			if (readPos < 0) readPos += lineFrames;
+			for (int c = 0; c < 2; c++) {
+				float delayed = line[readPos * 2 + c];
+				wet[i * 2 + c] = delayed;
+				line[pos * 2 + c] = samples[i * 2 + c] + delayed * feedback;
+			}
+			if (++pos >= lineFrames) pos = 0;
+		}
+		// Pass 2 (vectorized): blend
+		MixInto(samples, wet, frameCount * 2, mix);
+	}
+
+private:
+	static constexpr float kMaxSeconds = 2.0f;
+	float time, feedback, mix;
+	std::vector<float> line;  // interleaved stereo
+	int pos;
+};
+
+//--------------------------------------------------------------------------------
+// Reverb (Schroeder/Freeverb style: parallel damped combs, then allpasses)
+//--------------------------------------------------------------------------------
+
+class ReverbEffect : public AudioEffect {
+public:
+	ReverbEffect() : AudioEffect(REVERB), roomSize(0.8f), damping(0.3f), mix(0.25f), builtRate(0) {}
+
+	void Configure(ValueDict params) override {
+		AudioEffect::Configure(params);
+		roomSize = Param(params, "roomSize", roomSize);
+		damping = Param(params, "damping", damping);
+		mix = Param(params, "mix", mix);
+		if (roomSize > 0.98f) roomSize = 0.98f;
+	}
+
+	void Reset() override { builtRate = 0; }
+
+protected:
+	void Run(float* samples, int frameCount, int sampleRate) override {
+		if (builtRate != sampleRate) Build(sampleRate);
+		float* wet = WetBuffer(frameCount * 2);
+		for (int c = 0; c < 2; c++) {
+			for (int i = 0; i < frameCount; i++) {
+				float input = samples[i * 2 + c] * 0.015f;
+				float out = 0;
+				for (int k = 0; k < kCombs; k++) {
+					Line& comb = combs[c][k];
+					float y = comb.data[comb.pos];
+					comb.filter = y * (1 - damping) + comb.filter * damping;
+					comb.data[comb.pos] = input + comb.filter * roomSize;
+					if (++comb.pos >= (int)comb.data.size()) comb.pos = 0;
+					out += y;
+				}
+				for (int k = 0; k < kAllpasses; k++) {
+					Line& ap = allpasses[c][k];
+					float buffered = ap.data[ap.pos];
+					ap.data[ap.pos] = out + buffered * 0.5f;
+					if (++ap.pos >= (int)ap.data.size()) ap.pos = 0;
+					out = buffered - out;
+				}
+				wet[i * 2 + c] = out;
+			}
+		}
+		MixInto(samples, wet, frameCount * 2, mix);
+	}
+
+private:
+	struct Line {
+		std::vector<float> data;
+		int pos;
+		float filter;
+	};
+	static const int kCombs = 4;
+	static const int kAllpasses = 2;
+
+	void Build(int sampleRate) {
+		static const int combTuning[kCombs] = { 1116, 1188, 1277, 1356 };
+		static const int allpassTuning[kAllpasses] = { 556, 441 };
+		float scale = sampleRate / 44100.0f;
+		for (int c = 0; c < 2; c++) {
+			int spread = (c == 0 ? 0 : 23);
+			for (int k = 0; k < kCombs; k++) {
+				combs[c][k].data.assign((int)((combTuning[k] + spread) * scale), 0.0f);
+				combs[c][k].pos = 0;
+				combs[c][k].filter = 0;
+			}
+			for (int k = 0; k < kAllpasses; k++) {
+				allpasses[c][k].data.assign((int)((allpassTuning[k] + spread) * scale), 0.0f);
+				allpasses[c][k].pos = 0;
+				allpasses[c][k].filter = 0;
+			}
+		}
+		builtRate = sampleRate;
+	}
+
+	float roomSize, damping, mix;
+	int builtRate;
+	Line combs[2][kCombs];
+	Line allpasses[2][kAllpasses];
+};
+
+//--------------------------------------------------------------------------------
+// Distortion and bitcrush (stateless per sample, so fully vectorized)
+//--------------------------------------------------------------------------------
+
+class DistortionEffect : public AudioEffect {
+public:
+	DistortionEffect() : AudioEffect(DISTORTION), drive(4), output(0.7f), mix(1) {}
+
+	void Configure(ValueDict params) override {
+		AudioEffect::Configure(params);
+		drive = Param(params, "drive", drive);
+		output = Param(params, "output", output);
+		mix = Param(params, "mix", mix);
+	}
+
+protected:
+	void Run(float* samples, int frameCount, int sampleRate) override {
+		SoftClip(samples, frameCount * 2, drive, output, mix);
+	}
+
+private:
+	float drive, output, mix;
+};
+
+class BitcrushEffect : public AudioEffect {
+public:
+	BitcrushEffect() : AudioEffect(BITCRUSH), bits(8), downsample(1), mix(1), holdCount(0) {
+		held[0] = held[1] = 0;
+	}
+
+	void Configure(ValueDict params) override {
+		AudioEffect::Configure(params);
+		bits = Param(params, "bits", bits);
+		downsample = (int)Param(params, "downsample", (float)downsample);
+		mix = Param(params, "mix", mix);
+		if (bits < 1) bits = 1;
+		if (bits > 24) bits = 24;
+		if (downsample < 1) downsample = 1;
+	}
+
+protected:
+	void Run(float* samples, int frameCount, int sampleRate) override {
+		if (downsample > 1) {
+			// Sample-and-hold is sequential; do it before the vectorized quantize
+			for (int i = 0; i < frameCount; i++) {
+				if (holdCount == 0) { held[0] = samples[i * 2]; held[1] = samples[i * 2 + 1]; }
+				samples[i * 2] = held[0];
+				samples[i * 2 + 1] = held[1];
+				if (++holdCount >= downsample) holdCount = 0;
+			}
+		}
+		Quantize(samples, frameCount * 2, powf(2, bits - 1), mix);
+	}
+
+private:
+	float bits;
+	int downsample;
+	float mix;
+	int holdCount;
+	float held[2];
+};
+
+//--------------------------------------------------------------------------------
+// Compressor (stereo-linked peak detector)
+//--------------------------------------------------------------------------------
+
+class CompressorEffect : public AudioEffect {
+public:
+	CompressorEffect() : AudioEffect(COMPRESSOR), threshold(-18), ratio(4), attack(0.01f),
+		release(0.1f), makeup(0), envelope(0) {}
+
+	void Configure(ValueDict params) override {
+		AudioEffect::Configure(params);
+		threshold = Param(params, "threshold", threshold);
+		ratio = Param(params, "ratio", ratio);
+		attack = Param(params, "attack", attack);
+		release = Param(params, "release", release);
+		makeup = Param(params, "makeup", makeup);
+		if (ratio < 1) ratio = 1;
+	}
+
+	void Reset() override { envelope = 0; }
+
+protected:
+	void Run(float* samples, int frameCount, int sampleRate) override {
+		float attackCoef = expf(-1.0f / (attack * sampleRate + 1));
+		float releaseCoef = expf(-1.0f / (release * sampleRate + 1));
+		float thresholdLin = powf(10, threshold / 20);
+		float makeupLin = powf(10, makeup / 20);
+		float exponent = 1 / ratio - 1;
+		for (int i = 0; i < frameCount; i++) {
+			float peak = fmaxf(fabsf(samples[i * 2]), fabsf(samples[i * 2 + 1]));
+			float coef = (peak > envelope ? attackCoef : releaseCoef);
+			envelope = peak + (envelope - peak) * coef;
+			float gain = (envelope > thresholdLin ? powf(envelope / thresholdLin, exponent) : 1);
+			gain *= makeupLin;
+			samples[i * 2] *= gain;
+			samples[i * 2 + 1] *= gain;
+		}
+	}
+
+private:
+	float threshold, ratio, attack, release, makeup;
+	float envelope;
+};
+
+//--------------------------------------------------------------------------------
+// Factory
+//--------------------------------------------------------------------------------
+
+AudioEffect* AudioEffect::Create(const String& typeName) {
+	String name = typeName.ToLower();
+	for (int t = LOWPASS; t <= HIGHSHELF; t++) {
+		if (name == kTypeNames[t]) return new BiquadEffect((Type)t);
+	}
+	if (name == "delay" || name == "echo") return new DelayEffect();
+	if (name == "reverb") return new ReverbEffect();
+	if (name == "distortion") return new DistortionEffect();
+	if (name == "bitcrush") return new BitcrushEffect();
+	if (name == "compressor") return new CompressorEffect();
+	return nullptr;
+}
+
+//--------------------------------------------------------------------------------
+// Effect chains and raylib processors
+//--------------------------------------------------------------------------------
+
+// raylib's AudioCallback carries no user pointer, so each stream chain gets
+// its own trampoline from a fixed table of slots; the master chain has one too.
+static const int kMaxChains = 8;
+
+struct EffectChain {
+	void* streamBuffer;   // AudioStream.buffer identifies the stream
+	AudioStream stream;
+	std::vector<AudioEffect*> effects;
+};
+
+static EffectChain chains[kMaxChains];
+static std::vector<AudioEffect*> masterEffects;
+
+static void RunChain(std::vector<AudioEffect*>& effects, void* buffer, unsigned int frames) {
+	int sampleRate = DeviceSampleRate();
+	for (size_t i = 0; i < effects.size(); i++) {
+		effects[i]->Process((float*)buffer, (int)frames, sampleRate);
+	}
+}
+
+template <int N>
+static void ChainProcessor(void* buffer, unsigned int frames) {
+	RunChain(chains[N].effects, buffer, frames);
+}
+
+static const AudioCallback kProcessors[kMaxChains] = {
+	ChainProcessor<0>, ChainProcessor<1>, ChainProcessor<2>, ChainProcessor<3>,
+	ChainProcessor<4>, ChainProcessor<5>, ChainProcessor<6>, ChainProcessor<7>
+};
+
+static void MasterProcessor(void* buffer, unsigned int frames) {
+	RunChain(masterEffects, buffer, frames);
+}
+
+static void RemoveEffect(std::vector<AudioEffect*>& effects, AudioEffect* effect) {
+	for (size_t i = 0; i < effects.size(); i++) {
+		if (effects[i] == effect) { effects.erase(effects.begin() + i); return; }
+	}
+}
+
+static int FindChain(void* streamBuffer) {
+	for (int i = 0; i < kMaxChains; i++) {
+		if (!chains[i].effects.empty() && chains[i].streamBuffer == streamBuffer) return i;
+	}
+	return -1;
+}
+
+bool AttachStreamEffect(AudioStream stream, AudioEffect* effect) {
+	if (!IsAudioStreamValid(stream) || effect == nullptr) return false;
+	int slot = FindChain(stream.buffer);
+	if (slot < 0) {
+		for (slot = 0; slot < kMaxChains; slot++) {
+			if (chains[slot].effects.empty()) break;
+		}
+		if (slot >= kMaxChains) return false;
+		chains[slot].streamBuffer = stream.buffer;
+		chains[slot].stream = stream;
+		chains[slot].effects.push_back(effect);
+		AttachAudioStreamProcessor(stream, kProcessors[slot]);
+		return true;
+	}
+	RemoveEffect(chains[slot].effects, effect);
+	chains[slot].effects.push_back(effect);
+	return true;
+}
+
+static void DetachFromSlot(int slot, AudioEffect* effect) {
+	RemoveEffect(chains[slot].effects, effect);
+	if (chains[slot].effects.empty()) {
+		DetachAudioStreamProcessor(chains[slot].stream, kProcessors[slot]);
+		chains[slot].streamBuffer = nullptr;
+	}
+}
+
+void DetachStreamEffect(AudioStream stream, AudioEffect* effect) {
+	int slot = FindChain(stream.buffer);
+	if (slot >= 0) DetachFromSlot(slot, effect);
+}
+
+void DetachAllStreamEffects(AudioStream stream) {
+	int slot = FindChain(stream.buffer);
+	if (slot < 0) return;
+	chains[slot].effects.clear();
+	DetachAudioStreamProcessor(chains[slot].stream, kProcessors[slot]);
+	chains[slot].streamBuffer = nullptr;
+}
+
+void AttachMasterEffect(AudioEffect* effect) {
+	if (effect == nullptr) return;
+	if (masterEffects.empty()) AttachAudioMixedProcessor(MasterProcessor);
+	RemoveEffect(masterEffects, effect);
+	masterEffects.push_back(effect);
+}
+
+void DetachMasterEffect(AudioEffect* effect) {
+	if (masterEffects.empty()) return;
+	RemoveEffect(masterEffects, effect);
+	if (masterEffects.empty()) DetachAudioMixedProcessor(MasterProcessor);
+}
+
+void DetachEffectEverywhere(AudioEffect* effect) {
+	for (int slot = 0; slot < kMaxChains; slot++) {
+		if (!chains[slot].effects.empty()) DetachFromSlot(slot, effect);
+	}
+	DetachMasterEffect(effect);
+}
+
+//--------------------------------------------------------------------------------
+// MiniScript glue
+//--------------------------------------------------------------------------------
+
+static String kHandle("_handle");
+
+ValueDict AudioEffectClass() {
+	static ValueDict map;
+	if (map.Count() == 0) {
+		map.SetValue(kHandle, Value::zero);
+		map.SetValue(String("type"), Value::null);
+	}
+	return map;
+}
+
+Value AudioEffectToValue(AudioEffect* effect) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, AudioEffectClass());
+	map.SetValue(kHandle, Value((long)effect));
+	map.SetValue(String("type"), Value(String(effect->TypeName())));
+	return Value(map);
+}
+
+AudioEffect* ValueToAudioEffect(Value value) {
+	if (value.type != ValueType::Map) return nullptr;
+	ValueDict map = value.GetDict();
+	Value handleVal = map.Lookup(kHandle, Value::zero);
+	return (AudioEffect*)(long)handleVal.IntValue();
+}
@@ -0,0 +1,79 @@
+//
+//  AudioEffects.h
+//  MSRLWeb
+//
+//  Native audio effects (filters, delay, reverb, distortion, bitcrush,
+//  compressor) that can be chained onto AudioStreams, Sounds, Music, or the
+//  master output via raylib's audio processors.  Processors always see
+//  interleaved stereo float samples at the device sample rate.
+//
+
+#ifndef AUDIOEFFECTS_H
+#define AUDIOEFFECTS_H
+
+#include "raylib.h"
+#include "MiniscriptTypes.h"
+#include <vector>
+
+class AudioEffect {
+public:
+	enum Type {
+		LOWPASS, HIGHPASS, BANDPASS, NOTCH, PEAK, LOWSHELF, HIGHSHELF,
+		DELAY, REVERB, DISTORTION, BITCRUSH, COMPRESSOR
+	};
+
+	// Create an effect of the given type name (e.g. "lowpass"); null if unknown
+	static AudioEffect* Create(const MiniScript::String& typeName);
+
+	virtual ~AudioEffect() {}
+
+	// Update parameters from a map; keys not present keep their current values
+	virtual void Configure(MiniScript::ValueDict params);
+
+	// Process frameCount interleaved stereo frames in place (timed, honors bypass)
+	void Process(float* samples, int frameCount, int sampleRate);
+
+	// Clear internal state (delay lines, filter history, etc.)
+	virtual void Reset() {}
+
+	Type type;
+	bool bypass;
+
+	// CPU cost accounting
+	double processMs;       // total time spent in Process
+	double framesProcessed; // total frames processed
+	int lastSampleRate;
+
+	// Percentage of real time spent in this effect (100 = one whole core)
+	double CpuPercent() const;
+	const char* TypeName() const;
+
+protected:
+	AudioEffect(Type type);
+	virtual void Run(float* samples, int frameCount, int sampleRate) = 0;
+};
+
+// Attach/detach an effect to the stream's processor chain (effects run in attach order)
+bool AttachStreamEffect(AudioStream stream, AudioEffect* effect);
+void DetachStreamEffect(AudioStream stream, AudioEffect* effect);
+
+// Attach/detach an effect to the master (mixed) output
+void AttachMasterEffect(AudioEffect* effect);
+void DetachMasterEffect(AudioEffect* effect);
+
+// Remove an effect from every chain it is attached to (call before deleting it)
+void DetachEffectEverywhere(AudioEffect* effect);
+
+// Remove all effects from a stream (call before unloading the stream)
+void DetachAllStreamEffects(AudioStream stream);
+
+// MiniScript glue
+
+// Get the AudioEffect class (MiniScript intrinsic class)
+MiniScript::ValueDict AudioEffectClass();
+
+// Convert between MiniScript Value and AudioEffect
+MiniScript::Value AudioEffectToValue(AudioEffect* effect);
+AudioEffect* ValueToAudioEffect(MiniScript::Value value);
+
+#endif // AUDIOEFFECTS_H
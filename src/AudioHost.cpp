@@ -0,0 +1,81 @@
+//
+//  AudioHost.cpp
+//  MSRLWeb
+//
+//  Host-side audio services
+//
+
+#include "AudioHost.h"
+#include <vector>
+
+struct AutoMusic {
+	Music* music;
+	double lastUpdate;   // GetTime() of the last refill while playing (< 0 if not playing)
+	MusicAutoUpdateStats stats;
+};
+
+static std::vector<AutoMusic> autoMusic;
+
+// raylib uses two sub-buffers per stream; when no default size has been set,
+// assume a 4096-frame sub-buffer.
+static int subBufferFrames = 4096;
+
+static int FindAutoMusic(Music* music) {
+	for (int i = 0; i < (int)autoMusic.size(); i++) {
+		if (autoMusic[i].music == music) return i;
+	}
+	return -1;
+}
+
+void SetMusicAutoUpdate(Music* music, bool enabled) {
+	if (music == nullptr) return;
+	int index = FindAutoMusic(music);
+	if (enabled && index < 0) {
+		AutoMusic entry;
+		entry.music = music;
+		entry.lastUpdate = -1;
+		entry.stats = MusicAutoUpdateStats{0, 0, 0};
+		autoMusic.push_back(entry);
+	} else if (!enabled && index >= 0) {
+		autoMusic.erase(autoMusic.begin() + index);
+	}
+}
+
+bool IsMusicAutoUpdate(Music* music) {
+	return FindAutoMusic(music) >= 0;
+}
+
+bool GetMusicAutoUpdateStats(Music* music, MusicAutoUpdateStats* outStats) {
+	int index = FindAutoMusic(music);
+	if (index < 0) return false;
+	*outStats = autoMusic[index].stats;
+	return true;
+}
+
+void UpdateAutoMusicStreams() {
+	if (autoMusic.empty()) return;
+	double now = GetTime();
+	for (size_t i = 0; i < autoMusic.size(); i++) {
+		AutoMusic& entry = autoMusic[i];
+		Music music = *entry.music;
+		if (!IsMusicStreamPlaying(music)) {
+			entry.lastUpdate = -1;
+			continue;
+		}
+
+		if (entry.lastUpdate >= 0 && music.stream.sampleRate > 0) {
+			double gap = now - entry.lastUpdate;
+			if (gap > entry.stats.maxGap) entry.stats.maxGap = gap;
+			double bufferSeconds = 2.0 * subBufferFrames / music.stream.sampleRate;
+			if (gap > bufferSeconds) entry.stats.underruns++;
+		}
+
+		UpdateMusicStream(music);
+		entry.stats.updates++;
+		entry.lastUpdate = now;
+	}
+}
+
+void SetAutoUpdateBufferFrames(int frames) {
+	subBufferFrames = (frames > 0 ? frames : 4096);
+}
@@ -0,0 +1,39 @@
+//
+//  AudioHost.h
+//  MSRLWeb
+//
+//  Host-side audio services that run outside the script: automatic refills
+//  of registered Music streams from MainLoop, so music keeps playing even
+//  when a script frame runs long.
+//
+
+#ifndef AUDIOHOST_H
+#define AUDIOHOST_H
+
+#include "raylib.h"
+
+// Statistics for one auto-updated Music stream
+struct MusicAutoUpdateStats {
+	long updates;      // number of host refills
+	long underruns;    // refills that came too late to keep the buffer from running dry
+	double maxGap;     // longest time between refills while playing, in seconds
+};
+
+// Register (or unregister) a heap-allocated Music for automatic updates.
+// The pointer must stay valid until unregistered.
+void SetMusicAutoUpdate(Music* music, bool enabled);
+
+// Check whether the given Music is registered for automatic updates
+bool IsMusicAutoUpdate(Music* music);
+
+// Get the stats for a registered Music; returns false if not registered
+bool GetMusicAutoUpdateStats(Music* music, MusicAutoUpdateStats* outStats);
+
+// Refill all registered Music streams (called by the host every frame)
+void UpdateAutoMusicStreams();
+
+// Note the stream buffer size in frames (as passed to SetAudioStreamBufferSizeDefault),
+// used to decide how long a stream can go without refilling before it underruns
+void SetAutoUpdateBufferFrames(int frames);
+
+#endif // AUDIOHOST_H
@@ -0,0 +1,153 @@
+//
+//  AudioStreamQueue.cpp
+//  MSRLWeb
+//
+//  Ring buffer for AudioStream callbacks
+//
+
+#include "AudioStreamQueue.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+//--------------------------------------------------------------------------------
+// AudioStreamQueue implementation
+//--------------------------------------------------------------------------------
+
+AudioStreamQueue::AudioStreamQueue(unsigned int capacityFrames, unsigned int frameBytes, unsigned char silence)
+	: underruns(0), framesPlayed(0), silentFrames(0),
+	  buffer(nullptr), capacity(1), frameBytes(frameBytes), silence(silence),
+	  readPos(0), writePos(0) {
+	while (capacity < capacityFrames) capacity <<= 1;
+	buffer = (unsigned char*)malloc((size_t)capacity * frameBytes);
+	if (buffer == nullptr) throw std::bad_alloc();
+}
+
+AudioStreamQueue::~AudioStreamQueue() {
+	free(buffer);
+}
+
+unsigned int AudioStreamQueue::QueuedFrames() const {
+	return writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_acquire);
+}
+
+unsigned int AudioStreamQueue::Write(const void* data, unsigned int frameCount) {
+	unsigned int write = writePos.load(std::memory_order_relaxed);
+	unsigned int read = readPos.load(std::memory_order_acquire);
+	unsigned int space = capacity - (write - read);
+	if (frameCount > space) frameCount = space;
+	if (frameCount == 0) return 0;
+
+	// Copy in (at most) two pieces, wrapping around the end of the buffer
+	unsigned int start = write & (capacity - 1);
+	unsigned int first = capacity - start;
+	if (first > frameCount) first = frameCount;
+	const unsigned char* src = (const unsigned char*)data;
+	memcpy(buffer + (size_t)start * frameBytes, src, (size_t)first * frameBytes);
+	if (frameCount > first) {
+		memcpy(buffer, src + (size_t)first * frameBytes, (size_t)(frameCount - first) * frameBytes);
+	}
+
+	writePos.store(write + frameCount, std::memory_order_release);
+	return frameCount;
+}
+
+void AudioStreamQueue::Read(void* out, unsigned int frameCount) {
+	unsigned int read = readPos.load(std::memory_order_relaxed);
+	unsigned int write = writePos.load(std::memory_order_acquire);
+	unsigned int available = write - read;
+	unsigned int count = (available < frameCount ? available : frameCount);
+
+	unsigned char* dst = (unsigned char*)out;
+	if (count > 0) {
+		unsigned int start = read & (capacity - 1);
+		unsigned int first = capacity - start;
+		if (first > count) first = count;
+		memcpy(dst, buffer + (size_t)start * frameBytes, (size_t)first * frameBytes);
+		if (count > first) {
+			memcpy(dst + (size_t)first * frameBytes, buffer, (size_t)(count - first) * frameBytes);
+		}
+		readPos.store(read + count, std::memory_order_release);
+	}
+
+	if (count < frameCount) {
+		memset(dst + (size_t)count * frameBytes, silence, (size_t)(frameCount - count) * frameBytes);
+		underruns.fetch_add(1, std::memory_order_relaxed);
+		silentFrames.fetch_add(frameCount - count, std::memory_order_relaxed);
+	}
+	framesPlayed.fetch_add(count, std::memory_order_relaxed);
+}
+
+void AudioStreamQueue::Clear() {
+	readPos.store(writePos.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+//--------------------------------------------------------------------------------
+// Stream attachment
+//--------------------------------------------------------------------------------
+
+// raylib's AudioCallback carries no user pointer, so each attached queue gets
+// its own trampoline function from a fixed table of slots.
+static const int kMaxQueues = 8;
+
+struct QueueSlot {
+	void* streamBuffer;   // AudioStream.buffer identifies the stream
+	AudioStreamQueue* queue;
+};
+
+static QueueSlot slots[kMaxQueues];
+
+template <int N>
+static void QueueCallback(void* bufferData, unsigned int frames) {
+	AudioStreamQueue* queue = slots[N].queue;
+	if (queue) queue->Read(bufferData, frames);
+}
+
+static const AudioCallback kCallbacks[kMaxQueues] = {
+	QueueCallback<0>, QueueCallback<1>, QueueCallback<2>, QueueCallback<3>,
+	QueueCallback<4>, QueueCallback<5>, QueueCallback<6>, QueueCallback<7>
+};
+
+static int FindSlot(void* streamBuffer) {
+	for (int i = 0; i < kMaxQueues; i++) {
+		if (slots[i].queue && slots[i].streamBuffer == streamBuffer) return i;
+	}
+	return -1;
+}
+
+AudioStreamQueue* AttachAudioStreamQueue(AudioStream stream, unsigned int capacityFrames) {
+	if (!IsAudioStreamValid(stream) || capacityFrames == 0) return nullptr;
+	DetachAudioStreamQueue(stream);
+
+	int slot;
+	for (slot = 0; slot < kMaxQueues; slot++) {
+		if (!slots[slot].queue) break;
+	}
+	if (slot >= kMaxQueues) return nullptr;
+
+	unsigned int frameBytes = (stream.sampleSize / 8) * stream.channels;
+	unsigned char silence = (stream.sampleSize == 8 ? 128 : 0);
+	AudioStreamQueue* queue = new AudioStreamQueue(capacityFrames, frameBytes, silence);
+
+	slots[slot].streamBuffer = stream.buffer;
+	slots[slot].queue = queue;
+	SetAudioStreamCallback(stream, kCallbacks[slot]);
+	return queue;
+}
+
+AudioStreamQueue* GetAudioStreamQueue(AudioStream stream) {
+	int slot = FindSlot(stream.buffer);
+	return slot < 0 ? nullptr : slots[slot].queue;
+}
+
+void DetachAudioStreamQueue(AudioStream stream) {
+	int slot = FindSlot(stream.buffer);
+	if (slot < 0) return;
+
+	// raylib swaps the callback under its audio lock, so once this returns
+	// the callback can no longer be reading from the queue
+	SetAudioStreamCallback(stream, nullptr);
+	delete slots[slot].queue;
+	slots[slot].queue = nullptr;
+	slots[slot].streamBuffer = nullptr;
+}
@@ -0,0 +1,63 @@
+//
+//  AudioStreamQueue.h
+//  MSRLWeb
+//
+//  Lock-free single-producer/single-consumer ring buffer that can be attached
+//  to a raylib AudioStream.  The script (producer) queues blocks of samples
+//  ahead of time; the stream's audio callback (consumer) drains them, padding
+//  with silence and counting an underrun whenever the queue runs dry.
+//
+
+#ifndef AUDIOSTREAMQUEUE_H
+#define AUDIOSTREAMQUEUE_H
+
+#include "raylib.h"
+#include <atomic>
+
+class AudioStreamQueue {
+public:
+	// Create a queue holding at least capacityFrames frames of frameBytes each
+	// (capacity is rounded up to a power of 2).  silence is the byte value
+	// used to pad short reads (128 for unsigned 8-bit samples, else 0).
+	AudioStreamQueue(unsigned int capacityFrames, unsigned int frameBytes, unsigned char silence);
+	~AudioStreamQueue();
+
+	// Producer side: copy up to frameCount frames in; returns frames accepted
+	unsigned int Write(const void* data, unsigned int frameCount);
+
+	// Consumer side: fill exactly frameCount frames, padding with silence
+	void Read(void* out, unsigned int frameCount);
+
+	// Drop everything queued (call only while the stream is stopped or detached)
+	void Clear();
+
+	unsigned int Capacity() const { return capacity; }
+	unsigned int FrameBytes() const { return frameBytes; }
+	unsigned int QueuedFrames() const;
+	unsigned int FreeFrames() const { return capacity - QueuedFrames(); }
+
+	// Counters updated by the audio callback
+	std::atomic<unsigned int> underruns;
+	std::atomic<unsigned int> framesPlayed;
+	std::atomic<unsigned int> silentFrames;
+
+private:
+	unsigned char* buffer;
+	unsigned int capacity;     // in frames; always a power of 2
+	unsigned int frameBytes;
+	unsigned char silence;
+	std::atomic<unsigned int> readPos;   // monotonically increasing frame counters;
+	std::atomic<unsigned int> writePos;  // wrap-around is handled by unsigned math
+};
+
+// Attach a new queue to the given stream, routing its audio callback to it.
+// Returns nullptr if the stream is invalid or all callback slots are in use.
+AudioStreamQueue* AttachAudioStreamQueue(AudioStream stream, unsigned int capacityFrames);
+
+// Find the queue attached to the given stream, or nullptr if none
+AudioStreamQueue* GetAudioStreamQueue(AudioStream stream);
+
+// Detach and delete the stream's queue (if any), restoring normal buffering
+void DetachAudioStreamQueue(AudioStream stream);
+
+#endif // AUDIOSTREAMQUEUE_H
@@ -0,0 +1,207 @@
+//
+//  CollisionMask.cpp
+//  MSRLWeb
+//
+//  CollisionMask implementation
+//
+
+#include "CollisionMask.h"
+#include "LiveHandles.h"
+#include "RaylibTypes.h"
+#include "MiniscriptInterpreter.h"
+#include "macros.h"
+#include <algorithm>
+#include <math.h>
+
+using namespace MiniScript;
+
+static LiveHandles<CollisionMask> liveCollisionMasks;
+
+static String kHandle("_handle");
+
+//--------------------------------------------------------------------------------
+// CollisionMask implementation
+//--------------------------------------------------------------------------------
+
+CollisionMask::CollisionMask(Image image, Rectangle area, int threshold)
+	: width(0), height(0), wordsPerRow(0), left(0), top(0), right(0), bottom(0), solidCount(0) {
+	liveCollisionMasks.Add(this);
+	if (image.data == nullptr || image.width <= 0 || image.height <= 0) return;
+
+	// Clip the area to the image (truncating, as ImageFromImage does)
+	int x0 = std::max(0, (int)area.x), y0 = std::max(0, (int)area.y);
+	int x1 = std::min(image.width, (int)area.x + (int)area.width);
+	int y1 = std::min(image.height, (int)area.y + (int)area.height);
+	if (x1 <= x0 || y1 <= y0) return;
+	width = x1 - x0;
+	height = y1 - y0;
+	wordsPerRow = (width + 63) / 64;
+	bits.assign((size_t)wordsPerRow * height, 0);
+
+	// RGBA8 is read in place; anything else is converted first
+	bool direct = (image.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+	Color* colors = direct ? (Color*)image.data : LoadImageColors(image);
+	if (colors == nullptr) return;
+
+	left = width; top = height; right = 0; bottom = 0;
+	for (int y = 0; y < height; y++) {
+		const Color* src = colors + (size_t)(y0 + y) * image.width + x0;
+		uint64_t* row = &bits[(size_t)y * wordsPerRow];
+		for (int x = 0; x < width; x++) {
+			if (src[x].a >= threshold) row[x >> 6] |= (uint64_t)1 << (x & 63);
+		}
+		long rowCount = 0;
+		for (int w = 0; w < wordsPerRow; w++) rowCount += __builtin_popcountll(row[w]);
+		if (rowCount == 0) continue;
+		solidCount += rowCount;
+		top = std::min(top, y);
+		bottom = y + 1;
+		int w = 0;
+		while (row[w] == 0) w++;
+		left = std::min(left, w * 64 + __builtin_ctzll(row[w]));
+		w = wordsPerRow - 1;
+		while (row[w] == 0) w--;
+		right = std::max(right, w * 64 + 64 - __builtin_clzll(row[w]));
+	}
+	if (solidCount == 0) left = top = right = bottom = 0;
+
+	if (!direct) UnloadImageColors(colors);
+}
+
+CollisionMask::~CollisionMask() {
+	liveCollisionMasks.Remove(this);
+}
+
+bool CollisionMask::Get(int x, int y) const {
+	if (x < 0 || y < 0 || x >= width || y >= height) return false;
+	return (Row(y)[x >> 6] >> (x & 63)) & 1;
+}
+
+uint64_t CollisionMask::Extract(int y, int x) const {
+	if (x >= width || x <= -64) return 0;
+	if (x < 0) return Extract(y, 0) << -x;
+	const uint64_t* row = Row(y);
+	int w = x >> 6, shift = x & 63;
+	uint64_t result = row[w] >> shift;
+	if (shift != 0 && w + 1 < wordsPerRow) result |= row[w + 1] << (64 - shift);
+	return result;
+}
+
+bool CollisionMask::Overlaps(const CollisionMask& other, int dx, int dy, int* contactX, int* contactY) const {
+	if (solidCount == 0 || other.solidCount == 0) return false;
+
+	// Only the intersection of the two masks' solid bounds can overlap
+	int x0 = std::max(left, other.left + dx), x1 = std::min(right, other.right + dx);
+	int y0 = std::max(top, other.top + dy), y1 = std::min(bottom, other.bottom + dy);
+	if (x0 >= x1 || y0 >= y1) return false;
+
+	int w0 = x0 >> 6, w1 = (x1 - 1) >> 6;
+	for (int y = y0; y < y1; y++) {
+		const uint64_t* row = Row(y);
+		for (int w = w0; w <= w1; w++) {
+			if (row[w] == 0) continue;
+			uint64_t hit = row[w] & other.Extract(y - dy, w * 64 - dx);
+			if (hit == 0) continue;
+			if (contactX) *contactX = w * 64 + __builtin_ctzll(hit);
+			if (contactY) *contactY = y;
+			return true;
+		}
+	}
+	return false;
+}
+
+//--------------------------------------------------------------------------------
+// CollisionMask class
+//--------------------------------------------------------------------------------
+
+// Helper: get the CollisionMask from self
+static CollisionMask* GetCollisionMask(Context* context) {
+	return liveCollisionMasks.FromSelf(context, "CollisionMask");
+}
+
+// Helper: get the other mask, and its offset rounded to whole pixels
+static CollisionMask* GetOther(Context* context, const char* funcName, int* dx, int* dy) {
+	CollisionMask* other = ValueToCollisionMask(context->GetVar(String("other")));
+	if (other == nullptr) RuntimeException(String(funcName) + ": CollisionMask required for other parameter").raise();
+	*dx = (int)floor(context->GetVar(String("offsetX")).DoubleValue() + 0.5);
+	*dy = (int)floor(context->GetVar(String("offsetY")).DoubleValue() + 0.5);
+	return other;
+}
+
+ValueDict CollisionMaskClass() {
+	static ValueDict maskClass;
+
+	if (maskClass.Count() > 0) return maskClass;
+
+	maskClass.SetValue(kHandle, Value::zero);
+	maskClass.SetValue(String("width"), Value::zero);
+	maskClass.SetValue(String("height"), Value::zero);
+	maskClass.SetValue(String("count"), Value::zero);
+	maskClass.SetValue(String("bounds"), Value::null);
+
+	Intrinsic* f;
+
+	// CollisionMask.get
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("x", Value::zero);
+	f->AddParam("y", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		CollisionMask* mask = GetCollisionMask(context);
+		int x = (int)floor(context->GetVar(String("x")).DoubleValue());
+		int y = (int)floor(context->GetVar(String("y")).DoubleValue());
+		return IntrinsicResult(mask->Get(x, y) ? Value::one : Value::zero);
+	};
+	maskClass.SetValue(String("get"), f->GetFunc());
+
+	// CollisionMask.overlaps
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("other");
+	f->AddParam("offsetX", Value::zero);
+	f->AddParam("offsetY", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		CollisionMask* mask = GetCollisionMask(context);
+		int dx, dy;
+		CollisionMask* other = GetOther(context, "CollisionMask.overlaps", &dx, &dy);
+		return IntrinsicResult(mask->Overlaps(*other, dx, dy) ? Value::one : Value::zero);
+	};
+	maskClass.SetValue(String("overlaps"), f->GetFunc());
+
+	// CollisionMask.contactPoint
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("other");
+	f->AddParam("offsetX", Value::zero);
+	f->AddParam("offsetY", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		CollisionMask* mask = GetCollisionMask(context);
+		int dx, dy;
+		CollisionMask* other = GetOther(context, "CollisionMask.contactPoint", &dx, &dy);
+		int x, y;
+		if (!mask->Overlaps(*other, dx, dy, &x, &y)) return IntrinsicResult::Null;
+		ValueList result;
+		result.Add(Value(x));
+		result.Add(Value(y));
+		return IntrinsicResult(Value(result));
+	};
+	maskClass.SetValue(String("contactPoint"), f->GetFunc());
+
+	return maskClass;
+}
+
+Value CollisionMaskToValue(CollisionMask* mask) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, CollisionMaskClass());
+	map.SetValue(kHandle, Value((long)mask));
+	map.SetValue(String("width"), Value(mask->width));
+	map.SetValue(String("height"), Value(mask->height));
+	map.SetValue(String("count"), Value((double)mask->solidCount));
+	map.SetValue(String("bounds"), RectangleToValue(Rectangle{ (float)mask->left, (float)mask->top,
+		(float)(mask->right - mask->left), (float)(mask->bottom - mask->top) }));
+	return Value(map);
+}
+
+CollisionMask* ValueToCollisionMask(Value value) {
+	return liveCollisionMasks.FromValue(value);
+}
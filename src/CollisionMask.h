@@ -0,0 +1,58 @@
+//
+//  CollisionMask.h
+//  MSRLWeb
+//
+//  CollisionMask: the solid (opaque enough) pixels of an image, as one
+//  bit per pixel packed into 64-bit words, row by row.  Two masks are
+//  tested for overlap at any integer offset by shifting the other mask's
+//  row words into line and ANDing them, 64 pixels per operation, within
+//  the intersection of their solid bounds only.
+//
+
+#ifndef COLLISIONMASK_H
+#define COLLISIONMASK_H
+
+#include "raylib.h"
+#include "MiniscriptTypes.h"
+#include <stdint.h>
+#include <vector>
+
+class CollisionMask {
+public:
+	// Solid where alpha >= threshold, in the given area of the image
+	CollisionMask(Image image, Rectangle area, int threshold);
+	~CollisionMask();
+
+	int width, height;
+	int wordsPerRow;
+	std::vector<uint64_t> bits;     // (bits past the width are always 0)
+
+	// Bounds of the solid pixels (empty: right <= left)
+	int left, top, right, bottom;
+	long solidCount;
+
+	bool Get(int x, int y) const;
+
+	// Whether other, placed with its top-left at (dx, dy) in this mask's
+	// coordinates, has any solid pixel on one of ours.  If so and contact
+	// is not null, it gets the first such pixel (topmost, then leftmost),
+	// in this mask's coordinates.
+	bool Overlaps(const CollisionMask& other, int dx, int dy, int* contactX = nullptr, int* contactY = nullptr) const;
+
+private:
+	const uint64_t* Row(int y) const { return &bits[(size_t)y * wordsPerRow]; }
+
+	// 64 bits of row y starting at pixel x (which may be negative or past
+	// the end; pixels outside the mask are 0)
+	uint64_t Extract(int y, int x) const;
+};
+
+// Get the CollisionMask class (MiniScript intrinsic class)
+MiniScript::ValueDict CollisionMaskClass();
+
+// Convert between MiniScript Value and CollisionMask.
+// ValueToCollisionMask returns null for anything but a live CollisionMask.
+MiniScript::Value CollisionMaskToValue(CollisionMask* mask);
+CollisionMask* ValueToCollisionMask(MiniScript::Value value);
+
+#endif // COLLISIONMASK_H
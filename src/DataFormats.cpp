@@ -0,0 +1,449 @@
+//
+//  DataFormats.cpp
+//  MSRLWeb
+//
+//  Native GRFON and TSV implementation
+//
+
+#include "DataFormats.h"
+#include "Json.h"
+#include "MiniscriptInterpreter.h"
+#include <stdlib.h>
+#include <string.h>
+
+using namespace MiniScript;
+
+static const int kMaxDepth = 512;
+
+// Convert text the way `if s == "0" or val(s) != 0 then s = val(s)` does in
+// the scripts: returns true (with the number) if the text counts as numeric.
+static bool NumericValue(const char* s, long n, double* out) {
+	if (n == 1 && s[0] == '0') { *out = 0; return true; }
+	if (n == 0) return false;
+	std::string buf(s, n);
+	double d = strtod(buf.c_str(), nullptr);
+	if (d == 0) return false;
+	*out = d;
+	return true;
+}
+
+//--------------------------------------------------------------------------------
+// GRFON parsing (a line-for-line port of grfon.ms Parser)
+//--------------------------------------------------------------------------------
+
+namespace {
+
+class GrfonParser {
+public:
+	GrfonParser(const char* source, long length, bool trueAndFalse, bool null)
+		: src(source), len(length), p(0), depth(0),
+		  interpretTrueAndFalse(trueAndFalse), interpretNull(null) {}
+
+	Value Parse() { return ParseElement(false); }
+
+private:
+	const char* src;
+	long len;
+	long p;
+	int depth;
+	bool interpretTrueAndFalse;
+	bool interpretNull;
+
+	bool IsCommentStart(long i) const { return i + 1 < len && src[i] == '/' && src[i + 1] == '/'; }
+
+	void SkipWhitespace() {
+		while (p < len) {
+			char c = src[p];
+			if (IsCommentStart(p)) SkipToEOL();
+			else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') p++;
+			else break;
+		}
+	}
+
+	void SkipToEOL() {
+		while (p < len) {
+			char c = src[p++];
+			if (c == '\r' || c == '\n') break;
+		}
+	}
+
+	// Add an unkeyed value to a collection result (or start one)
+	static void AddUnkeyed(Value& result, Value tok) {
+		if (result.IsNull()) {
+			result = tok;
+		} else if (result.type == ValueType::List) {
+			result.GetList().Add(tok);
+		} else if (result.type == ValueType::Map) {
+			ValueDict map = result.GetDict();
+			Value underscore = map.Lookup(String("_"), Value::null);
+			if (underscore.type == ValueType::List) {
+				underscore.GetList().Add(tok);
+			} else {
+				ValueList list;
+				list.Add(tok);
+				map.SetValue(String("_"), Value(list));
+			}
+		} else {
+			ValueList list;
+			list.Add(result);
+			list.Add(tok);
+			result = Value(list);
+		}
+	}
+
+	Value ParseElement(bool asValue) {
+		if (++depth > kMaxDepth) RuntimeException("GRFON error: nesting too deep").raise();
+		Value result = Value::null;
+		while (true) {
+			SkipWhitespace();
+			if (p >= len) break;
+			if (src[p] == '}') {
+				// done with current collection
+				if (!asValue) p++;
+				break;
+			}
+			Value tok;
+			if (src[p] == '{') {
+				// nested collection
+				p++;
+				tok = ParseElement(false);
+				if (tok.IsNull()) tok = Value(ValueDict());	// (interpret {} as an empty map)
+				if (p < len && src[p] == '{') p++;
+			} else {
+				tok = ParseValue();
+			}
+			if (asValue) { result = tok; break; }
+			if (tok.IsNull()) break;
+			char next = 0;
+			SkipWhitespace();
+			if (p < len) next = src[p];
+			if (next == ':') {			// key:value pair
+				p++;	// skip colon
+				Value tok2 = ParseElement(true);
+				if (result.IsNull()) {
+					result = Value(ValueDict());
+				} else if (result.type != ValueType::Map) {
+					ValueDict map;
+					if (result.type == ValueType::List) {
+						map.SetValue(String("_"), result);
+					} else {
+						ValueList list;
+						list.Add(result);
+						map.SetValue(String("_"), Value(list));
+					}
+					result = Value(map);
+				}
+				result.GetDict().SetValue(tok, tok2);
+				SkipWhitespace();
+				if (p < len && src[p] == ';') p++;
+			} else if (next == ';') {	// new collection element
+				if (result.IsNull()) {
+					ValueList list;
+					list.Add(tok);
+					result = Value(list);
+				} else {
+					AddUnkeyed(result, tok);
+				}
+				p++;	// skip semicolon
+			} else {
+				AddUnkeyed(result, tok);
+				if (next == 0) break;
+			}
+		}
+		depth--;
+		return result;
+	}
+
+	Value ParseValue() {
+		SkipWhitespace();
+		if (p >= len) return Value::null;
+		if (src[p] == '}') return Value::null;
+		bool anyEscape;
+		long start = GetStringAndEsc(&anyEscape);
+		const char* s = src + start;
+		long n = p - start;
+		if (p > len) n = len - start;
+		if (interpretTrueAndFalse) {
+			if (n == 4 && strncmp(s, "true", 4) == 0) return Value::one;
+			if (n == 5 && strncmp(s, "false", 5) == 0) return Value::zero;
+		}
+		if (interpretNull && n == 4 && strncmp(s, "null", 4) == 0) return Value::null;
+		if (anyEscape) return Value(Unescape(s, n));
+		double num;
+		if (NumericValue(s, n, &num)) return Value(num);
+		return Value(String(s, n));
+	}
+
+	// Scan a string literal, stopping at a delimiter so the caller can see
+	// if it is a ":" or "}" or whatever.  Returns its start position.
+	long GetStringAndEsc(bool* anyEscape) {
+		long start = p;
+		*anyEscape = false;
+		while (p < len) {
+			char c = src[p];
+			if (c == ':' && p + 2 < len && src[p + 1] == '/' && src[p + 2] == '/') {
+				p += 3;
+				continue;
+			}
+			if (c == ':' || c == ';' || c == '}' || c == '\r' || c == '\n') break;
+			if (IsCommentStart(p)) break;
+			p++;
+			if (c == '\\') {
+				*anyEscape = true;
+				p++;
+			}
+		}
+		return start;
+	}
+
+	static int HexDigit(char c) {
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return 0;
+	}
+
+	static String Unescape(const char* s, long n) {
+		std::string out;
+		out.reserve(n);
+		for (long i = 0; i < n; i++) {
+			if (s[i] != '\\' || i + 1 >= n) {
+				if (s[i] != '\\') out += s[i];
+				continue;
+			}
+			char c = s[++i];
+			switch (c) {
+				case 'b': out += '\b'; break;
+				case 't': out += '\t'; break;
+				case 'n': out += '\n'; break;
+				case 'f': out += '\f'; break;
+				case 'r': out += '\r'; break;
+				case 'u': {
+					// Unicode code point (must always be 4 digits)
+					unsigned long cp = 0;
+					for (int k = 1; k <= 4 && i + k < n; k++) cp = cp * 16 + HexDigit(s[i + k]);
+					AppendUTF8(out, cp);
+					i += 4;
+					break;
+				}
+				default: out += c; break;
+			}
+		}
+		return String(out.c_str(), out.size());
+	}
+};
+
+} // anonymous namespace
+
+Value GrfonParse(const char* source, long length, bool interpretTrueAndFalse, bool interpretNull) {
+	GrfonParser parser(source, length, interpretTrueAndFalse, interpretNull);
+	return parser.Parse();
+}
+
+//--------------------------------------------------------------------------------
+// GRFON generating
+//--------------------------------------------------------------------------------
+
+static void ReplaceAll(std::string& s, const char* from, const char* to) {
+	size_t fromLen = strlen(from), toLen = strlen(to);
+	size_t pos = 0;
+	while ((pos = s.find(from, pos)) != std::string::npos) {
+		s.replace(pos, fromLen, to);
+		pos += toLen;
+	}
+}
+
+// Escape special characters (see grfon.ms escape, including its `://` rule)
+static void GrfonEscape(const String& s, std::string& out) {
+	std::string t;
+	const char* c = s.c_str();
+	for (long i = 0, n = s.LengthB(); i < n; i++) {
+		switch (c[i]) {
+			case '\\': t += "\\\\"; break;
+			case '"':  t += "\\\""; break;
+			case ':':  t += "\\:"; break;
+			case ';':  t += "\\;"; break;
+			case '{':  t += "\\{"; break;
+			case '}':  t += "\\}"; break;
+			case '\b': t += "\\b"; break;
+			case '\t': t += "\\t"; break;
+			case '\n': t += "\\n"; break;
+			case '\f': t += "\\f"; break;
+			case '\r': t += "\\r"; break;
+			default:   t += c[i]; break;
+		}
+	}
+	ReplaceAll(t, "//", "\\/\\/");
+	ReplaceAll(t, "\\:\\/\\/", "://");
+	out += t;
+}
+
+static void GrfonFormatTo(Value value, bool compact, int indent, bool topLevel, std::string& out);
+
+static void AppendIndent(std::string& out, int indent) {
+	for (int i = 0; i < indent; i++) out += "  ";
+}
+
+// Shared by lists and maps: the opening, separators and closing
+static void GrfonCollection(Value value, bool compact, int indent, bool topLevel, std::string& out) {
+	std::string ws;
+	if (compact) {
+		ws = "; ";
+	} else {
+		ws = "\n";
+		if (!topLevel) AppendIndent(ws, indent + 1);
+	}
+	if (!topLevel) {
+		out += '{';
+		if (!compact) out += ws;
+	}
+	int nextIndent = indent + (topLevel ? 0 : 1);
+	if (value.type == ValueType::List) {
+		ValueList list = value.GetList();
+		for (int i = 0; i < list.Count(); i++) {
+			if (i > 0) out += ws;
+			GrfonFormatTo(list[i], compact, nextIndent, false, out);
+		}
+	} else {
+		ValueDict map = value.GetDict();
+		ValueList keys = map.Keys();
+		for (int i = 0; i < keys.Count(); i++) {
+			if (i > 0) out += ws;
+			GrfonFormatTo(keys[i], true, nextIndent, false, out);
+			out += ": ";
+			GrfonFormatTo(map.Lookup(keys[i], Value::null), compact, nextIndent, false, out);
+		}
+	}
+	if (!topLevel) {
+		if (!compact) {
+			out += '\n';
+			AppendIndent(out, indent);
+		}
+		out += '}';
+	}
+}
+
+static void GrfonFormatTo(Value value, bool compact, int indent, bool topLevel, std::string& out) {
+	if (indent > kMaxDepth) RuntimeException("toGRFON: nesting too deep").raise();
+	switch (value.type) {
+		case ValueType::Function: out += "<function>"; break;
+		case ValueType::Null: out += "null"; break;
+		case ValueType::Number: out += value.ToString().c_str(); break;
+		case ValueType::String: GrfonEscape(value.ToString(), out); break;
+		case ValueType::List:
+		case ValueType::Map:
+			GrfonCollection(value, compact, indent, topLevel, out);
+			break;
+		default: break;
+	}
+}
+
+String GrfonFormat(Value value, bool compact, int indent, bool topLevel) {
+	std::string out;
+	GrfonFormatTo(value, compact, indent, topLevel, out);
+	return String(out.c_str(), out.size());
+}
+
+//--------------------------------------------------------------------------------
+// TSV
+//--------------------------------------------------------------------------------
+
+std::vector<TextSpan> TsvSplitLines(const char* text, long length) {
+	// Pick the separator the way tsv.ms does
+	const char* sep = "\n";
+	long sepLen = 1;
+	for (long i = 0; i < length; i++) {
+		if (text[i] == '\r') {
+			if (i + 1 < length && text[i + 1] == '\n') { sep = "\r\n"; sepLen = 2; break; }
+			sep = "\r";		// (keep looking, in case there's a CRLF later)
+		}
+	}
+
+	std::vector<TextSpan> lines;
+	long start = 0;
+	for (long i = 0; i + sepLen <= length; ) {
+		if (strncmp(text + i, sep, sepLen) == 0) {
+			lines.push_back(TextSpan{ text + start, i - start });
+			i += sepLen;
+			start = i;
+		} else {
+			i++;
+		}
+	}
+	lines.push_back(TextSpan{ text + start, length - start });
+	return lines;
+}
+
+static void SplitTabs(const char* s, long n, std::vector<TextSpan>& fields) {
+	fields.clear();
+	long start = 0;
+	for (long i = 0; i < n; i++) {
+		if (s[i] == '\t') {
+			fields.push_back(TextSpan{ s + start, i - start });
+			start = i + 1;
+		}
+	}
+	fields.push_back(TextSpan{ s + start, n - start });
+}
+
+static Value FieldValue(const TextSpan& field) {
+	double num;
+	if (NumericValue(field.text, field.length, &num)) return Value(num);
+	return Value(String(field.text, field.length));
+}
+
+Value TsvParseLines(const std::vector<TextSpan>& lines, bool asRowList, bool columnar) {
+	if (columnar) asRowList = true;
+	if (lines.empty()) return asRowList && !columnar ? Value(ValueList()) : Value(ValueDict());
+
+	// First line should be column names.
+	std::vector<TextSpan> fields;
+	SplitTabs(lines[0].text, lines[0].length, fields);
+	std::vector<Value> colNames;
+	for (size_t i = 0; i < fields.size(); i++) colNames.push_back(Value(String(fields[i].text, fields[i].length)));
+	size_t firstDataCol = asRowList ? 0 : 1;
+
+	ValueList rowList;
+	ValueDict rowMaps;
+	ValueDict columns;
+	ValueList lineNums;
+	std::vector<ValueList> columnLists;
+	if (columnar) {
+		columnLists.resize(colNames.size());
+		for (size_t c = 0; c < colNames.size(); c++) columns.SetValue(colNames[c], Value(columnLists[c]));
+		columns.SetValue(String("_lineNum"), Value(lineNums));
+	}
+
+	// Subsequent lines are data, with row names at index 0.
+	for (size_t lineNum = 1; lineNum < lines.size(); lineNum++) {
+		const char* line = lines[lineNum].text;
+		long n = lines[lineNum].length;
+		if (n == 0) continue;
+		if (line[n - 1] == '\r') n--;	// (fix Windows line endings)
+		SplitTabs(line, n, fields);
+
+		if (columnar) {
+			lineNums.Add(Value((double)(lineNum + 1)));
+			for (size_t c = 0; c < colNames.size(); c++) {
+				columnLists[c].Add(c < fields.size() ? FieldValue(fields[c]) : Value::null);
+			}
+			continue;
+		}
+
+		ValueDict rowMap;
+		rowMap.SetValue(String("_lineNum"), Value((double)(lineNum + 1)));
+		if (asRowList) {
+			rowList.Add(Value(rowMap));
+		} else {
+			if (fields[0].length == 0) continue;
+			rowMaps.SetValue(Value(String(fields[0].text, fields[0].length)), Value(rowMap));
+		}
+		for (size_t c = firstDataCol; c < colNames.size(); c++) {
+			rowMap.SetValue(colNames[c], c < fields.size() ? FieldValue(fields[c]) : Value::null);
+		}
+	}
+
+	if (columnar) return Value(columns);
+	if (asRowList) return Value(rowList);
+	return Value(rowMaps);
+}
@@ -0,0 +1,38 @@
+//
+//  DataFormats.h
+//  MSRLWeb
+//
+//  Native GRFON and TSV readers (and a GRFON writer) backing
+//  assets/lib/grfon.ms and assets/lib/tsv.ms, with the same results as
+//  the script implementations.
+//
+
+#ifndef DATAFORMATS_H
+#define DATAFORMATS_H
+
+#include "MiniscriptTypes.h"
+#include <vector>
+
+// Parse GRFON text (see grfon.ms parse).  The flags match the module's
+// interpretTrueAndFalse and interpretNull settings.
+MiniScript::Value GrfonParse(const char* source, long length, bool interpretTrueAndFalse, bool interpretNull);
+
+// Convert a MiniScript value to GRFON text (see grfon.ms toGRFON)
+MiniScript::String GrfonFormat(MiniScript::Value value, bool compact, int indent, bool topLevel);
+
+// A line of TSV text (not null-terminated)
+struct TextSpan {
+	const char* text;
+	long length;
+};
+
+// Split text into lines the way tsv.ms does: on CRLF if the text has any,
+// otherwise on CR if it has any, otherwise on LF
+std::vector<TextSpan> TsvSplitLines(const char* text, long length);
+
+// Parse TSV lines (the first holding column names; see tsv.ms parseLines).
+// If columnar, return a map from each column name (and "_lineNum") to a
+// list of that column's values, one per data row.
+MiniScript::Value TsvParseLines(const std::vector<TextSpan>& lines, bool asRowList, bool columnar);
+
+#endif // DATAFORMATS_H
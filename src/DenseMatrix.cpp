@@ -0,0 +1,693 @@
+//
+//  DenseMatrix.cpp
+//  MSRLWeb
+//
+//  DenseMatrix implementation
+//
+
+#include "DenseMatrix.h"
+#include "LiveHandles.h"
+#include "RawData.h"
+#include "MiniscriptInterpreter.h"
+#include "macros.h"
+#include <algorithm>
+#include <math.h>
+#include <memory>
+#include <string.h>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+using namespace MiniScript;
+
+// Tile size for multiply: a 64x64 tile of doubles is 32 KB, which stays
+// in L1/L2 cache while every row of the left operand streams past it.
+static const int kMultiplyTile = 64;
+static const int kTransposeTile = 32;
+
+static LiveHandles<DenseMatrix> liveMatrices;
+
+//--------------------------------------------------------------------------------
+// Vector kernels (wasm SIMD when available, scalar otherwise)
+//--------------------------------------------------------------------------------
+
+// y += a * x
+static inline void Axpy(double a, const double* x, double* y, int count) {
+	int i = 0;
+#if defined(__wasm_simd128__)
+	v128_t va = wasm_f64x2_splat(a);
+	for (; i + 2 <= count; i += 2) {
+		v128_t vy = wasm_v128_load(y + i);
+		vy = wasm_f64x2_add(vy, wasm_f64x2_mul(va, wasm_v128_load(x + i)));
+		wasm_v128_store(y + i, vy);
+	}
+#endif
+	for (; i < count; i++) y[i] += a * x[i];
+}
+
+// y += a
+static inline void AddConstant(double a, double* y, size_t count) {
+	size_t i = 0;
+#if defined(__wasm_simd128__)
+	v128_t va = wasm_f64x2_splat(a);
+	for (; i + 2 <= count; i += 2) wasm_v128_store(y + i, wasm_f64x2_add(wasm_v128_load(y + i), va));
+#endif
+	for (; i < count; i++) y[i] += a;
+}
+
+// y *= a
+static inline void ScaleBy(double a, double* y, size_t count) {
+	size_t i = 0;
+#if defined(__wasm_simd128__)
+	v128_t va = wasm_f64x2_splat(a);
+	for (; i + 2 <= count; i += 2) wasm_v128_store(y + i, wasm_f64x2_mul(wasm_v128_load(y + i), va));
+#endif
+	for (; i < count; i++) y[i] *= a;
+}
+
+// y += x
+static inline void AddVector(const double* x, double* y, size_t count) {
+	size_t i = 0;
+#if defined(__wasm_simd128__)
+	for (; i + 2 <= count; i += 2) {
+		wasm_v128_store(y + i, wasm_f64x2_add(wasm_v128_load(y + i), wasm_v128_load(x + i)));
+	}
+#endif
+	for (; i < count; i++) y[i] += x[i];
+}
+
+// y *= x
+static inline void MultiplyVector(const double* x, double* y, size_t count) {
+	size_t i = 0;
+#if defined(__wasm_simd128__)
+	for (; i + 2 <= count; i += 2) {
+		wasm_v128_store(y + i, wasm_f64x2_mul(wasm_v128_load(y + i), wasm_v128_load(x + i)));
+	}
+#endif
+	for (; i < count; i++) y[i] *= x[i];
+}
+
+//--------------------------------------------------------------------------------
+// DenseMatrix implementation
+//--------------------------------------------------------------------------------
+
+DenseMatrix::DenseMatrix(int rows, int columns, double initialValue)
+	: rows(rows), columns(columns), elem((size_t)rows * columns, initialValue) {
+	liveMatrices.Add(this);
+}
+
+DenseMatrix::~DenseMatrix() {
+	liveMatrices.Remove(this);
+}
+
+void DenseMatrix::Fill(double value) {
+	std::fill(elem.begin(), elem.end(), value);
+}
+
+void DenseMatrix::AddScalar(double addend) {
+	AddConstant(addend, elem.data(), elem.size());
+}
+
+void DenseMatrix::Add(const DenseMatrix& addend) {
+	AddVector(addend.elem.data(), elem.data(), elem.size());
+}
+
+void DenseMatrix::MultiplyScalar(double factor) {
+	ScaleBy(factor, elem.data(), elem.size());
+}
+
+void DenseMatrix::ElemMultiply(const DenseMatrix& factor) {
+	MultiplyVector(factor.elem.data(), elem.data(), elem.size());
+}
+
+void DenseMatrix::SwapRows(int rowA, int rowB) {
+	if (rowA == rowB) return;
+	std::swap_ranges(Row(rowA), Row(rowA) + columns, Row(rowB));
+}
+
+void DenseMatrix::SwapColumns(int colA, int colB) {
+	for (int r = 0; r < rows; r++) std::swap(Row(r)[colA], Row(r)[colB]);
+}
+
+void DenseMatrix::Round(int decimalPlaces) {
+	// Same arithmetic as MiniScript's round intrinsic
+	double factor = pow(10.0, decimalPlaces);
+	for (size_t i = 0; i < elem.size(); i++) elem[i] = round(elem[i] * factor) / factor;
+}
+
+void DenseMatrix::TransposeInto(DenseMatrix& out) const {
+	// Work in square tiles, so both the reads and the writes stay in cache
+	for (int r0 = 0; r0 < rows; r0 += kTransposeTile) {
+		int r1 = std::min(r0 + kTransposeTile, rows);
+		for (int c0 = 0; c0 < columns; c0 += kTransposeTile) {
+			int c1 = std::min(c0 + kTransposeTile, columns);
+			for (int r = r0; r < r1; r++) {
+				const double* src = Row(r);
+				for (int c = c0; c < c1; c++) out.elem[(size_t)c * rows + r] = src[c];
+			}
+		}
+	}
+}
+
+void DenseMatrix::Multiply(const DenseMatrix& a, const DenseMatrix& b, DenseMatrix& out) {
+	// Tiled i-k-j order: each output row accumulates a[i][k] * (row k of b),
+	// a contiguous multiply-add the compiler (or our SIMD) can stream through.
+	// For any one output element, the terms are still summed in k order, so
+	// results match the simple triple loop in matrixUtil.ms exactly.
+	out.Fill(0);
+	int inner = a.columns;
+	for (int k0 = 0; k0 < inner; k0 += kMultiplyTile) {
+		int k1 = std::min(k0 + kMultiplyTile, inner);
+		for (int j0 = 0; j0 < b.columns; j0 += kMultiplyTile) {
+			int width = std::min(kMultiplyTile, b.columns - j0);
+			for (int i = 0; i < a.rows; i++) {
+				const double* aRow = a.Row(i);
+				double* outRow = out.Row(i) + j0;
+				for (int k = k0; k < k1; k++) Axpy(aRow[k], b.Row(k) + j0, outRow, width);
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------
+// Conversions
+//--------------------------------------------------------------------------------
+
+DenseMatrix* DenseMatrixFromList(ValueList list, const char** error) {
+	int rows = list.Count();
+	if (rows == 0) { *error = "empty list"; return nullptr; }
+	if (list[0].type != ValueType::List) {
+		// 1D list: a row vector
+		DenseMatrix* m = new DenseMatrix(1, rows);
+		for (int c = 0; c < rows; c++) m->elem[c] = list[c].DoubleValue();
+		return m;
+	}
+	int columns = list[0].GetList().Count();
+	if (columns == 0) { *error = "empty row"; return nullptr; }
+	for (int r = 1; r < rows; r++) {
+		if (list[r].type != ValueType::List || list[r].GetList().Count() != columns) {
+			*error = "rows must be lists of the same length";
+			return nullptr;
+		}
+	}
+	DenseMatrix* m = new DenseMatrix(rows, columns);
+	for (int r = 0; r < rows; r++) {
+		ValueList row = list[r].GetList();
+		double* dest = m->Row(r);
+		for (int c = 0; c < columns; c++) dest[c] = row[c].DoubleValue();
+	}
+	return m;
+}
+
+ValueList DenseMatrixToList(const DenseMatrix& m) {
+	ValueList result;
+	for (int r = 0; r < m.rows; r++) {
+		ValueList row;
+		const double* src = m.Row(r);
+		for (int c = 0; c < m.columns; c++) row.Add(Value(src[c]));
+		result.Add(Value(row));
+	}
+	return result;
+}
+
+DenseMatrix* ValueToNewDenseMatrix(const char* funcName, Value source, int columns) {
+	DenseMatrix* other = ValueToDenseMatrix(source);
+	if (other != nullptr) {
+		DenseMatrix* m = new DenseMatrix(other->rows, other->columns);
+		m->elem = other->elem;
+		return m;
+	}
+
+	const char* error = nullptr;
+	if (source.type == ValueType::List) {
+		DenseMatrix* m = DenseMatrixFromList(source.GetList(), &error);
+		if (m == nullptr) RuntimeException(String(funcName) + ": " + error).raise();
+		return m;
+	}
+
+	if (source.type == ValueType::Map) {
+		ValueDict map = source.GetDict();
+
+		// matrixUtil Matrix
+		Value elem = map.Lookup(String("elem"), Value::null);
+		if (elem.type == ValueType::List) return ValueToNewDenseMatrix(funcName, elem, columns);
+
+		// raylib Matrix (as from GetCameraMatrix2D): m0-m3 are the first
+		// column, m4-m7 the second, and so on
+		if (map.Lookup(String("m0"), Value::null).type == ValueType::Number) {
+			DenseMatrix* m = new DenseMatrix(4, 4);
+			for (int i = 0; i < 16; i++) {
+				m->Row(i % 4)[i / 4] = map.Lookup(String("m") + String::Format(i), Value::zero).DoubleValue();
+			}
+			return m;
+		}
+
+		// RawData of float64 values, row by row
+		BinaryData* data = ValueToRawData(source);
+		if (data != nullptr) {
+			int count = data->length / 8;
+			if (columns < 1 || count == 0 || count % columns != 0) {
+				RuntimeException(String(funcName) + ": RawData length must be a multiple of 8 * columns").raise();
+			}
+			DenseMatrix* m = new DenseMatrix(count / columns, columns);
+			if (data->littleEndian) {
+				memcpy(m->elem.data(), data->bytes, (size_t)count * 8);
+			} else {
+				for (int i = 0; i < count; i++) m->elem[i] = data->GetDouble(i * 8);
+			}
+			return m;
+		}
+	}
+
+	RuntimeException(String(funcName) + ": matrix, list, or RawData required").raise();
+	return nullptr;
+}
+
+//--------------------------------------------------------------------------------
+// MiniScript DenseMatrix class
+//--------------------------------------------------------------------------------
+
+static String kHandle("_handle");
+
+// Helper: get DenseMatrix from self
+static DenseMatrix* GetDenseMatrix(Context* context) {
+	return liveMatrices.FromSelf(context, "DenseMatrix");
+}
+
+// Helper: get a matrix operand (a DenseMatrix as-is, or anything else
+// matrix-like converted into holder)
+static DenseMatrix* GetOperand(const char* funcName, Value value, std::unique_ptr<DenseMatrix>& holder) {
+	DenseMatrix* matrix = ValueToDenseMatrix(value);
+	if (matrix != nullptr) return matrix;
+	holder.reset(ValueToNewDenseMatrix(funcName, value, 0));
+	return holder.get();
+}
+
+// Helper: check that two matrices are the same size
+static void CheckSameSize(const char* funcName, const DenseMatrix& a, const DenseMatrix& b) {
+	if (a.SameSize(b)) return;
+	RuntimeException(String(funcName) + ": size mismatch ("
+		+ String::Format(a.rows) + "x" + String::Format(a.columns) + " and "
+		+ String::Format(b.rows) + "x" + String::Format(b.columns) + ")").raise();
+}
+
+// Helper: get the matrix a method should write its result to -- the
+// given dest (which must be the right size), or else a new matrix
+static DenseMatrix* GetOutput(const char* funcName, Context* context, int rows, int columns, Value* outValue) {
+	Value destVal = context->GetVar(String("dest"));
+	if (destVal.IsNull()) {
+		DenseMatrix* m = new DenseMatrix(rows, columns);
+		*outValue = DenseMatrixToValue(m);
+		return m;
+	}
+	DenseMatrix* dest = ValueToDenseMatrix(destVal);
+	if (dest == nullptr) RuntimeException(String(funcName) + ": dest must be a DenseMatrix").raise();
+	if (dest->rows != rows || dest->columns != columns) {
+		RuntimeException(String(funcName) + ": dest must be "
+			+ String::Format(rows) + "x" + String::Format(columns)).raise();
+	}
+	*outValue = destVal;
+	return dest;
+}
+
+// Helper: get a row or column index, allowing negative values to count from the end
+static int GetIndex(Context* context, const char* name, int limit) {
+	int index = context->GetVar(String(name)).IntValue();
+	if (index < 0) index += limit;
+	if (index < 0 || index >= limit) IndexException().raise();
+	return index;
+}
+
+ValueDict DenseMatrixClass() {
+	static ValueDict denseMatrixClass;
+
+	if (denseMatrixClass.Count() > 0) return denseMatrixClass;
+
+	denseMatrixClass.SetValue(kHandle, Value::zero);
+	denseMatrixClass.SetValue(String("rows"), Value::zero);
+	denseMatrixClass.SetValue(String("columns"), Value::zero);
+
+	Intrinsic* f;
+
+	// DenseMatrix.size
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		ValueList result;
+		result.Add(Value(m->rows));
+		result.Add(Value(m->columns));
+		return IntrinsicResult(Value(result));
+	};
+	denseMatrixClass.SetValue(String("size"), f->GetFunc());
+
+	// DenseMatrix.get
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("row", 0);
+	f->AddParam("column", 0);
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		int r = GetIndex(context, "row", m->rows);
+		int c = GetIndex(context, "column", m->columns);
+		return IntrinsicResult(m->Row(r)[c]);
+	};
+	denseMatrixClass.SetValue(String("get"), f->GetFunc());
+
+	// DenseMatrix.set
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("row", 0);
+	f->AddParam("column", 0);
+	f->AddParam("value", 0);
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		int r = GetIndex(context, "row", m->rows);
+		int c = GetIndex(context, "column", m->columns);
+		m->Row(r)[c] = context->GetVar(String("value")).DoubleValue();
+		return IntrinsicResult::Null;
+	};
+	denseMatrixClass.SetValue(String("set"), f->GetFunc());
+
+	// DenseMatrix.fill
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("value", 0);
+	f->code = INTRINSIC_LAMBDA {
+		GetDenseMatrix(context)->Fill(context->GetVar(String("value")).DoubleValue());
+		return IntrinsicResult::Null;
+	};
+	denseMatrixClass.SetValue(String("fill"), f->GetFunc());
+
+	// DenseMatrix.row
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("zeroBasedRowNum", 0);
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		int r = GetIndex(context, "zeroBasedRowNum", m->rows);
+		DenseMatrix* result = new DenseMatrix(1, m->columns);
+		memcpy(result->elem.data(), m->Row(r), sizeof(double) * m->columns);
+		return IntrinsicResult(DenseMatrixToValue(result));
+	};
+	denseMatrixClass.SetValue(String("row"), f->GetFunc());
+
+	// DenseMatrix.column
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("zeroBasedColNum", 0);
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		int c = GetIndex(context, "zeroBasedColNum", m->columns);
+		DenseMatrix* result = new DenseMatrix(m->rows, 1);
+		for (int r = 0; r < m->rows; r++) result->elem[r] = m->Row(r)[c];
+		return IntrinsicResult(DenseMatrixToValue(result));
+	};
+	denseMatrixClass.SetValue(String("column"), f->GetFunc());
+
+	// DenseMatrix.columnAsRow
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("zeroBasedColNum", 0);
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		int c = GetIndex(context, "zeroBasedColNum", m->columns);
+		DenseMatrix* result = new DenseMatrix(1, m->rows);
+		for (int r = 0; r < m->rows; r++) result->elem[r] = m->Row(r)[c];
+		return IntrinsicResult(DenseMatrixToValue(result));
+	};
+	denseMatrixClass.SetValue(String("columnAsRow"), f->GetFunc());
+
+	// DenseMatrix.transpose
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("dest");
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		Value resultVal;
+		DenseMatrix* result = GetOutput("DenseMatrix.transpose", context, m->columns, m->rows, &resultVal);
+		if (result == m) {
+			// (in place, so work on a copy)
+			DenseMatrix temp(m->columns, m->rows);
+			m->TransposeInto(temp);
+			m->elem.swap(temp.elem);
+		} else {
+			m->TransposeInto(*result);
+		}
+		return IntrinsicResult(resultVal);
+	};
+	denseMatrixClass.SetValue(String("transpose"), f->GetFunc());
+
+	// DenseMatrix.clone
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("dest");
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		Value resultVal;
+		DenseMatrix* result = GetOutput("DenseMatrix.clone", context, m->rows, m->columns, &resultVal);
+		if (result != m) result->elem = m->elem;
+		return IntrinsicResult(resultVal);
+	};
+	denseMatrixClass.SetValue(String("clone"), f->GetFunc());
+
+	// DenseMatrix.add (in place)
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("addend", 0);
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		Value addend = context->GetVar(String("addend"));
+		if (addend.type == ValueType::Number) {
+			m->AddScalar(addend.DoubleValue());
+		} else {
+			std::unique_ptr<DenseMatrix> holder;
+			DenseMatrix* other = GetOperand("DenseMatrix.add", addend, holder);
+			CheckSameSize("DenseMatrix.add", *m, *other);
+			m->Add(*other);
+		}
+		return IntrinsicResult::Null;
+	};
+	denseMatrixClass.SetValue(String("add"), f->GetFunc());
+
+	// DenseMatrix.plus
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("addend", 0);
+	f->AddParam("dest");
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		Value addend = context->GetVar(String("addend"));
+		std::unique_ptr<DenseMatrix> holder;
+		DenseMatrix* other = nullptr;
+		if (addend.type != ValueType::Number) {
+			other = GetOperand("DenseMatrix.plus", addend, holder);
+			CheckSameSize("DenseMatrix.plus", *m, *other);
+		}
+		Value resultVal;
+		DenseMatrix* result = GetOutput("DenseMatrix.plus", context, m->rows, m->columns, &resultVal);
+		if (other != nullptr && result == other) {
+			// dest is the operand; copying self in first would overwrite
+			// it, but the operation commutes, so apply self to it instead
+			result->Add(*m);
+		} else {
+			if (result != m) result->elem = m->elem;
+			if (other == nullptr) result->AddScalar(addend.DoubleValue());
+			else result->Add(*other);
+		}
+		return IntrinsicResult(resultVal);
+	};
+	denseMatrixClass.SetValue(String("plus"), f->GetFunc());
+
+	// DenseMatrix.elemMultiplyBy (in place)
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("factor", 1);
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		Value factor = context->GetVar(String("factor"));
+		if (factor.type == ValueType::Number) {
+			m->MultiplyScalar(factor.DoubleValue());
+		} else {
+			std::unique_ptr<DenseMatrix> holder;
+			DenseMatrix* other = GetOperand("DenseMatrix.elemMultiplyBy", factor, holder);
+			CheckSameSize("DenseMatrix.elemMultiplyBy", *m, *other);
+			m->ElemMultiply(*other);
+		}
+		return IntrinsicResult::Null;
+	};
+	denseMatrixClass.SetValue(String("elemMultiplyBy"), f->GetFunc());
+
+	// DenseMatrix.elemTimes
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("factor", 1);
+	f->AddParam("dest");
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		Value factor = context->GetVar(String("factor"));
+		std::unique_ptr<DenseMatrix> holder;
+		DenseMatrix* other = nullptr;
+		if (factor.type != ValueType::Number) {
+			other = GetOperand("DenseMatrix.elemTimes", factor, holder);
+			CheckSameSize("DenseMatrix.elemTimes", *m, *other);
+		}
+		Value resultVal;
+		DenseMatrix* result = GetOutput("DenseMatrix.elemTimes", context, m->rows, m->columns, &resultVal);
+		if (other != nullptr && result == other) {
+			// dest is the operand; copying self in first would overwrite
+			// it, but the operation commutes, so apply self to it instead
+			result->ElemMultiply(*m);
+		} else {
+			if (result != m) result->elem = m->elem;
+			if (other == nullptr) result->MultiplyScalar(factor.DoubleValue());
+			else result->ElemMultiply(*other);
+		}
+		return IntrinsicResult(resultVal);
+	};
+	denseMatrixClass.SetValue(String("elemTimes"), f->GetFunc());
+
+	// DenseMatrix.times
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("m2", 1);
+	f->AddParam("dest");
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		Value m2 = context->GetVar(String("m2"));
+		Value resultVal;
+		if (m2.type == ValueType::Number) {
+			// simple multiplication by a scalar
+			DenseMatrix* result = GetOutput("DenseMatrix.times", context, m->rows, m->columns, &resultVal);
+			if (result != m) result->elem = m->elem;
+			result->MultiplyScalar(m2.DoubleValue());
+			return IntrinsicResult(resultVal);
+		}
+		// matrix multiplication
+		std::unique_ptr<DenseMatrix> holder;
+		DenseMatrix* other = GetOperand("DenseMatrix.times", m2, holder);
+		if (other->rows != m->columns) {
+			RuntimeException(String("DenseMatrix.times: incompatible sizes ")
+				+ String::Format(m->rows) + "x" + String::Format(m->columns) + " and "
+				+ String::Format(other->rows) + "x" + String::Format(other->columns)).raise();
+		}
+		DenseMatrix* result = GetOutput("DenseMatrix.times", context, m->rows, other->columns, &resultVal);
+		if (result == m || result == other) {
+			// (output overlaps an input, so compute into a temporary)
+			DenseMatrix temp(result->rows, result->columns);
+			DenseMatrix::Multiply(*m, *other, temp);
+			result->elem.swap(temp.elem);
+		} else {
+			DenseMatrix::Multiply(*m, *other, *result);
+		}
+		return IntrinsicResult(resultVal);
+	};
+	denseMatrixClass.SetValue(String("times"), f->GetFunc());
+
+	// DenseMatrix.swapRows
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("rowA", 0);
+	f->AddParam("rowB", 1);
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		m->SwapRows(GetIndex(context, "rowA", m->rows), GetIndex(context, "rowB", m->rows));
+		return IntrinsicResult::Null;
+	};
+	denseMatrixClass.SetValue(String("swapRows"), f->GetFunc());
+
+	// DenseMatrix.swapColumns
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("colA", 0);
+	f->AddParam("colB", 1);
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		m->SwapColumns(GetIndex(context, "colA", m->columns), GetIndex(context, "colB", m->columns));
+		return IntrinsicResult::Null;
+	};
+	denseMatrixClass.SetValue(String("swapColumns"), f->GetFunc());
+
+	// DenseMatrix.sameSize
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("m2");
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		std::unique_ptr<DenseMatrix> holder;
+		DenseMatrix* other = GetOperand("DenseMatrix.sameSize", context->GetVar(String("m2")), holder);
+		return IntrinsicResult(m->SameSize(*other));
+	};
+	denseMatrixClass.SetValue(String("sameSize"), f->GetFunc());
+
+	// DenseMatrix.equals
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("m2");
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		std::unique_ptr<DenseMatrix> holder;
+		DenseMatrix* other = GetOperand("DenseMatrix.equals", context->GetVar(String("m2")), holder);
+		return IntrinsicResult(m->SameSize(*other) && m->elem == other->elem);
+	};
+	denseMatrixClass.SetValue(String("equals"), f->GetFunc());
+
+	// DenseMatrix.round (in place)
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("decimalPlaces", 0);
+	f->code = INTRINSIC_LAMBDA {
+		GetDenseMatrix(context)->Round(context->GetVar(String("decimalPlaces")).IntValue());
+		return IntrinsicResult::Null;
+	};
+	denseMatrixClass.SetValue(String("round"), f->GetFunc());
+
+	// DenseMatrix.toList
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(Value(DenseMatrixToList(*GetDenseMatrix(context))));
+	};
+	denseMatrixClass.SetValue(String("toList"), f->GetFunc());
+
+	// DenseMatrix.toRawData (float64 values, row by row)
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		BinaryData* data = new BinaryData((int)(m->elem.size() * sizeof(double)));
+		memcpy(data->bytes, m->elem.data(), data->length);
+		return IntrinsicResult(RawDataToValue(data));
+	};
+	denseMatrixClass.SetValue(String("toRawData"), f->GetFunc());
+
+	// DenseMatrix.toRaylib (a 4x4 matrix as a raylib Matrix map, m0-m15)
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		DenseMatrix* m = GetDenseMatrix(context);
+		if (m->rows != 4 || m->columns != 4) RuntimeException("DenseMatrix.toRaylib: matrix must be 4x4").raise();
+		ValueDict result;
+		for (int i = 0; i < 16; i++) {
+			result.SetValue(String("m") + String::Format(i), Value(m->Row(i % 4)[i / 4]));
+		}
+		return IntrinsicResult(result);
+	};
+	denseMatrixClass.SetValue(String("toRaylib"), f->GetFunc());
+
+	return denseMatrixClass;
+}
+
+Value DenseMatrixToValue(DenseMatrix* matrix) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, DenseMatrixClass());
+	map.SetValue(kHandle, Value((long)matrix));
+	map.SetValue(String("rows"), Value(matrix->rows));
+	map.SetValue(String("columns"), Value(matrix->columns));
+	return Value(map);
+}
+
+DenseMatrix* ValueToDenseMatrix(Value value) {
+	return liveMatrices.FromValue(value);
+}
@@ -0,0 +1,69 @@
+//
+//  DenseMatrix.h
+//  MSRLWeb
+//
+//  DenseMatrix: a native matrix of doubles in one contiguous row-major
+//  block, with the same methods as the Matrix class in
+//  assets/lib/matrixUtil.ms.  The multiply and transpose kernels work in
+//  cache-sized tiles, and the element-wise loops use wasm SIMD when built
+//  with it.
+//
+
+#ifndef DENSEMATRIX_H
+#define DENSEMATRIX_H
+
+#include "MiniscriptTypes.h"
+#include <vector>
+
+class DenseMatrix {
+public:
+	DenseMatrix(int rows, int columns, double initialValue = 0);
+	~DenseMatrix();
+
+	int rows;
+	int columns;
+	std::vector<double> elem;   // rows * columns values, row by row
+
+	double* Row(int r) { return &elem[(size_t)r * columns]; }
+	const double* Row(int r) const { return &elem[(size_t)r * columns]; }
+
+	bool SameSize(const DenseMatrix& other) const { return rows == other.rows && columns == other.columns; }
+
+	void Fill(double value);
+	void AddScalar(double addend);
+	void Add(const DenseMatrix& addend);                 // element-wise; sizes must match
+	void MultiplyScalar(double factor);
+	void ElemMultiply(const DenseMatrix& factor);        // element-wise; sizes must match
+	void SwapRows(int rowA, int rowB);
+	void SwapColumns(int colA, int colB);
+	void Round(int decimalPlaces);
+
+	// Write the transpose into out (which must be columns x rows, and not this)
+	void TransposeInto(DenseMatrix& out) const;
+
+	// out = a * b.  out must be a.rows x b.columns, and not a or b;
+	// a.columns must equal b.rows.
+	static void Multiply(const DenseMatrix& a, const DenseMatrix& b, DenseMatrix& out);
+};
+
+// Fill a matrix from a 1D list (a row vector) or a 2D list (list of rows);
+// returns null (with error set) if the list is empty or ragged
+DenseMatrix* DenseMatrixFromList(MiniScript::ValueList list, const char** error);
+
+// Convert a matrix back to a list of rows (like matrixUtil's Matrix.elem)
+MiniScript::ValueList DenseMatrixToList(const DenseMatrix& m);
+
+// Get the DenseMatrix class (MiniScript intrinsic class)
+MiniScript::ValueDict DenseMatrixClass();
+
+// Convert between MiniScript Value and DenseMatrix.  ValueToDenseMatrix
+// returns null for anything but a live (not yet unloaded) DenseMatrix.
+MiniScript::Value DenseMatrixToValue(DenseMatrix* matrix);
+DenseMatrix* ValueToDenseMatrix(MiniScript::Value value);
+
+// Make a new matrix from any matrix-like value: a DenseMatrix (copied),
+// a 1D or 2D list, a matrixUtil Matrix, a raylib Matrix map (m0-m15), or
+// a RawData of float64 values (which needs columns).  Raises on failure.
+DenseMatrix* ValueToNewDenseMatrix(const char* funcName, MiniScript::Value source, int columns);
+
+#endif // DENSEMATRIX_H
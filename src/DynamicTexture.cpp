@@ -0,0 +1,348 @@
+//
+//  DynamicTexture.cpp
+//  MSRLWeb
+//
+//  DynamicTexture implementation
+//
+
+#include "DynamicTexture.h"
+#include "LiveHandles.h"
+#include "RaylibTypes.h"
+#include "FrameArena.h"
+#include "MiniscriptInterpreter.h"
+#include "macros.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <unordered_map>
+
+using namespace MiniScript;
+
+// An upload call costs about as much as sending this many more pixels,
+// so two dirty rectangles are merged when their union wastes less.
+static const long kUploadOverheadPixels = 1024;
+
+// Beyond this many separate rectangles, they're merged into one
+static const size_t kMaxDirtyRects = 32;
+
+// Live dynamic textures, and the same by the pixel buffer of their image
+static LiveHandles<DynamicTexture> liveDynamicTextures;
+static std::unordered_map<const void*, DynamicTexture*> dynamicTexturesByPixels;
+
+static String kHandle("_handle");
+
+//--------------------------------------------------------------------------------
+// DynamicTexture implementation
+//--------------------------------------------------------------------------------
+
+DynamicTexture::DynamicTexture(Image source)
+	: allDirty(false), uploads(0), uploadedPixels(0),
+	  trackedData(nullptr), trackedWidth(0), trackedHeight(0), trackedFormat(0) {
+	image = new Image(ImageCopy(source));
+	texture = new Texture(LoadTextureFromImage(*image));
+	Track();
+	liveDynamicTextures.Add(this);
+}
+
+DynamicTexture::~DynamicTexture() {
+	liveDynamicTextures.Remove(this);
+	if (trackedData != nullptr) dynamicTexturesByPixels.erase(trackedData);
+	UnloadTexture(*texture);
+	UnloadImage(*image);
+	delete texture;
+	delete image;
+}
+
+void DynamicTexture::Track() {
+	if (trackedData != nullptr) dynamicTexturesByPixels.erase(trackedData);
+	trackedData = image->data;
+	trackedWidth = image->width;
+	trackedHeight = image->height;
+	trackedFormat = image->format;
+	if (trackedData != nullptr) dynamicTexturesByPixels[trackedData] = this;
+}
+
+bool OwnedByDynamicTexture(const void* imageOrTexture) {
+	if (imageOrTexture == nullptr) return false;
+	for (DynamicTexture* dynTex : liveDynamicTextures) {
+		if (imageOrTexture == dynTex->image || imageOrTexture == dynTex->texture) return true;
+	}
+	return false;
+}
+
+static inline DirtyRect Union(const DirtyRect& a, const DirtyRect& b) {
+	int x0 = std::min(a.x, b.x), y0 = std::min(a.y, b.y);
+	int x1 = std::max(a.x + a.width, b.x + b.width);
+	int y1 = std::max(a.y + a.height, b.y + b.height);
+	return DirtyRect{ x0, y0, x1 - x0, y1 - y0 };
+}
+
+void DynamicTexture::MarkDirty(int x, int y, int width, int height) {
+	if (allDirty) return;
+	int x0 = std::max(x, 0), y0 = std::max(y, 0);
+	int x1 = std::min(x + width, image->width), y1 = std::min(y + height, image->height);
+	if (x0 >= x1 || y0 >= y1) return;
+	DirtyRect r = { x0, y0, x1 - x0, y1 - y0 };
+	if (r.width == image->width && r.height == image->height) {
+		MarkAllDirty();
+		return;
+	}
+
+	// Fold in every rectangle that's cheaper to upload together with this
+	// one than separately (which includes any it overlaps much).  A merge
+	// grows r, so start over after each.
+	for (size_t i = 0; i < dirty.size(); ) {
+		DirtyRect u = Union(r, dirty[i]);
+		if (u.Area() <= r.Area() + dirty[i].Area() + kUploadOverheadPixels) {
+			r = u;
+			dirty[i] = dirty.back();
+			dirty.pop_back();
+			i = 0;
+		} else {
+			i++;
+		}
+	}
+	dirty.push_back(r);
+
+	if (dirty.size() > kMaxDirtyRects) {
+		DirtyRect all = dirty[0];
+		for (const DirtyRect& d : dirty) all = Union(all, d);
+		dirty.clear();
+		dirty.push_back(all);
+	}
+}
+
+void DynamicTexture::MarkAllDirty() {
+	allDirty = true;
+	dirty.clear();
+}
+
+int DynamicTexture::Flush() {
+	if (image->data == nullptr) return 0;
+	long imagePixels = (long)image->width * image->height;
+
+	// Resized, reformatted (or otherwise reallocated) since the last
+	// flush: the texture no longer fits, so make a new one.  Compressed
+	// formats can't be partially updated, so they always go this way.
+	bool compressed = (image->format >= PIXELFORMAT_COMPRESSED_DXT1_RGB);
+	bool reshaped = (image->data != trackedData || image->width != trackedWidth
+					 || image->height != trackedHeight || image->format != trackedFormat);
+	if (reshaped || (compressed && (allDirty || !dirty.empty()))) {
+		UnloadTexture(*texture);
+		*texture = LoadTextureFromImage(*image);
+		Track();
+		dirty.clear();
+		allDirty = false;
+		uploads++;
+		uploadedPixels += imagePixels;
+		return 1;
+	}
+
+	// Once most of the image is dirty, one full upload beats several
+	long dirtyPixels = 0;
+	for (const DirtyRect& d : dirty) dirtyPixels += d.Area();
+	if (allDirty || dirtyPixels * 4 >= imagePixels * 3) {
+		UpdateTexture(*texture, image->data);
+		dirty.clear();
+		allDirty = false;
+		uploads++;
+		uploadedPixels += imagePixels;
+		return 1;
+	}
+
+	int count = 0;
+	int bytesPerPixel = GetPixelDataSize(1, 1, image->format);
+	size_t stride = (size_t)image->width * bytesPerPixel;
+	for (const DirtyRect& d : dirty) {
+		Rectangle rec = { (float)d.x, (float)d.y, (float)d.width, (float)d.height };
+		const unsigned char* first = (const unsigned char*)image->data + d.y * stride + (size_t)d.x * bytesPerPixel;
+		if (d.width == image->width) {
+			// Full rows are already contiguous
+			UpdateTextureRec(*texture, rec, first);
+		} else {
+			size_t rowBytes = (size_t)d.width * bytesPerPixel;
+			unsigned char* packed = FrameArena::AllocArray<unsigned char>((int)(rowBytes * d.height));
+			for (int y = 0; y < d.height; y++) memcpy(packed + y * rowBytes, first + y * stride, rowBytes);
+			UpdateTextureRec(*texture, rec, packed);
+		}
+		count++;
+		uploadedPixels += d.Area();
+	}
+	uploads += count;
+	dirty.clear();
+	return count;
+}
+
+//--------------------------------------------------------------------------------
+// Dirty notifications from the Image bindings
+//--------------------------------------------------------------------------------
+
+static inline DynamicTexture* FindByPixels(const Image& image) {
+	if (dynamicTexturesByPixels.empty() || image.data == nullptr) return nullptr;
+	auto it = dynamicTexturesByPixels.find(image.data);
+	return (it == dynamicTexturesByPixels.end()) ? nullptr : it->second;
+}
+
+void MarkImageDirty(const Image& image) {
+	DynamicTexture* dynTex = FindByPixels(image);
+	if (dynTex != nullptr) dynTex->MarkAllDirty();
+}
+
+void MarkImageDirty(const Image& image, Rectangle area) {
+	DynamicTexture* dynTex = FindByPixels(image);
+	if (dynTex == nullptr) return;
+	float x0 = std::min(area.x, area.x + area.width), x1 = std::max(area.x, area.x + area.width);
+	float y0 = std::min(area.y, area.y + area.height), y1 = std::max(area.y, area.y + area.height);
+	if (!(isfinite(x0) && isfinite(x1) && isfinite(y0) && isfinite(y1))) {
+		dynTex->MarkAllDirty();
+		return;
+	}
+	// (clamped before the int conversion, which would overflow otherwise)
+	float limit = (float)std::max(image.width, image.height) + 2;
+	x0 = std::max(-2.0f, std::min(x0, limit));  x1 = std::max(-2.0f, std::min(x1, limit));
+	y0 = std::max(-2.0f, std::min(y0, limit));  y1 = std::max(-2.0f, std::min(y1, limit));
+	int ix0 = (int)floorf(x0) - 1, iy0 = (int)floorf(y0) - 1;
+	int ix1 = (int)ceilf(x1) + 1, iy1 = (int)ceilf(y1) + 1;
+	dynTex->MarkDirty(ix0, iy0, ix1 - ix0, iy1 - iy0);
+}
+
+void MarkImageDirty(const Image& image, const Vector2* points, int count, float pad) {
+	if (count <= 0 || FindByPixels(image) == nullptr) return;
+	float x0 = points[0].x, x1 = points[0].x, y0 = points[0].y, y1 = points[0].y;
+	for (int i = 1; i < count; i++) {
+		x0 = std::min(x0, points[i].x);  x1 = std::max(x1, points[i].x);
+		y0 = std::min(y0, points[i].y);  y1 = std::max(y1, points[i].y);
+	}
+	MarkImageDirty(image, Rectangle{ x0 - pad, y0 - pad, x1 - x0 + 2*pad, y1 - y0 + 2*pad });
+}
+
+//--------------------------------------------------------------------------------
+// DynamicTexture class
+//--------------------------------------------------------------------------------
+
+// Helper: get the DynamicTexture from self
+static DynamicTexture* GetDynamicTexture(Context* context) {
+	return liveDynamicTextures.FromSelf(context, "DynamicTexture");
+}
+
+// Image and Texture maps for the dynamic texture's own image and texture
+// (like ImageToValue and TextureToValue, but without a copy)
+static Value ImageMap(Image* image) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, ImageClass());
+	map.SetValue(kHandle, Value((long)image));
+	return Value(map);
+}
+
+static Value TextureMap(Texture* texture) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, TextureClass());
+	map.SetValue(kHandle, Value((long)texture));
+	return Value(map);
+}
+
+// Refresh the plain fields of the map (and of its image and texture maps)
+static void SyncFields(ValueDict map, DynamicTexture* dynTex) {
+	ValueDict imageMap = map.Lookup(String("image"), Value::null).GetDict();
+	imageMap.SetValue(String("width"), Value(dynTex->image->width));
+	imageMap.SetValue(String("height"), Value(dynTex->image->height));
+	imageMap.SetValue(String("mipmaps"), Value(dynTex->image->mipmaps));
+	imageMap.SetValue(String("format"), Value(dynTex->image->format));
+	ValueDict texMap = map.Lookup(String("texture"), Value::null).GetDict();
+	texMap.SetValue(String("id"), Value((int)dynTex->texture->id));
+	texMap.SetValue(String("width"), Value(dynTex->texture->width));
+	texMap.SetValue(String("height"), Value(dynTex->texture->height));
+	texMap.SetValue(String("mipmaps"), Value(dynTex->texture->mipmaps));
+	texMap.SetValue(String("format"), Value(dynTex->texture->format));
+	map.SetValue(String("width"), Value(dynTex->image->width));
+	map.SetValue(String("height"), Value(dynTex->image->height));
+	map.SetValue(String("uploads"), Value((double)dynTex->uploads));
+	map.SetValue(String("uploadedPixels"), Value((double)dynTex->uploadedPixels));
+}
+
+ValueDict DynamicTextureClass() {
+	static ValueDict dynTexClass;
+
+	if (dynTexClass.Count() > 0) return dynTexClass;
+
+	dynTexClass.SetValue(kHandle, Value::zero);
+	dynTexClass.SetValue(String("image"), Value::null);
+	dynTexClass.SetValue(String("texture"), Value::null);
+	dynTexClass.SetValue(String("width"), Value::zero);
+	dynTexClass.SetValue(String("height"), Value::zero);
+	dynTexClass.SetValue(String("uploads"), Value::zero);
+	dynTexClass.SetValue(String("uploadedPixels"), Value::zero);
+
+	Intrinsic* f;
+
+	// DynamicTexture.flush
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		DynamicTexture* dynTex = GetDynamicTexture(context);
+		int count = dynTex->Flush();
+		if (count > 0) SyncFields(context->GetVar(String("self")).GetDict(), dynTex);
+		return IntrinsicResult(Value(count));
+	};
+	dynTexClass.SetValue(String("flush"), f->GetFunc());
+
+	// DynamicTexture.markDirty
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("rec");
+	f->code = INTRINSIC_LAMBDA {
+		DynamicTexture* dynTex = GetDynamicTexture(context);
+		Value recVal = context->GetVar(String("rec"));
+		if (recVal.IsNull()) {
+			dynTex->MarkAllDirty();
+		} else {
+			MarkImageDirty(*dynTex->image, ValueToRectangle(recVal));
+		}
+		return IntrinsicResult::Null;
+	};
+	dynTexClass.SetValue(String("markDirty"), f->GetFunc());
+
+	// DynamicTexture.dirtyRects
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		DynamicTexture* dynTex = GetDynamicTexture(context);
+		ValueList result;
+		if (dynTex->allDirty) {
+			result.Add(RectangleToValue(Rectangle{ 0, 0, (float)dynTex->image->width, (float)dynTex->image->height }));
+		}
+		for (const DirtyRect& d : dynTex->dirty) {
+			result.Add(RectangleToValue(Rectangle{ (float)d.x, (float)d.y, (float)d.width, (float)d.height }));
+		}
+		return IntrinsicResult(Value(result));
+	};
+	dynTexClass.SetValue(String("dirtyRects"), f->GetFunc());
+
+	return dynTexClass;
+}
+
+Value DynamicTextureToValue(DynamicTexture* dynTex) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, DynamicTextureClass());
+	map.SetValue(kHandle, Value((long)dynTex));
+	map.SetValue(String("image"), ImageMap(dynTex->image));
+	map.SetValue(String("texture"), TextureMap(dynTex->texture));
+	SyncFields(map, dynTex);
+	return Value(map);
+}
+
+DynamicTexture* ValueToDynamicTexture(Value value) {
+	return liveDynamicTextures.FromValue(value);
+}
+
+void UnloadDynamicTexture(Value value) {
+	DynamicTexture* dynTex = ValueToDynamicTexture(value);
+	if (dynTex == nullptr) return;
+	delete dynTex;
+	ValueDict map = value.GetDict();
+	map.SetValue(kHandle, Value::zero);
+	Value imageVal = map.Lookup(String("image"), Value::null);
+	if (imageVal.type == ValueType::Map) imageVal.GetDict().SetValue(kHandle, Value::zero);
+	Value texVal = map.Lookup(String("texture"), Value::null);
+	if (texVal.type == ValueType::Map) texVal.GetDict().SetValue(kHandle, Value::zero);
+}
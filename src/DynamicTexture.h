@@ -0,0 +1,85 @@
+//
+//  DynamicTexture.h
+//  MSRLWeb
+//
+//  DynamicTexture: an Image paired with the Texture made from it.  The
+//  Image drawing bindings report the area each call changes, and the
+//  dynamic texture keeps a short list of dirty rectangles (merging ones
+//  that are cheaper to upload together), so that flush re-uploads only
+//  what changed, with UpdateTextureRec.
+//
+
+#ifndef DYNAMICTEXTURE_H
+#define DYNAMICTEXTURE_H
+
+#include "raylib.h"
+#include "MiniscriptTypes.h"
+#include <vector>
+
+struct DirtyRect {
+	int x, y, width, height;
+
+	long Area() const { return (long)width * height; }
+};
+
+class DynamicTexture {
+public:
+	// Makes its own copy of source, and a texture from it
+	DynamicTexture(Image source);
+	~DynamicTexture();
+
+	// Owned by the dynamic texture and freed with it.  Scripts see them as
+	// ordinary Image and Texture maps (dyn.image, dyn.texture), but
+	// UnloadImage and UnloadTexture refuse them (see OwnedByDynamicTexture).
+	Image* image;
+	Texture* texture;
+	std::vector<DirtyRect> dirty;   // disjoint enough to upload one by one
+	bool allDirty;
+
+	// Totals, for diagnostics
+	long uploads;
+	long uploadedPixels;
+
+	// Note a changed area (clipped to the image), or the whole image
+	void MarkDirty(int x, int y, int width, int height);
+	void MarkAllDirty();
+
+	// Upload the dirty areas to the texture.  If the image was resized or
+	// reformatted since the last flush, the texture is recreated instead.
+	// Returns the number of uploads done.
+	int Flush();
+
+private:
+	void Track();
+
+	// The pixel buffer and shape the texture was made from
+	const void* trackedData;
+	int trackedWidth, trackedHeight, trackedFormat;
+};
+
+// Note a change to the pixels of an image.  These are no-ops unless the
+// image belongs to a DynamicTexture.  Float areas are rounded outward,
+// with a pixel to spare.
+void MarkImageDirty(const Image& image);
+void MarkImageDirty(const Image& image, Rectangle area);
+void MarkImageDirty(const Image& image, const Vector2* points, int count, float pad = 1);
+
+// Whether an Image or Texture struct (the _handle of an image or texture
+// map) belongs to a live DynamicTexture, and so must not be unloaded
+// separately
+bool OwnedByDynamicTexture(const void* imageOrTexture);
+
+// Get the DynamicTexture class (MiniScript intrinsic class)
+MiniScript::ValueDict DynamicTextureClass();
+
+// Convert between MiniScript Value and DynamicTexture.
+// ValueToDynamicTexture returns null for anything but a live (not yet
+// unloaded) DynamicTexture.
+MiniScript::Value DynamicTextureToValue(DynamicTexture* dynTex);
+DynamicTexture* ValueToDynamicTexture(MiniScript::Value value);
+
+// Unload a DynamicTexture, and clear the handles of its map (and of its
+// image and texture maps)
+void UnloadDynamicTexture(MiniScript::Value value);
+
+#endif // DYNAMICTEXTURE_H
@@ -0,0 +1,136 @@
+//
+//  FrameArena.cpp
+//  MSRLWeb
+//
+//  Per-frame bump allocator implementation
+//
+
+#include "FrameArena.h"
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace FrameArena {
+
+// Size of the first block; later blocks grow as needed
+static const size_t kInitialBlockSize = 64 * 1024;
+
+// Requests this big get their own malloc (freed at the next Reset) instead
+// of growing the arena, so one long wave or big image doesn't pin its size
+static const size_t kLargeAllocSize = 1024 * 1024;
+
+// After this many frames in a row using under a quarter of the block, it is
+// shrunk back to fit what those frames did use
+static const int kShrinkFrames = 300;
+
+struct Block {
+	unsigned char* base;
+	size_t size;
+	size_t used;
+};
+
+static std::vector<Block> blocks;
+static std::vector<void*> largeAllocs;
+static Stats stats = {0, 0, 0, 0, 0, 0, 0, 0};
+
+// Frames in a row that used under a quarter of the block, and the most any
+// of them used
+static int quietFrames = 0;
+static size_t quietPeak = 0;
+
+static Block& AddBlock(size_t minSize) {
+	size_t size = kInitialBlockSize;
+	if (!blocks.empty() && blocks.back().size * 2 > size) size = blocks.back().size * 2;
+	if (size < minSize) size = minSize;
+
+	unsigned char* base = (unsigned char*)malloc(size);
+	if (base == nullptr) throw std::bad_alloc();
+
+	blocks.push_back(Block{base, size, 0});
+	stats.blockMallocs++;
+	stats.capacity += size;
+	return blocks.back();
+}
+
+void* Alloc(size_t size, size_t align) {
+	if (size == 0) size = 1;
+	if (size >= kLargeAllocSize) {
+		unsigned char* raw = (unsigned char*)malloc(size + align);
+		if (raw == nullptr) throw std::bad_alloc();
+		largeAllocs.push_back(raw);
+		stats.allocations++;
+		stats.largeAllocations++;
+		stats.bytesAllocated += (long)size;
+		stats.frameBytes += size;
+		return (void*)(((size_t)raw + align - 1) & ~(align - 1));
+	}
+	if (blocks.empty()) AddBlock(size + align);
+
+	Block* block = &blocks.back();
+	size_t offset = (block->used + align - 1) & ~(align - 1);
+	if (offset + size > block->size) {
+		block = &AddBlock(size + align);
+		offset = 0;
+	}
+
+	size_t consumed = offset + size - block->used;
+	block->used = offset + size;
+	stats.allocations++;
+	stats.bytesAllocated += (long)consumed;
+	stats.frameBytes += consumed;
+	return block->base + offset;
+}
+
+void Reset() {
+	stats.resets++;
+	if (stats.frameBytes > stats.highWater) stats.highWater = stats.frameBytes;
+	stats.frameBytes = 0;
+
+	for (void* p : largeAllocs) free(p);
+	largeAllocs.clear();
+
+	if (blocks.size() > 1) {
+		// Last frame overflowed; replace all blocks with one that fits it all
+		size_t total = 0;
+		for (size_t i = 0; i < blocks.size(); i++) {
+			total += blocks[i].size;
+			free(blocks[i].base);
+		}
+		blocks.clear();
+		stats.capacity = 0;
+		AddBlock(total);
+		quietFrames = 0;
+		quietPeak = 0;
+	} else if (!blocks.empty()) {
+		Block& block = blocks[0];
+		if (block.size > kInitialBlockSize && block.used < block.size / 4) {
+			if (block.used > quietPeak) quietPeak = block.used;
+			if (++quietFrames >= kShrinkFrames) {
+				// Usage has stayed well below capacity for a while; give it back
+				size_t size = quietPeak * 2;
+				if (size < kInitialBlockSize) size = kInitialBlockSize;
+				free(block.base);
+				blocks.clear();
+				stats.capacity = 0;
+				AddBlock(size);
+				quietFrames = 0;
+				quietPeak = 0;
+			}
+		} else {
+			quietFrames = 0;
+			quietPeak = 0;
+		}
+		if (!blocks.empty()) blocks[0].used = 0;
+	}
+}
+
+Stats GetStats() {
+	return stats;
+}
+
+void ResetStats() {
+	size_t capacity = stats.capacity;
+	stats = Stats{0, 0, 0, 0, 0, capacity, stats.frameBytes, 0};
+}
+
+} // namespace FrameArena
@@ -0,0 +1,59 @@
+//
+//  FrameArena.h
+//  MSRLWeb
+//
+//  Per-frame bump allocator for short-lived scratch buffers in the binding layer
+//  (point arrays, codepoint arrays, sample buffers, etc.).  Memory handed out
+//  here is only valid until the next Reset(), which happens at EndDrawing and
+//  once per host frame, so never keep a pointer to it beyond the current call.
+//
+
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <stddef.h>
+
+namespace FrameArena {
+
+// Counters describing arena usage (exposed to scripts via GetFrameArenaStats)
+struct Stats {
+	long allocations;       // Total number of Alloc calls served
+	long bytesAllocated;    // Total bytes handed out (including alignment padding)
+	long blockMallocs;      // Number of times the arena had to malloc a new block
+	long largeAllocations;  // Allocs too big for the arena, malloc'd separately
+	long resets;            // Number of Reset calls
+	size_t capacity;        // Current total capacity of all blocks
+	size_t frameBytes;      // Bytes in use since the last Reset
+	size_t highWater;       // Largest frameBytes seen at any Reset
+};
+
+// Allocate `size` bytes of scratch memory, aligned to `align` (a power of 2).
+// Never returns null for size > 0; throws std::bad_alloc if the system is out
+// of memory.  Contents are uninitialized.
+void* Alloc(size_t size, size_t align = 16);
+
+// Typed convenience wrapper: scratch array of `count` elements of T.
+// T must be trivially destructible (no destructors are run).
+template <typename T>
+inline T* AllocArray(int count) {
+	if (count <= 0) return nullptr;
+	return (T*)Alloc(sizeof(T) * (size_t)count, alignof(T) > 16 ? alignof(T) : 16);
+}
+
+// Recycle all scratch memory.  If the last frame overflowed into extra blocks,
+// they are merged into one block big enough for that frame, so steady-state
+// frames need no further mallocs.  Allocations of 1 MB or more bypass the
+// blocks (they are malloc'd, and freed here), and a block that stays mostly
+// unused for a few seconds of frames is shrunk, so a one-off spike doesn't
+// hold on to memory for the rest of the session.
+void Reset();
+
+// Get a snapshot of the usage counters.
+Stats GetStats();
+
+// Zero the cumulative counters (capacity is unaffected).
+void ResetStats();
+
+} // namespace FrameArena
+
+#endif // FRAMEARENA_H
@@ -0,0 +1,219 @@
+//
+//  Geometry.cpp
+//  MSRLWeb
+//
+//  2D geometry implementation
+//
+
+#include "Geometry.h"
+#include <math.h>
+
+using namespace MiniScript;
+
+Value LookupInherited(ValueDict map, const String& key) {
+	for (int depth = 0; depth < 16; depth++) {
+		Value v = map.Lookup(key, Value::null);
+		if (!v.IsNull()) return v;
+		Value parent = map.Lookup(Value::magicIsA, Value::null);
+		if (parent.type != ValueType::Map) break;
+		map = parent.GetDict();
+	}
+	return Value::null;
+}
+
+bool ValueToPoint2D(Value value, Point2D* out) {
+	if (value.type == ValueType::Map) {
+		ValueDict map = value.GetDict();
+		out->x = LookupInherited(map, String("x")).DoubleValue();
+		out->y = LookupInherited(map, String("y")).DoubleValue();
+		return true;
+	}
+	if (value.type == ValueType::List) {
+		ValueList list = value.GetList();
+		if (list.Count() < 2) return false;
+		out->x = list[0].DoubleValue();
+		out->y = list[1].DoubleValue();
+		return true;
+	}
+	return false;
+}
+
+Value Point2DToList(Point2D p) {
+	ValueList result;
+	result.Add(Value(p.x));
+	result.Add(Value(p.y));
+	return Value(result);
+}
+
+double ProportionAlongLine(Point2D a, Point2D b, Point2D p) {
+	double abx = b.x - a.x, aby = b.y - a.y;
+	double lenSqr = abx * abx + aby * aby;
+	if (lenSqr == 0) return 0;
+	return ((p.x - a.x) * abx + (p.y - a.y) * aby) / lenSqr;
+}
+
+Point2D NearestPointOnLine(Point2D a, Point2D b, Point2D p) {
+	double t = ProportionAlongLine(a, b, p);
+	return Point2D{ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+}
+
+Point2D NearestPointOnLineSegment(Point2D a, Point2D b, Point2D p) {
+	double t = ProportionAlongLine(a, b, p);
+	if (t <= 0) return a;
+	if (t >= 1) return b;
+	return Point2D{ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+}
+
+double Distance(Point2D a, Point2D b) {
+	double dx = a.x - b.x, dy = a.y - b.y;
+	return sqrt(dx * dx + dy * dy);
+}
+
+bool LineIntersectProportion(Point2D p1, Point2D p2, Point2D p3, Point2D p4, double* outFraction) {
+	double denom = (p4.y - p3.y) * (p2.x - p1.x) - (p4.x - p3.x) * (p2.y - p1.y);
+	if (denom == 0) return false;	// parallel
+	*outFraction = ((p4.x - p3.x) * (p1.y - p3.y) - (p4.y - p3.y) * (p1.x - p3.x)) / denom;
+	return true;
+}
+
+bool LineSegmentsIntersect(Point2D p1, Point2D p2, Point2D p3, Point2D p4) {
+	double denom = (p4.y - p3.y) * (p2.x - p1.x) - (p4.x - p3.x) * (p2.y - p1.y);
+	if (denom == 0) return false;
+	double ua = ((p4.x - p3.x) * (p1.y - p3.y) - (p4.y - p3.y) * (p1.x - p3.x)) / denom;
+	if (ua < 0 || ua > 1) return false;
+	double ub = ((p2.x - p1.x) * (p1.y - p3.y) - (p2.y - p1.y) * (p1.x - p3.x)) / denom;
+	return ub >= 0 && ub <= 1;
+}
+
+Point2D Reflect(Point2D vector, Point2D normal) {
+	double dotProd = vector.x * normal.x + vector.y * normal.y;
+	return Point2D{ vector.x - 2 * dotProd * normal.x, vector.y - 2 * dotProd * normal.y };
+}
+
+bool MoveTowardsXY(Point2D* mover, Point2D target, double maxDist) {
+	double dx = target.x - mover->x;
+	double dy = target.y - mover->y;
+	if (dx == 0 && dy == 0) return false;	// already there
+	double dist = sqrt(dx * dx + dy * dy);
+	if (dist < maxDist) {
+		*mover = target;
+	} else {
+		double f = maxDist / dist;
+		mover->x = mover->x + dx * f;
+		mover->y = mover->y + dy * f;
+	}
+	return true;
+}
+
+Point2D BounceVelocity(const Ball2D& ball, const Segment2D& seg, double friction) {
+	// Compute velocity of each line segment endpoint
+	double v1x = 0, v1y = 0, v2x = 0, v2y = 0;
+	if (seg.hasPrev1) {
+		v1x = seg.p1.x - seg.prev1.x;
+		v1y = seg.p1.y - seg.prev1.y;
+	}
+	if (seg.hasPrev2) {
+		v2x = seg.p2.x - seg.prev2.x;
+		v2y = seg.p2.y - seg.prev2.y;
+	}
+
+	// Compute contact point interpolation factor
+	double lambda = ProportionAlongLine(seg.p1, seg.p2, Point2D{ ball.x, ball.y });
+	double contactVX = v1x + (v2x - v1x) * lambda;
+	double contactVY = v1y + (v2y - v1y) * lambda;
+
+	// Compute normal of the line segment
+	double nx = -(seg.p2.y - seg.p1.y);
+	double ny = seg.p2.x - seg.p1.x;
+	double nlen = sqrt(nx * nx + ny * ny);
+	nx /= nlen; ny /= nlen;
+
+	// Reflect the velocity relative to the contact point
+	Point2D rel = { ball.vx - contactVX, ball.vy - contactVY };
+	Point2D newRel = Reflect(rel, Point2D{ nx, ny });
+
+	// Friction: remove some of the component along the segment
+	double px = ny, py = -nx;
+	double dot = rel.x * px + rel.y * py;
+	return Point2D{ newRel.x - dot * px * friction, newRel.y - dot * py * friction };
+}
+
+void BounceOffSegment(Ball2D* ball, const Segment2D& segment, double friction, double fracBefore) {
+	double prevBallX = ball->x - ball->vx;
+	double prevBallY = ball->y - ball->vy;
+	double t = fracBefore - 0.01;
+	ball->x = prevBallX + (ball->x - prevBallX) * t;
+	ball->y = prevBallY + (ball->y - prevBallY) * t;
+	Point2D v = BounceVelocity(*ball, segment, friction);
+	ball->vx = v.x;
+	ball->vy = v.y;
+}
+
+static bool BounceOffStaticPoly(Ball2D* ball, const Point2D* pts, int count, double friction) {
+	Point2D prevBallPos = { ball->x - ball->vx, ball->y - ball->vy };
+	Point2D ballPos = { ball->x, ball->y };
+	// Find the segment which *first* intersects the ball.
+	double bestFrac = 1;
+	int best = -1;
+	for (int i = 0; i < count; i++) {
+		const Point2D& a = pts[i];
+		const Point2D& b = pts[(i + 1) % count];
+		if (!LineSegmentsIntersect(prevBallPos, ballPos, a, b)) continue;
+		double fracBefore;
+		if (!LineIntersectProportion(prevBallPos, ballPos, a, b, &fracBefore)) continue;
+		if (fracBefore <= 0 || fracBefore > bestFrac) continue;
+		bestFrac = fracBefore;
+		best = i;
+	}
+	if (best < 0) return false;
+	Segment2D seg = { pts[best], pts[(best + 1) % count], false, false, {0, 0}, {0, 0} };
+	BounceOffSegment(ball, seg, friction, bestFrac);
+	return true;
+}
+
+static bool BounceOffMovingPoly(Ball2D* ball, const Point2D* pts, int count, const Point2D* prevPts, double friction) {
+	// For each segment, work in a frame where the segment's average motion
+	// is subtracted from the ball's velocity; then add it back at the end.
+	double bestFrac = 1;
+	int best = -1;
+	Ball2D bestBall = *ball;
+	Segment2D bestSeg;
+	double bestSegVx = 0, bestSegVy = 0;
+	for (int i = 0; i < count; i++) {
+		int nexti = (i + 1) % count;
+		const Point2D& a = pts[i];
+		const Point2D& b = pts[nexti];
+		double segVx = ((a.x - prevPts[i].x) + (b.x - prevPts[nexti].x)) / 2;
+		double segVy = ((a.y - prevPts[i].y) + (b.y - prevPts[nexti].y)) / 2;
+		Ball2D aball = { ball->x, ball->y, ball->vx - segVx, ball->vy - segVy };
+		Point2D prevBallPos = { aball.x - aball.vx, aball.y - aball.vy };
+		Point2D ballPos = { aball.x, aball.y };
+		if (!LineSegmentsIntersect(prevBallPos, ballPos, a, b)) continue;
+		double fracBefore;
+		if (!LineIntersectProportion(prevBallPos, ballPos, a, b, &fracBefore)) continue;
+		if (fracBefore <= 0 || fracBefore > bestFrac) continue;
+		bestFrac = fracBefore;
+		best = i;
+		bestBall = aball;
+		bestSeg.p1 = a;
+		bestSeg.p2 = b;
+		bestSeg.hasPrev1 = bestSeg.hasPrev2 = true;
+		bestSeg.prev1 = Point2D{ prevPts[i].x + segVx, prevPts[i].y + segVy };
+		bestSeg.prev2 = Point2D{ prevPts[nexti].x + segVx, prevPts[nexti].y + segVy };
+		bestSegVx = segVx;
+		bestSegVy = segVy;
+	}
+	if (best < 0) return false;
+	BounceOffSegment(&bestBall, bestSeg, friction, bestFrac);
+	ball->x = bestBall.x;
+	ball->y = bestBall.y;
+	ball->vx = bestBall.vx + bestSegVx;
+	ball->vy = bestBall.vy + bestSegVy;
+	return true;
+}
+
+bool BounceOffPoly(Ball2D* ball, const Point2D* pts, int count, const Point2D* prevPts, double friction) {
+	if (count < 2) return false;
+	if (prevPts == nullptr) return BounceOffStaticPoly(ball, pts, count, friction);
+	return BounceOffMovingPoly(ball, pts, count, prevPts, friction);
+}
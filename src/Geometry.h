@@ -0,0 +1,75 @@
+//
+//  Geometry.h
+//  MSRLWeb
+//
+//  2D geometry kernels behind the hidden intrinsics used by
+//  assets/lib/mathUtil.ms (lines, segments, reflection, and bouncing a
+//  ball off segments and polygons).  Everything works in doubles, with
+//  the same arithmetic as the script versions.
+//
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include "MiniscriptTypes.h"
+
+struct Point2D {
+	double x, y;
+};
+
+// A ball-like object moving from (x-vx, y-vy) to (x, y) this frame
+struct Ball2D {
+	double x, y, vx, vy;
+};
+
+// A line segment, optionally with the previous position of each end
+struct Segment2D {
+	Point2D p1, p2;
+	bool hasPrev1, hasPrev2;
+	Point2D prev1, prev2;
+};
+
+// Look up a key in a map or any of its base classes (as `map.key` does in script)
+MiniScript::Value LookupInherited(MiniScript::ValueDict map, const MiniScript::String& key);
+
+// Get a point from a map with x and y, or an [x, y] list; false if neither
+bool ValueToPoint2D(MiniScript::Value value, Point2D* out);
+
+// Make an [x, y] list
+MiniScript::Value Point2DToList(Point2D p);
+
+// How far along the line from a to b the nearest point to p is (0 at a, 1 at b)
+double ProportionAlongLine(Point2D a, Point2D b, Point2D p);
+
+// Nearest point to p on the infinite line through a and b, or on the segment a-b
+Point2D NearestPointOnLine(Point2D a, Point2D b, Point2D p);
+Point2D NearestPointOnLineSegment(Point2D a, Point2D b, Point2D p);
+
+double Distance(Point2D a, Point2D b);
+
+// Fraction of the way from p1 to p2 where line p1-p2 crosses line p3-p4;
+// false if the lines are parallel
+bool LineIntersectProportion(Point2D p1, Point2D p2, Point2D p3, Point2D p4, double* outFraction);
+
+// Whether segment p1-p2 crosses segment p3-p4
+bool LineSegmentsIntersect(Point2D p1, Point2D p2, Point2D p3, Point2D p4);
+
+// Reflect a vector across a (unit) normal
+Point2D Reflect(Point2D vector, Point2D normal);
+
+// Move mover toward target by at most maxDist; false if it was already there
+bool MoveTowardsXY(Point2D* mover, Point2D target, double maxDist);
+
+// Velocity of a ball after hitting a (possibly moving) segment, relative to
+// the segment's motion (see mathUtil.bounceVelocity)
+Point2D BounceVelocity(const Ball2D& ball, const Segment2D& segment, double friction);
+
+// Stop the ball just short of the segment and give it its bounce velocity
+void BounceOffSegment(Ball2D* ball, const Segment2D& segment, double friction, double fracBefore);
+
+// Bounce a ball off the first edge of a polygon its path crosses.  If
+// prevPts is not null, the polygon moved from there (same point count).
+// Returns whether it bounced.
+bool BounceOffPoly(Ball2D* ball, const Point2D* pts, int count, const Point2D* prevPts, double friction);
+
+#endif // GEOMETRY_H
@@ -0,0 +1,402 @@
+//
+//  ImageFilter.cpp
+//  MSRLWeb
+//
+//  Image filter implementation
+//
+
+#include "ImageFilter.h"
+#include <emscripten.h>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+// raylib's blur is this many box blurs in a row
+static const int kBlurIterations = 4;
+
+// Columns per strip in the vertical blur pass: one row of a strip is
+// 512 bytes, and the running sums for a strip fit in registers/L1.
+static const int kBlurStrip = 32;
+
+// Columns per tile in the 2D convolution, so that the kernel's rows of a
+// tile stay in cache while the tile is swept top to bottom
+static const int kConvolveTile = 256;
+
+//--------------------------------------------------------------------------------
+// One pixel as 4 floats (wasm SIMD when available, scalar otherwise).
+// The scalar version does exactly the same per-lane operations.
+//--------------------------------------------------------------------------------
+
+#if defined(__wasm_simd128__)
+typedef v128_t F4;
+static inline F4 F4Zero() { return wasm_f32x4_splat(0.0f); }
+static inline F4 F4Splat(float v) { return wasm_f32x4_splat(v); }
+static inline F4 F4Load(const float* p) { return wasm_v128_load(p); }
+static inline void F4Store(float* p, F4 v) { wasm_v128_store(p, v); }
+static inline F4 F4Add(F4 a, F4 b) { return wasm_f32x4_add(a, b); }
+static inline F4 F4Sub(F4 a, F4 b) { return wasm_f32x4_sub(a, b); }
+static inline F4 F4Mul(F4 a, F4 b) { return wasm_f32x4_mul(a, b); }
+static inline F4 F4Div(F4 a, F4 b) { return wasm_f32x4_div(a, b); }
+static inline F4 F4Trunc(F4 a) { return wasm_f32x4_trunc(a); }
+#else
+struct F4 { float v[4]; };
+static inline F4 F4Zero() { return F4{ { 0, 0, 0, 0 } }; }
+static inline F4 F4Splat(float v) { return F4{ { v, v, v, v } }; }
+static inline F4 F4Load(const float* p) { return F4{ { p[0], p[1], p[2], p[3] } }; }
+static inline void F4Store(float* p, F4 a) { memcpy(p, a.v, sizeof(a.v)); }
+static inline F4 F4Add(F4 a, F4 b) { for (int k = 0; k < 4; k++) a.v[k] += b.v[k]; return a; }
+static inline F4 F4Sub(F4 a, F4 b) { for (int k = 0; k < 4; k++) a.v[k] -= b.v[k]; return a; }
+static inline F4 F4Mul(F4 a, F4 b) { for (int k = 0; k < 4; k++) a.v[k] *= b.v[k]; return a; }
+static inline F4 F4Div(F4 a, F4 b) { for (int k = 0; k < 4; k++) a.v[k] /= b.v[k]; return a; }
+static inline F4 F4Trunc(F4 a) { for (int k = 0; k < 4; k++) a.v[k] = (float)(int)a.v[k]; return a; }
+#endif
+
+// Pixels to floats (divided by scale, as raylib does: c/255.0f for the
+// convolution, c/1 for the blur)
+static void ColorsToFloats(const Color* pixels, int count, float scale, float* out) {
+	for (int i = 0; i < count; i++) {
+		out[i*4 + 0] = (float)pixels[i].r / scale;
+		out[i*4 + 1] = (float)pixels[i].g / scale;
+		out[i*4 + 2] = (float)pixels[i].b / scale;
+		out[i*4 + 3] = (float)pixels[i].a / scale;
+	}
+}
+
+// Put an RGBA8 pixel buffer in place of the image's data, converting
+// back to the image's own format (as raylib's filters do)
+static void ReplacePixels(Image* image, Color* pixels) {
+	int format = image->format;
+	MemFree(image->data);
+	image->data = pixels;
+	image->format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+	ImageFormat(image, format);
+}
+
+static inline bool Filterable(const Image* image) {
+	return image->data != nullptr && image->width > 0 && image->height > 0
+		&& image->format < PIXELFORMAT_COMPRESSED_DXT1_RGB;
+}
+
+//--------------------------------------------------------------------------------
+// Blur
+//--------------------------------------------------------------------------------
+
+// Horizontal box blur of each row: the average of the pixels from
+// x-r+1 to x+r (those inside the row), kept as a running sum
+static void BoxBlurRows(const float* src, float* dst, int width, int height, int r) {
+	int initial = std::min(r, width);
+	for (int row = 0; row < height; row++) {
+		const float* s = src + (size_t)row * width * 4;
+		float* d = dst + (size_t)row * width * 4;
+		F4 sum = F4Zero();
+		int count = initial;
+		for (int i = 0; i < initial; i++) sum = F4Add(sum, F4Load(s + i*4));
+		for (int x = 0; x < width; x++) {
+			if (x - r >= 0) { sum = F4Sub(sum, F4Load(s + (x - r)*4)); count--; }
+			if (x + r < width) { sum = F4Add(sum, F4Load(s + (x + r)*4)); count++; }
+			F4Store(d + x*4, F4Div(sum, F4Splat((float)count)));
+		}
+	}
+}
+
+// The same, vertically, a strip of columns at a time so that each step
+// down reads two short runs of memory instead of striding the whole
+// image.  (raylib truncates the results of this pass to whole numbers.)
+static void BoxBlurColumns(const float* src, float* dst, int width, int height, int r) {
+	int initial = std::min(r, height);
+	size_t stride = (size_t)width * 4;
+	F4 sums[kBlurStrip];
+	for (int x0 = 0; x0 < width; x0 += kBlurStrip) {
+		int n = std::min(kBlurStrip, width - x0);
+		const float* s = src + (size_t)x0 * 4;
+		float* d = dst + (size_t)x0 * 4;
+		for (int c = 0; c < n; c++) sums[c] = F4Zero();
+		for (int i = 0; i < initial; i++) {
+			for (int c = 0; c < n; c++) sums[c] = F4Add(sums[c], F4Load(s + i*stride + c*4));
+		}
+		int count = initial;
+		for (int y = 0; y < height; y++) {
+			if (y - r >= 0) {
+				const float* out = s + (y - r)*stride;
+				for (int c = 0; c < n; c++) sums[c] = F4Sub(sums[c], F4Load(out + c*4));
+				count--;
+			}
+			if (y + r < height) {
+				const float* in = s + (y + r)*stride;
+				for (int c = 0; c < n; c++) sums[c] = F4Add(sums[c], F4Load(in + c*4));
+				count++;
+			}
+			F4 divisor = F4Splat((float)count);
+			float* row = d + y*stride;
+			for (int c = 0; c < n; c++) F4Store(row + c*4, F4Trunc(F4Div(sums[c], divisor)));
+		}
+	}
+}
+
+void FilterBlurGaussian(Image* image, int blurSize) {
+	if (!Filterable(image)) { ImageBlurGaussian(image, blurSize); return; }
+	if (blurSize < 1) return;		// (nothing to blur; raylib would divide by zero)
+
+	ImageAlphaPremultiply(image);
+	Color* pixels = LoadImageColors(*image);
+	int count = image->width * image->height;
+	std::vector<float> a((size_t)count * 4), b((size_t)count * 4);
+	ColorsToFloats(pixels, count, 1.0f, a.data());
+
+	for (int iter = 0; iter < kBlurIterations; iter++) {
+		BoxBlurRows(a.data(), b.data(), image->width, image->height, blurSize);
+		BoxBlurColumns(b.data(), a.data(), image->width, image->height, blurSize);
+	}
+
+	// Undo the premultiplied alpha
+	for (int i = 0; i < count; i++) {
+		const float* p = &a[(size_t)i * 4];
+		if (p[3] == 0.0f) {
+			pixels[i] = Color{ 0, 0, 0, 0 };
+		} else if (p[3] <= 255.0f) {
+			float alpha = p[3] / 255.0f;
+			pixels[i].r = (unsigned char)std::min(p[0] / alpha, 255.0f);
+			pixels[i].g = (unsigned char)std::min(p[1] / alpha, 255.0f);
+			pixels[i].b = (unsigned char)std::min(p[2] / alpha, 255.0f);
+			pixels[i].a = (unsigned char)p[3];
+		}
+	}
+	ReplacePixels(image, pixels);
+}
+
+//--------------------------------------------------------------------------------
+// Convolution
+//--------------------------------------------------------------------------------
+
+// Like raylib, pixels are addressed by their index in the whole buffer,
+// so a kernel hanging off the left or right edge of a row reads the end
+// of the neighboring row, and anything off the top or bottom counts as 0.
+
+static inline F4 ClampUnit(F4 v) {
+#if defined(__wasm_simd128__)
+	return wasm_f32x4_pmin(wasm_f32x4_splat(1.0f), wasm_f32x4_pmax(wasm_f32x4_splat(0.0f), v));
+#else
+	for (int k = 0; k < 4; k++) v.v[k] = (v.v[k] < 0.0f) ? 0.0f : (v.v[k] > 1.0f) ? 1.0f : v.v[k];
+	return v;
+#endif
+}
+
+static void FloatsToColors(const float* values, int count, Color* out) {
+	for (int i = 0; i < count; i++) {
+		float v[4];
+		F4Store(v, ClampUnit(F4Load(values + (size_t)i * 4)));
+		out[i].r = (unsigned char)(v[0] * 255.0f);
+		out[i].g = (unsigned char)(v[1] * 255.0f);
+		out[i].b = (unsigned char)(v[2] * 255.0f);
+		out[i].a = (unsigned char)(v[3] * 255.0f);
+	}
+}
+
+// Full 2D kernel, summed in the same order as raylib (so with the same
+// rounding), a tile of columns at a time
+static void Convolve2D(const float* src, float* dst, int width, int height, const float* kernel, int kw) {
+	long count = (long)width * height;
+	int h = kw / 2;
+	std::vector<long> offsets(kw * kw);
+	for (int a = 0; a < kw; a++) {
+		for (int b = 0; b < kw; b++) offsets[a*kw + b] = (long)width * (a - h) + (b - h);
+	}
+	long lowest = offsets.front(), highest = offsets.back();
+	for (int x0 = 0; x0 < width; x0 += kConvolveTile) {
+		int x1 = std::min(x0 + kConvolveTile, width);
+		for (int y = 0; y < height; y++) {
+			for (int x = x0; x < x1; x++) {
+				long i = (long)y * width + x;
+				F4 sum = F4Zero();
+				if (i + lowest >= 0 && i + highest < count) {
+					for (int k = 0; k < kw * kw; k++) {
+						sum = F4Add(sum, F4Mul(F4Load(src + (i + offsets[k]) * 4), F4Splat(kernel[k])));
+					}
+				} else {
+					for (int k = 0; k < kw * kw; k++) {
+						long j = i + offsets[k];
+						if (j < 0 || j >= count) continue;
+						sum = F4Add(sum, F4Mul(F4Load(src + j * 4), F4Splat(kernel[k])));
+					}
+				}
+				F4Store(dst + i * 4, sum);
+			}
+		}
+	}
+}
+
+// If the kernel is (to float precision) a column times a row, get them
+static bool FactorKernel(const float* kernel, int kw, std::vector<float>& column, std::vector<float>& row) {
+	int pivot = 0;
+	for (int k = 1; k < kw * kw; k++) {
+		if (fabsf(kernel[k]) > fabsf(kernel[pivot])) pivot = k;
+	}
+	float biggest = fabsf(kernel[pivot]);
+	if (biggest == 0.0f || !isfinite(biggest)) return false;
+	int pr = pivot / kw, pc = pivot % kw;
+	row.assign(kernel + pr*kw, kernel + pr*kw + kw);
+	column.resize(kw);
+	for (int a = 0; a < kw; a++) column[a] = kernel[a*kw + pc] / kernel[pivot];
+	float tolerance = biggest * 1e-6f;
+	for (int a = 0; a < kw; a++) {
+		for (int b = 0; b < kw; b++) {
+			if (fabsf(kernel[a*kw + b] - column[a] * row[b]) > tolerance) return false;
+		}
+	}
+	return true;
+}
+
+// A separable kernel as a horizontal pass and then a vertical one.  The
+// horizontal pass also covers the rows just above and below the image,
+// which the vertical pass reaches into, so the edges come out as in 2D.
+static void ConvolveSeparable(const float* src, float* dst, int width, int height,
+							  const std::vector<float>& column, const std::vector<float>& row) {
+	int kw = (int)row.size();
+	int h = kw / 2;
+	long count = (long)width * height;
+	long before = (long)width * h;				// extra rows above
+	long after = (long)width * (kw - 1 - h);	// and below
+	std::vector<float> mid((size_t)(before + count + after) * 4);
+
+	for (long j = -before; j < count + after; j++) {
+		float* out = &mid[(size_t)(j + before) * 4];
+		F4 sum = F4Zero();
+		long first = j - h, last = j + (kw - 1 - h);
+		if (last >= 0 && first < count) {
+			if (first >= 0 && last < count) {
+				const float* in = src + first * 4;
+				for (int b = 0; b < kw; b++) sum = F4Add(sum, F4Mul(F4Load(in + b*4), F4Splat(row[b])));
+			} else {
+				for (int b = 0; b < kw; b++) {
+					long k = first + b;
+					if (k < 0 || k >= count) continue;
+					sum = F4Add(sum, F4Mul(F4Load(src + k*4), F4Splat(row[b])));
+				}
+			}
+		}
+		F4Store(out, sum);
+	}
+
+	// Vertical pass, a row at a time: each output row is a weighted sum
+	// of kw consecutive rows of mid
+	for (int y = 0; y < height; y++) {
+		float* out = dst + (size_t)y * width * 4;
+		const float* top = &mid[(size_t)y * width * 4];		// row y - h, in mid's coordinates
+		for (int x = 0; x < width; x++) {
+			F4 sum = F4Zero();
+			for (int a = 0; a < kw; a++) {
+				sum = F4Add(sum, F4Mul(F4Load(top + ((size_t)a * width + x) * 4), F4Splat(column[a])));
+			}
+			F4Store(out + x*4, sum);
+		}
+	}
+}
+
+void FilterKernelConvolution(Image* image, const float* kernel, int kernelSize) {
+	if (!Filterable(image) || kernel == nullptr) { ImageKernelConvolution(image, kernel, kernelSize); return; }
+	int kw = (int)sqrtf((float)kernelSize);
+	if (kw * kw != kernelSize) {
+		TraceLog(LOG_WARNING, "IMAGE: Convolution kernel must be square to be applied");
+		return;
+	}
+	if (kw == 0) return;
+
+	Color* pixels = LoadImageColors(*image);
+	int count = image->width * image->height;
+	std::vector<float> src((size_t)count * 4), dst((size_t)count * 4);
+	ColorsToFloats(pixels, count, 255.0f, src.data());
+
+	std::vector<float> column, row;
+	if (kw >= 3 && FactorKernel(kernel, kw, column, row)) {
+		ConvolveSeparable(src.data(), dst.data(), image->width, image->height, column, row);
+	} else {
+		Convolve2D(src.data(), dst.data(), image->width, image->height, kernel, kw);
+	}
+
+	FloatsToColors(dst.data(), count, pixels);
+	ReplacePixels(image, pixels);
+}
+
+//--------------------------------------------------------------------------------
+// Benchmark
+//--------------------------------------------------------------------------------
+
+template <typename NativeFunc, typename RaylibFunc>
+static FilterBenchmarkResult Bench(const char* name, const Image& source, int reps,
+								   NativeFunc nativeFilter, RaylibFunc raylibFilter) {
+	FilterBenchmarkResult result;
+	result.name = name;
+	double nativeMs = 0, raylibMs = 0;
+	Image a = { 0 }, b = { 0 };
+	for (int i = 0; i < reps; i++) {
+		if (i > 0) { UnloadImage(a); UnloadImage(b); }
+		a = ImageCopy(source);
+		b = ImageCopy(source);
+		double t0 = emscripten_get_now();
+		nativeFilter(&a);
+		double t1 = emscripten_get_now();
+		raylibFilter(&b);
+		double t2 = emscripten_get_now();
+		nativeMs += t1 - t0;
+		raylibMs += t2 - t1;
+	}
+	result.nativeMs = nativeMs / reps;
+	result.raylibMs = raylibMs / reps;
+	result.maxDiff = 0;
+	const unsigned char* pa = (const unsigned char*)a.data;
+	const unsigned char* pb = (const unsigned char*)b.data;
+	for (long i = 0; i < (long)a.width * a.height * 4; i++) {
+		result.maxDiff = std::max(result.maxDiff, abs((int)pa[i] - (int)pb[i]));
+	}
+	UnloadImage(a);
+	UnloadImage(b);
+	return result;
+}
+
+std::vector<FilterBenchmarkResult> RunFilterBenchmark(int width, int height, int blurSize, int reps) {
+	width = std::max(8, std::min(width, 4096));
+	height = std::max(8, std::min(height, 4096));
+	blurSize = std::max(blurSize, 1);
+	reps = std::max(reps, 1);
+
+	// A busy RGBA8 image, with varying alpha
+	Image source = GenImageColor(width, height, BLANK);
+	Color* px = (Color*)source.data;
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			unsigned int v = (unsigned int)(x * 73856093) ^ (unsigned int)(y * 19349663);
+			px[y*width + x] = Color{ (unsigned char)(v >> 3), (unsigned char)(x * 255 / width),
+									 (unsigned char)(y * 255 / height), (unsigned char)(128 + (v >> 11) % 128) };
+		}
+	}
+
+	static const float sharpen[9] = { 0, -1, 0, -1, 5, -1, 0, -1, 0 };
+	static float gauss5[25];
+	static float box9[81];
+	static const float binomial[5] = { 1, 4, 6, 4, 1 };
+	for (int a = 0; a < 5; a++) {
+		for (int b = 0; b < 5; b++) gauss5[a*5 + b] = binomial[a] * binomial[b] / 256.0f;
+	}
+	for (int k = 0; k < 81; k++) box9[k] = 1.0f / 81.0f;
+
+	std::vector<FilterBenchmarkResult> results;
+	results.push_back(Bench("blurGaussian", source, reps,
+		[blurSize](Image* img) { FilterBlurGaussian(img, blurSize); },
+		[blurSize](Image* img) { ImageBlurGaussian(img, blurSize); }));
+	results.push_back(Bench("sharpen3x3", source, reps,
+		[](Image* img) { FilterKernelConvolution(img, sharpen, 9); },
+		[](Image* img) { ImageKernelConvolution(img, sharpen, 9); }));
+	results.push_back(Bench("gaussian5x5", source, reps,
+		[](Image* img) { FilterKernelConvolution(img, gauss5, 25); },
+		[](Image* img) { ImageKernelConvolution(img, gauss5, 25); }));
+	results.push_back(Bench("box9x9", source, reps,
+		[](Image* img) { FilterKernelConvolution(img, box9, 81); },
+		[](Image* img) { ImageKernelConvolution(img, box9, 81); }));
+	UnloadImage(source);
+	return results;
+}
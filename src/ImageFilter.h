@@ -0,0 +1,36 @@
+//
+//  ImageFilter.h
+//  MSRLWeb
+//
+//  Faster versions of raylib's ImageBlurGaussian and
+//  ImageKernelConvolution.  Pixels are held as 4 floats (r, g, b, a), so
+//  each pixel is one wasm SIMD vector, and the per-channel arithmetic is
+//  the same as raylib's.  The blur is raylib's repeated box blur (a
+//  running sum, so its cost doesn't grow with the radius), with the
+//  vertical passes done in strips of columns to stay in cache.
+//  Convolution kernels that are the outer product of a column and a row
+//  are detected and applied as two 1D passes.
+//
+
+#ifndef IMAGEFILTER_H
+#define IMAGEFILTER_H
+
+#include "raylib.h"
+#include <string>
+#include <vector>
+
+// Drop-in replacements for the raylib functions of the same name
+void FilterBlurGaussian(Image* image, int blurSize);
+void FilterKernelConvolution(Image* image, const float* kernel, int kernelSize);
+
+// Time of each filter next to the raylib function it replaces, on a
+// width x height image
+struct FilterBenchmarkResult {
+	std::string name;
+	double nativeMs;        // milliseconds per call
+	double raylibMs;
+	int maxDiff;            // largest difference in any channel of any pixel
+};
+std::vector<FilterBenchmarkResult> RunFilterBenchmark(int width, int height, int blurSize, int reps);
+
+#endif // IMAGEFILTER_H
@@ -0,0 +1,341 @@
+//
+//  ImageJob.cpp
+//  MSRLWeb
+//
+//  ImageJob implementation
+//
+
+#include "ImageJob.h"
+#include "LiveHandles.h"
+#include "RaylibTypes.h"
+#include "MiniscriptInterpreter.h"
+#include "macros.h"
+#include <emscripten.h>
+#include <algorithm>
+#include <math.h>
+
+using namespace MiniScript;
+
+// Compiled into raylib (rtextures.c includes the stb_perlin implementation)
+extern "C" float stb_perlin_fbm_noise3(float x, float y, float z, float lacunarity, float gain, int octaves);
+
+// Rows are generated in batches of about this many pixels between checks
+// of the clock
+static const int kBatchPixels = 16384;
+
+// How long ImageJob.wait works on its job each frame (the script is
+// waiting, so it can have most of the frame)
+static const double kWaitBudgetMs = 12;
+
+static double frameBudgetMs = 4;
+
+// Live jobs, and the same, oldest first, for UpdateImageJobs
+static LiveHandles<ImageJob> liveImageJobs;
+static std::vector<ImageJob*> imageJobQueue;
+
+static String kHandle("_handle");
+static String kImage("_image");
+
+//--------------------------------------------------------------------------------
+// ImageJob implementation
+//--------------------------------------------------------------------------------
+
+ImageJob::ImageJob(ImageJobKind kind, int width, int height, const ImageJobParams& params)
+	: kind(kind), params(params), rowsDone(0), handedOff(false), seedsPerRow(0), seedsPerCol(0) {
+	width = std::max(width, 0);
+	height = std::max(height, 0);
+	size_t bytes = (size_t)width * height * sizeof(Color);
+	image.data = (bytes > 0 ? MemAlloc((unsigned int)bytes) : nullptr);
+	image.width = width;
+	image.height = height;
+	image.mipmaps = 1;
+	image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+
+	if (kind == ImageJobKind::Cellular) {
+		// The seeds are placed up front, drawing random values in the same
+		// order as GenImageCellular does
+		seedsPerRow = width / params.tileSize;
+		seedsPerCol = height / params.tileSize;
+		int seedCount = seedsPerRow * seedsPerCol;
+		seeds.resize(seedCount);
+		for (int i = 0; i < seedCount; i++) {
+			int y = (i/seedsPerRow)*params.tileSize + GetRandomValue(0, params.tileSize - 1);
+			int x = (i%seedsPerRow)*params.tileSize + GetRandomValue(0, params.tileSize - 1);
+			seeds[i] = Vector2{ (float)x, (float)y };
+		}
+	}
+
+	liveImageJobs.Add(this);
+	imageJobQueue.push_back(this);
+}
+
+ImageJob::~ImageJob() {
+	if (!handedOff) UnloadImage(image);
+	liveImageJobs.Remove(this);
+	imageJobQueue.erase(std::remove(imageJobQueue.begin(), imageJobQueue.end(), this), imageJobQueue.end());
+}
+
+int ImageJob::Step(double budgetMs) {
+	int batch = std::max(1, kBatchPixels / std::max(image.width, 1));
+	double start = emscripten_get_now();
+	int rows = 0;
+	while (!Done()) {
+		rows += StepRows(batch);
+		if (emscripten_get_now() - start >= budgetMs) break;
+	}
+	return rows;
+}
+
+int ImageJob::StepRows(int count) {
+	int end = std::min(rowsDone + std::max(count, 0), image.height);
+	int rows = end - rowsDone;
+	for (; rowsDone < end; rowsDone++) GenerateRow(rowsDone);
+	if (Done()) {
+		seeds.clear();
+		seeds.shrink_to_fit();
+	}
+	return rows;
+}
+
+// Blend of two colors, as raylib's gradient generators do it
+static inline Color Mix(Color a, Color b, float factor) {
+	return Color{
+		(unsigned char)(int)((float)b.r*factor + (float)a.r*(1.0f - factor)),
+		(unsigned char)(int)((float)b.g*factor + (float)a.g*(1.0f - factor)),
+		(unsigned char)(int)((float)b.b*factor + (float)a.b*(1.0f - factor)),
+		(unsigned char)(int)((float)b.a*factor + (float)a.a*(1.0f - factor))
+	};
+}
+
+// One row of pixels, computed exactly as in the raylib generator
+void ImageJob::GenerateRow(int y) {
+	int width = image.width, height = image.height;
+	Color* row = (Color*)image.data + (size_t)y * width;
+	const ImageJobParams& p = params;
+
+	switch (kind) {
+	case ImageJobKind::GradientLinear: {
+		float radianDirection = (float)(90 - p.direction)/180.f*3.14159f;
+		float cosDir = cosf(radianDirection);
+		float sinDir = sinf(radianDirection);
+		for (int x = 0; x < width; x++) {
+			float factor = (x*cosDir + y*sinDir)/(width*cosDir + height*sinDir);
+			factor = (factor > 1.0f) ? 1.0f : factor;
+			factor = (factor < 0.0f) ? 0.0f : factor;
+			row[x] = Mix(p.colorA, p.colorB, factor);
+		}
+	} break;
+
+	case ImageJobKind::GradientRadial: {
+		float radius = (width < height) ? (float)width/2.0f : (float)height/2.0f;
+		float centerX = (float)width/2.0f;
+		float centerY = (float)height/2.0f;
+		for (int x = 0; x < width; x++) {
+			float dist = hypotf((float)x - centerX, (float)y - centerY);
+			float factor = (dist - radius*p.density)/(radius*(1.0f - p.density));
+			factor = (float)fmax(factor, 0.0f);
+			factor = (float)fmin(factor, 1.f);
+			row[x] = Mix(p.colorA, p.colorB, factor);
+		}
+	} break;
+
+	case ImageJobKind::GradientSquare: {
+		float centerX = (float)width/2.0f;
+		float centerY = (float)height/2.0f;
+		for (int x = 0; x < width; x++) {
+			float distX = fabsf(x - centerX);
+			float distY = fabsf(y - centerY);
+			float manhattanDist = fmaxf(distX/centerX, distY/centerY);
+			float factor = (manhattanDist - p.density)/(1.0f - p.density);
+			factor = fminf(fmaxf(factor, 0.0f), 1.0f);
+			row[x] = Mix(p.colorA, p.colorB, factor);
+		}
+	} break;
+
+	case ImageJobKind::Checked:
+		for (int x = 0; x < width; x++) {
+			row[x] = ((x/p.checksX + y/p.checksY)%2 == 0) ? p.colorA : p.colorB;
+		}
+		break;
+
+	case ImageJobKind::WhiteNoise:
+		for (int x = 0; x < width; x++) {
+			row[x] = (GetRandomValue(0, 99) < (int)(p.factor*100.0f)) ? WHITE : BLACK;
+		}
+		break;
+
+	case ImageJobKind::Cellular: {
+		int tileY = y/p.tileSize;
+		for (int x = 0; x < width; x++) {
+			int tileX = x/p.tileSize;
+			float minDistance = 65536.0f;
+			for (int i = -1; i < 2; i++) {
+				if ((tileX + i < 0) || (tileX + i >= seedsPerRow)) continue;
+				for (int j = -1; j < 2; j++) {
+					if ((tileY + j < 0) || (tileY + j >= seedsPerCol)) continue;
+					Vector2 neighborSeed = seeds[(tileY + j)*seedsPerRow + tileX + i];
+					float dist = (float)hypot(x - (int)neighborSeed.x, y - (int)neighborSeed.y);
+					minDistance = (float)fmin(minDistance, dist);
+				}
+			}
+			int intensity = (int)(minDistance*256.0f/p.tileSize);
+			if (intensity > 255) intensity = 255;
+			row[x] = Color{ (unsigned char)intensity, (unsigned char)intensity, (unsigned char)intensity, 255 };
+		}
+	} break;
+
+	case ImageJobKind::PerlinNoise: {
+		float aspectRatio = (float)width/(float)height;
+		for (int x = 0; x < width; x++) {
+			float nx = (float)(x + p.offsetX)*(p.scale/(float)width);
+			float ny = (float)(y + p.offsetY)*(p.scale/(float)height);
+			if (width > height) nx *= aspectRatio;
+			else ny /= aspectRatio;
+			float noise = stb_perlin_fbm_noise3(nx, ny, 1.0f, 2.0f, 0.5f, 6);
+			if (noise < -1.0f) noise = -1.0f;
+			if (noise > 1.0f) noise = 1.0f;
+			float np = (noise + 1.0f)/2.0f;
+			int intensity = (int)(np*255.0f);
+			row[x] = Color{ (unsigned char)intensity, (unsigned char)intensity, (unsigned char)intensity, 255 };
+		}
+	} break;
+	}
+}
+
+//--------------------------------------------------------------------------------
+// Scheduling
+//--------------------------------------------------------------------------------
+
+void UpdateImageJobs() {
+	if (imageJobQueue.empty()) return;
+	double start = emscripten_get_now();
+	for (ImageJob* job : imageJobQueue) {
+		if (job->Done()) continue;
+		double left = frameBudgetMs - (emscripten_get_now() - start);
+		if (left <= 0) break;
+		job->Step(left);
+	}
+}
+
+void SetImageJobBudget(double ms) {
+	frameBudgetMs = std::max(ms, 0.0);
+}
+
+double GetImageJobBudget() {
+	return frameBudgetMs;
+}
+
+//--------------------------------------------------------------------------------
+// ImageJob class
+//--------------------------------------------------------------------------------
+
+// Helper: get the ImageJob from self
+static ImageJob* GetImageJob(Context* context) {
+	return liveImageJobs.FromSelf(context, "ImageJob");
+}
+
+// The finished image, as an Image map (made once; after that the pixels
+// belong to the script, and are freed with UnloadImage)
+static Value FinishedImage(Context* context, ImageJob* job) {
+	if (!job->Done()) return Value::null;
+	ValueDict map = context->GetVar(String("self")).GetDict();
+	if (!job->handedOff) {
+		map.SetValue(kImage, ImageToValue(job->image));
+		job->handedOff = true;
+	}
+	return map.Lookup(kImage, Value::null);
+}
+
+ValueDict ImageJobClass() {
+	static ValueDict jobClass;
+
+	if (jobClass.Count() > 0) return jobClass;
+
+	jobClass.SetValue(kHandle, Value::zero);
+	jobClass.SetValue(String("width"), Value::zero);
+	jobClass.SetValue(String("height"), Value::zero);
+
+	Intrinsic* f;
+
+	// ImageJob.progress
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(Value((double)GetImageJob(context)->Progress()));
+	};
+	jobClass.SetValue(String("progress"), f->GetFunc());
+
+	// ImageJob.rowsDone
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(Value(GetImageJob(context)->rowsDone));
+	};
+	jobClass.SetValue(String("rowsDone"), f->GetFunc());
+
+	// ImageJob.done
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(GetImageJob(context)->Done() ? Value::one : Value::zero);
+	};
+	jobClass.SetValue(String("done"), f->GetFunc());
+
+	// ImageJob.image
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		ImageJob* job = GetImageJob(context);
+		return IntrinsicResult(FinishedImage(context, job));
+	};
+	jobClass.SetValue(String("image"), f->GetFunc());
+
+	// ImageJob.step
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("ms", Value(4));
+	f->code = INTRINSIC_LAMBDA {
+		ImageJob* job = GetImageJob(context);
+		double ms = context->GetVar(String("ms")).DoubleValue();
+		return IntrinsicResult(Value(job->Step(ms)));
+	};
+	jobClass.SetValue(String("step"), f->GetFunc());
+
+	// ImageJob.wait: work on the job each frame, yielding in between, and
+	// return the finished image
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		ImageJob* job = GetImageJob(context);
+		if (!job->Done()) job->Step(kWaitBudgetMs);
+		if (!job->Done()) {
+			// Let this frame end; we're called again on the next one
+			context->vm->yielding = true;
+			return IntrinsicResult(Value::one, false);
+		}
+		return IntrinsicResult(FinishedImage(context, job));
+	};
+	jobClass.SetValue(String("wait"), f->GetFunc());
+
+	return jobClass;
+}
+
+Value ImageJobToValue(ImageJob* job) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, ImageJobClass());
+	map.SetValue(kHandle, Value((long)job));
+	map.SetValue(String("width"), Value(job->image.width));
+	map.SetValue(String("height"), Value(job->image.height));
+	return Value(map);
+}
+
+ImageJob* ValueToImageJob(Value value) {
+	return liveImageJobs.FromValue(value);
+}
+
+void UnloadImageJob(Value value) {
+	ImageJob* job = ValueToImageJob(value);
+	if (job == nullptr) return;
+	delete job;
+	value.GetDict().SetValue(kHandle, Value::zero);
+}
@@ -0,0 +1,89 @@
+//
+//  ImageJob.h
+//  MSRLWeb
+//
+//  ImageJob: one of raylib's GenImage* generators, run a few rows at a
+//  time instead of all at once, so that a large image can be made without
+//  stalling a frame.  Unfinished jobs are advanced from MainLoop within a
+//  per-frame time budget; a script can also step a job itself, or wait
+//  for it (yielding each frame) and get the finished Image.  The pixels
+//  are the same as those of the raylib function.
+//
+
+#ifndef IMAGEJOB_H
+#define IMAGEJOB_H
+
+#include "raylib.h"
+#include "MiniscriptTypes.h"
+#include <vector>
+
+enum class ImageJobKind {
+	GradientLinear,
+	GradientRadial,
+	GradientSquare,
+	Checked,
+	WhiteNoise,
+	Cellular,
+	PerlinNoise
+};
+
+// Parameters of the generators, named as in raylib (each kind uses some)
+struct ImageJobParams {
+	Color colorA, colorB;       // start/end, inner/outer, col1/col2
+	int direction;              // GradientLinear
+	float density;              // GradientRadial, GradientSquare
+	int checksX, checksY;       // Checked
+	float factor;               // WhiteNoise
+	int tileSize;               // Cellular
+	int offsetX, offsetY;       // PerlinNoise
+	float scale;
+};
+
+class ImageJob {
+public:
+	ImageJob(ImageJobKind kind, int width, int height, const ImageJobParams& params);
+	~ImageJob();
+
+	ImageJobKind kind;
+	ImageJobParams params;
+	Image image;            // RGBA8; filled in from the top
+	int rowsDone;
+	bool handedOff;         // the image now belongs to the script
+
+	bool Done() const { return rowsDone >= image.height; }
+	float Progress() const { return image.height > 0 ? (float)rowsDone / image.height : 1.0f; }
+
+	// Generate rows for about budgetMs (at least one batch of rows, unless
+	// done).  Returns the number of rows generated.
+	int Step(double budgetMs);
+
+	// Generate the next count rows (or fewer, at the end)
+	int StepRows(int count);
+
+private:
+	void GenerateRow(int y);
+
+	std::vector<Vector2> seeds;     // Cellular
+	int seedsPerRow, seedsPerCol;
+};
+
+// Advance unfinished jobs, oldest first, within the per-frame budget.
+// Called once per frame from MainLoop.
+void UpdateImageJobs();
+
+// Time (in milliseconds) UpdateImageJobs may spend per frame
+void SetImageJobBudget(double ms);
+double GetImageJobBudget();
+
+// Get the ImageJob class (MiniScript intrinsic class)
+MiniScript::ValueDict ImageJobClass();
+
+// Convert between MiniScript Value and ImageJob.
+// ValueToImageJob returns null for anything but a live ImageJob.
+MiniScript::Value ImageJobToValue(ImageJob* job);
+ImageJob* ValueToImageJob(MiniScript::Value value);
+
+// Cancel (if unfinished) and free a job, and clear its handle
+void UnloadImageJob(MiniScript::Value value);
+
+#endif // IMAGEJOB_H
@@ -0,0 +1,449 @@
+//
+//  ImageRaster.cpp
+//  MSRLWeb
+//
+//  Image raster fast path implementation
+//
+
+#include "ImageRaster.h"
+#include <emscripten.h>
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+static inline uint32_t PackColor(Color c) {
+	uint32_t p;
+	memcpy(&p, &c, 4);
+	return p;
+}
+
+static inline Color UnpackColor(uint32_t p) {
+	Color c;
+	memcpy(&c, &p, 4);
+	return c;
+}
+
+static inline uint32_t* PixelRow(Image* image, int y) {
+	return (uint32_t*)image->data + (size_t)y * image->width;
+}
+
+bool RasterSupported(const Image* image) {
+	return image != nullptr && image->data != nullptr && image->width > 0 && image->height > 0
+		&& image->format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+}
+
+//--------------------------------------------------------------------------------
+// Span kernels (wasm SIMD when available, scalar otherwise)
+//--------------------------------------------------------------------------------
+
+// Set count pixels starting at p
+static inline void FillSpan(uint32_t* p, int count, uint32_t pixel) {
+	int i = 0;
+#if defined(__wasm_simd128__)
+	v128_t v = wasm_i32x4_splat((int32_t)pixel);
+	for (; i + 8 <= count; i += 8) {
+		wasm_v128_store(p + i, v);
+		wasm_v128_store(p + i + 4, v);
+	}
+	for (; i + 4 <= count; i += 4) wasm_v128_store(p + i, v);
+#endif
+	for (; i < count; i++) p[i] = pixel;
+}
+
+// Tint a source pixel, as raylib's ColorAlphaBlend does: c*(tint+1) >> 8
+static inline uint32_t TintPixel(uint32_t pixel, Color tint) {
+	Color c = UnpackColor(pixel);
+	c.r = (unsigned char)(((unsigned int)c.r * ((unsigned int)tint.r + 1)) >> 8);
+	c.g = (unsigned char)(((unsigned int)c.g * ((unsigned int)tint.g + 1)) >> 8);
+	c.b = (unsigned char)(((unsigned int)c.b * ((unsigned int)tint.b + 1)) >> 8);
+	c.a = (unsigned char)(((unsigned int)c.a * ((unsigned int)tint.a + 1)) >> 8);
+	return PackColor(c);
+}
+
+// Blend an (already tinted) source pixel over a destination pixel, with
+// exactly the integer math of raylib's ColorAlphaBlend
+static inline uint32_t BlendPixel(uint32_t dstPixel, uint32_t srcPixel) {
+	Color src = UnpackColor(srcPixel);
+	if (src.a == 0) return dstPixel;
+	if (src.a == 255) return srcPixel;
+	Color dst = UnpackColor(dstPixel);
+	unsigned int alpha = (unsigned int)src.a + 1;
+	unsigned int dstWeight = (unsigned int)dst.a * (256 - alpha);
+	unsigned int outA = (alpha * 256 + dstWeight) >> 8;		// always > 0 here
+	Color out;
+	out.r = (unsigned char)((((unsigned int)src.r * alpha * 256 + (unsigned int)dst.r * dstWeight) / outA) >> 8);
+	out.g = (unsigned char)((((unsigned int)src.g * alpha * 256 + (unsigned int)dst.g * dstWeight) / outA) >> 8);
+	out.b = (unsigned char)((((unsigned int)src.b * alpha * 256 + (unsigned int)dst.b * dstWeight) / outA) >> 8);
+	out.a = (unsigned char)outA;
+	return PackColor(out);
+}
+
+#if defined(__wasm_simd128__)
+// Tint 4 pixels at once; tintMul holds tint+1 for each channel of 2 pixels
+static inline v128_t TintPixels(v128_t v, v128_t tintMul) {
+	v128_t lo = wasm_u16x8_shr(wasm_i16x8_mul(wasm_u16x8_extend_low_u8x16(v), tintMul), 8);
+	v128_t hi = wasm_u16x8_shr(wasm_i16x8_mul(wasm_u16x8_extend_high_u8x16(v), tintMul), 8);
+	return wasm_u8x16_narrow_i16x8(lo, hi);
+}
+#endif
+
+// Blend count source pixels over the destination.  Groups of 4 that are
+// all fully transparent (after tinting) are skipped, and groups that are
+// all opaque are copied; only mixed groups blend pixel by pixel.
+static void BlendSpan(uint32_t* d, const uint32_t* s, int count, Color tint) {
+	bool tinted = (PackColor(tint) != 0xFFFFFFFFu);
+	int i = 0;
+#if defined(__wasm_simd128__)
+	v128_t tintMul = wasm_i16x8_make(tint.r + 1, tint.g + 1, tint.b + 1, tint.a + 1,
+									 tint.r + 1, tint.g + 1, tint.b + 1, tint.a + 1);
+	v128_t alphaMask = wasm_i32x4_splat((int32_t)0xFF000000);
+	uint32_t group[4];
+	for (; i + 4 <= count; i += 4) {
+		v128_t v = wasm_v128_load(s + i);
+		if (tinted) v = TintPixels(v, tintMul);
+		v128_t a = wasm_v128_and(v, alphaMask);
+		if (!wasm_v128_any_true(a)) continue;
+		if (wasm_i32x4_all_true(wasm_i32x4_eq(a, alphaMask))) {
+			wasm_v128_store(d + i, v);
+			continue;
+		}
+		wasm_v128_store(group, v);
+		for (int k = 0; k < 4; k++) d[i + k] = BlendPixel(d[i + k], group[k]);
+	}
+#endif
+	for (; i < count; i++) d[i] = BlendPixel(d[i], tinted ? TintPixel(s[i], tint) : s[i]);
+}
+
+//--------------------------------------------------------------------------------
+// Rectangles and circles
+//--------------------------------------------------------------------------------
+
+// Fill a rectangle with raylib's ImageDrawRectangleRec clipping, quirks
+// included: it always sets the first pixel, and fills the whole first row
+// even when the height rounds down to zero.
+static void FillRectangle(Image* dst, Rectangle rec, uint32_t pixel) {
+	if (rec.x < 0) { rec.width += rec.x; rec.x = 0; }
+	if (rec.y < 0) { rec.height += rec.y; rec.y = 0; }
+	if (rec.width < 0) rec.width = 0;
+	if (rec.height < 0) rec.height = 0;
+	if ((rec.x + rec.width) >= dst->width) rec.width = dst->width - rec.x;
+	if ((rec.y + rec.height) >= dst->height) rec.height = dst->height - rec.y;
+	if ((rec.x >= dst->width) || (rec.y >= dst->height)) return;
+	if (((rec.x + rec.width) <= 0) || ((rec.y + rec.height) <= 0)) return;
+
+	int sx = (int)rec.x, sy = (int)rec.y;
+	int w = (int)rec.width, h = (int)rec.height;
+	if (w < 1) { w = 1; h = 1; }
+	else if (h < 1) h = 1;
+	uint32_t* first = PixelRow(dst, sy) + sx;
+	FillSpan(first, w, pixel);
+	for (int y = 1; y < h; y++) memcpy(first + (size_t)y * dst->width, first, (size_t)w * 4);
+}
+
+void RasterClearBackground(Image* dst, Color color) {
+	if (!RasterSupported(dst)) { ImageClearBackground(dst, color); return; }
+	FillSpan((uint32_t*)dst->data, dst->width * dst->height, PackColor(color));
+}
+
+void RasterDrawRectangleRec(Image* dst, Rectangle rec, Color color) {
+	if (!RasterSupported(dst)) { ImageDrawRectangleRec(dst, rec, color); return; }
+	FillRectangle(dst, rec, PackColor(color));
+}
+
+static inline Rectangle IntRect(int x, int y, int width, int height) {
+	return Rectangle{ (float)x, (float)y, (float)width, (float)height };
+}
+
+void RasterDrawRectangleLines(Image* dst, Rectangle rec, int thick, Color color) {
+	if (!RasterSupported(dst)) { ImageDrawRectangleLines(dst, rec, thick, color); return; }
+	uint32_t pixel = PackColor(color);
+	FillRectangle(dst, IntRect((int)rec.x, (int)rec.y, (int)rec.width, thick), pixel);
+	FillRectangle(dst, IntRect((int)rec.x, (int)(rec.y + thick), thick, (int)(rec.height - thick*2)), pixel);
+	FillRectangle(dst, IntRect((int)(rec.x + rec.width - thick), (int)(rec.y + thick), thick, (int)(rec.height - thick*2)), pixel);
+	FillRectangle(dst, IntRect((int)rec.x, (int)(rec.y + rec.height - thick), (int)rec.width, thick), pixel);
+}
+
+void RasterDrawCircle(Image* dst, int centerX, int centerY, int radius, Color color) {
+	if (!RasterSupported(dst)) { ImageDrawCircle(dst, centerX, centerY, radius, color); return; }
+	// raylib's midpoint walk, one span per row
+	uint32_t pixel = PackColor(color);
+	int x = 0, y = radius;
+	int decision = 3 - 2*radius;
+	while (y >= x) {
+		FillRectangle(dst, IntRect(centerX - x, centerY + y, x*2, 1), pixel);
+		FillRectangle(dst, IntRect(centerX - x, centerY - y, x*2, 1), pixel);
+		FillRectangle(dst, IntRect(centerX - y, centerY + x, y*2, 1), pixel);
+		FillRectangle(dst, IntRect(centerX - y, centerY - x, y*2, 1), pixel);
+		x++;
+		if (decision > 0) {
+			y--;
+			decision += 4*(x - y) + 10;
+		} else {
+			decision += 4*x + 6;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------
+// Triangles
+//--------------------------------------------------------------------------------
+
+// raylib's triangle setup: a bounding box clamped to the image, and
+// integer edge functions stepped across it.  A pixel is drawn where all
+// three edge functions are >= 0.
+struct TriangleSetup {
+	int xMin, xMax, yMin, yMax;		// inclusive, and inside the image
+	int xStep[3], yStep[3];
+	int row[3];						// edge functions at (xMin, yMin)
+};
+
+static bool SetupTriangle(const Image* dst, Vector2 v1, Vector2 v2, Vector2 v3, TriangleSetup* t) {
+	t->xMin = (int)std::min(v1.x, std::min(v2.x, v3.x));
+	t->yMin = (int)std::min(v1.y, std::min(v2.y, v3.y));
+	t->xMax = (int)std::max(v1.x, std::max(v2.x, v3.x));
+	t->yMax = (int)std::max(v1.y, std::max(v2.y, v3.y));
+	t->xMin = std::max(t->xMin, 0);
+	t->yMin = std::max(t->yMin, 0);
+	t->xMax = std::min(t->xMax, dst->width - 1);
+	t->yMax = std::min(t->yMax, dst->height - 1);
+	if (t->xMin > t->xMax || t->yMin > t->yMax) return false;
+
+	float hsum = v1.x*v2.y - v1.y*v2.x + v2.x*v3.y - v2.y*v3.x + v3.x*v1.y - v3.y*v1.x;
+	int sign = (hsum > 0) ? -1 : 1;		// flip the edges of a back-facing triangle
+	t->xStep[0] = sign * (int)(v3.y - v2.y);  t->yStep[0] = sign * (int)(v2.x - v3.x);
+	t->xStep[1] = sign * (int)(v1.y - v3.y);  t->yStep[1] = sign * (int)(v3.x - v1.x);
+	t->xStep[2] = sign * (int)(v2.y - v1.y);  t->yStep[2] = sign * (int)(v1.x - v2.x);
+	t->row[0] = (int)((t->xMin - v2.x)*t->xStep[0] + t->yStep[0]*(t->yMin - v2.y));
+	t->row[1] = (int)((t->xMin - v3.x)*t->xStep[1] + t->yStep[1]*(t->yMin - v3.y));
+	t->row[2] = (int)((t->xMin - v1.x)*t->xStep[2] + t->yStep[2]*(t->yMin - v1.y));
+	return true;
+}
+
+// Narrow [*lo, *hi] to the steps k where w + k*step >= 0; false if empty
+static inline bool ClipEdge(long long w, long long step, long long* lo, long long* hi) {
+	if (step > 0) {
+		if (w < 0) *lo = std::max(*lo, (-w + step - 1) / step);
+	} else if (step < 0) {
+		if (w < 0) return false;
+		*hi = std::min(*hi, w / -step);
+	} else if (w < 0) {
+		return false;
+	}
+	return *lo <= *hi;
+}
+
+// The span of pixels (as offsets from xMin) inside the triangle on the
+// current row, solved from the edge functions instead of tested per pixel
+static inline bool RowSpan(const TriangleSetup& t, int* outLo, int* outHi) {
+	long long lo = 0, hi = t.xMax - t.xMin;
+	for (int e = 0; e < 3; e++) {
+		if (!ClipEdge(t.row[e], t.xStep[e], &lo, &hi)) return false;
+	}
+	*outLo = (int)lo;
+	*outHi = (int)hi;
+	return true;
+}
+
+static void FillTriangle(Image* dst, Vector2 v1, Vector2 v2, Vector2 v3, uint32_t pixel) {
+	TriangleSetup t;
+	if (!SetupTriangle(dst, v1, v2, v3, &t)) return;
+	for (int y = t.yMin; y <= t.yMax; y++) {
+		int lo, hi;
+		if (RowSpan(t, &lo, &hi)) FillSpan(PixelRow(dst, y) + t.xMin + lo, hi - lo + 1, pixel);
+		for (int e = 0; e < 3; e++) t.row[e] += t.yStep[e];
+	}
+}
+
+void RasterDrawTriangle(Image* dst, Vector2 v1, Vector2 v2, Vector2 v3, Color color) {
+	if (!RasterSupported(dst)) { ImageDrawTriangle(dst, v1, v2, v3, color); return; }
+	FillTriangle(dst, v1, v2, v3, PackColor(color));
+}
+
+void RasterDrawTriangleEx(Image* dst, Vector2 v1, Vector2 v2, Vector2 v3, Color c1, Color c2, Color c3) {
+	if (!RasterSupported(dst)) { ImageDrawTriangleEx(dst, v1, v2, v3, c1, c2, c3); return; }
+	TriangleSetup t;
+	if (!SetupTriangle(dst, v1, v2, v3, &t)) return;
+	int wSum = t.row[0] + t.row[1] + t.row[2];
+	if (wSum == 0) return;		// degenerate: no area to interpolate over
+	float wInvSum = 255.0f / wSum;
+	for (int y = t.yMin; y <= t.yMax; y++) {
+		int lo, hi;
+		if (RowSpan(t, &lo, &hi)) {
+			uint32_t* p = PixelRow(dst, y) + t.xMin;
+			int w1 = t.row[0] + lo*t.xStep[0];
+			int w2 = t.row[1] + lo*t.xStep[1];
+			int w3 = t.row[2] + lo*t.xStep[2];
+			for (int k = lo; k <= hi; k++) {
+				unsigned int aW1 = (unsigned char)((float)w1*wInvSum);
+				unsigned int aW2 = (unsigned char)((float)w2*wInvSum);
+				unsigned int aW3 = (unsigned char)((float)w3*wInvSum);
+				Color c;
+				c.r = (unsigned char)((c1.r*aW1 + c2.r*aW2 + c3.r*aW3)/255);
+				c.g = (unsigned char)((c1.g*aW1 + c2.g*aW2 + c3.g*aW3)/255);
+				c.b = (unsigned char)((c1.b*aW1 + c2.b*aW2 + c3.b*aW3)/255);
+				c.a = (unsigned char)((c1.a*aW1 + c2.a*aW2 + c3.a*aW3)/255);
+				p[k] = PackColor(c);
+				w1 += t.xStep[0];
+				w2 += t.xStep[1];
+				w3 += t.xStep[2];
+			}
+		}
+		for (int e = 0; e < 3; e++) t.row[e] += t.yStep[e];
+	}
+}
+
+void RasterDrawTriangleFan(Image* dst, const Vector2* points, int pointCount, Color color) {
+	if (!RasterSupported(dst)) { ImageDrawTriangleFan(dst, (Vector2*)points, pointCount, color); return; }
+	uint32_t pixel = PackColor(color);
+	for (int i = 1; i < pointCount - 1; i++) FillTriangle(dst, points[0], points[i], points[i + 1], pixel);
+}
+
+void RasterDrawTriangleStrip(Image* dst, const Vector2* points, int pointCount, Color color) {
+	if (!RasterSupported(dst)) { ImageDrawTriangleStrip(dst, (Vector2*)points, pointCount, color); return; }
+	uint32_t pixel = PackColor(color);
+	for (int i = 2; i < pointCount; i++) {
+		if ((i % 2) == 0) FillTriangle(dst, points[i], points[i - 2], points[i - 1], pixel);
+		else FillTriangle(dst, points[i], points[i - 1], points[i - 2], pixel);
+	}
+}
+
+//--------------------------------------------------------------------------------
+// Blitting
+//--------------------------------------------------------------------------------
+
+void RasterDraw(Image* dst, Image src, Rectangle srcRec, Rectangle dstRec, Color tint) {
+	if (!RasterSupported(dst) || !RasterSupported(&src)) {
+		ImageDraw(dst, src, srcRec, dstRec, tint);
+		return;
+	}
+
+	// Source clipping, as in raylib
+	Rectangle s = srcRec;
+	if (s.x < 0) { s.width += s.x; s.x = 0; }
+	if (s.y < 0) { s.height += s.y; s.y = 0; }
+	if ((s.x + s.width) > src.width) s.width = src.width - s.x;
+	if ((s.y + s.height) > src.height) s.height = src.height - s.y;
+
+	// A scaled draw makes raylib resize a copy of the source first; leave
+	// that to raylib.
+	if (((int)s.width != (int)dstRec.width) || ((int)s.height != (int)dstRec.height)) {
+		ImageDraw(dst, src, srcRec, dstRec, tint);
+		return;
+	}
+
+	// Destination clipping, as in raylib
+	Rectangle d = dstRec;
+	if (d.x < 0) {
+		s.x -= d.x;
+		s.width += d.x;
+		d.x = 0;
+	} else if ((d.x + s.width) > dst->width) s.width = dst->width - d.x;
+	if (d.y < 0) {
+		s.y -= d.y;
+		s.height += d.y;
+		d.y = 0;
+	} else if ((d.y + s.height) > dst->height) s.height = dst->height - d.y;
+	if (dst->width < s.width) s.width = (float)dst->width;
+	if (dst->height < s.height) s.height = (float)dst->height;
+
+	// Then also keep to both images (raylib doesn't recheck the far edges
+	// after clipping the near ones, and can write past the end of a row)
+	int sx = (int)s.x, sy = (int)s.y, dx = (int)d.x, dy = (int)d.y;
+	int w = std::min((int)s.width, std::min(dst->width - dx, src.width - sx));
+	int h = std::min((int)s.height, std::min(dst->height - dy, src.height - sy));
+	if (w <= 0 || h <= 0) return;
+
+	for (int y = 0; y < h; y++) {
+		BlendSpan(PixelRow(dst, dy + y) + dx, PixelRow(&src, sy + y) + sx, w, tint);
+	}
+}
+
+Rectangle RasterDrawTextEx(Image* dst, Font font, const char* text, Vector2 position, float fontSize, float spacing, Color tint) {
+	// Same as raylib: render the text to its own image, then draw that
+	Image imText = ImageTextEx(font, text, fontSize, spacing, tint);
+	Rectangle srcRec = { 0.0f, 0.0f, (float)imText.width, (float)imText.height };
+	Rectangle dstRec = { position.x, position.y, (float)imText.width, (float)imText.height };
+	RasterDraw(dst, imText, srcRec, dstRec, WHITE);
+	UnloadImage(imText);
+	return dstRec;
+}
+
+//--------------------------------------------------------------------------------
+// Benchmark
+//--------------------------------------------------------------------------------
+
+template <typename NativeFunc, typename RaylibFunc>
+static RasterBenchmarkResult Bench(const char* name, double pixels, int reps,
+								   Image* a, Image* b, NativeFunc nativeDraw, RaylibFunc raylibDraw) {
+	ImageClearBackground(a, BLACK);
+	ImageClearBackground(b, BLACK);
+	double t0 = emscripten_get_now();
+	for (int i = 0; i < reps; i++) nativeDraw(a);
+	double t1 = emscripten_get_now();
+	for (int i = 0; i < reps; i++) raylibDraw(b);
+	double t2 = emscripten_get_now();
+
+	RasterBenchmarkResult result;
+	result.name = name;
+	result.pixels = pixels;
+	double total = pixels * reps;
+	result.nativeMPixels = total / (std::max(t1 - t0, 0.001) * 1000.0);
+	result.raylibMPixels = total / (std::max(t2 - t1, 0.001) * 1000.0);
+	result.match = memcmp(a->data, b->data, (size_t)a->width * a->height * 4) == 0;
+	return result;
+}
+
+std::vector<RasterBenchmarkResult> RunRasterBenchmark(int size, int reps) {
+	size = std::max(16, std::min(size, 4096));
+	reps = std::max(reps, 1);
+	float s = (float)size;
+	Image a = GenImageColor(size, size, BLACK);
+	Image b = GenImageColor(size, size, BLACK);
+
+	// A source image with clear, opaque and translucent areas
+	Image src = GenImageColor(size, size, BLANK);
+	ImageDrawCircle(&src, size/2, size/2, size/3, ORANGE);
+	ImageDrawRectangle(&src, 0, size/4, size, size/4, Color{ 40, 120, 200, 128 });
+
+	std::vector<RasterBenchmarkResult> results;
+	results.push_back(Bench("clear", s*s, reps, &a, &b,
+		[](Image* img) { RasterClearBackground(img, DARKBLUE); },
+		[](Image* img) { ImageClearBackground(img, DARKBLUE); }));
+
+	int inset = size/8, side = size - 2*inset;
+	Rectangle rec = IntRect(inset, inset, side, side);
+	results.push_back(Bench("rectangle", (double)side*side, reps, &a, &b,
+		[rec](Image* img) { RasterDrawRectangleRec(img, rec, RED); },
+		[rec](Image* img) { ImageDrawRectangleRec(img, rec, RED); }));
+
+	int radius = size/2 - 1;
+	results.push_back(Bench("circle", 3.14159265358979 * radius * radius, reps, &a, &b,
+		[size, radius](Image* img) { RasterDrawCircle(img, size/2, size/2, radius, GREEN); },
+		[size, radius](Image* img) { ImageDrawCircle(img, size/2, size/2, radius, GREEN); }));
+
+	Vector2 v1 = { 0, 0 }, v2 = { s/4, s - 1 }, v3 = { s - 1, s/2 };
+	double area = fabs((v2.x - v1.x)*(v3.y - v1.y) - (v3.x - v1.x)*(v2.y - v1.y)) / 2;
+	results.push_back(Bench("triangle", area, reps, &a, &b,
+		[v1, v2, v3](Image* img) { RasterDrawTriangle(img, v1, v2, v3, SKYBLUE); },
+		[v1, v2, v3](Image* img) { ImageDrawTriangle(img, v1, v2, v3, SKYBLUE); }));
+	results.push_back(Bench("triangleEx", area, reps, &a, &b,
+		[v1, v2, v3](Image* img) { RasterDrawTriangleEx(img, v1, v2, v3, RED, GREEN, BLUE); },
+		[v1, v2, v3](Image* img) { ImageDrawTriangleEx(img, v1, v2, v3, RED, GREEN, BLUE); }));
+
+	Rectangle full = IntRect(0, 0, size, size);
+	results.push_back(Bench("draw", s*s, reps, &a, &b,
+		[src, full](Image* img) { RasterDraw(img, src, full, full, WHITE); },
+		[src, full](Image* img) { ImageDraw(img, src, full, full, WHITE); }));
+	results.push_back(Bench("drawTinted", s*s, reps, &a, &b,
+		[src, full](Image* img) { RasterDraw(img, src, full, full, Color{ 255, 200, 100, 180 }); },
+		[src, full](Image* img) { ImageDraw(img, src, full, full, Color{ 255, 200, 100, 180 }); }));
+
+	UnloadImage(src);
+	UnloadImage(a);
+	UnloadImage(b);
+	return results;
+}
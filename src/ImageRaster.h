@@ -0,0 +1,49 @@
+//
+//  ImageRaster.h
+//  MSRLWeb
+//
+//  Fast CPU paths for the raylib Image drawing functions.  For RGBA8
+//  images (the format GenImageColor, LoadImage of a PNG, and ImageText
+//  produce) shapes are filled a row span at a time, with clipping done
+//  once per span and the span itself written 4 pixels per wasm SIMD
+//  store; ImageDraw blends 4 pixels at a time, skipping fully clear and
+//  copying fully opaque groups.  Results are pixel-for-pixel the same as
+//  raylib's.  Any other format falls through to the raylib function.
+//
+
+#ifndef IMAGERASTER_H
+#define IMAGERASTER_H
+
+#include "raylib.h"
+#include <string>
+#include <vector>
+
+// Whether the fast paths apply to this image (RGBA8 with pixel data)
+bool RasterSupported(const Image* image);
+
+// Drop-in replacements for the raylib functions of the same name
+void RasterClearBackground(Image* dst, Color color);
+void RasterDrawRectangleRec(Image* dst, Rectangle rec, Color color);
+void RasterDrawRectangleLines(Image* dst, Rectangle rec, int thick, Color color);
+void RasterDrawCircle(Image* dst, int centerX, int centerY, int radius, Color color);
+void RasterDrawTriangle(Image* dst, Vector2 v1, Vector2 v2, Vector2 v3, Color color);
+void RasterDrawTriangleEx(Image* dst, Vector2 v1, Vector2 v2, Vector2 v3, Color c1, Color c2, Color c3);
+void RasterDrawTriangleFan(Image* dst, const Vector2* points, int pointCount, Color color);
+void RasterDrawTriangleStrip(Image* dst, const Vector2* points, int pointCount, Color color);
+void RasterDraw(Image* dst, Image src, Rectangle srcRec, Rectangle dstRec, Color tint);
+
+// Draws text as ImageDrawTextEx does, and returns the area it covers
+Rectangle RasterDrawTextEx(Image* dst, Font font, const char* text, Vector2 position, float fontSize, float spacing, Color tint);
+
+// Fill rate of each fast path next to the raylib function it replaces,
+// on a size x size RGBA8 image
+struct RasterBenchmarkResult {
+	std::string name;
+	double pixels;          // pixels covered per call
+	double nativeMPixels;   // fill rate in Mpixels/s
+	double raylibMPixels;
+	bool match;             // whether both produced the same pixels
+};
+std::vector<RasterBenchmarkResult> RunRasterBenchmark(int size, int reps);
+
+#endif // IMAGERASTER_H
@@ -0,0 +1,250 @@
+//
+//  InputEvents.cpp
+//  MSRLWeb
+//
+//  Input event queue implementation
+//
+
+#include "InputEvents.h"
+#include "raylib.h"
+#include <emscripten.h>
+#include <emscripten/html5.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const char* kCanvas = "#canvas";
+static const int kMaxQueuedEvents = 4096;
+static const int kMaxGamepads = 4;
+static const int kMaxGamepadButtons = GAMEPAD_BUTTON_RIGHT_THUMB + 1;
+
+static bool enabled = false;
+static std::vector<InputEvent> pending;   // recorded since the last take (time in ms, from emscripten_get_now)
+static std::vector<InputEvent> taken;     // returned by the last take
+static int dropped = 0;
+
+static bool gamepadAvailable[kMaxGamepads];
+static uint32_t gamepadButtons[kMaxGamepads];  // bit per button, as of the last poll
+
+static void Record(int type, int code, float x, float y, double timeMs) {
+	if ((int)pending.size() >= kMaxQueuedEvents) {
+		dropped++;
+		return;
+	}
+	InputEvent e;
+	e.type = type;
+	e.code = code;
+	e.x = x;
+	e.y = y;
+	e.time = timeMs;
+	pending.push_back(e);
+}
+
+// Convert canvas-relative CSS pixels to screen coordinates
+static void CanvasToScreen(long cssX, long cssY, float* outX, float* outY) {
+	double cssWidth = 0, cssHeight = 0;
+	emscripten_get_element_css_size(kCanvas, &cssWidth, &cssHeight);
+	*outX = (float)(cssWidth > 0 ? cssX * GetScreenWidth() / cssWidth : cssX);
+	*outY = (float)(cssHeight > 0 ? cssY * GetScreenHeight() / cssHeight : cssY);
+}
+
+//--------------------------------------------------------------------------------
+// Keyboard
+//--------------------------------------------------------------------------------
+
+struct KeyCodeEntry {
+	const char* code;   // KeyboardEvent.code
+	int key;            // raylib KeyboardKey
+};
+
+static const KeyCodeEntry kKeyCodes[] = {
+	{ "Space", KEY_SPACE }, { "Quote", KEY_APOSTROPHE }, { "Comma", KEY_COMMA },
+	{ "Minus", KEY_MINUS }, { "Period", KEY_PERIOD }, { "Slash", KEY_SLASH },
+	{ "Semicolon", KEY_SEMICOLON }, { "Equal", KEY_EQUAL },
+	{ "BracketLeft", KEY_LEFT_BRACKET }, { "Backslash", KEY_BACKSLASH },
+	{ "BracketRight", KEY_RIGHT_BRACKET }, { "Backquote", KEY_GRAVE },
+	{ "Escape", KEY_ESCAPE }, { "Enter", KEY_ENTER }, { "Tab", KEY_TAB },
+	{ "Backspace", KEY_BACKSPACE }, { "Insert", KEY_INSERT }, { "Delete", KEY_DELETE },
+	{ "ArrowRight", KEY_RIGHT }, { "ArrowLeft", KEY_LEFT }, { "ArrowDown", KEY_DOWN },
+	{ "ArrowUp", KEY_UP }, { "PageUp", KEY_PAGE_UP }, { "PageDown", KEY_PAGE_DOWN },
+	{ "Home", KEY_HOME }, { "End", KEY_END }, { "CapsLock", KEY_CAPS_LOCK },
+	{ "ScrollLock", KEY_SCROLL_LOCK }, { "NumLock", KEY_NUM_LOCK },
+	{ "PrintScreen", KEY_PRINT_SCREEN }, { "Pause", KEY_PAUSE },
+	{ "ShiftLeft", KEY_LEFT_SHIFT }, { "ControlLeft", KEY_LEFT_CONTROL },
+	{ "AltLeft", KEY_LEFT_ALT }, { "MetaLeft", KEY_LEFT_SUPER },
+	{ "ShiftRight", KEY_RIGHT_SHIFT }, { "ControlRight", KEY_RIGHT_CONTROL },
+	{ "AltRight", KEY_RIGHT_ALT }, { "MetaRight", KEY_RIGHT_SUPER },
+	{ "ContextMenu", KEY_KB_MENU },
+	{ "NumpadDecimal", KEY_KP_DECIMAL }, { "NumpadDivide", KEY_KP_DIVIDE },
+	{ "NumpadMultiply", KEY_KP_MULTIPLY }, { "NumpadSubtract", KEY_KP_SUBTRACT },
+	{ "NumpadAdd", KEY_KP_ADD }, { "NumpadEnter", KEY_KP_ENTER },
+	{ "NumpadEqual", KEY_KP_EQUAL },
+};
+
+// Map a KeyboardEvent.code (physical key) to a raylib key; 0 if unknown
+static int KeyFromCode(const char* code) {
+	size_t len = strlen(code);
+	if (len == 4 && strncmp(code, "Key", 3) == 0) return KEY_A + (code[3] - 'A');
+	if (len == 6 && strncmp(code, "Digit", 5) == 0) return KEY_ZERO + (code[5] - '0');
+	if (len == 7 && strncmp(code, "Numpad", 6) == 0 && code[6] >= '0' && code[6] <= '9') {
+		return KEY_KP_0 + (code[6] - '0');
+	}
+	if (code[0] == 'F' && len >= 2 && len <= 3) {
+		int n = atoi(code + 1);
+		if (n >= 1 && n <= 12) return KEY_F1 + n - 1;
+	}
+	for (size_t i = 0; i < sizeof(kKeyCodes) / sizeof(kKeyCodes[0]); i++) {
+		if (strcmp(code, kKeyCodes[i].code) == 0) return kKeyCodes[i].key;
+	}
+	return 0;
+}
+
+// Decode a KeyboardEvent.key that is a single character; 0 otherwise
+// (named keys like "Enter" or "ArrowUp" are longer than one codepoint)
+static int SingleCodepoint(const char* key) {
+	int size = 0;
+	int codepoint = GetCodepoint(key, &size);
+	if (size == 0 || key[size] != 0 || codepoint < 32) return 0;
+	return codepoint;
+}
+
+static EM_BOOL OnKey(int eventType, const EmscriptenKeyboardEvent* e, void* userData) {
+	double now = emscripten_get_now();
+	int key = KeyFromCode(e->code);
+	if (eventType == EMSCRIPTEN_EVENT_KEYDOWN) {
+		if (key) Record(e->repeat ? INPUT_EVENT_KEY_REPEAT : INPUT_EVENT_KEY_DOWN, key, 0, 0, now);
+		// Characters come from keydown: keypress never fires once keydown's
+		// default is prevented (see prevent-defaults.js)
+		if (!e->ctrlKey && !e->metaKey) {
+			int codepoint = SingleCodepoint(e->key);
+			if (codepoint) Record(INPUT_EVENT_CHAR, codepoint, 0, 0, now);
+		}
+	} else if (key) {
+		Record(INPUT_EVENT_KEY_UP, key, 0, 0, now);
+	}
+	return EM_FALSE;  // let raylib see the event too
+}
+
+//--------------------------------------------------------------------------------
+// Mouse and touch
+//--------------------------------------------------------------------------------
+
+static int MouseButtonFromDOM(unsigned short button) {
+	switch (button) {
+		case 0: return MOUSE_BUTTON_LEFT;
+		case 1: return MOUSE_BUTTON_MIDDLE;
+		case 2: return MOUSE_BUTTON_RIGHT;
+		case 3: return MOUSE_BUTTON_BACK;
+		case 4: return MOUSE_BUTTON_FORWARD;
+		default: return button;
+	}
+}
+
+static EM_BOOL OnMouseButton(int eventType, const EmscriptenMouseEvent* e, void* userData) {
+	float x, y;
+	CanvasToScreen(e->targetX, e->targetY, &x, &y);
+	int type = (eventType == EMSCRIPTEN_EVENT_MOUSEDOWN ? INPUT_EVENT_MOUSE_DOWN : INPUT_EVENT_MOUSE_UP);
+	Record(type, MouseButtonFromDOM(e->button), x, y, emscripten_get_now());
+	return EM_FALSE;
+}
+
+static EM_BOOL OnWheel(int eventType, const EmscriptenWheelEvent* e, void* userData) {
+	// Like raylib, report only the direction (one notch per event)
+	float x = (e->deltaX > 0 ? -1.0f : e->deltaX < 0 ? 1.0f : 0.0f);
+	float y = (e->deltaY > 0 ? -1.0f : e->deltaY < 0 ? 1.0f : 0.0f);
+	Record(INPUT_EVENT_MOUSE_WHEEL, 0, x, y, emscripten_get_now());
+	return EM_FALSE;
+}
+
+static EM_BOOL OnTouch(int eventType, const EmscriptenTouchEvent* e, void* userData) {
+	int type = INPUT_EVENT_TOUCH_MOVE;
+	if (eventType == EMSCRIPTEN_EVENT_TOUCHSTART) type = INPUT_EVENT_TOUCH_DOWN;
+	else if (eventType == EMSCRIPTEN_EVENT_TOUCHEND || eventType == EMSCRIPTEN_EVENT_TOUCHCANCEL) type = INPUT_EVENT_TOUCH_UP;
+	double now = emscripten_get_now();
+	for (int i = 0; i < e->numTouches; i++) {
+		const EmscriptenTouchPoint& t = e->touches[i];
+		if (!t.isChanged) continue;
+		float x, y;
+		CanvasToScreen(t.targetX, t.targetY, &x, &y);
+		Record(type, (int)t.identifier, x, y, now);
+	}
+	return EM_FALSE;
+}
+
+//--------------------------------------------------------------------------------
+// Gamepads (browsers have no button events, so compare against the last poll)
+//--------------------------------------------------------------------------------
+
+static void PollGamepads() {
+	double now = emscripten_get_now();
+	for (int pad = 0; pad < kMaxGamepads; pad++) {
+		bool available = IsGamepadAvailable(pad);
+		if (available != gamepadAvailable[pad]) {
+			Record(available ? INPUT_EVENT_GAMEPAD_CONNECTED : INPUT_EVENT_GAMEPAD_DISCONNECTED, 0, pad, 0, now);
+			gamepadAvailable[pad] = available;
+		}
+		uint32_t buttons = 0;
+		if (available) {
+			for (int b = 1; b < kMaxGamepadButtons; b++) {
+				if (IsGamepadButtonDown(pad, b)) buttons |= (1u << b);
+			}
+		}
+		uint32_t changed = buttons ^ gamepadButtons[pad];
+		for (int b = 1; changed && b < kMaxGamepadButtons; b++) {
+			if (!(changed & (1u << b))) continue;
+			Record((buttons & (1u << b)) ? INPUT_EVENT_GAMEPAD_DOWN : INPUT_EVENT_GAMEPAD_UP, b, pad, 0, now);
+		}
+		gamepadButtons[pad] = buttons;
+	}
+}
+
+//--------------------------------------------------------------------------------
+// Public interface
+//--------------------------------------------------------------------------------
+
+void EnableInputEvents() {
+	if (enabled) return;
+	enabled = true;
+	pending.reserve(256);
+
+	const char* window = EMSCRIPTEN_EVENT_TARGET_WINDOW;
+	emscripten_set_keydown_callback(window, nullptr, true, OnKey);
+	emscripten_set_keyup_callback(window, nullptr, true, OnKey);
+	emscripten_set_mousedown_callback(kCanvas, nullptr, true, OnMouseButton);
+	emscripten_set_mouseup_callback(kCanvas, nullptr, true, OnMouseButton);
+	emscripten_set_wheel_callback(kCanvas, nullptr, true, OnWheel);
+	emscripten_set_touchstart_callback(kCanvas, nullptr, true, OnTouch);
+	emscripten_set_touchmove_callback(kCanvas, nullptr, true, OnTouch);
+	emscripten_set_touchend_callback(kCanvas, nullptr, true, OnTouch);
+	emscripten_set_touchcancel_callback(kCanvas, nullptr, true, OnTouch);
+
+	// Take the current gamepad state as the baseline
+	for (int pad = 0; pad < kMaxGamepads; pad++) {
+		gamepadAvailable[pad] = IsGamepadAvailable(pad);
+		gamepadButtons[pad] = 0;
+		for (int b = 1; gamepadAvailable[pad] && b < kMaxGamepadButtons; b++) {
+			if (IsGamepadButtonDown(pad, b)) gamepadButtons[pad] |= (1u << b);
+		}
+	}
+}
+
+int TakeInputEvents(InputEvent** outEvents, int* outCount) {
+	EnableInputEvents();
+	PollGamepads();
+
+	taken.swap(pending);
+	pending.clear();
+
+	// Convert event times to the GetTime() clock
+	double nowMs = emscripten_get_now();
+	double nowTime = GetTime();
+	for (size_t i = 0; i < taken.size(); i++) {
+		taken[i].time = nowTime - (nowMs - taken[i].time) / 1000.0;
+	}
+
+	*outEvents = taken.data();
+	*outCount = (int)taken.size();
+	int result = dropped;
+	dropped = 0;
+	return result;
+}
@@ -0,0 +1,49 @@
+//
+//  InputEvents.h
+//  MSRLWeb
+//
+//  Input event queue: records key, character, mouse, wheel, touch and
+//  gamepad events as the browser delivers them (so quick taps between
+//  frames are not lost), for scripts to collect all at once each frame.
+//
+
+#ifndef INPUTEVENTS_H
+#define INPUTEVENTS_H
+
+#include <stdint.h>
+
+enum InputEventType {
+	INPUT_EVENT_KEY_DOWN = 1,      // code: KEY_*
+	INPUT_EVENT_KEY_UP,            // code: KEY_*
+	INPUT_EVENT_KEY_REPEAT,        // code: KEY_* (auto-repeat while held)
+	INPUT_EVENT_CHAR,              // code: Unicode codepoint typed
+	INPUT_EVENT_MOUSE_DOWN,        // code: MOUSE_BUTTON_*; x, y: position
+	INPUT_EVENT_MOUSE_UP,          // code: MOUSE_BUTTON_*; x, y: position
+	INPUT_EVENT_MOUSE_WHEEL,       // x, y: wheel movement (positive = up/left, as GetMouseWheelMoveV)
+	INPUT_EVENT_TOUCH_DOWN,        // code: touch point id; x, y: position
+	INPUT_EVENT_TOUCH_MOVE,        // code: touch point id; x, y: position
+	INPUT_EVENT_TOUCH_UP,          // code: touch point id; x, y: position
+	INPUT_EVENT_GAMEPAD_DOWN,      // code: GAMEPAD_BUTTON_*; x: gamepad
+	INPUT_EVENT_GAMEPAD_UP,        // code: GAMEPAD_BUTTON_*; x: gamepad
+	INPUT_EVENT_GAMEPAD_CONNECTED,    // x: gamepad
+	INPUT_EVENT_GAMEPAD_DISCONNECTED  // x: gamepad
+};
+
+// One recorded event (24 bytes; also the record layout of the RawData form)
+struct InputEvent {
+	int32_t type;   // InputEventType
+	int32_t code;
+	float x;
+	float y;
+	double time;    // seconds, on the same clock as GetTime()
+};
+
+// Start recording (installs the browser listeners; safe to call repeatedly)
+void EnableInputEvents();
+
+// Poll gamepads, then move all events recorded since the last call into out
+// (oldest first).  Returns the number of events that had to be dropped
+// because the queue was full.
+int TakeInputEvents(InputEvent** outEvents, int* outCount);
+
+#endif // INPUTEVENTS_H
@@ -0,0 +1,273 @@
+//
+//  InputMap.cpp
+//  MSRLWeb
+//
+//  InputMap implementation
+//
+
+#include "InputMap.h"
+#include "raylib.h"
+#include "MiniscriptInterpreter.h"
+#include "macros.h"
+#include <math.h>
+
+using namespace MiniScript;
+
+static std::vector<InputMap*> liveMaps;
+
+//--------------------------------------------------------------------------------
+// InputMap implementation
+//--------------------------------------------------------------------------------
+
+InputMap::InputMap() {
+	liveMaps.push_back(this);
+}
+
+InputMap::~InputMap() {
+	for (size_t i = 0; i < liveMaps.size(); i++) {
+		if (liveMaps[i] == this) { liveMaps.erase(liveMaps.begin() + i); break; }
+	}
+}
+
+void InputMap::SetAction(const Action& action) {
+	for (size_t i = 0; i < actions.size(); i++) {
+		if (actions[i].name == action.name) { actions[i] = action; return; }
+	}
+	actions.push_back(action);
+	snapshot.SetValue(action.name, Value::zero);
+}
+
+const InputMap::Action* InputMap::Find(const String& name) const {
+	for (size_t i = 0; i < actions.size(); i++) {
+		if (actions[i].name == name) return &actions[i];
+	}
+	return nullptr;
+}
+
+// Raw value of one binding: 0 or 1 for buttons, -1 to 1 for axes (after the dead zone)
+static float BindingValue(const InputMap::Binding& b, float deadZone) {
+	switch (b.kind) {
+		case InputMap::Binding::KEY:
+			return IsKeyDown(b.code) ? 1.0f : 0.0f;
+		case InputMap::Binding::MOUSE_BUTTON:
+			return IsMouseButtonDown(b.code) ? 1.0f : 0.0f;
+		case InputMap::Binding::GAMEPAD_BUTTON:
+			return (IsGamepadAvailable(b.gamepad) && IsGamepadButtonDown(b.gamepad, b.code)) ? 1.0f : 0.0f;
+		case InputMap::Binding::GAMEPAD_AXIS: {
+			if (!IsGamepadAvailable(b.gamepad)) return 0;
+			float v = GetGamepadAxisMovement(b.gamepad, b.code);
+			float mag = fabsf(v);
+			if (mag <= deadZone) return 0;
+			// Rescale so the output still starts from 0 at the edge of the dead zone
+			float scaled = (deadZone < 1 ? (mag - deadZone) / (1 - deadZone) : 1);
+			return v < 0 ? -scaled : scaled;
+		}
+	}
+	return 0;
+}
+
+void InputMap::Update() {
+	for (size_t i = 0; i < actions.size(); i++) {
+		Action& a = actions[i];
+		float value = 0;
+		bool down = false;
+		for (size_t j = 0; j < a.bindings.size(); j++) {
+			float v = BindingValue(a.bindings[j], a.deadZone) * a.bindings[j].scale;
+			if (a.isAxis) value += v;
+			else if (v > 0) down = true;
+		}
+		if (a.isAxis) {
+			if (value > 1) value = 1;
+			if (value < -1) value = -1;
+			down = (value != 0);
+		} else {
+			value = down ? 1.0f : 0.0f;
+		}
+		a.pressed = (down && !a.down);
+		a.released = (!down && a.down);
+		a.down = down;
+		a.value = value;
+		snapshot.SetValue(a.name, Value(value));
+	}
+}
+
+void UpdateInputMaps() {
+	for (size_t i = 0; i < liveMaps.size(); i++) liveMaps[i]->Update();
+}
+
+//--------------------------------------------------------------------------------
+// MiniScript InputMap class
+//--------------------------------------------------------------------------------
+
+static String kHandle("_handle");
+
+// Helper: get InputMap from self
+static InputMap* GetInputMap(Context* context) {
+	InputMap* inputMap = ValueToInputMap(context->GetVar(String("self")));
+	if (inputMap == nullptr) RuntimeException("InputMap required for self parameter").raise();
+	return inputMap;
+}
+
+// Helper: look up an action by name, or raise an error
+static const InputMap::Action* GetAction(Context* context) {
+	String name = context->GetVar(String("name")).ToString();
+	const InputMap::Action* action = GetInputMap(context)->Find(name);
+	if (action == nullptr) RuntimeException(String("InputMap: unknown action \"") + name + "\"").raise();
+	return action;
+}
+
+// Parse one binding: a KEY_* number, or a map with one of "key", "mouse",
+// "button" or "axis", plus optional "gamepad" (default 0) and "scale" (default 1)
+static InputMap::Binding ValueToBinding(Value value, float scale) {
+	InputMap::Binding b;
+	b.kind = InputMap::Binding::KEY;
+	b.gamepad = 0;
+	b.scale = scale;
+	if (value.type == ValueType::Number) {
+		b.code = value.IntValue();
+		return b;
+	}
+	if (value.type != ValueType::Map) RuntimeException("InputMap: binding must be a key code or map").raise();
+	ValueDict map = value.GetDict();
+	Value v;
+	if (!(v = map.Lookup(String("key"), Value::null)).IsNull()) {
+		b.kind = InputMap::Binding::KEY;
+	} else if (!(v = map.Lookup(String("mouse"), Value::null)).IsNull()) {
+		b.kind = InputMap::Binding::MOUSE_BUTTON;
+	} else if (!(v = map.Lookup(String("button"), Value::null)).IsNull()) {
+		b.kind = InputMap::Binding::GAMEPAD_BUTTON;
+	} else if (!(v = map.Lookup(String("axis"), Value::null)).IsNull()) {
+		b.kind = InputMap::Binding::GAMEPAD_AXIS;
+	} else {
+		RuntimeException("InputMap: binding map needs a key, mouse, button or axis").raise();
+	}
+	b.code = v.IntValue();
+	b.gamepad = map.Lookup(String("gamepad"), Value::zero).IntValue();
+	b.scale = scale * map.Lookup(String("scale"), Value::one).FloatValue();
+	return b;
+}
+
+static void AddBindings(InputMap::Action& action, Value bindings, float scale) {
+	if (bindings.IsNull()) return;
+	if (bindings.type != ValueType::List) {
+		action.bindings.push_back(ValueToBinding(bindings, scale));
+		return;
+	}
+	ValueList list = bindings.GetList();
+	for (int i = 0; i < list.Count(); i++) action.bindings.push_back(ValueToBinding(list[i], scale));
+}
+
+static InputMap::Action NewAction(Context* context, bool isAxis) {
+	InputMap::Action action;
+	action.name = context->GetVar(String("name")).ToString();
+	action.isAxis = isAxis;
+	action.deadZone = context->GetVar(String("deadZone")).FloatValue();
+	action.value = 0;
+	action.down = action.pressed = action.released = false;
+	return action;
+}
+
+ValueDict InputMapClass() {
+	static ValueDict inputMapClass;
+
+	if (inputMapClass.Count() > 0) return inputMapClass;
+
+	inputMapClass.SetValue(kHandle, Value::zero);
+	inputMapClass.SetValue(String("actions"), Value::null);
+
+	Intrinsic* f;
+
+	// InputMap.addAction
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("name");
+	f->AddParam("bindings");
+	f->AddParam("deadZone", Value(0.5));
+	f->code = INTRINSIC_LAMBDA {
+		InputMap* inputMap = GetInputMap(context);
+		InputMap::Action action = NewAction(context, false);
+		AddBindings(action, context->GetVar(String("bindings")), 1);
+		inputMap->SetAction(action);
+		return IntrinsicResult::Null;
+	};
+	inputMapClass.SetValue(String("addAction"), f->GetFunc());
+
+	// InputMap.addAxis
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("name");
+	f->AddParam("positive");
+	f->AddParam("negative");
+	f->AddParam("deadZone", Value(0.2));
+	f->code = INTRINSIC_LAMBDA {
+		InputMap* inputMap = GetInputMap(context);
+		InputMap::Action action = NewAction(context, true);
+		AddBindings(action, context->GetVar(String("positive")), 1);
+		AddBindings(action, context->GetVar(String("negative")), -1);
+		inputMap->SetAction(action);
+		return IntrinsicResult::Null;
+	};
+	inputMapClass.SetValue(String("addAxis"), f->GetFunc());
+
+	// InputMap.value
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("name");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(GetAction(context)->value);
+	};
+	inputMapClass.SetValue(String("value"), f->GetFunc());
+
+	// InputMap.isDown
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("name");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(GetAction(context)->down);
+	};
+	inputMapClass.SetValue(String("isDown"), f->GetFunc());
+
+	// InputMap.pressed
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("name");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(GetAction(context)->pressed);
+	};
+	inputMapClass.SetValue(String("pressed"), f->GetFunc());
+
+	// InputMap.released
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("name");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(GetAction(context)->released);
+	};
+	inputMapClass.SetValue(String("released"), f->GetFunc());
+
+	// InputMap.update (evaluate now, rather than waiting for the end of the frame)
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		GetInputMap(context)->Update();
+		return IntrinsicResult::Null;
+	};
+	inputMapClass.SetValue(String("update"), f->GetFunc());
+
+	return inputMapClass;
+}
+
+Value InputMapToValue(InputMap* inputMap) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, InputMapClass());
+	map.SetValue(kHandle, Value((long)inputMap));
+	map.SetValue(String("actions"), Value(inputMap->snapshot));
+	return Value(map);
+}
+
+InputMap* ValueToInputMap(Value value) {
+	if (value.type != ValueType::Map) return nullptr;
+	ValueDict map = value.GetDict();
+	Value handleVal = map.Lookup(kHandle, Value::zero);
+	return (InputMap*)(long)handleVal.IntValue();
+}
@@ -0,0 +1,65 @@
+//
+//  InputMap.h
+//  MSRLWeb
+//
+//  InputMap: named actions and axes, each bound to any number of keys,
+//  mouse buttons, gamepad buttons and gamepad axes.  The host evaluates
+//  every live InputMap once per frame (after EndDrawing polls input), so
+//  scripts read results without calling any raylib input functions.
+//
+
+#ifndef INPUTMAP_H
+#define INPUTMAP_H
+
+#include "MiniscriptTypes.h"
+#include <vector>
+
+class InputMap {
+public:
+	struct Binding {
+		enum Kind { KEY, MOUSE_BUTTON, GAMEPAD_BUTTON, GAMEPAD_AXIS };
+		Kind kind;
+		int code;       // KEY_*, MOUSE_BUTTON_*, GAMEPAD_BUTTON_* or GAMEPAD_AXIS_*
+		int gamepad;    // for gamepad bindings
+		float scale;    // multiplier for the binding's value (-1 for "negative" bindings)
+	};
+
+	struct Action {
+		MiniScript::String name;
+		std::vector<Binding> bindings;
+		bool isAxis;      // axes sum their bindings into -1 to 1; actions are on/off
+		float deadZone;   // analog inputs below this count as 0
+		float value;
+		bool down, pressed, released;
+	};
+
+	InputMap();
+	~InputMap();
+
+	// Define (or redefine) an action or axis
+	void SetAction(const Action& action);
+
+	// Find an action by name; null if not defined
+	const Action* Find(const MiniScript::String& name) const;
+
+	// Evaluate all bindings and update the snapshot
+	void Update();
+
+	// Snapshot shared with the script: action name -> current value
+	MiniScript::ValueDict snapshot;
+
+private:
+	std::vector<Action> actions;
+};
+
+// Evaluate every live InputMap (called by the host once per frame)
+void UpdateInputMaps();
+
+// Get the InputMap class (MiniScript intrinsic class)
+MiniScript::ValueDict InputMapClass();
+
+// Convert between MiniScript Value and InputMap
+MiniScript::Value InputMapToValue(InputMap* inputMap);
+InputMap* ValueToInputMap(MiniScript::Value value);
+
+#endif // INPUTMAP_H
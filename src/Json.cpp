@@ -0,0 +1,305 @@
+//
+//  Json.cpp
+//  MSRLWeb
+//
+//  Native JSON implementation
+//
+
+#include "Json.h"
+#include "MiniscriptInterpreter.h"
+#include <stdlib.h>
+#include <string.h>
+
+using namespace MiniScript;
+
+static const int kMaxDepth = 512;
+
+void AppendUTF8(std::string& out, unsigned long cp) {
+	if (cp < 0x80) {
+		out += (char)cp;
+	} else if (cp < 0x800) {
+		out += (char)(0xC0 | (cp >> 6));
+		out += (char)(0x80 | (cp & 0x3F));
+	} else if (cp < 0x10000) {
+		out += (char)(0xE0 | (cp >> 12));
+		out += (char)(0x80 | ((cp >> 6) & 0x3F));
+		out += (char)(0x80 | (cp & 0x3F));
+	} else {
+		out += (char)(0xF0 | (cp >> 18));
+		out += (char)(0x80 | ((cp >> 12) & 0x3F));
+		out += (char)(0x80 | ((cp >> 6) & 0x3F));
+		out += (char)(0x80 | (cp & 0x3F));
+	}
+}
+
+//--------------------------------------------------------------------------------
+// Parsing
+//--------------------------------------------------------------------------------
+
+namespace {
+
+class JsonParser {
+public:
+	JsonParser(const char* source, long length) : src(source), len(length), p(0), depth(0) {}
+
+	Value ParseDocument() {
+		Value result = ParseValue();
+		return result;
+	}
+
+private:
+	const char* src;
+	long len;
+	long p;
+	int depth;
+
+	void Error(const char* message) {
+		RuntimeException(String("JSON error at position ") + String::Format((int)p) + ": " + message).raise();
+	}
+
+	void SkipWhitespace() {
+		while (p < len) {
+			char c = src[p];
+			if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+			p++;
+		}
+	}
+
+	bool Matches(const char* word, long wordLen) {
+		return p + wordLen <= len && strncmp(src + p, word, wordLen) == 0;
+	}
+
+	Value ParseValue() {
+		SkipWhitespace();
+		if (p >= len) Error("unexpected end of input");
+		char c = src[p];
+		if (c == '"') return Value(ParseString());
+		if ((c >= '0' && c <= '9') || c == '-' || c == '.') return ParseNumber();
+		if (c == '[') return ParseList();
+		if (c == '{') return ParseMap();
+		if (c == 't' && Matches("true", 4)) { p += 4; return Value::one; }
+		if (c == 'f' && Matches("false", 5)) { p += 5; return Value::zero; }
+		if (c == 'n' && Matches("null", 4)) { p += 4; return Value::null; }
+		Error("unexpected character");
+		return Value::null;
+	}
+
+	Value ParseList() {
+		if (++depth > kMaxDepth) Error("nesting too deep");
+		p++;	// skip "["
+		SkipWhitespace();
+		ValueList result;
+		while (true) {
+			if (p >= len) Error("unterminated list");
+			if (src[p] == ']') break;
+			result.Add(ParseValue());
+			SkipWhitespace();
+			// after an element, we should have either a comma or a ']'
+			if (p < len && src[p] == ',') {
+				p++;
+				SkipWhitespace();
+			}
+		}
+		p++;
+		depth--;
+		return Value(result);
+	}
+
+	Value ParseMap() {
+		if (++depth > kMaxDepth) Error("nesting too deep");
+		p++;	// skip "{"
+		SkipWhitespace();
+		ValueDict result;
+		while (true) {
+			if (p >= len) Error("unterminated object");
+			if (src[p] == '}') break;
+			if (src[p] != '"') Error("object member key must be a string literal");
+			String key = ParseString();
+			SkipWhitespace();
+			if (p >= len || src[p] != ':') Error("colon expected");
+			p++;
+			Value value = ParseValue();
+			result.SetValue(key, value);
+			SkipWhitespace();
+			// after a key/value pair, we should have either a comma or a '}'
+			if (p < len && src[p] == ',') {
+				p++;
+				SkipWhitespace();
+			}
+		}
+		p++;
+		depth--;
+		return Value(result);
+	}
+
+	int HexDigit(char c) {
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		Error("invalid \\u escape");
+		return 0;
+	}
+
+	unsigned long ParseHex4() {
+		if (p + 4 > len) Error("invalid \\u escape");
+		unsigned long result = 0;
+		for (int i = 0; i < 4; i++) result = result * 16 + HexDigit(src[p + i]);
+		p += 4;
+		return result;
+	}
+
+	// Get a string literal from the source.  Advance to the next
+	// character after the closing quote.
+	String ParseString() {
+		p++;	// skip opening quote
+		long start = p;
+		while (p < len && src[p] != '"' && src[p] != '\\') p++;
+		if (p >= len) Error("unterminated string");
+		if (src[p] == '"') {
+			// Common case: no escapes, so take the bytes as they are
+			String result(src + start, p - start);
+			p++;
+			return result;
+		}
+
+		std::string buf(src + start, p - start);
+		while (true) {
+			if (p >= len) Error("unterminated string");
+			char c = src[p++];
+			if (c == '"') break;
+			if (c != '\\') {
+				buf += c;
+				continue;
+			}
+			if (p >= len) Error("unterminated string");
+			c = src[p++];
+			switch (c) {
+				case 'b': buf += '\b'; break;
+				case 't': buf += '\t'; break;
+				case 'n': buf += '\n'; break;
+				case 'f': buf += '\f'; break;
+				case 'r': buf += '\r'; break;
+				case 'u': {
+					unsigned long cp = ParseHex4();
+					// Combine a UTF-16 surrogate pair, if that's what this is
+					if (cp >= 0xD800 && cp < 0xDC00 && p + 6 <= len && src[p] == '\\' && src[p + 1] == 'u') {
+						long save = p;
+						p += 2;
+						unsigned long low = ParseHex4();
+						if (low >= 0xDC00 && low < 0xE000) cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+						else p = save;
+					}
+					AppendUTF8(buf, cp);
+					break;
+				}
+				default: buf += c; break;
+			}
+		}
+		return String(buf.c_str(), buf.size());
+	}
+
+	// Get a numeric literal from the source.  Like json.ms, we're rather
+	// permissive here, consuming anything made of number characters.
+	Value ParseNumber() {
+		long start = p;
+		while (p < len && strchr("0123456789+-.eE", src[p]) != nullptr && src[p] != 0) p++;
+		std::string buf(src + start, p - start);
+		return Value(strtod(buf.c_str(), nullptr));
+	}
+};
+
+} // anonymous namespace
+
+Value JsonParse(const char* source, long length) {
+	JsonParser parser(source, length);
+	return parser.ParseDocument();
+}
+
+//--------------------------------------------------------------------------------
+// Generating
+//--------------------------------------------------------------------------------
+
+void JsonEscape(const String& s, std::string& out) {
+	const char* c = s.c_str();
+	for (long i = 0, n = s.LengthB(); i < n; i++) {
+		switch (c[i]) {
+			case '\\': out += "\\\\"; break;
+			case '"':  out += "\\\""; break;
+			case '\b': out += "\\b"; break;
+			case '\t': out += "\\t"; break;
+			case '\n': out += "\\n"; break;
+			case '\f': out += "\\f"; break;
+			case '\r': out += "\\r"; break;
+			default:   out += c[i]; break;
+		}
+	}
+}
+
+// Line break and indentation, as json.ms writes them
+static void AppendBreak(std::string& out, int indent) {
+	out += '\r';
+	for (int i = 0; i < indent; i++) out += "  ";
+}
+
+static void Format(Value value, bool compact, int indent, std::string& out) {
+	if (indent > kMaxDepth) RuntimeException("toJSON: nesting too deep").raise();
+	switch (value.type) {
+		case ValueType::Function:
+			out += "\"<function>\"";
+			break;
+		case ValueType::Null:
+			out += "null";
+			break;
+		case ValueType::Number:
+			out += value.ToString().c_str();
+			break;
+		case ValueType::String:
+			out += '"';
+			JsonEscape(value.ToString(), out);
+			out += '"';
+			break;
+		case ValueType::List: {
+			ValueList list = value.GetList();
+			out += '[';
+			if (!compact) AppendBreak(out, indent + 1);
+			for (int i = 0; i < list.Count(); i++) {
+				if (i > 0) {
+					out += ',';
+					if (!compact) AppendBreak(out, indent + 1);
+				}
+				Format(list[i], compact, indent + 1, out);
+			}
+			if (!compact) AppendBreak(out, indent);
+			out += ']';
+			break;
+		}
+		case ValueType::Map: {
+			ValueDict map = value.GetDict();
+			ValueList keys = map.Keys();
+			out += '{';
+			if (!compact) AppendBreak(out, indent + 1);
+			for (int i = 0; i < keys.Count(); i++) {
+				if (i > 0) {
+					out += ',';
+					if (!compact) AppendBreak(out, indent + 1);
+				}
+				out += '"';
+				JsonEscape(keys[i].ToString(), out);
+				out += '"';
+				out += (compact ? ":" : ": ");
+				Format(map.Lookup(keys[i], Value::null), compact, indent + 1, out);
+			}
+			if (!compact) AppendBreak(out, indent);
+			out += '}';
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+String JsonFormat(Value value, bool compact, int indent) {
+	std::string out;
+	Format(value, compact, indent, out);
+	return String(out.c_str(), out.size());
+}
@@ -0,0 +1,31 @@
+//
+//  Json.h
+//  MSRLWeb
+//
+//  Native JSON reader/writer backing assets/lib/json.ms.  Produces exactly
+//  the same values and text as the script implementation (true/false become
+//  1/0, lists use char(13) line breaks and two-space indents, etc.), only
+//  much faster.
+//
+
+#ifndef JSON_H
+#define JSON_H
+
+#include "MiniscriptTypes.h"
+#include <string>
+
+// Parse JSON text of the given length into a MiniScript value.
+// Like json.ms, this is permissive (e.g. trailing commas are fine), but
+// structural errors raise a RuntimeException giving the position.
+MiniScript::Value JsonParse(const char* source, long length);
+
+// Convert a MiniScript value to JSON text (see json.ms toJSON)
+MiniScript::String JsonFormat(MiniScript::Value value, bool compact, int indent);
+
+// Append s to out with JSON backslash escapes (see json.ms escape)
+void JsonEscape(const MiniScript::String& s, std::string& out);
+
+// Append a Unicode code point to out as UTF-8
+void AppendUTF8(std::string& out, unsigned long codepoint);
+
+#endif // JSON_H
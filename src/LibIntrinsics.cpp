@@ -0,0 +1,879 @@
+//
+//  LibIntrinsics.cpp
+//  MSRLWeb
+//
+//  Hidden intrinsics (names starting with an underscore) that back the
+//  modules in assets/lib.  Scripts should call these through the modules,
+//  which check for them with intrinsics.hasIndex and fall back to their
+//  own MiniScript code when they are missing.
+//
+
+#include "RaylibIntrinsics.h"
+#include "RawData.h"
+#include "Json.h"
+#include "DataFormats.h"
+#include "DenseMatrix.h"
+#include "Geometry.h"
+#include "Path2D.h"
+#include "Polygon2D.h"
+#include "TextUtil.h"
+#include "FrameArena.h"
+#include "MiniscriptInterpreter.h"
+#include "MiniscriptTypes.h"
+#include "macros.h"
+#include <algorithm>
+#include <memory>
+#include <string.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace MiniScript;
+
+// Helper: get the text of a string or RawData argument without copying it.
+// The returned pointer is valid as long as holder (and the RawData) lives.
+static const char* GetSourceText(const char* funcName, Value source, String& holder, long* outLength) {
+	if (source.type == ValueType::Map) {
+		BinaryData* data = ValueToRawData(source);
+		if (data == nullptr) RuntimeException(String(funcName) + ": string or RawData required").raise();
+		*outLength = data->length;
+		return (const char*)data->bytes;
+	}
+	holder = source.ToString();
+	*outLength = holder.LengthB();
+	return holder.c_str();
+}
+
+// Helper: like GetSourceText, but a list of strings is also accepted,
+// and joined with the given separator.
+static const char* GetSourceTextOrLines(const char* funcName, Value source, const char* separator, String& holder, long* outLength) {
+	if (source.type != ValueType::List) return GetSourceText(funcName, source, holder, outLength);
+	ValueList lines = source.GetList();
+	std::string joined;
+	for (int i = 0; i < lines.Count(); i++) {
+		if (i > 0) joined += separator;
+		joined += lines[i].ToString().c_str();
+	}
+	holder = String(joined.c_str(), joined.size());
+	*outLength = holder.LengthB();
+	return holder.c_str();
+}
+
+// Helper: convert a list of rows (matrixUtil's Matrix.elem) to a DenseMatrix
+static DenseMatrix* ElemToDenseMatrix(const char* funcName, Value elem) {
+	if (elem.type != ValueType::List) RuntimeException(String(funcName) + ": list required").raise();
+	const char* error = nullptr;
+	DenseMatrix* m = DenseMatrixFromList(elem.GetList(), &error);
+	if (m == nullptr) RuntimeException(String(funcName) + ": " + error).raise();
+	return m;
+}
+
+// Helper: get a point (map with x and y, or [x, y] list) parameter
+static Point2D GetPoint(Context* context, const char* funcName, const char* paramName) {
+	Point2D p;
+	if (!ValueToPoint2D(context->GetVar(String(paramName)), &p)) {
+		RuntimeException(String(funcName) + ": " + paramName + " must be a map with x and y, or an [x, y] list").raise();
+	}
+	return p;
+}
+
+// Helper: get a ball map's position and velocity
+static Ball2D MapToBall(ValueDict map) {
+	Ball2D ball;
+	ball.x = LookupInherited(map, String("x")).DoubleValue();
+	ball.y = LookupInherited(map, String("y")).DoubleValue();
+	ball.vx = LookupInherited(map, String("vx")).DoubleValue();
+	ball.vy = LookupInherited(map, String("vy")).DoubleValue();
+	return ball;
+}
+
+// Helper: store a ball's position and velocity back into its map
+static void BallToMap(const Ball2D& ball, ValueDict map) {
+	map.SetValue(String("x"), Value(ball.x));
+	map.SetValue(String("y"), Value(ball.y));
+	map.SetValue(String("vx"), Value(ball.vx));
+	map.SetValue(String("vy"), Value(ball.vy));
+}
+
+static Value GetBallMap(Context* context, const char* funcName, const char* paramName) {
+	Value ball = context->GetVar(String(paramName));
+	if (ball.type != ValueType::Map) RuntimeException(String(funcName) + ": " + paramName + " must be a map").raise();
+	return ball;
+}
+
+// Helper: get a segment map (x1, y1, x2, y2, and optionally prevX1, prevY1,
+// prevX2, prevY2)
+static Segment2D MapToSegment(ValueDict map) {
+	Segment2D seg;
+	seg.p1.x = map.Lookup(String("x1"), Value::zero).DoubleValue();
+	seg.p1.y = map.Lookup(String("y1"), Value::zero).DoubleValue();
+	seg.p2.x = map.Lookup(String("x2"), Value::zero).DoubleValue();
+	seg.p2.y = map.Lookup(String("y2"), Value::zero).DoubleValue();
+	Value prevX1 = map.Lookup(String("prevX1"), Value::null);
+	Value prevX2 = map.Lookup(String("prevX2"), Value::null);
+	seg.hasPrev1 = !prevX1.IsNull();
+	seg.hasPrev2 = !prevX2.IsNull();
+	seg.prev1.x = prevX1.DoubleValue();
+	seg.prev1.y = map.Lookup(String("prevY1"), Value::zero).DoubleValue();
+	seg.prev2.x = prevX2.DoubleValue();
+	seg.prev2.y = map.Lookup(String("prevY2"), Value::zero).DoubleValue();
+	return seg;
+}
+
+// Helper: get a list of points, a RawData of float32 x,y pairs, or a
+// Polygon's points, as a scratch array (valid until the end of the frame)
+static Point2D* GetPoints(const char* funcName, Value value, int* outCount) {
+	Polygon2D* poly = ValueToPolygon2D(value);
+	if (poly != nullptr) {
+		*outCount = poly->Count();
+		return poly->points.data();
+	}
+	if (value.type == ValueType::List) {
+		ValueList list = value.GetList();
+		int count = list.Count();
+		Point2D* pts = FrameArena::AllocArray<Point2D>(count);
+		for (int i = 0; i < count; i++) {
+			if (!ValueToPoint2D(list[i], &pts[i])) {
+				RuntimeException(String(funcName) + ": points must be maps with x and y, or [x, y] lists").raise();
+			}
+		}
+		*outCount = count;
+		return pts;
+	}
+	BinaryData* data = ValueToRawData(value);
+	if (data == nullptr) RuntimeException(String(funcName) + ": list of points or RawData required").raise();
+	int count = data->length / 8;
+	Point2D* pts = FrameArena::AllocArray<Point2D>(count);
+	for (int i = 0; i < count; i++) {
+		pts[i].x = data->GetFloat(i * 8);
+		pts[i].y = data->GetFloat(i * 8 + 4);
+	}
+	*outCount = count;
+	return pts;
+}
+
+// Helper: get the polygon (and optional previous polygon) for the bounce functions
+static Point2D* GetPolyParams(Context* context, const char* funcName, int* outCount, Point2D** outPrevPts) {
+	Point2D* pts = GetPoints(funcName, context->GetVar(String("polyPts")), outCount);
+	*outPrevPts = nullptr;
+	Value prevVal = context->GetVar(String("prevPolyPts"));
+	if (!prevVal.IsNull()) {
+		int prevCount;
+		*outPrevPts = GetPoints(funcName, prevVal, &prevCount);
+		if (prevCount != *outCount) RuntimeException(String(funcName) + ": prevPolyPts must have as many points as polyPts").raise();
+	}
+	return pts;
+}
+
+// Helper: whether the first count elements of a list are all numbers
+// (the case the listUtil intrinsics handle natively)
+static bool AllNumbers(ValueList& list, long count) {
+	for (long i = 0; i < count; i++) {
+		if (list[i].type != ValueType::Number) return false;
+	}
+	return true;
+}
+
+// Helper: make a String from bytes
+static Value StringValue(const std::string& bytes) {
+	return Value(String(bytes.c_str(), (long)bytes.size()));
+}
+
+// Helper: trim self (see string.trim), returning self itself if unchanged
+static IntrinsicResult TrimSelf(Context* context, bool left, bool right) {
+	Value selfVal = context->GetVar(String("self"));
+	String self = selfVal.ToString();
+	Value charsVal = context->GetVar(String("charsToRemove"));
+	String chars = charsVal.IsNull() ? String(" \t\r\n") : charsVal.ToString();
+	long start, end;
+	TextTrimRange(self.c_str(), self.LengthB(), chars.c_str(), chars.LengthB(), left, right, &start, &end);
+	if (start == 0 && end == self.LengthB()) return IntrinsicResult(selfVal);
+	return IntrinsicResult(String(self.c_str() + start, end - start));
+}
+
+void AddLibIntrinsics() {
+	Intrinsic *f;
+
+	// json.ms
+
+	f = Intrinsic::Create("_jsonParse");
+	f->AddParam("source");
+	f->code = INTRINSIC_LAMBDA {
+		String holder;
+		long length;
+		const char* text = GetSourceText("json.parse", context->GetVar(String("source")), holder, &length);
+		return IntrinsicResult(JsonParse(text, length));
+	};
+
+	f = Intrinsic::Create("_toJSON");
+	f->AddParam("value");
+	f->AddParam("compact", Value::zero);
+	f->AddParam("indent", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(JsonFormat(context->GetVar(String("value")),
+			context->GetVar(String("compact")).BoolValue(),
+			context->GetVar(String("indent")).IntValue()));
+	};
+
+	// grfon.ms
+
+	f = Intrinsic::Create("_grfonParse");
+	f->AddParam("source");
+	f->AddParam("interpretTrueAndFalse", Value::zero);
+	f->AddParam("interpretNull", Value::one);
+	f->code = INTRINSIC_LAMBDA {
+		String holder;
+		long length;
+		const char* text = GetSourceTextOrLines("grfon.parse", context->GetVar(String("source")), "\n", holder, &length);
+		return IntrinsicResult(GrfonParse(text, length,
+			context->GetVar(String("interpretTrueAndFalse")).BoolValue(),
+			context->GetVar(String("interpretNull")).BoolValue()));
+	};
+
+	f = Intrinsic::Create("_toGRFON");
+	f->AddParam("value");
+	f->AddParam("compact", Value::zero);
+	f->AddParam("indent", Value::zero);
+	f->AddParam("topLevel", Value::one);
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(GrfonFormat(context->GetVar(String("value")),
+			context->GetVar(String("compact")).BoolValue(),
+			context->GetVar(String("indent")).IntValue(),
+			context->GetVar(String("topLevel")).BoolValue()));
+	};
+
+	// tsv.ms
+
+	f = Intrinsic::Create("_tsvParse");
+	f->AddParam("source");
+	f->AddParam("asRowList", Value::one);
+	f->AddParam("columnar", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		Value source = context->GetVar(String("source"));
+		bool asRowList = context->GetVar(String("asRowList")).BoolValue();
+		bool columnar = context->GetVar(String("columnar")).BoolValue();
+		if (source.type == ValueType::List) {
+			// Already split into lines; keep the strings alive while we parse
+			ValueList list = source.GetList();
+			std::vector<String> holders(list.Count());
+			std::vector<TextSpan> lines(list.Count());
+			for (int i = 0; i < list.Count(); i++) {
+				holders[i] = list[i].ToString();
+				lines[i].text = holders[i].c_str();
+				lines[i].length = holders[i].LengthB();
+			}
+			return IntrinsicResult(TsvParseLines(lines, asRowList, columnar));
+		}
+		String holder;
+		long length;
+		const char* text = GetSourceText("tsv.parse", source, holder, &length);
+		return IntrinsicResult(TsvParseLines(TsvSplitLines(text, length), asRowList, columnar));
+	};
+
+	// matrixUtil.ms
+
+	f = Intrinsic::Create("_matrixMultiply");
+	f->AddParam("a");
+	f->AddParam("b");
+	f->code = INTRINSIC_LAMBDA {
+		std::unique_ptr<DenseMatrix> a(ElemToDenseMatrix("Matrix.times", context->GetVar(String("a"))));
+		std::unique_ptr<DenseMatrix> b(ElemToDenseMatrix("Matrix.times", context->GetVar(String("b"))));
+		if (a->columns != b->rows) RuntimeException("Matrix.times: incompatible sizes").raise();
+		DenseMatrix result(a->rows, b->columns);
+		DenseMatrix::Multiply(*a, *b, result);
+		return IntrinsicResult(Value(DenseMatrixToList(result)));
+	};
+
+	f = Intrinsic::Create("_matrixTranspose");
+	f->AddParam("elem");
+	f->code = INTRINSIC_LAMBDA {
+		std::unique_ptr<DenseMatrix> m(ElemToDenseMatrix("Matrix.transpose", context->GetVar(String("elem"))));
+		DenseMatrix result(m->columns, m->rows);
+		m->TransposeInto(result);
+		return IntrinsicResult(Value(DenseMatrixToList(result)));
+	};
+
+	// mathUtil.ms
+
+	f = Intrinsic::Create("_distance");
+	f->AddParam("p1");
+	f->AddParam("p2");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(Distance(GetPoint(context, "distance", "p1"), GetPoint(context, "distance", "p2")));
+	};
+
+	f = Intrinsic::Create("_lerp2d");
+	f->AddParam("p1");
+	f->AddParam("p2");
+	f->AddParam("t");
+	f->code = INTRINSIC_LAMBDA {
+		Point2D p1 = GetPoint(context, "lerp2d", "p1");
+		Point2D p2 = GetPoint(context, "lerp2d", "p2");
+		double t = context->GetVar(String("t")).DoubleValue();
+		return IntrinsicResult(Point2DToList(Point2D{ p1.x + (p2.x - p1.x) * t, p1.y + (p2.y - p1.y) * t }));
+	};
+
+	f = Intrinsic::Create("_moveTowardsXY");
+	f->AddParam("mover");
+	f->AddParam("target");
+	f->AddParam("maxDist", 1);
+	f->code = INTRINSIC_LAMBDA {
+		ValueDict mover = GetBallMap(context, "moveTowardsXY", "mover").GetDict();
+		Point2D pos;
+		ValueToPoint2D(Value(mover), &pos);
+		Point2D target = GetPoint(context, "moveTowardsXY", "target");
+		if (!MoveTowardsXY(&pos, target, context->GetVar(String("maxDist")).DoubleValue())) return IntrinsicResult(false);
+		mover.SetValue(String("x"), Value(pos.x));
+		mover.SetValue(String("y"), Value(pos.y));
+		return IntrinsicResult(true);
+	};
+
+	f = Intrinsic::Create("_proportionAlongLine");
+	f->AddParam("endA");
+	f->AddParam("endB");
+	f->AddParam("p");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(ProportionAlongLine(GetPoint(context, "proportionAlongLine", "endA"),
+			GetPoint(context, "proportionAlongLine", "endB"), GetPoint(context, "proportionAlongLine", "p")));
+	};
+
+	f = Intrinsic::Create("_nearestPointOnLine");
+	f->AddParam("endA");
+	f->AddParam("endB");
+	f->AddParam("p");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(Point2DToList(NearestPointOnLine(GetPoint(context, "nearestPointOnLine", "endA"),
+			GetPoint(context, "nearestPointOnLine", "endB"), GetPoint(context, "nearestPointOnLine", "p"))));
+	};
+
+	f = Intrinsic::Create("_nearestPointOnLineSegment");
+	f->AddParam("endA");
+	f->AddParam("endB");
+	f->AddParam("p");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(Point2DToList(NearestPointOnLineSegment(GetPoint(context, "nearestPointOnLineSegment", "endA"),
+			GetPoint(context, "nearestPointOnLineSegment", "endB"), GetPoint(context, "nearestPointOnLineSegment", "p"))));
+	};
+
+	f = Intrinsic::Create("_distanceToLineSegment");
+	f->AddParam("endA");
+	f->AddParam("endB");
+	f->AddParam("p");
+	f->code = INTRINSIC_LAMBDA {
+		Point2D p = GetPoint(context, "distanceToLineSegment", "p");
+		Point2D nearest = NearestPointOnLineSegment(GetPoint(context, "distanceToLineSegment", "endA"),
+			GetPoint(context, "distanceToLineSegment", "endB"), p);
+		return IntrinsicResult(Distance(p, nearest));
+	};
+
+	f = Intrinsic::Create("_lineIntersectProportion");
+	f->AddParam("p1");
+	f->AddParam("p2");
+	f->AddParam("p3");
+	f->AddParam("p4");
+	f->code = INTRINSIC_LAMBDA {
+		double fraction;
+		if (!LineIntersectProportion(GetPoint(context, "lineIntersectProportion", "p1"), GetPoint(context, "lineIntersectProportion", "p2"),
+			GetPoint(context, "lineIntersectProportion", "p3"), GetPoint(context, "lineIntersectProportion", "p4"), &fraction)) {
+			return IntrinsicResult::Null;
+		}
+		return IntrinsicResult(fraction);
+	};
+
+	f = Intrinsic::Create("_lineSegmentsIntersect");
+	f->AddParam("p1");
+	f->AddParam("p2");
+	f->AddParam("p3");
+	f->AddParam("p4");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(LineSegmentsIntersect(GetPoint(context, "lineSegmentsIntersect", "p1"), GetPoint(context, "lineSegmentsIntersect", "p2"),
+			GetPoint(context, "lineSegmentsIntersect", "p3"), GetPoint(context, "lineSegmentsIntersect", "p4")));
+	};
+
+	f = Intrinsic::Create("_lineLineIntersection");
+	f->AddParam("p1");
+	f->AddParam("p2");
+	f->AddParam("p3");
+	f->AddParam("p4");
+	f->code = INTRINSIC_LAMBDA {
+		Point2D p1 = GetPoint(context, "lineLineIntersection", "p1");
+		Point2D p2 = GetPoint(context, "lineLineIntersection", "p2");
+		double t;
+		if (!LineIntersectProportion(p1, p2, GetPoint(context, "lineLineIntersection", "p3"),
+			GetPoint(context, "lineLineIntersection", "p4"), &t)) {
+			return IntrinsicResult::Null;
+		}
+		return IntrinsicResult(Point2DToList(Point2D{ p1.x + (p2.x - p1.x) * t, p1.y + (p2.y - p1.y) * t }));
+	};
+
+	f = Intrinsic::Create("_reflect");
+	f->AddParam("vector");
+	f->AddParam("normal");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(Point2DToList(Reflect(GetPoint(context, "reflect", "vector"), GetPoint(context, "reflect", "normal"))));
+	};
+
+	f = Intrinsic::Create("_bounceOffSegment");
+	f->AddParam("ball");
+	f->AddParam("segment");
+	f->AddParam("friction", Value(0.1));
+	f->AddParam("fracBefore");
+	f->code = INTRINSIC_LAMBDA {
+		ValueDict ballMap = GetBallMap(context, "bounceOffSegment", "ball").GetDict();
+		Value segVal = context->GetVar(String("segment"));
+		if (segVal.type != ValueType::Map) RuntimeException("bounceOffSegment: segment must be a map").raise();
+		Ball2D ball = MapToBall(ballMap);
+		Segment2D seg = MapToSegment(segVal.GetDict());
+		Value fracVal = context->GetVar(String("fracBefore"));
+		double fracBefore = 0;
+		if (!fracVal.IsNull()) {
+			fracBefore = fracVal.DoubleValue();
+		} else {
+			LineIntersectProportion(Point2D{ ball.x - ball.vx, ball.y - ball.vy }, Point2D{ ball.x, ball.y },
+				seg.p1, seg.p2, &fracBefore);
+		}
+		BounceOffSegment(&ball, seg, context->GetVar(String("friction")).DoubleValue(), fracBefore);
+		BallToMap(ball, ballMap);
+		return IntrinsicResult::Null;
+	};
+
+	f = Intrinsic::Create("_bounceOffPoly");
+	f->AddParam("ball");
+	f->AddParam("polyPts");
+	f->AddParam("prevPolyPts");
+	f->AddParam("friction", Value(0.1));
+	f->code = INTRINSIC_LAMBDA {
+		ValueDict ballMap = GetBallMap(context, "bounceOffPoly", "ball").GetDict();
+		int count;
+		Point2D* prevPts;
+		Point2D* pts = GetPolyParams(context, "bounceOffPoly", &count, &prevPts);
+		Ball2D ball = MapToBall(ballMap);
+		if (!BounceOffPoly(&ball, pts, count, prevPts, context->GetVar(String("friction")).DoubleValue())) {
+			return IntrinsicResult(false);
+		}
+		BallToMap(ball, ballMap);
+		return IntrinsicResult(true);
+	};
+
+	// Bulk versions: one call for many points or balls
+
+	f = Intrinsic::Create("_distances");
+	f->AddParam("p");
+	f->AddParam("points");
+	f->code = INTRINSIC_LAMBDA {
+		Point2D p = GetPoint(context, "distances", "p");
+		int count;
+		Point2D* pts = GetPoints("distances", context->GetVar(String("points")), &count);
+		ValueList result;
+		for (int i = 0; i < count; i++) result.Add(Value(Distance(p, pts[i])));
+		return IntrinsicResult(Value(result));
+	};
+
+	f = Intrinsic::Create("_bounceAllOffPoly");
+	f->AddParam("balls");
+	f->AddParam("polyPts");
+	f->AddParam("prevPolyPts");
+	f->AddParam("friction", Value(0.1));
+	f->code = INTRINSIC_LAMBDA {
+		int count;
+		Point2D* prevPts;
+		Point2D* pts = GetPolyParams(context, "bounceAllOffPoly", &count, &prevPts);
+		double friction = context->GetVar(String("friction")).DoubleValue();
+		Value balls = context->GetVar(String("balls"));
+		ValueList result;
+		if (balls.type == ValueType::List) {
+			ValueList list = balls.GetList();
+			for (int i = 0; i < list.Count(); i++) {
+				if (list[i].type != ValueType::Map) RuntimeException("bounceAllOffPoly: balls must be maps").raise();
+				ValueDict ballMap = list[i].GetDict();
+				Ball2D ball = MapToBall(ballMap);
+				bool bounced = BounceOffPoly(&ball, pts, count, prevPts, friction);
+				if (bounced) BallToMap(ball, ballMap);
+				result.Add(bounced ? Value::one : Value::zero);
+			}
+			return IntrinsicResult(Value(result));
+		}
+		// RawData of float32 [x, y, vx, vy] records, updated in place
+		BinaryData* data = ValueToRawData(balls);
+		if (data == nullptr) RuntimeException("bounceAllOffPoly: list of balls or RawData required").raise();
+		for (int offset = 0; offset + 16 <= data->length; offset += 16) {
+			Ball2D ball = { data->GetFloat(offset), data->GetFloat(offset + 4),
+				data->GetFloat(offset + 8), data->GetFloat(offset + 12) };
+			bool bounced = BounceOffPoly(&ball, pts, count, prevPts, friction);
+			if (bounced) {
+				data->SetFloat(offset, (float)ball.x);
+				data->SetFloat(offset + 4, (float)ball.y);
+				data->SetFloat(offset + 8, (float)ball.vx);
+				data->SetFloat(offset + 12, (float)ball.vy);
+			}
+			result.Add(bounced ? Value::one : Value::zero);
+		}
+		return IntrinsicResult(Value(result));
+	};
+
+	// pathUtil.ms (path may be a list of points, a RawData of x,y pairs, or a Path)
+
+	f = Intrinsic::Create("_nearestPointOnPath");
+	f->AddParam("point");
+	f->AddParam("path");
+	f->code = INTRINSIC_LAMBDA {
+		Point2D p = GetPoint(context, "nearestPointOnPath", "point");
+		Value pathVal = context->GetVar(String("path"));
+		Point2D q;
+		double dist;
+		Path2D* path = ValueToPath2D(pathVal);
+		if (path != nullptr) {
+			if (path->Nearest(p, &q, &dist) < 0) return IntrinsicResult::Null;
+		} else {
+			int count;
+			Point2D* pts = GetPoints("nearestPointOnPath", pathVal, &count);
+			if (count == 0) return IntrinsicResult::Null;
+			NearestOnPolyline(pts, count, p, &q, &dist);
+		}
+		return IntrinsicResult(Point2DToList(q));
+	};
+
+	f = Intrinsic::Create("_distanceToPath");
+	f->AddParam("point");
+	f->AddParam("path");
+	f->code = INTRINSIC_LAMBDA {
+		Point2D p = GetPoint(context, "distanceToPath", "point");
+		Value pathVal = context->GetVar(String("path"));
+		Point2D q;
+		double dist = 0;
+		Path2D* path = ValueToPath2D(pathVal);
+		if (path != nullptr) {
+			path->Nearest(p, &q, &dist);
+		} else {
+			int count;
+			Point2D* pts = GetPoints("distanceToPath", pathVal, &count);
+			if (count > 0) NearestOnPolyline(pts, count, p, &q, &dist);
+		}
+		return IntrinsicResult(dist);
+	};
+
+	// listUtil.ms.  _listAdd, _listMultiplyBy and _listDot only handle lists
+	// of numbers (returning 0 or null otherwise, so the script version can
+	// take over); the rest work on any values.
+
+	f = Intrinsic::Create("_listAdd");
+	f->AddParam("self");
+	f->AddParam("addend");
+	f->code = INTRINSIC_LAMBDA {
+		Value selfVal = context->GetVar(String("self"));
+		Value addend = context->GetVar(String("addend"));
+		if (selfVal.type != ValueType::List) return IntrinsicResult(false);
+		ValueList list = selfVal.GetList();
+		if (addend.type == ValueType::List) {
+			ValueList other = addend.GetList();
+			long count = std::min(list.Count(), other.Count());
+			if (!AllNumbers(list, count) || !AllNumbers(other, count)) return IntrinsicResult(false);
+			for (long i = 0; i < count; i++) list[i] = Value(list[i].DoubleValue() + other[i].DoubleValue());
+			return IntrinsicResult(true);
+		}
+		if (addend.type != ValueType::Number || !AllNumbers(list, list.Count())) return IntrinsicResult(false);
+		double a = addend.DoubleValue();
+		for (long i = 0; i < list.Count(); i++) list[i] = Value(list[i].DoubleValue() + a);
+		return IntrinsicResult(true);
+	};
+
+	f = Intrinsic::Create("_listMultiplyBy");
+	f->AddParam("self");
+	f->AddParam("factor");
+	f->code = INTRINSIC_LAMBDA {
+		Value selfVal = context->GetVar(String("self"));
+		Value factor = context->GetVar(String("factor"));
+		if (selfVal.type != ValueType::List) return IntrinsicResult(false);
+		ValueList list = selfVal.GetList();
+		if (factor.type == ValueType::List) {
+			ValueList other = factor.GetList();
+			long count = std::min(list.Count(), other.Count());
+			if (!AllNumbers(list, count) || !AllNumbers(other, count)) return IntrinsicResult(false);
+			for (long i = 0; i < count; i++) list[i] = Value(list[i].DoubleValue() * other[i].DoubleValue());
+			return IntrinsicResult(true);
+		}
+		if (factor.type != ValueType::Number || !AllNumbers(list, list.Count())) return IntrinsicResult(false);
+		double m = factor.DoubleValue();
+		for (long i = 0; i < list.Count(); i++) list[i] = Value(list[i].DoubleValue() * m);
+		return IntrinsicResult(true);
+	};
+
+	f = Intrinsic::Create("_listDot");
+	f->AddParam("self");
+	f->AddParam("other");
+	f->code = INTRINSIC_LAMBDA {
+		Value selfVal = context->GetVar(String("self"));
+		Value otherVal = context->GetVar(String("other"));
+		if (selfVal.type != ValueType::List || otherVal.type != ValueType::List) return IntrinsicResult::Null;
+		ValueList list = selfVal.GetList();
+		ValueList other = otherVal.GetList();
+		long count = list.Count();
+		if (other.Count() != count || !AllNumbers(list, count) || !AllNumbers(other, count)) return IntrinsicResult::Null;
+		double sum = 0;
+		for (long i = 0; i < count; i++) sum += list[i].DoubleValue() * other[i].DoubleValue();
+		return IntrinsicResult(sum);
+	};
+
+	f = Intrinsic::Create("_listMean");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		Value selfVal = context->GetVar(String("self"));
+		if (selfVal.type != ValueType::List) return IntrinsicResult::Null;
+		ValueList list = selfVal.GetList();
+		// like list.sum, non-numbers count as their DoubleValue
+		double sum = 0;
+		for (long i = 0; i < list.Count(); i++) sum += list[i].DoubleValue();
+		return IntrinsicResult(sum / list.Count());
+	};
+
+	f = Intrinsic::Create("_listReverse");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		Value selfVal = context->GetVar(String("self"));
+		if (selfVal.type != ValueType::List) return IntrinsicResult::Null;
+		ValueList list = selfVal.GetList();
+		for (long i = 0, j = list.Count() - 1; i < j; i++, j--) {
+			Value temp = list[i];
+			list[i] = list[j];
+			list[j] = temp;
+		}
+		return IntrinsicResult::Null;
+	};
+
+	f = Intrinsic::Create("_listCounts");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		Value selfVal = context->GetVar(String("self"));
+		ValueDict result;
+		if (selfVal.type != ValueType::List) return IntrinsicResult(result);
+		ValueList list = selfVal.GetList();
+		long count = list.Count();
+		if (AllNumbers(list, count)) {
+			// tally doubles, then make one map entry per distinct value
+			std::unordered_map<double, long> tally;
+			std::vector<double> order;
+			for (long i = 0; i < count; i++) {
+				double d = list[i].DoubleValue();
+				if (tally[d]++ == 0) order.push_back(d);
+			}
+			for (double d : order) result.SetValue(Value(d), Value((double)tally[d]));
+			return IntrinsicResult(result);
+		}
+		for (long i = 0; i < count; i++) {
+			Value item = list[i];
+			Value n = result.Lookup(item, Value::zero);
+			result.SetValue(item, Value(n.DoubleValue() + 1));
+		}
+		return IntrinsicResult(result);
+	};
+
+	f = Intrinsic::Create("_listDistinct");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		Value selfVal = context->GetVar(String("self"));
+		ValueList result;
+		if (selfVal.type != ValueType::List) return IntrinsicResult(result);
+		ValueList list = selfVal.GetList();
+		long count = list.Count();
+		// (in order of first appearance)
+		if (AllNumbers(list, count)) {
+			std::unordered_set<double> seen;
+			for (long i = 0; i < count; i++) {
+				if (seen.insert(list[i].DoubleValue()).second) result.Add(list[i]);
+			}
+			return IntrinsicResult(result);
+		}
+		ValueDict seen;
+		for (long i = 0; i < count; i++) {
+			Value item = list[i];
+			if (!seen.Lookup(item, Value::null).IsNull()) continue;
+			seen.SetValue(item, Value::one);
+			result.Add(item);
+		}
+		return IntrinsicResult(result);
+	};
+
+	// stringUtil.ms.  These read the string's UTF-8 bytes in place, and
+	// return self itself (no copy) when there's nothing to change.
+
+	f = Intrinsic::Create("_stringPad");
+	f->AddParam("self");
+	f->AddParam("length", Value::zero);
+	f->AddParam("padChar", " ");
+	f->AddParam("cutIfTooLong", Value::one);
+	f->code = INTRINSIC_LAMBDA {
+		Value selfVal = context->GetVar(String("self"));
+		String self = selfVal.ToString();
+		long length = context->GetVar(String("length")).IntValue();
+		long lenB = self.LengthB();
+		long charCount = Utf8CharCount(self.c_str(), lenB);
+		if (charCount > length) {
+			if (!context->GetVar(String("cutIfTooLong")).BoolValue()) return IntrinsicResult(selfVal);
+			if (length < 0) length = std::max(0L, charCount + length);	// (as self[:length] would)
+			return IntrinsicResult(String(self.c_str(), Utf8ByteOffset(self.c_str(), lenB, length)));
+		}
+		if (charCount == length) return IntrinsicResult(selfVal);
+		String padChar = context->GetVar(String("padChar")).ToString();
+		std::string result;
+		result.reserve(lenB + padChar.LengthB() * (length - charCount));
+		result.append(self.c_str(), lenB);
+		for (long i = charCount; i < length; i++) result.append(padChar.c_str(), padChar.LengthB());
+		return IntrinsicResult(StringValue(result));
+	};
+
+	f = Intrinsic::Create("_stringTrim");
+	f->AddParam("self");
+	f->AddParam("charsToRemove");
+	f->code = INTRINSIC_LAMBDA { return TrimSelf(context, true, true); };
+
+	f = Intrinsic::Create("_stringTrimLeft");
+	f->AddParam("self");
+	f->AddParam("charsToRemove");
+	f->code = INTRINSIC_LAMBDA { return TrimSelf(context, true, false); };
+
+	f = Intrinsic::Create("_stringTrimRight");
+	f->AddParam("self");
+	f->AddParam("charsToRemove");
+	f->code = INTRINSIC_LAMBDA { return TrimSelf(context, false, true); };
+
+	f = Intrinsic::Create("_stringLastIndexOf");
+	f->AddParam("self");
+	f->AddParam("substr");
+	f->AddParam("beforeIdx");
+	f->code = INTRINSIC_LAMBDA {
+		String self = context->GetVar(String("self")).ToString();
+		String substr = context->GetVar(String("substr")).ToString();
+		Value beforeVal = context->GetVar(String("beforeIdx"));
+		long from;
+		if (beforeVal.IsNull()) {
+			from = Utf8CharCount(self.c_str(), self.LengthB()) - Utf8CharCount(substr.c_str(), substr.LengthB());
+		} else {
+			from = beforeVal.IntValue() - 1;
+		}
+		long index = TextLastIndexOf(self.c_str(), self.LengthB(), substr.c_str(), substr.LengthB(), from);
+		if (index < 0) return IntrinsicResult::Null;
+		return IntrinsicResult((double)index);
+	};
+
+	f = Intrinsic::Create("_stringIsNumeric");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		String self = context->GetVar(String("self")).ToString();
+		return IntrinsicResult(TextIsNumeric(self.c_str(), self.LengthB()));
+	};
+
+	f = Intrinsic::Create("_stringCompress");
+	f->AddParam("self");
+	f->AddParam("charToCompress", " ");
+	f->code = INTRINSIC_LAMBDA {
+		Value selfVal = context->GetVar(String("self"));
+		String self = selfVal.ToString();
+		String run = context->GetVar(String("charToCompress")).ToString();
+		std::string result = TextCompress(self.c_str(), self.LengthB(), run.c_str(), run.LengthB());
+		if ((long)result.size() == self.LengthB()) return IntrinsicResult(selfVal);
+		return IntrinsicResult(StringValue(result));
+	};
+
+	f = Intrinsic::Create("_stringReverse");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		String self = context->GetVar(String("self")).ToString();
+		return IntrinsicResult(StringValue(TextReverse(self.c_str(), self.LengthB())));
+	};
+
+	f = Intrinsic::Create("_stringSplitLines");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		String self = context->GetVar(String("self")).ToString();
+		ValueList result;
+		for (const TextSpan& line : TsvSplitLines(self.c_str(), self.LengthB())) {
+			result.Add(Value(String(line.text, line.length)));
+		}
+		return IntrinsicResult(result);
+	};
+
+	f = Intrinsic::Create("_stringWrap");
+	f->AddParam("self");
+	f->AddParam("width", 67);
+	f->code = INTRINSIC_LAMBDA {
+		String self = context->GetVar(String("self")).ToString();
+		long width = context->GetVar(String("width")).IntValue();
+		ValueList result;
+		for (const TextSpan& line : TextWrap(self.c_str(), self.LengthB(), width)) {
+			result.Add(Value(String(line.text, line.length)));
+		}
+		return IntrinsicResult(result);
+	};
+
+	f = Intrinsic::Create("_stringFill");
+	f->AddParam("self");
+	f->AddParam("args");
+	f->code = INTRINSIC_LAMBDA {
+		Value selfVal = context->GetVar(String("self"));
+		String self = selfVal.ToString();
+		Value args = context->GetVar(String("args"));
+
+		// field name -> replacement text, for each index of args
+		std::unordered_map<std::string, std::string> fields;
+		if (args.type == ValueType::List) {
+			ValueList list = args.GetList();
+			for (long i = 0; i < list.Count(); i++) {
+				fields[Value((double)i).ToString().c_str()] = list[i].ToString().c_str();
+			}
+		} else if (args.type == ValueType::Map) {
+			ValueDict map = args.GetDict();
+			ValueList keys = map.Keys();
+			for (long i = 0; i < keys.Count(); i++) {
+				fields[keys[i].ToString().c_str()] = map.Lookup(keys[i], Value::null).ToString().c_str();
+			}
+		}
+		if (fields.empty()) return IntrinsicResult(selfVal);
+
+		// One pass, substituting each {field} we know
+		const char* text = self.c_str();
+		long lenB = self.LengthB();
+		std::string result;
+		result.reserve(lenB);
+		std::string name;
+		long p = 0;
+		while (p < lenB) {
+			if (text[p] == '{') {
+				const char* close = (const char*)memchr(text + p + 1, '}', lenB - p - 1);
+				if (close != nullptr) {
+					name.assign(text + p + 1, close - (text + p + 1));
+					auto it = fields.find(name);
+					if (it != fields.end()) {
+						result += it->second;
+						p = close - text + 1;
+						continue;
+					}
+				}
+			}
+			result += text[p++];
+		}
+		return IntrinsicResult(StringValue(result));
+	};
+
+	f = Intrinsic::Create("_stringEditDistance");
+	f->AddParam("self");
+	f->AddParam("s2");
+	f->code = INTRINSIC_LAMBDA {
+		String self = context->GetVar(String("self")).ToString();
+		String s2 = context->GetVar(String("s2")).ToString();
+		return IntrinsicResult((double)TextEditDistance(self.c_str(), self.LengthB(), s2.c_str(), s2.LengthB()));
+	};
+
+	f = Intrinsic::Create("_stringUrlEncode");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		String self = context->GetVar(String("self")).ToString();
+		return IntrinsicResult(StringValue(TextUrlEncode(self.c_str(), self.LengthB())));
+	};
+
+	f = Intrinsic::Create("_stringUrlDecode");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		String self = context->GetVar(String("self")).ToString();
+		return IntrinsicResult(StringValue(TextUrlDecode(self.c_str(), self.LengthB())));
+	};
+}
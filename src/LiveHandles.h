@@ -0,0 +1,49 @@
+//
+//  LiveHandles.h
+//  MSRLWeb
+//
+//  LiveHandles: the native objects of one type that currently exist behind
+//  MiniScript handle maps.  A handle map keeps its object's address as a
+//  number in _handle, and a script can hold on to a copy after the object
+//  is unloaded, or put any number there; so a handle is only dereferenced
+//  once its address has been found in this set.
+//
+
+#ifndef LIVEHANDLES_H
+#define LIVEHANDLES_H
+
+#include "MiniscriptInterpreter.h"
+#include "MiniscriptTypes.h"
+#include <unordered_set>
+
+template <class T>
+class LiveHandles {
+public:
+	// Call from the object's constructor and destructor
+	void Add(T* obj) { live.insert(obj); }
+	void Remove(T* obj) { live.erase(obj); }
+
+	typename std::unordered_set<T*>::const_iterator begin() const { return live.begin(); }
+	typename std::unordered_set<T*>::const_iterator end() const { return live.end(); }
+
+	// The live object behind a handle map; null for anything else
+	T* FromValue(MiniScript::Value value) const {
+		if (value.type != MiniScript::ValueType::Map) return nullptr;
+		MiniScript::Value handleVal = value.GetDict().Lookup(MiniScript::String("_handle"), MiniScript::Value::zero);
+		T* obj = (T*)(long)handleVal.IntValue();
+		if (obj == nullptr || live.count(obj) == 0) return nullptr;
+		return obj;
+	}
+
+	// The live object behind a method's self, raising if there is none
+	T* FromSelf(MiniScript::Context* context, const char* className) const {
+		T* obj = FromValue(context->GetVar(MiniScript::String("self")));
+		if (obj == nullptr) MiniScript::RuntimeException(MiniScript::String(className) + " required for self parameter").raise();
+		return obj;
+	}
+
+private:
+	std::unordered_set<T*> live;
+};
+
+#endif // LIVEHANDLES_H
@@ -0,0 +1,584 @@
+//
+//  NavGrid.cpp
+//  MSRLWeb
+//
+//  NavGrid implementation
+//
+
+#include "NavGrid.h"
+#include "LiveHandles.h"
+#include "Geometry.h"
+#include "RawData.h"
+#include "MiniscriptInterpreter.h"
+#include "macros.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+using namespace MiniScript;
+
+static LiveHandles<NavGrid> liveNavGrids;
+
+static String kHandle("_handle");
+
+static const float kSqrt2 = 1.41421356f;
+
+// The 8 neighbor directions: orthogonal first, then diagonal
+static const int kDirX[8] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+static const int kDirY[8] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+
+static inline int Sign(int v) { return (v > 0) - (v < 0); }
+
+// Length of the shortest 8-way (or 4-way) move by dx, dy on unit costs
+static inline float StepDistance(int dx, int dy, bool diagonal) {
+	dx = abs(dx); dy = abs(dy);
+	if (!diagonal) return (float)(dx + dy);
+	int lo = std::min(dx, dy), hi = std::max(dx, dy);
+	return (float)(hi - lo) + kSqrt2 * lo;
+}
+
+//--------------------------------------------------------------------------------
+// NavGrid implementation
+//--------------------------------------------------------------------------------
+
+NavGrid::NavGrid(int width, int height, float cost, bool diagonal)
+	: width(width), height(height), diagonal(diagonal), lastExpanded(0),
+	  searchId(0), statsValid(false), uniform(true), minCost(1) {
+	liveNavGrids.Add(this);
+	size_t n = (size_t)width * height;
+	costs.assign(n, cost);
+	g.resize(n);
+	parent.resize(n);
+	seen.assign(n, 0);
+	closed.assign(n, 0);
+}
+
+NavGrid::~NavGrid() {
+	liveNavGrids.Remove(this);
+}
+
+void NavGrid::SetCost(int x, int y, float cost) {
+	if (!InBounds(x, y)) return;
+	costs[y * width + x] = cost;
+	statsValid = false;
+}
+
+void NavGrid::FillRect(int x, int y, int w, int h, float cost) {
+	int x0 = std::max(0, x), y0 = std::max(0, y);
+	int x1 = std::min(width, x + w), y1 = std::min(height, y + h);
+	for (int row = y0; row < y1; row++) {
+		std::fill(costs.begin() + row * width + x0, costs.begin() + row * width + x1, cost);
+	}
+	statsValid = false;
+}
+
+void NavGrid::UpdateStats() {
+	if (statsValid) return;
+	bool any = false;
+	uniform = true;
+	minCost = 1;
+	for (float c : costs) {
+		if (c <= 0) continue;
+		if (!any) { minCost = c; any = true; continue; }
+		if (c != minCost) {
+			uniform = false;
+			if (c < minCost) minCost = c;
+		}
+	}
+	statsValid = true;
+}
+
+bool NavGrid::IsUniform() {
+	UpdateStats();
+	return uniform;
+}
+
+void NavGrid::BeginSearch() {
+	if (++searchId == 0) {
+		// Stamps wrapped around; old ones could now look current
+		std::fill(seen.begin(), seen.end(), 0);
+		std::fill(closed.begin(), closed.end(), 0);
+		searchId = 1;
+	}
+	heap.clear();
+	lastExpanded = 0;
+}
+
+// Heap order: lowest f first; on ties, the entry furthest along (highest g),
+// which tends to reach the goal with fewer expansions
+bool NavGrid::HeapAfter(const HeapEntry& a, const HeapEntry& b) {
+	return a.f > b.f || (a.f == b.f && a.g < b.g);
+}
+
+void NavGrid::Push(float f, float gVal, int index) {
+	heap.push_back(HeapEntry{ f, gVal, index });
+	std::push_heap(heap.begin(), heap.end(), HeapAfter);
+}
+
+NavGrid::HeapEntry NavGrid::Pop() {
+	std::pop_heap(heap.begin(), heap.end(), HeapAfter);
+	HeapEntry e = heap.back();
+	heap.pop_back();
+	return e;
+}
+
+float NavGrid::Heuristic(int x, int y, int gx, int gy) const {
+	return StepDistance(gx - x, gy - y, diagonal) * minCost;
+}
+
+bool NavGrid::FindPath(int sx, int sy, int gx, int gy, NavMethod method, std::vector<int>& out) {
+	out.clear();
+	lastExpanded = 0;
+	if (!InBounds(sx, sy) || !Open(gx, gy)) return false;
+	UpdateStats();
+
+	int start = sy * width + sx, goal = gy * width + gx;
+	bool jps = (method != NavMethod::AStar && diagonal && uniform);
+	BeginSearch();
+	g[start] = 0;
+	parent[start] = -1;
+	seen[start] = searchId;
+	Push(Heuristic(sx, sy, gx, gy), 0, start);
+	if (!(jps ? JumpPointSearch(goal) : AStar(goal))) return false;
+
+	// Walk back from the goal, then fill in the cells between jump points
+	std::vector<int> points;
+	for (int i = goal; i >= 0; i = parent[i]) points.push_back(i);
+	out.push_back(start);
+	for (int k = (int)points.size() - 2; k >= 0; k--) {
+		int x = out.back() % width, y = out.back() / width;
+		int tx = points[k] % width, ty = points[k] / width;
+		int dx = Sign(tx - x), dy = Sign(ty - y);
+		while (x != tx || y != ty) {
+			x += dx; y += dy;
+			out.push_back(y * width + x);
+		}
+	}
+	return true;
+}
+
+bool NavGrid::AStar(int goal) {
+	int gx = goal % width, gy = goal / width;
+	int dirCount = diagonal ? 8 : 4;
+	while (!heap.empty()) {
+		HeapEntry e = Pop();
+		int i = e.index;
+		if (closed[i] == searchId) continue;
+		closed[i] = searchId;
+		lastExpanded++;
+		if (i == goal) return true;
+
+		int x = i % width, y = i / width;
+		for (int d = 0; d < dirCount; d++) {
+			int dx = kDirX[d], dy = kDirY[d];
+			int nx = x + dx, ny = y + dy;
+			if (!Open(nx, ny)) continue;
+			if (d >= 4 && (!Open(nx, y) || !Open(x, ny))) continue;
+			int n = ny * width + nx;
+			if (closed[n] == searchId) continue;
+			float ng = g[i] + costs[n] * (d >= 4 ? kSqrt2 : 1);
+			if (seen[n] == searchId && ng >= g[n]) continue;
+			g[n] = ng;
+			parent[n] = i;
+			seen[n] = searchId;
+			Push(ng + Heuristic(nx, ny, gx, gy), ng, n);
+		}
+	}
+	return false;
+}
+
+// Step from (x - dx, y - dy) into (x, y) and keep going in that direction
+// until reaching the goal or a jump point (a cell with a neighbor that can
+// only be reached optimally through it).  Returns the cell, or -1 if the
+// way is blocked first.  Diagonal moves never cut corners.
+int NavGrid::Jump(int x, int y, int dx, int dy, int goal) const {
+	while (true) {
+		if (!Open(x, y)) return -1;
+		int i = y * width + x;
+		if (i == goal) return i;
+		if (dx != 0 && dy != 0) {
+			// Going diagonally, a straight jump point either way makes this one
+			if (Jump(x + dx, y, dx, 0, goal) >= 0 || Jump(x, y + dy, 0, dy, goal) >= 0) return i;
+		} else if (dx != 0) {
+			if ((Open(x, y - 1) && !Open(x - dx, y - 1)) || (Open(x, y + 1) && !Open(x - dx, y + 1))) return i;
+		} else {
+			if ((Open(x - 1, y) && !Open(x - 1, y - dy)) || (Open(x + 1, y) && !Open(x + 1, y - dy))) return i;
+		}
+		if (!Open(x + dx, y) || !Open(x, y + dy)) return -1;
+		x += dx;
+		y += dy;
+	}
+}
+
+bool NavGrid::JumpPointSearch(int goal) {
+	int gx = goal % width, gy = goal / width;
+	int dirX[8], dirY[8];
+	while (!heap.empty()) {
+		HeapEntry e = Pop();
+		int i = e.index;
+		if (closed[i] == searchId) continue;
+		closed[i] = searchId;
+		lastExpanded++;
+		if (i == goal) return true;
+
+		// Directions worth jumping in, given the direction we arrived from
+		int x = i % width, y = i / width;
+		int count = 0;
+		if (parent[i] < 0) {
+			for (int d = 0; d < 8; d++) {
+				if (d >= 4 && (!Open(x + kDirX[d], y) || !Open(x, y + kDirY[d]))) continue;
+				dirX[count] = kDirX[d]; dirY[count] = kDirY[d]; count++;
+			}
+		} else {
+			int px = parent[i] % width, py = parent[i] / width;
+			int dx = Sign(x - px), dy = Sign(y - py);
+			if (dx != 0 && dy != 0) {
+				bool openX = Open(x + dx, y), openY = Open(x, y + dy);
+				if (openY) { dirX[count] = 0; dirY[count] = dy; count++; }
+				if (openX) { dirX[count] = dx; dirY[count] = 0; count++; }
+				if (openX && openY) { dirX[count] = dx; dirY[count] = dy; count++; }
+			} else {
+				// Moving straight: ahead, and the perpendiculars and the
+				// diagonals toward them where the corner allows
+				int ax = dx, ay = dy;       // ahead
+				int sx = dy, sy = dx;       // one side (the other is -sx, -sy)
+				bool ahead = Open(x + ax, y + ay);
+				bool side1 = Open(x + sx, y + sy), side2 = Open(x - sx, y - sy);
+				if (ahead) {
+					dirX[count] = ax; dirY[count] = ay; count++;
+					if (side1) { dirX[count] = ax + sx; dirY[count] = ay + sy; count++; }
+					if (side2) { dirX[count] = ax - sx; dirY[count] = ay - sy; count++; }
+				}
+				if (side1) { dirX[count] = sx; dirY[count] = sy; count++; }
+				if (side2) { dirX[count] = -sx; dirY[count] = -sy; count++; }
+			}
+		}
+
+		for (int k = 0; k < count; k++) {
+			int j = Jump(x + dirX[k], y + dirY[k], dirX[k], dirY[k], goal);
+			if (j < 0 || closed[j] == searchId) continue;
+			int jx = j % width, jy = j / width;
+			float ng = g[i] + StepDistance(jx - x, jy - y, true) * minCost;
+			if (seen[j] == searchId && ng >= g[j]) continue;
+			g[j] = ng;
+			parent[j] = i;
+			seen[j] = searchId;
+			Push(ng + Heuristic(jx, jy, gx, gy), ng, j);
+		}
+	}
+	return false;
+}
+
+int NavGrid::BuildFlowField(const std::vector<int>& goals) {
+	size_t n = (size_t)width * height;
+	flowCost.assign(n, -1.0f);
+	flowStep.assign(n * 2, 0);
+
+	// Dijkstra outward from all goals at once.  Moving from a neighbor into
+	// cell i costs i's cost, so that is what each relaxation adds.
+	BeginSearch();
+	for (int goal : goals) {
+		if (goal < 0 || goal >= (int)n || costs[goal] <= 0 || seen[goal] == searchId) continue;
+		g[goal] = 0;
+		seen[goal] = searchId;
+		Push(0, 0, goal);
+	}
+	int dirCount = diagonal ? 8 : 4;
+	int reached = 0;
+	while (!heap.empty()) {
+		HeapEntry e = Pop();
+		int i = e.index;
+		if (closed[i] == searchId) continue;
+		closed[i] = searchId;
+		flowCost[i] = g[i];
+		reached++;
+
+		int x = i % width, y = i / width;
+		for (int d = 0; d < dirCount; d++) {
+			int nx = x + kDirX[d], ny = y + kDirY[d];
+			if (!Open(nx, ny)) continue;
+			if (d >= 4 && (!Open(nx, y) || !Open(x, ny))) continue;
+			int m = ny * width + nx;
+			if (closed[m] == searchId) continue;
+			float ng = g[i] + costs[i] * (d >= 4 ? kSqrt2 : 1);
+			if (seen[m] == searchId && ng >= g[m]) continue;
+			g[m] = ng;
+			seen[m] = searchId;
+			flowStep[m * 2] = (int8_t)-kDirX[d];
+			flowStep[m * 2 + 1] = (int8_t)-kDirY[d];
+			Push(ng, ng, m);
+		}
+	}
+	lastExpanded = reached;
+	return reached;
+}
+
+//--------------------------------------------------------------------------------
+// NavGrid class
+//--------------------------------------------------------------------------------
+
+// Helper: get the NavGrid from self
+static NavGrid* GetNavGrid(Context* context) {
+	return liveNavGrids.FromSelf(context, "NavGrid");
+}
+
+// Helper: get a cell coordinate parameter (cells are 1 unit square)
+static int GetCell(Context* context, const char* name) {
+	return (int)floor(context->GetVar(String(name)).DoubleValue());
+}
+
+// Helper: get a point parameter as a cell
+static void GetCellPoint(Context* context, const char* name, const char* funcName, int* x, int* y) {
+	Point2D p;
+	if (!ValueToPoint2D(context->GetVar(String(name)), &p)) {
+		RuntimeException(String(funcName) + ": " + name + " must be a point ([x, y] or {\"x\":x, \"y\":y})").raise();
+	}
+	*x = (int)floor(p.x);
+	*y = (int)floor(p.y);
+}
+
+bool SetNavGridCosts(NavGrid* grid, Value costsVal) {
+	size_t n = grid->costs.size();
+	if (costsVal.type == ValueType::Number) {
+		std::fill(grid->costs.begin(), grid->costs.end(), (float)costsVal.DoubleValue());
+	} else if (costsVal.type == ValueType::List) {
+		ValueList list = costsVal.GetList();
+		if ((size_t)list.Count() != n) return false;
+		for (size_t i = 0; i < n; i++) grid->costs[i] = (float)list[(long)i].DoubleValue();
+	} else {
+		BinaryData* data = ValueToRawData(costsVal);
+		if (data == nullptr || (size_t)data->length < n * sizeof(float)) return false;
+		const float* src = (const float*)data->bytes;
+		std::copy(src, src + n, grid->costs.begin());
+	}
+	grid->CostsChanged();
+	return true;
+}
+
+ValueDict NavGridClass() {
+	static ValueDict gridClass;
+
+	if (gridClass.Count() > 0) return gridClass;
+
+	gridClass.SetValue(kHandle, Value::zero);
+	gridClass.SetValue(String("width"), Value::zero);
+	gridClass.SetValue(String("height"), Value::zero);
+	gridClass.SetValue(String("diagonal"), Value::one);
+	gridClass.SetValue(String("expanded"), Value::zero);
+
+	Intrinsic* f;
+
+	// NavGrid.get
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("x", Value::zero);
+	f->AddParam("y", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		NavGrid* grid = GetNavGrid(context);
+		int x = GetCell(context, "x"), y = GetCell(context, "y");
+		if (!grid->InBounds(x, y)) return IntrinsicResult(Value::zero);
+		return IntrinsicResult(Value((double)grid->costs[y * grid->width + x]));
+	};
+	gridClass.SetValue(String("get"), f->GetFunc());
+
+	// NavGrid.set
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("x", Value::zero);
+	f->AddParam("y", Value::zero);
+	f->AddParam("cost", Value::one);
+	f->code = INTRINSIC_LAMBDA {
+		NavGrid* grid = GetNavGrid(context);
+		grid->SetCost(GetCell(context, "x"), GetCell(context, "y"),
+			(float)context->GetVar(String("cost")).DoubleValue());
+		return IntrinsicResult::Null;
+	};
+	gridClass.SetValue(String("set"), f->GetFunc());
+
+	// NavGrid.fillRect
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("x", Value::zero);
+	f->AddParam("y", Value::zero);
+	f->AddParam("width", Value::one);
+	f->AddParam("height", Value::one);
+	f->AddParam("cost", Value::one);
+	f->code = INTRINSIC_LAMBDA {
+		NavGrid* grid = GetNavGrid(context);
+		grid->FillRect(GetCell(context, "x"), GetCell(context, "y"),
+			context->GetVar(String("width")).IntValue(), context->GetVar(String("height")).IntValue(),
+			(float)context->GetVar(String("cost")).DoubleValue());
+		return IntrinsicResult::Null;
+	};
+	gridClass.SetValue(String("fillRect"), f->GetFunc());
+
+	// NavGrid.setCosts
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("costs");
+	f->code = INTRINSIC_LAMBDA {
+		NavGrid* grid = GetNavGrid(context);
+		if (!SetNavGridCosts(grid, context->GetVar(String("costs")))) {
+			RuntimeException("NavGrid.setCosts: costs must be a number, or a list or float RawData with one value per cell").raise();
+		}
+		return IntrinsicResult::Null;
+	};
+	gridClass.SetValue(String("setCosts"), f->GetFunc());
+
+	// NavGrid.findPath
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("start");
+	f->AddParam("goal");
+	f->AddParam("asRawData", Value::zero);
+	f->AddParam("method", Value(String("auto")));
+	f->code = INTRINSIC_LAMBDA {
+		Value self = context->GetVar(String("self"));
+		NavGrid* grid = GetNavGrid(context);
+		int sx, sy, gx, gy;
+		GetCellPoint(context, "start", "NavGrid.findPath", &sx, &sy);
+		GetCellPoint(context, "goal", "NavGrid.findPath", &gx, &gy);
+		String methodName = context->GetVar(String("method")).ToString();
+		NavMethod method;
+		if (methodName == "auto") method = NavMethod::Auto;
+		else if (methodName == "astar") method = NavMethod::AStar;
+		else if (methodName == "jps") method = NavMethod::JumpPoint;
+		else {
+			RuntimeException("NavGrid.findPath: unknown method (use \"auto\", \"astar\" or \"jps\")").raise();
+			return IntrinsicResult::Null;
+		}
+
+		static std::vector<int> cells;
+		bool found = grid->FindPath(sx, sy, gx, gy, method, cells);
+		self.GetDict().SetValue(String("expanded"), Value(grid->lastExpanded));
+		if (!found) return IntrinsicResult::Null;
+
+		int w = grid->width;
+		if (context->GetVar(String("asRawData")).BoolValue()) {
+			BinaryData* data = new BinaryData((int)(cells.size() * 2 * sizeof(float)));
+			float* out = (float*)data->bytes;
+			for (int cell : cells) {
+				*out++ = (float)(cell % w);
+				*out++ = (float)(cell / w);
+			}
+			return IntrinsicResult(RawDataToValue(data));
+		}
+		ValueList result;
+		for (int cell : cells) {
+			ValueList point;
+			point.Add(Value(cell % w));
+			point.Add(Value(cell / w));
+			result.Add(Value(point));
+		}
+		return IntrinsicResult(Value(result));
+	};
+	gridClass.SetValue(String("findPath"), f->GetFunc());
+
+	// NavGrid.buildFlowField
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("goals");
+	f->code = INTRINSIC_LAMBDA {
+		NavGrid* grid = GetNavGrid(context);
+		Value goalsVal = context->GetVar(String("goals"));
+
+		// One point, or a list of points
+		std::vector<int> goals;
+		Point2D p;
+		bool single = goalsVal.type == ValueType::Map ||
+			(goalsVal.type == ValueType::List && goalsVal.GetList().Count() > 0 &&
+			 goalsVal.GetList()[0].type == ValueType::Number);
+		if (single) {
+			if (!ValueToPoint2D(goalsVal, &p)) RuntimeException("NavGrid.buildFlowField: goals must be a point or list of points").raise();
+			int x = (int)floor(p.x), y = (int)floor(p.y);
+			if (grid->InBounds(x, y)) goals.push_back(y * grid->width + x);
+		} else if (goalsVal.type == ValueType::List) {
+			ValueList list = goalsVal.GetList();
+			for (long k = 0; k < list.Count(); k++) {
+				if (!ValueToPoint2D(list[k], &p)) RuntimeException("NavGrid.buildFlowField: goals must be a point or list of points").raise();
+				int x = (int)floor(p.x), y = (int)floor(p.y);
+				if (grid->InBounds(x, y)) goals.push_back(y * grid->width + x);
+			}
+		} else {
+			RuntimeException("NavGrid.buildFlowField: goals must be a point or list of points").raise();
+		}
+		return IntrinsicResult(Value(grid->BuildFlowField(goals)));
+	};
+	gridClass.SetValue(String("buildFlowField"), f->GetFunc());
+
+	// NavGrid.flowDirection
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("x", Value::zero);
+	f->AddParam("y", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		NavGrid* grid = GetNavGrid(context);
+		int x = GetCell(context, "x"), y = GetCell(context, "y");
+		if (!grid->HasFlowField() || !grid->InBounds(x, y)) return IntrinsicResult::Null;
+		int i = y * grid->width + x;
+		if (grid->flowCost[i] < 0) return IntrinsicResult::Null;
+		ValueList result;
+		result.Add(Value((int)grid->flowStep[i * 2]));
+		result.Add(Value((int)grid->flowStep[i * 2 + 1]));
+		return IntrinsicResult(Value(result));
+	};
+	gridClass.SetValue(String("flowDirection"), f->GetFunc());
+
+	// NavGrid.flowCost
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("x", Value::zero);
+	f->AddParam("y", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		NavGrid* grid = GetNavGrid(context);
+		int x = GetCell(context, "x"), y = GetCell(context, "y");
+		if (!grid->HasFlowField() || !grid->InBounds(x, y)) return IntrinsicResult::Null;
+		float cost = grid->flowCost[y * grid->width + x];
+		if (cost < 0) return IntrinsicResult::Null;
+		return IntrinsicResult(Value((double)cost));
+	};
+	gridClass.SetValue(String("flowCost"), f->GetFunc());
+
+	// NavGrid.flowCosts
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		NavGrid* grid = GetNavGrid(context);
+		if (!grid->HasFlowField()) return IntrinsicResult::Null;
+		int bytes = (int)(grid->flowCost.size() * sizeof(float));
+		BinaryData* data = new BinaryData(bytes);
+		memcpy(data->bytes, grid->flowCost.data(), bytes);
+		return IntrinsicResult(RawDataToValue(data));
+	};
+	gridClass.SetValue(String("flowCosts"), f->GetFunc());
+
+	// NavGrid.flowSteps
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		NavGrid* grid = GetNavGrid(context);
+		if (!grid->HasFlowField()) return IntrinsicResult::Null;
+		int bytes = (int)grid->flowStep.size();
+		BinaryData* data = new BinaryData(bytes);
+		memcpy(data->bytes, grid->flowStep.data(), bytes);
+		return IntrinsicResult(RawDataToValue(data));
+	};
+	gridClass.SetValue(String("flowSteps"), f->GetFunc());
+
+	return gridClass;
+}
+
+Value NavGridToValue(NavGrid* grid) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, NavGridClass());
+	map.SetValue(kHandle, Value((long)grid));
+	map.SetValue(String("width"), Value(grid->width));
+	map.SetValue(String("height"), Value(grid->height));
+	map.SetValue(String("diagonal"), grid->diagonal ? Value::one : Value::zero);
+	map.SetValue(String("expanded"), Value(grid->lastExpanded));
+	return Value(map);
+}
+
+NavGrid* ValueToNavGrid(Value value) {
+	return liveNavGrids.FromValue(value);
+}
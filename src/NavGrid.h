@@ -0,0 +1,105 @@
+//
+//  NavGrid.h
+//  MSRLWeb
+//
+//  NavGrid: a grid of movement costs for pathfinding.  Costs live in one
+//  contiguous array (cost to enter each cell; 0 or less is blocked).  Paths
+//  are found with A* on a binary heap, or with jump-point search when every
+//  open cell costs the same, and the per-cell search state is kept between
+//  searches and stamped with a search number instead of being cleared.  A
+//  flow field gives the cost and first step toward the nearest of a set of
+//  goals from every cell at once, for many agents sharing a destination.
+//
+//  Diagonal moves cost sqrt(2) times the cell's cost, and never cut a
+//  corner: both cells beside the diagonal must be open.
+//
+
+#ifndef NAVGRID_H
+#define NAVGRID_H
+
+#include "MiniscriptTypes.h"
+#include <stdint.h>
+#include <vector>
+
+enum class NavMethod { Auto, AStar, JumpPoint };
+
+class NavGrid {
+public:
+	NavGrid(int width, int height, float cost, bool diagonal);
+	~NavGrid();
+
+	int width, height;
+	bool diagonal;
+	std::vector<float> costs;
+
+	bool InBounds(int x, int y) const { return x >= 0 && y >= 0 && x < width && y < height; }
+	bool Open(int x, int y) const { return InBounds(x, y) && costs[y * width + x] > 0; }
+
+	// Call after changing costs directly
+	void CostsChanged() { statsValid = false; }
+	void SetCost(int x, int y, float cost);
+	void FillRect(int x, int y, int w, int h, float cost);
+
+	// Whether every open cell has the same cost (so jump-point search applies)
+	bool IsUniform();
+
+	// Cells from start to goal, both included, as cell indexes (y*width+x);
+	// false if the goal can't be reached.  Auto uses jump-point search where
+	// it applies (diagonal moves, uniform costs) and A* elsewhere; so does
+	// JumpPoint, on a grid it doesn't suit.
+	bool FindPath(int sx, int sy, int gx, int gy, NavMethod method, std::vector<int>& out);
+
+	// Cells taken off the open list by the last search (FindPath or
+	// BuildFlowField)
+	int lastExpanded;
+
+	// Fill the flow field from the given goal cells; returns how many cells
+	// can reach a goal
+	int BuildFlowField(const std::vector<int>& goals);
+	bool HasFlowField() const { return !flowCost.empty(); }
+	std::vector<float> flowCost;    // cost to the nearest goal; -1 if unreachable
+	std::vector<int8_t> flowStep;   // dx, dy of the first step (0, 0 at goals)
+
+private:
+	struct HeapEntry {
+		float f, g;
+		int index;
+	};
+
+	// Search state, reused between searches; entries are valid only where
+	// their stamp equals searchId
+	std::vector<float> g;
+	std::vector<int> parent;
+	std::vector<uint32_t> seen, closed;
+	std::vector<HeapEntry> heap;
+	uint32_t searchId;
+
+	// Cached over the open cells
+	bool statsValid, uniform;
+	float minCost;
+
+	static bool HeapAfter(const HeapEntry& a, const HeapEntry& b);
+	void UpdateStats();
+	void BeginSearch();
+	void Push(float f, float g, int index);
+	HeapEntry Pop();
+	float Heuristic(int x, int y, int gx, int gy) const;
+
+	bool AStar(int goal);
+	bool JumpPointSearch(int goal);
+	int Jump(int x, int y, int dx, int dy, int goal) const;
+};
+
+// Set every cost from a number, or a list or float RawData with one value
+// per cell (row by row); false if costs is none of these or too short
+bool SetNavGridCosts(NavGrid* grid, MiniScript::Value costs);
+
+// Get the NavGrid class (MiniScript intrinsic class)
+MiniScript::ValueDict NavGridClass();
+
+// Convert between MiniScript Value and NavGrid.
+// ValueToNavGrid returns null for anything but a live NavGrid.
+MiniScript::Value NavGridToValue(NavGrid* grid);
+NavGrid* ValueToNavGrid(MiniScript::Value value);
+
+#endif // NAVGRID_H
@@ -0,0 +1,556 @@
+//
+//  Noise.cpp
+//  MSRLWeb
+//
+//  Noise implementation
+//
+
+#include "Noise.h"
+#include "LiveHandles.h"
+#include "RawData.h"
+#include "MiniscriptInterpreter.h"
+#include "macros.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+using namespace MiniScript;
+
+static const int kMaxOctaves = 16;
+
+// Largest grid made by Noise.grid, in values
+static const double kMaxGridValues = 16 * 1024 * 1024;
+
+static LiveHandles<Noise> liveNoises;
+
+static String kHandle("_handle");
+
+//--------------------------------------------------------------------------------
+// 4 lanes of floats (F4) and of 32-bit ints or comparison masks (I4):
+// wasm SIMD when available, scalar otherwise, with the same results.
+//--------------------------------------------------------------------------------
+
+#if defined(__wasm_simd128__)
+typedef v128_t F4;
+typedef v128_t I4;
+static inline F4 FSplat(float v) { return wasm_f32x4_splat(v); }
+static inline F4 FLoad(const float* p) { return wasm_v128_load(p); }
+static inline void FStore(float* p, F4 a) { wasm_v128_store(p, a); }
+static inline F4 FAdd(F4 a, F4 b) { return wasm_f32x4_add(a, b); }
+static inline F4 FSub(F4 a, F4 b) { return wasm_f32x4_sub(a, b); }
+static inline F4 FMul(F4 a, F4 b) { return wasm_f32x4_mul(a, b); }
+static inline F4 FMin(F4 a, F4 b) { return wasm_f32x4_pmin(a, b); }
+static inline F4 FMax(F4 a, F4 b) { return wasm_f32x4_pmax(a, b); }
+static inline F4 FAbs(F4 a) { return wasm_f32x4_abs(a); }
+static inline F4 FSqrt(F4 a) { return wasm_f32x4_sqrt(a); }
+static inline F4 FFloor(F4 a) { return wasm_f32x4_floor(a); }
+static inline I4 FLess(F4 a, F4 b) { return wasm_f32x4_lt(a, b); }
+static inline F4 FSelect(I4 mask, F4 a, F4 b) { return wasm_v128_bitselect(a, b, mask); }
+static inline F4 FFlipSign(F4 a, I4 signBits) { return wasm_v128_xor(a, signBits); }
+static inline F4 FFromI(I4 a) { return wasm_f32x4_convert_i32x4(a); }
+static inline I4 IFromF(F4 a) { return wasm_i32x4_trunc_sat_f32x4(a); }
+static inline I4 ISplat(uint32_t v) { return wasm_i32x4_splat((int32_t)v); }
+static inline I4 IAdd(I4 a, I4 b) { return wasm_i32x4_add(a, b); }
+static inline I4 IMul(I4 a, I4 b) { return wasm_i32x4_mul(a, b); }
+static inline I4 IAnd(I4 a, I4 b) { return wasm_v128_and(a, b); }
+static inline I4 IOr(I4 a, I4 b) { return wasm_v128_or(a, b); }
+static inline I4 IXor(I4 a, I4 b) { return wasm_v128_xor(a, b); }
+static inline I4 INot(I4 a) { return wasm_v128_not(a); }
+static inline I4 IShr(I4 a, int n) { return wasm_u32x4_shr(a, n); }
+static inline I4 IShl(I4 a, int n) { return wasm_i32x4_shl(a, n); }
+static inline I4 IEq(I4 a, I4 b) { return wasm_i32x4_eq(a, b); }
+#else
+struct F4 { float v[4]; };
+struct I4 { uint32_t v[4]; };
+static inline F4 FSplat(float v) { return F4{ { v, v, v, v } }; }
+static inline F4 FLoad(const float* p) { return F4{ { p[0], p[1], p[2], p[3] } }; }
+static inline void FStore(float* p, F4 a) { memcpy(p, a.v, sizeof(a.v)); }
+static inline F4 FAdd(F4 a, F4 b) { for (int k = 0; k < 4; k++) a.v[k] += b.v[k]; return a; }
+static inline F4 FSub(F4 a, F4 b) { for (int k = 0; k < 4; k++) a.v[k] -= b.v[k]; return a; }
+static inline F4 FMul(F4 a, F4 b) { for (int k = 0; k < 4; k++) a.v[k] *= b.v[k]; return a; }
+static inline F4 FMin(F4 a, F4 b) { for (int k = 0; k < 4; k++) a.v[k] = (b.v[k] < a.v[k]) ? b.v[k] : a.v[k]; return a; }
+static inline F4 FMax(F4 a, F4 b) { for (int k = 0; k < 4; k++) a.v[k] = (a.v[k] < b.v[k]) ? b.v[k] : a.v[k]; return a; }
+static inline F4 FAbs(F4 a) { for (int k = 0; k < 4; k++) a.v[k] = fabsf(a.v[k]); return a; }
+static inline F4 FSqrt(F4 a) { for (int k = 0; k < 4; k++) a.v[k] = sqrtf(a.v[k]); return a; }
+static inline F4 FFloor(F4 a) { for (int k = 0; k < 4; k++) a.v[k] = floorf(a.v[k]); return a; }
+static inline I4 FLess(F4 a, F4 b) { I4 r; for (int k = 0; k < 4; k++) r.v[k] = (a.v[k] < b.v[k]) ? 0xFFFFFFFFu : 0; return r; }
+static inline F4 FSelect(I4 mask, F4 a, F4 b) { for (int k = 0; k < 4; k++) a.v[k] = mask.v[k] ? a.v[k] : b.v[k]; return a; }
+static inline F4 FFlipSign(F4 a, I4 signBits) {
+	for (int k = 0; k < 4; k++) {
+		uint32_t bits;
+		memcpy(&bits, &a.v[k], 4);
+		bits ^= signBits.v[k];
+		memcpy(&a.v[k], &bits, 4);
+	}
+	return a;
+}
+static inline F4 FFromI(I4 a) { F4 r; for (int k = 0; k < 4; k++) r.v[k] = (float)(int32_t)a.v[k]; return r; }
+static inline I4 IFromF(F4 a) { I4 r; for (int k = 0; k < 4; k++) r.v[k] = (uint32_t)(int32_t)a.v[k]; return r; }
+static inline I4 ISplat(uint32_t v) { return I4{ { v, v, v, v } }; }
+static inline I4 IAdd(I4 a, I4 b) { for (int k = 0; k < 4; k++) a.v[k] += b.v[k]; return a; }
+static inline I4 IMul(I4 a, I4 b) { for (int k = 0; k < 4; k++) a.v[k] *= b.v[k]; return a; }
+static inline I4 IAnd(I4 a, I4 b) { for (int k = 0; k < 4; k++) a.v[k] &= b.v[k]; return a; }
+static inline I4 IOr(I4 a, I4 b) { for (int k = 0; k < 4; k++) a.v[k] |= b.v[k]; return a; }
+static inline I4 IXor(I4 a, I4 b) { for (int k = 0; k < 4; k++) a.v[k] ^= b.v[k]; return a; }
+static inline I4 INot(I4 a) { for (int k = 0; k < 4; k++) a.v[k] = ~a.v[k]; return a; }
+static inline I4 IShr(I4 a, int n) { for (int k = 0; k < 4; k++) a.v[k] >>= n; return a; }
+static inline I4 IShl(I4 a, int n) { for (int k = 0; k < 4; k++) a.v[k] <<= n; return a; }
+static inline I4 IEq(I4 a, I4 b) { for (int k = 0; k < 4; k++) a.v[k] = (a.v[k] == b.v[k]) ? 0xFFFFFFFFu : 0; return a; }
+#endif
+
+static inline I4 IIsZero(I4 a) { return IEq(a, ISplat(0)); }
+
+// 1 where the mask is set, 0 elsewhere
+static inline I4 IBit(I4 mask) { return IAnd(mask, ISplat(1)); }
+static inline F4 FBit(I4 mask) { return FSelect(mask, FSplat(1.0f), FSplat(0.0f)); }
+
+//--------------------------------------------------------------------------------
+// Lattice hashing and gradients
+//--------------------------------------------------------------------------------
+
+// Hash of a lattice point and seed (multiply-xorshift; good in every bit)
+static inline I4 Hash(I4 x, I4 y, I4 seed) {
+	I4 h = IXor(seed, IXor(IMul(x, ISplat(0x27d4eb2d)), IMul(y, ISplat(0x165667b1))));
+	h = IXor(h, IShr(h, 15));
+	h = IMul(h, ISplat(0x2c1b3c6d));
+	h = IXor(h, IShr(h, 12));
+	h = IMul(h, ISplat(0x297a2d39));
+	return IXor(h, IShr(h, 15));
+}
+
+static inline I4 Hash(I4 x, I4 y, I4 z, I4 seed) {
+	return Hash(x, IXor(y, IMul(z, ISplat(0x1b873593))), seed);
+}
+
+// A hash as a value from -1 to 1
+static inline F4 HashValue(I4 h) {
+	return FSub(FMul(FFromI(IShr(h, 8)), FSplat(2.0f / 16777215.0f)), FSplat(1.0f));
+}
+
+// Dot product of (x, y) with one of 8 gradients picked by the hash
+// (Gustavson's 2D gradient set)
+static inline F4 Grad(I4 h, F4 x, F4 y) {
+	I4 low = IIsZero(IAnd(h, ISplat(4)));
+	F4 u = FSelect(low, x, y);
+	F4 v = FSelect(low, y, x);
+	u = FFlipSign(u, IShl(IAnd(h, ISplat(1)), 31));
+	v = FFlipSign(FAdd(v, v), IShl(IAnd(h, ISplat(2)), 30));
+	return FAdd(u, v);
+}
+
+// The same in 3D, with Perlin's 12 edge gradients (16, with 4 repeated)
+static inline F4 Grad(I4 h, F4 x, F4 y, F4 z) {
+	I4 g = IAnd(h, ISplat(15));
+	F4 u = FSelect(IIsZero(IAnd(g, ISplat(8))), x, y);
+	I4 useX = IOr(IEq(g, ISplat(12)), IEq(g, ISplat(14)));
+	F4 v = FSelect(IIsZero(IAnd(g, ISplat(12))), y, FSelect(useX, x, z));
+	u = FFlipSign(u, IShl(IAnd(g, ISplat(1)), 31));
+	v = FFlipSign(v, IShl(IAnd(g, ISplat(2)), 30));
+	return FAdd(u, v);
+}
+
+static inline F4 Fade(F4 t) {
+	F4 poly = FAdd(FMul(t, FSub(FMul(t, FSplat(6.0f)), FSplat(15.0f))), FSplat(10.0f));
+	return FMul(FMul(FMul(t, t), t), poly);
+}
+
+static inline F4 Lerp(F4 a, F4 b, F4 t) {
+	return FAdd(a, FMul(t, FSub(b, a)));
+}
+
+//--------------------------------------------------------------------------------
+// Basis functions
+//--------------------------------------------------------------------------------
+
+static F4 Perlin2(F4 x, F4 y, I4 seed) {
+	F4 fx = FFloor(x), fy = FFloor(y);
+	I4 ix = IFromF(fx), iy = IFromF(fy);
+	I4 ix1 = IAdd(ix, ISplat(1)), iy1 = IAdd(iy, ISplat(1));
+	F4 x0 = FSub(x, fx), y0 = FSub(y, fy);
+	F4 x1 = FSub(x0, FSplat(1.0f)), y1 = FSub(y0, FSplat(1.0f));
+	F4 n00 = Grad(Hash(ix, iy, seed), x0, y0);
+	F4 n10 = Grad(Hash(ix1, iy, seed), x1, y0);
+	F4 n01 = Grad(Hash(ix, iy1, seed), x0, y1);
+	F4 n11 = Grad(Hash(ix1, iy1, seed), x1, y1);
+	F4 u = Fade(x0), v = Fade(y0);
+	return FMul(FSplat(0.507f), Lerp(Lerp(n00, n10, u), Lerp(n01, n11, u), v));
+}
+
+static F4 Perlin3(F4 x, F4 y, F4 z, I4 seed) {
+	F4 fx = FFloor(x), fy = FFloor(y), fz = FFloor(z);
+	I4 ix = IFromF(fx), iy = IFromF(fy), iz = IFromF(fz);
+	I4 ix1 = IAdd(ix, ISplat(1)), iy1 = IAdd(iy, ISplat(1)), iz1 = IAdd(iz, ISplat(1));
+	F4 x0 = FSub(x, fx), y0 = FSub(y, fy), z0 = FSub(z, fz);
+	F4 x1 = FSub(x0, FSplat(1.0f)), y1 = FSub(y0, FSplat(1.0f)), z1 = FSub(z0, FSplat(1.0f));
+	F4 u = Fade(x0), v = Fade(y0), w = Fade(z0);
+	F4 n000 = Grad(Hash(ix, iy, iz, seed), x0, y0, z0);
+	F4 n100 = Grad(Hash(ix1, iy, iz, seed), x1, y0, z0);
+	F4 n010 = Grad(Hash(ix, iy1, iz, seed), x0, y1, z0);
+	F4 n110 = Grad(Hash(ix1, iy1, iz, seed), x1, y1, z0);
+	F4 n001 = Grad(Hash(ix, iy, iz1, seed), x0, y0, z1);
+	F4 n101 = Grad(Hash(ix1, iy, iz1, seed), x1, y0, z1);
+	F4 n011 = Grad(Hash(ix, iy1, iz1, seed), x0, y1, z1);
+	F4 n111 = Grad(Hash(ix1, iy1, iz1, seed), x1, y1, z1);
+	F4 front = Lerp(Lerp(n000, n100, u), Lerp(n010, n110, u), v);
+	F4 back = Lerp(Lerp(n001, n101, u), Lerp(n011, n111, u), v);
+	return FMul(FSplat(0.936f), Lerp(front, back, w));
+}
+
+static F4 Value2(F4 x, F4 y, I4 seed) {
+	F4 fx = FFloor(x), fy = FFloor(y);
+	I4 ix = IFromF(fx), iy = IFromF(fy);
+	I4 ix1 = IAdd(ix, ISplat(1)), iy1 = IAdd(iy, ISplat(1));
+	F4 u = Fade(FSub(x, fx)), v = Fade(FSub(y, fy));
+	F4 n00 = HashValue(Hash(ix, iy, seed)), n10 = HashValue(Hash(ix1, iy, seed));
+	F4 n01 = HashValue(Hash(ix, iy1, seed)), n11 = HashValue(Hash(ix1, iy1, seed));
+	return Lerp(Lerp(n00, n10, u), Lerp(n01, n11, u), v);
+}
+
+static F4 Value3(F4 x, F4 y, F4 z, I4 seed) {
+	F4 fx = FFloor(x), fy = FFloor(y), fz = FFloor(z);
+	I4 ix = IFromF(fx), iy = IFromF(fy), iz = IFromF(fz);
+	I4 ix1 = IAdd(ix, ISplat(1)), iy1 = IAdd(iy, ISplat(1)), iz1 = IAdd(iz, ISplat(1));
+	F4 u = Fade(FSub(x, fx)), v = Fade(FSub(y, fy)), w = Fade(FSub(z, fz));
+	F4 front = Lerp(Lerp(HashValue(Hash(ix, iy, iz, seed)), HashValue(Hash(ix1, iy, iz, seed)), u),
+				   Lerp(HashValue(Hash(ix, iy1, iz, seed)), HashValue(Hash(ix1, iy1, iz, seed)), u), v);
+	F4 back = Lerp(Lerp(HashValue(Hash(ix, iy, iz1, seed)), HashValue(Hash(ix1, iy, iz1, seed)), u),
+				  Lerp(HashValue(Hash(ix, iy1, iz1, seed)), HashValue(Hash(ix1, iy1, iz1, seed)), u), v);
+	return Lerp(front, back, w);
+}
+
+// Contribution of one simplex corner
+static inline F4 SimplexCorner(I4 h, F4 x, F4 y, float radius) {
+	F4 t = FMax(FSub(FSub(FSplat(radius), FMul(x, x)), FMul(y, y)), FSplat(0.0f));
+	t = FMul(t, t);
+	return FMul(FMul(t, t), Grad(h, x, y));
+}
+
+static inline F4 SimplexCorner(I4 h, F4 x, F4 y, F4 z, float radius) {
+	F4 t = FMax(FSub(FSub(FSub(FSplat(radius), FMul(x, x)), FMul(y, y)), FMul(z, z)), FSplat(0.0f));
+	t = FMul(t, t);
+	return FMul(FMul(t, t), Grad(h, x, y, z));
+}
+
+static F4 Simplex2(F4 x, F4 y, I4 seed) {
+	const float F2 = 0.366025403f;     // (sqrt(3) - 1) / 2
+	const float G2 = 0.211324865f;     // (3 - sqrt(3)) / 6
+	F4 s = FMul(FAdd(x, y), FSplat(F2));
+	F4 fi = FFloor(FAdd(x, s)), fj = FFloor(FAdd(y, s));
+	F4 t = FMul(FAdd(fi, fj), FSplat(G2));
+	F4 x0 = FSub(x, FSub(fi, t)), y0 = FSub(y, FSub(fj, t));
+	// Which of the two triangles of the skewed cell we're in
+	I4 lower = FLess(y0, x0);
+	F4 x1 = FAdd(FSub(x0, FBit(lower)), FSplat(G2));
+	F4 y1 = FAdd(FSub(y0, FBit(INot(lower))), FSplat(G2));
+	F4 x2 = FAdd(FSub(x0, FSplat(1.0f)), FSplat(2 * G2));
+	F4 y2 = FAdd(FSub(y0, FSplat(1.0f)), FSplat(2 * G2));
+	I4 i = IFromF(fi), j = IFromF(fj);
+	F4 n0 = SimplexCorner(Hash(i, j, seed), x0, y0, 0.5f);
+	F4 n1 = SimplexCorner(Hash(IAdd(i, IBit(lower)), IAdd(j, IBit(INot(lower))), seed), x1, y1, 0.5f);
+	F4 n2 = SimplexCorner(Hash(IAdd(i, ISplat(1)), IAdd(j, ISplat(1)), seed), x2, y2, 0.5f);
+	return FMul(FSplat(40.0f), FAdd(FAdd(n0, n1), n2));
+}
+
+static F4 Simplex3(F4 x, F4 y, F4 z, I4 seed) {
+	const float F3 = 1.0f / 3.0f;
+	const float G3 = 1.0f / 6.0f;
+	F4 s = FMul(FAdd(FAdd(x, y), z), FSplat(F3));
+	F4 fi = FFloor(FAdd(x, s)), fj = FFloor(FAdd(y, s)), fk = FFloor(FAdd(z, s));
+	F4 t = FMul(FAdd(FAdd(fi, fj), fk), FSplat(G3));
+	F4 x0 = FSub(x, FSub(fi, t)), y0 = FSub(y, FSub(fj, t)), z0 = FSub(z, FSub(fk, t));
+	// Which of the six tetrahedra: the second corner steps along the
+	// largest offset, the third along all but the smallest
+	I4 xy = INot(FLess(x0, y0)), xz = INot(FLess(x0, z0)), yz = INot(FLess(y0, z0));
+	I4 i1 = IAnd(xy, xz), j1 = IAnd(INot(xy), yz), k1 = IAnd(INot(xz), INot(yz));
+	I4 i2 = IOr(xy, xz), j2 = IOr(INot(xy), yz), k2 = INot(IAnd(xz, yz));
+	F4 x1 = FAdd(FSub(x0, FBit(i1)), FSplat(G3));
+	F4 y1 = FAdd(FSub(y0, FBit(j1)), FSplat(G3));
+	F4 z1 = FAdd(FSub(z0, FBit(k1)), FSplat(G3));
+	F4 x2 = FAdd(FSub(x0, FBit(i2)), FSplat(2 * G3));
+	F4 y2 = FAdd(FSub(y0, FBit(j2)), FSplat(2 * G3));
+	F4 z2 = FAdd(FSub(z0, FBit(k2)), FSplat(2 * G3));
+	F4 x3 = FSub(x0, FSplat(1 - 3 * G3));
+	F4 y3 = FSub(y0, FSplat(1 - 3 * G3));
+	F4 z3 = FSub(z0, FSplat(1 - 3 * G3));
+	I4 i = IFromF(fi), j = IFromF(fj), k = IFromF(fk);
+	I4 one = ISplat(1);
+	F4 n0 = SimplexCorner(Hash(i, j, k, seed), x0, y0, z0, 0.6f);
+	F4 n1 = SimplexCorner(Hash(IAdd(i, IBit(i1)), IAdd(j, IBit(j1)), IAdd(k, IBit(k1)), seed), x1, y1, z1, 0.6f);
+	F4 n2 = SimplexCorner(Hash(IAdd(i, IBit(i2)), IAdd(j, IBit(j2)), IAdd(k, IBit(k2)), seed), x2, y2, z2, 0.6f);
+	F4 n3 = SimplexCorner(Hash(IAdd(i, one), IAdd(j, one), IAdd(k, one), seed), x3, y3, z3, 0.6f);
+	return FMul(FSplat(32.0f), FAdd(FAdd(n0, n1), FAdd(n2, n3)));
+}
+
+// Worley (cellular) noise: distance to the nearest of one jittered point
+// per cell, mapped from 0..1 to -1..1
+static F4 Worley2(F4 x, F4 y, I4 seed) {
+	F4 fx = FFloor(x), fy = FFloor(y);
+	I4 ix = IFromF(fx), iy = IFromF(fy);
+	F4 x0 = FSub(x, fx), y0 = FSub(y, fy);
+	F4 best = FSplat(8.0f);
+	for (int dy = -1; dy <= 1; dy++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			I4 h = Hash(IAdd(ix, ISplat((uint32_t)dx)), IAdd(iy, ISplat((uint32_t)dy)), seed);
+			F4 px = FSub(FAdd(FSplat((float)dx), FMul(FFromI(IAnd(h, ISplat(0xFFFF))), FSplat(1.0f / 65536))), x0);
+			F4 py = FSub(FAdd(FSplat((float)dy), FMul(FFromI(IShr(h, 16)), FSplat(1.0f / 65536))), y0);
+			best = FMin(best, FAdd(FMul(px, px), FMul(py, py)));
+		}
+	}
+	return FSub(FMul(FMin(FSqrt(best), FSplat(1.0f)), FSplat(2.0f)), FSplat(1.0f));
+}
+
+static F4 Worley3(F4 x, F4 y, F4 z, I4 seed) {
+	F4 fx = FFloor(x), fy = FFloor(y), fz = FFloor(z);
+	I4 ix = IFromF(fx), iy = IFromF(fy), iz = IFromF(fz);
+	F4 x0 = FSub(x, fx), y0 = FSub(y, fy), z0 = FSub(z, fz);
+	I4 mask = ISplat(1023);
+	F4 scale = FSplat(1.0f / 1024);
+	F4 best = FSplat(12.0f);
+	for (int dz = -1; dz <= 1; dz++) {
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				I4 h = Hash(IAdd(ix, ISplat((uint32_t)dx)), IAdd(iy, ISplat((uint32_t)dy)),
+							IAdd(iz, ISplat((uint32_t)dz)), seed);
+				F4 px = FSub(FAdd(FSplat((float)dx), FMul(FFromI(IAnd(h, mask)), scale)), x0);
+				F4 py = FSub(FAdd(FSplat((float)dy), FMul(FFromI(IAnd(IShr(h, 10), mask)), scale)), y0);
+				F4 pz = FSub(FAdd(FSplat((float)dz), FMul(FFromI(IAnd(IShr(h, 20), mask)), scale)), z0);
+				best = FMin(best, FAdd(FAdd(FMul(px, px), FMul(py, py)), FMul(pz, pz)));
+			}
+		}
+	}
+	return FSub(FMul(FMin(FSqrt(best), FSplat(1.0f)), FSplat(2.0f)), FSplat(1.0f));
+}
+
+static F4 Basis(NoiseType type, F4 x, F4 y, const F4* z, I4 seed) {
+	switch (type) {
+	case NoiseType::Perlin:  return z ? Perlin3(x, y, *z, seed) : Perlin2(x, y, seed);
+	case NoiseType::Simplex: return z ? Simplex3(x, y, *z, seed) : Simplex2(x, y, seed);
+	case NoiseType::Value:   return z ? Value3(x, y, *z, seed) : Value2(x, y, seed);
+	case NoiseType::Worley:  return z ? Worley3(x, y, *z, seed) : Worley2(x, y, seed);
+	}
+	return FSplat(0.0f);
+}
+
+//--------------------------------------------------------------------------------
+// Noise implementation
+//--------------------------------------------------------------------------------
+
+Noise::Noise()
+	: type(NoiseType::Perlin), fractal(NoiseFractal::None), seed(0), frequency(1),
+	  octaves(4), lacunarity(2), gain(0.5f) {
+	liveNoises.Add(this);
+}
+
+Noise::~Noise() {
+	liveNoises.Remove(this);
+}
+
+// Noise (with the fractal sum, if any) at 4 points; z null for 2D
+static F4 Evaluate(const Noise& noise, F4 x, F4 y, const F4* z) {
+	F4 f = FSplat(noise.frequency);
+	x = FMul(x, f);
+	y = FMul(y, f);
+	F4 zf;
+	if (z) zf = FMul(*z, f);
+	const F4* zp = z ? &zf : nullptr;
+	if (noise.fractal == NoiseFractal::None) return Basis(noise.type, x, y, zp, ISplat(noise.seed));
+
+	// Each octave has its own seed, so they don't line up at the origin
+	int octaves = std::max(1, std::min(noise.octaves, kMaxOctaves));
+	F4 sum = FSplat(0.0f);
+	F4 lacunarity = FSplat(noise.lacunarity);
+	float amplitude = 1, total = 0;
+	for (int octave = 0; octave < octaves; octave++) {
+		F4 n = Basis(noise.type, x, y, zp, ISplat(noise.seed + (uint32_t)octave));
+		if (noise.fractal == NoiseFractal::Ridged) {
+			n = FSub(FSplat(1.0f), FAbs(n));
+			n = FMul(n, n);
+		}
+		sum = FAdd(sum, FMul(n, FSplat(amplitude)));
+		total += amplitude;
+		amplitude *= noise.gain;
+		x = FMul(x, lacunarity);
+		y = FMul(y, lacunarity);
+		if (z) zf = FMul(zf, lacunarity);
+	}
+	F4 result = FMul(sum, FSplat(1.0f / total));
+	// (ridges sum to 0..1; spread that to -1..1 like the rest)
+	if (noise.fractal == NoiseFractal::Ridged) result = FSub(FAdd(result, result), FSplat(1.0f));
+	return result;
+}
+
+float Noise::Get(float x, float y) const {
+	float out[4];
+	FStore(out, Evaluate(*this, FSplat(x), FSplat(y), nullptr));
+	return out[0];
+}
+
+float Noise::Get(float x, float y, float z) const {
+	float out[4];
+	F4 zv = FSplat(z);
+	FStore(out, Evaluate(*this, FSplat(x), FSplat(y), &zv));
+	return out[0];
+}
+
+void Noise::Get4(const float* x, const float* y, const float* z, float* out) const {
+	F4 zv;
+	if (z) zv = FLoad(z);
+	FStore(out, Evaluate(*this, FLoad(x), FLoad(y), z ? &zv : nullptr));
+}
+
+void Noise::Grid(float* out, int width, int height, double x0, double y0, double step, const double* z) const {
+	F4 zv = FSplat(z ? (float)*z : 0.0f);
+	const F4* zp = z ? &zv : nullptr;
+	float xs[4], values[4];
+	for (int j = 0; j < height; j++) {
+		F4 yv = FSplat((float)(y0 + j * step));
+		float* row = out + (size_t)j * width;
+		for (int i = 0; i < width; i += 4) {
+			int n = std::min(4, width - i);
+			for (int k = 0; k < 4; k++) xs[k] = (float)(x0 + (i + std::min(k, n - 1)) * step);
+			FStore(values, Evaluate(*this, FLoad(xs), yv, zp));
+			memcpy(row + i, values, n * sizeof(float));
+		}
+	}
+}
+
+bool ParseNoiseType(const String& name, NoiseType* out) {
+	String s = name.ToLower();
+	if (s == "perlin") *out = NoiseType::Perlin;
+	else if (s == "simplex") *out = NoiseType::Simplex;
+	else if (s == "value") *out = NoiseType::Value;
+	else if (s == "worley" || s == "cellular") *out = NoiseType::Worley;
+	else return false;
+	return true;
+}
+
+bool ParseNoiseFractal(const String& name, NoiseFractal* out) {
+	String s = name.ToLower();
+	if (s == "" || s == "none") *out = NoiseFractal::None;
+	else if (s == "fbm") *out = NoiseFractal::FBm;
+	else if (s == "ridged") *out = NoiseFractal::Ridged;
+	else return false;
+	return true;
+}
+
+static const char* NoiseTypeName(NoiseType type) {
+	switch (type) {
+	case NoiseType::Perlin: return "perlin";
+	case NoiseType::Simplex: return "simplex";
+	case NoiseType::Value: return "value";
+	case NoiseType::Worley: return "worley";
+	}
+	return "";
+}
+
+static const char* NoiseFractalName(NoiseFractal fractal) {
+	switch (fractal) {
+	case NoiseFractal::None: return "none";
+	case NoiseFractal::FBm: return "fbm";
+	case NoiseFractal::Ridged: return "ridged";
+	}
+	return "";
+}
+
+//--------------------------------------------------------------------------------
+// Noise class
+//--------------------------------------------------------------------------------
+
+// Helper: get the Noise from self
+static Noise* GetNoise(Context* context) {
+	return liveNoises.FromSelf(context, "Noise");
+}
+
+ValueDict NoiseClass() {
+	static ValueDict noiseClass;
+
+	if (noiseClass.Count() > 0) return noiseClass;
+
+	noiseClass.SetValue(kHandle, Value::zero);
+	noiseClass.SetValue(String("type"), Value::null);
+	noiseClass.SetValue(String("fractal"), Value::null);
+	noiseClass.SetValue(String("seed"), Value::zero);
+	noiseClass.SetValue(String("frequency"), Value::one);
+	noiseClass.SetValue(String("octaves"), Value::one);
+	noiseClass.SetValue(String("lacunarity"), Value::zero);
+	noiseClass.SetValue(String("gain"), Value::zero);
+
+	Intrinsic* f;
+
+	// Noise.get
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("x", Value::zero);
+	f->AddParam("y", Value::zero);
+	f->AddParam("z");
+	f->code = INTRINSIC_LAMBDA {
+		Noise* noise = GetNoise(context);
+		float x = context->GetVar(String("x")).FloatValue();
+		float y = context->GetVar(String("y")).FloatValue();
+		Value zVal = context->GetVar(String("z"));
+		float result = zVal.IsNull() ? noise->Get(x, y) : noise->Get(x, y, zVal.FloatValue());
+		return IntrinsicResult(Value((double)result));
+	};
+	noiseClass.SetValue(String("get"), f->GetFunc());
+
+	// Noise.grid (float32 values, row by row)
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("width");
+	f->AddParam("height");
+	f->AddParam("x", Value::zero);
+	f->AddParam("y", Value::zero);
+	f->AddParam("step", Value::one);
+	f->AddParam("z");
+	f->AddParam("dest");
+	f->code = INTRINSIC_LAMBDA {
+		Noise* noise = GetNoise(context);
+		int width = context->GetVar(String("width")).IntValue();
+		int height = context->GetVar(String("height")).IntValue();
+		if (width < 1 || height < 1) RuntimeException("Noise.grid: width and height must be at least 1").raise();
+		if ((double)width * height > kMaxGridValues) RuntimeException("Noise.grid: grid too large").raise();
+		double x = context->GetVar(String("x")).DoubleValue();
+		double y = context->GetVar(String("y")).DoubleValue();
+		double step = context->GetVar(String("step")).DoubleValue();
+		Value zVal = context->GetVar(String("z"));
+		double z = zVal.DoubleValue();
+		int bytes = width * height * (int)sizeof(float);
+
+		Value destVal = context->GetVar(String("dest"));
+		BinaryData* data;
+		if (destVal.IsNull()) {
+			data = new BinaryData(bytes);
+			destVal = RawDataToValue(data);
+		} else {
+			data = ValueToRawData(destVal);
+			if (data == nullptr) RuntimeException("Noise.grid: dest must be a RawData").raise();
+			if (data->length < bytes) data->Resize(bytes);
+		}
+		noise->Grid((float*)data->bytes, width, height, x, y, step, zVal.IsNull() ? nullptr : &z);
+		return IntrinsicResult(destVal);
+	};
+	noiseClass.SetValue(String("grid"), f->GetFunc());
+
+	return noiseClass;
+}
+
+Value NoiseToValue(Noise* noise) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, NoiseClass());
+	map.SetValue(kHandle, Value((long)noise));
+	map.SetValue(String("type"), Value(String(NoiseTypeName(noise->type))));
+	map.SetValue(String("fractal"), Value(String(NoiseFractalName(noise->fractal))));
+	map.SetValue(String("seed"), Value((double)noise->seed));
+	map.SetValue(String("frequency"), Value((double)noise->frequency));
+	map.SetValue(String("octaves"), Value(noise->octaves));
+	map.SetValue(String("lacunarity"), Value((double)noise->lacunarity));
+	map.SetValue(String("gain"), Value((double)noise->gain));
+	return Value(map);
+}
+
+Noise* ValueToNoise(Value value) {
+	return liveNoises.FromValue(value);
+}
@@ -0,0 +1,61 @@
+//
+//  Noise.h
+//  MSRLWeb
+//
+//  Noise: seeded coherent noise (Perlin, simplex, value and Worley, in 2D
+//  or 3D), optionally summed over octaves as fBm or ridged noise.  Lattice
+//  points are hashed with integer arithmetic instead of a permutation
+//  table, so every step is plain lane-wise math and 4 points are
+//  evaluated at once with wasm SIMD.  A single point goes through the same
+//  code, so it gets exactly the value it would get in a grid, and a given
+//  seed gives the same values everywhere.
+//
+
+#ifndef NOISE_H
+#define NOISE_H
+
+#include "MiniscriptTypes.h"
+#include <stdint.h>
+
+enum class NoiseType { Perlin, Simplex, Value, Worley };
+enum class NoiseFractal { None, FBm, Ridged };
+
+class Noise {
+public:
+	Noise();
+	~Noise();
+
+	NoiseType type;
+	NoiseFractal fractal;
+	uint32_t seed;
+	float frequency;
+	int octaves;            // (for fBm and ridged)
+	float lacunarity;       // frequency multiplier per octave
+	float gain;             // amplitude multiplier per octave
+
+	// Noise at a point, from -1 to 1
+	float Get(float x, float y) const;
+	float Get(float x, float y, float z) const;
+
+	// Noise at 4 points at once (z may be null for 2D)
+	void Get4(const float* x, const float* y, const float* z, float* out) const;
+
+	// A width x height grid of values, row by row, at x0 + i*step,
+	// y0 + j*step (and z, unless 2D)
+	void Grid(float* out, int width, int height, double x0, double y0, double step, const double* z) const;
+};
+
+// Parse a type or fractal name ("perlin", "simplex", "value", "worley";
+// "none", "fbm", "ridged"); false if unknown
+bool ParseNoiseType(const MiniScript::String& name, NoiseType* out);
+bool ParseNoiseFractal(const MiniScript::String& name, NoiseFractal* out);
+
+// Get the Noise class (MiniScript intrinsic class)
+MiniScript::ValueDict NoiseClass();
+
+// Convert between MiniScript Value and Noise.
+// ValueToNoise returns null for anything but a live Noise.
+MiniScript::Value NoiseToValue(Noise* noise);
+Noise* ValueToNoise(MiniScript::Value value);
+
+#endif // NOISE_H
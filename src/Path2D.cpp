@@ -0,0 +1,346 @@
+//
+//  Path2D.cpp
+//  MSRLWeb
+//
+//  Path2D implementation
+//
+
+#include "Path2D.h"
+#include "LiveHandles.h"
+#include "RawData.h"
+#include "MiniscriptInterpreter.h"
+#include "macros.h"
+#include <algorithm>
+#include <math.h>
+
+using namespace MiniScript;
+
+// Paths with fewer segments than this are searched linearly; the grid
+// doesn't pay for itself until there are a few dozen segments.
+static const int kGridMinSegments = 32;
+static const int kGridMaxSide = 512;
+
+static LiveHandles<Path2D> livePaths;
+
+//--------------------------------------------------------------------------------
+// Path2D implementation
+//--------------------------------------------------------------------------------
+
+Path2D::Path2D(const Point2D* pts, int count)
+	: points(pts, pts + count), gridBuilt(false), gridMinX(0), gridMinY(0), cellSize(0),
+	  gridCols(0), gridRows(0), queryStamp(0) {
+	cumLength.resize(count);
+	double total = 0;
+	for (int i = 0; i < count; i++) {
+		if (i > 0) total += Distance(points[i - 1], points[i]);
+		cumLength[i] = total;
+	}
+	livePaths.Add(this);
+}
+
+Path2D::~Path2D() {
+	livePaths.Remove(this);
+}
+
+PathLocation Path2D::Locate(double distance) const {
+	PathLocation loc = { -1, 0, 0, 0, {0, 0} };
+	int count = Count();
+	if (count == 0) return loc;
+	double total = Length();
+	if (!(distance >= 0)) distance = 0;	// (also catches NaN)
+	if (distance >= total) {
+		// at (or past) the end: park on the last point
+		loc.index = count - 1;
+		loc.distAtIndex = total;
+		loc.position = points[count - 1];
+		return loc;
+	}
+	// last point whose cumulative length is <= distance; zero-length
+	// segments are skipped, since their end has the same length
+	int i = (int)(std::upper_bound(cumLength.begin(), cumLength.end(), distance) - cumLength.begin()) - 1;
+	loc.index = i;
+	loc.distAtIndex = cumLength[i];
+	loc.distToNext = cumLength[i + 1] - cumLength[i];
+	loc.t = (distance - cumLength[i]) / loc.distToNext;
+	const Point2D& a = points[i];
+	const Point2D& b = points[i + 1];
+	loc.position = Point2D{ a.x + (b.x - a.x) * loc.t, a.y + (b.y - a.y) * loc.t };
+	return loc;
+}
+
+void Path2D::BuildGrid() {
+	gridBuilt = true;
+	int segCount = Count() - 1;
+	if (segCount < kGridMinSegments) return;
+
+	double minX = points[0].x, maxX = minX, minY = points[0].y, maxY = minY;
+	for (const Point2D& p : points) {
+		minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+		minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+	}
+	double w = maxX - minX, h = maxY - minY;
+	double extent = std::max(w, h);
+	if (!(extent > 0) || !isfinite(extent)) return;
+
+	// Aim for about one segment per cell; a long thin path gets a strip
+	cellSize = std::max(sqrt(w * h / segCount), extent / segCount);
+	cellSize = std::max(cellSize, extent / (kGridMaxSide - 1));
+	gridMinX = minX;
+	gridMinY = minY;
+	gridCols = (int)(w / cellSize) + 1;
+	gridRows = (int)(h / cellSize) + 1;
+
+	// Count the segments touching each cell (by bounding box), then fill
+	int cellCount = gridCols * gridRows;
+	gridStart.assign(cellCount + 1, 0);
+	for (int pass = 0; pass < 2; pass++) {
+		std::vector<int> cursor;
+		if (pass == 1) {
+			for (int c = 0; c < cellCount; c++) gridStart[c + 1] += gridStart[c];
+			gridSegs.resize(gridStart[cellCount]);
+			cursor.assign(gridStart.begin(), gridStart.end() - 1);
+		}
+		for (int s = 0; s < segCount; s++) {
+			const Point2D& a = points[s];
+			const Point2D& b = points[s + 1];
+			int cx0 = (int)((std::min(a.x, b.x) - minX) / cellSize);
+			int cx1 = std::min(gridCols - 1, (int)((std::max(a.x, b.x) - minX) / cellSize));
+			int cy0 = (int)((std::min(a.y, b.y) - minY) / cellSize);
+			int cy1 = std::min(gridRows - 1, (int)((std::max(a.y, b.y) - minY) / cellSize));
+			for (int cy = cy0; cy <= cy1; cy++) {
+				for (int cx = cx0; cx <= cx1; cx++) {
+					int c = cy * gridCols + cx;
+					if (pass == 0) gridStart[c + 1]++;
+					else gridSegs[cursor[c]++] = s;
+				}
+			}
+		}
+	}
+	visitStamp.assign(segCount, 0);
+}
+
+int Path2D::Nearest(Point2D p, Point2D* outPoint, double* outDist) {
+	int count = Count();
+	if (count == 0) return -1;
+	if (!gridBuilt) BuildGrid();
+	if (gridCols == 0) return NearestOnPolyline(points.data(), count, p, outPoint, outDist);
+
+	if (++queryStamp == 0) {
+		std::fill(visitStamp.begin(), visitStamp.end(), 0);
+		queryStamp = 1;
+	}
+	int best = -1;
+	double bestDist = 0;
+	Point2D bestPt = {0, 0};
+	int cx0 = std::max(0, std::min(gridCols - 1, (int)floor((p.x - gridMinX) / cellSize)));
+	int cy0 = std::max(0, std::min(gridRows - 1, (int)floor((p.y - gridMinY) / cellSize)));
+	int maxRing = std::max(gridCols, gridRows);
+
+	// Search rings of cells outward from p's cell (clamped into the grid).
+	// Everything in ring r is at least (r-1) cells away, so we can stop once
+	// that exceeds the best distance found so far.
+	for (int r = 0; r <= maxRing; r++) {
+		if (best >= 0 && (r - 1) * cellSize > bestDist) break;
+		int yLo = std::max(0, cy0 - r), yHi = std::min(gridRows - 1, cy0 + r);
+		for (int cy = yLo; cy <= yHi; cy++) {
+			bool fullRow = (cy == cy0 - r || cy == cy0 + r);
+			int xLo = std::max(0, cx0 - r), xHi = std::min(gridCols - 1, cx0 + r);
+			for (int cx = xLo; cx <= xHi; cx++) {
+				if (!fullRow && cx != cx0 - r && cx != cx0 + r) {
+					if (cx < cx0 + r) cx = cx0 + r - 1;	// jump to the right edge
+					continue;
+				}
+				int c = cy * gridCols + cx;
+				for (int k = gridStart[c]; k < gridStart[c + 1]; k++) {
+					int s = gridSegs[k];
+					if (visitStamp[s] == queryStamp) continue;
+					visitStamp[s] = queryStamp;
+					Point2D q = NearestPointOnLineSegment(points[s], points[s + 1], p);
+					double d = Distance(q, p);
+					if (best < 0 || d < bestDist || (d == bestDist && s < best)) {
+						best = s;
+						bestDist = d;
+						bestPt = q;
+					}
+				}
+			}
+		}
+	}
+	*outPoint = bestPt;
+	*outDist = bestDist;
+	return best;
+}
+
+int NearestOnPolyline(const Point2D* pts, int count, Point2D p, Point2D* outPoint, double* outDist) {
+	if (count == 1) {
+		*outPoint = pts[0];
+		*outDist = Distance(pts[0], p);
+		return 0;
+	}
+	int best = -1;
+	double bestDist = 0;
+	for (int i = 0; i + 1 < count; i++) {
+		Point2D q = NearestPointOnLineSegment(pts[i], pts[i + 1], p);
+		double d = Distance(q, p);
+		if (best < 0 || d < bestDist) {
+			best = i;
+			bestDist = d;
+			*outPoint = q;
+		}
+	}
+	*outDist = bestDist;
+	return best;
+}
+
+//--------------------------------------------------------------------------------
+// MiniScript Path class
+//--------------------------------------------------------------------------------
+
+static String kHandle("_handle");
+
+// Helper: get Path2D from self
+static Path2D* GetPath(Context* context) {
+	return livePaths.FromSelf(context, "Path");
+}
+
+// Helper: get a point parameter
+static Point2D GetPointParam(Context* context, const char* funcName, const char* param) {
+	Point2D p;
+	if (!ValueToPoint2D(context->GetVar(String(param)), &p)) {
+		RuntimeException(String(funcName) + ": " + param + " must be a map with x and y, or an [x, y] list").raise();
+	}
+	return p;
+}
+
+ValueDict PathClass() {
+	static ValueDict pathClass;
+
+	if (pathClass.Count() > 0) return pathClass;
+
+	pathClass.SetValue(kHandle, Value::zero);
+	pathClass.SetValue(String("length"), Value::zero);
+	pathClass.SetValue(String("points"), Value::null);
+
+	Intrinsic* f;
+
+	// Path.nearestPoint
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("point");
+	f->code = INTRINSIC_LAMBDA {
+		Path2D* path = GetPath(context);
+		Point2D p = GetPointParam(context, "Path.nearestPoint", "point");
+		Point2D q;
+		double dist;
+		if (path->Nearest(p, &q, &dist) < 0) return IntrinsicResult::Null;
+		return IntrinsicResult(Point2DToList(q));
+	};
+	pathClass.SetValue(String("nearestPoint"), f->GetFunc());
+
+	// Path.distanceTo
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("point");
+	f->code = INTRINSIC_LAMBDA {
+		Path2D* path = GetPath(context);
+		Point2D p = GetPointParam(context, "Path.distanceTo", "point");
+		Point2D q;
+		double dist = 0;
+		path->Nearest(p, &q, &dist);
+		return IntrinsicResult(dist);
+	};
+	pathClass.SetValue(String("distanceTo"), f->GetFunc());
+
+	// Path.distanceAlong
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("point");
+	f->code = INTRINSIC_LAMBDA {
+		Path2D* path = GetPath(context);
+		Point2D p = GetPointParam(context, "Path.distanceAlong", "point");
+		Point2D q;
+		double dist;
+		int seg = path->Nearest(p, &q, &dist);
+		if (seg < 0) return IntrinsicResult(0.0);
+		return IntrinsicResult(path->cumLength[seg] + Distance(path->points[seg], q));
+	};
+	pathClass.SetValue(String("distanceAlong"), f->GetFunc());
+
+	// Path.pointAt
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("distance", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		Path2D* path = GetPath(context);
+		if (path->Count() == 0) return IntrinsicResult::Null;
+		PathLocation loc = path->Locate(context->GetVar(String("distance")).DoubleValue());
+		return IntrinsicResult(Point2DToList(loc.position));
+	};
+	pathClass.SetValue(String("pointAt"), f->GetFunc());
+
+	// Path.cursorTo: position a pathUtil PathPoint (or any map) the given
+	// distance along this path, setting curIndex, distAtIndex, distToNext,
+	// t, and position
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("cursor");
+	f->AddParam("distance", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		Path2D* path = GetPath(context);
+		Value cursorVal = context->GetVar(String("cursor"));
+		if (cursorVal.type != ValueType::Map) RuntimeException("Path.cursorTo: cursor must be a map").raise();
+		ValueDict cursor = cursorVal.GetDict();
+		PathLocation loc = path->Locate(context->GetVar(String("distance")).DoubleValue());
+		cursor.SetValue(String("curIndex"), Value(loc.index));
+		cursor.SetValue(String("distAtIndex"), Value(loc.distAtIndex));
+		cursor.SetValue(String("distToNext"), Value(loc.distToNext));
+		cursor.SetValue(String("t"), Value(loc.t));
+		cursor.SetValue(String("position"), Point2DToList(loc.position));
+		return IntrinsicResult::Null;
+	};
+	pathClass.SetValue(String("cursorTo"), f->GetFunc());
+
+	return pathClass;
+}
+
+Value Path2DToValue(Path2D* path) {
+	ValueList pointList;
+	for (const Point2D& p : path->points) pointList.Add(Point2DToList(p));
+
+	ValueDict map;
+	map.SetValue(Value::magicIsA, PathClass());
+	map.SetValue(kHandle, Value((long)path));
+	map.SetValue(String("length"), Value(path->Length()));
+	map.SetValue(String("points"), Value(pointList));
+	return Value(map);
+}
+
+Path2D* ValueToPath2D(Value value) {
+	return livePaths.FromValue(value);
+}
+
+Path2D* ValueToNewPath2D(const char* funcName, Value source) {
+	Path2D* other = ValueToPath2D(source);
+	if (other != nullptr) return new Path2D(other->points.data(), other->Count());
+
+	std::vector<Point2D> pts;
+	if (source.type == ValueType::List) {
+		ValueList list = source.GetList();
+		pts.resize(list.Count());
+		for (int i = 0; i < list.Count(); i++) {
+			if (!ValueToPoint2D(list[i], &pts[i])) {
+				RuntimeException(String(funcName) + ": points must be maps with x and y, or [x, y] lists").raise();
+			}
+		}
+	} else {
+		BinaryData* data = ValueToRawData(source);
+		if (data == nullptr) RuntimeException(String(funcName) + ": list of points or RawData required").raise();
+		int count = data->length / 8;
+		pts.resize(count);
+		for (int i = 0; i < count; i++) {
+			pts[i].x = data->GetFloat(i * 8);
+			pts[i].y = data->GetFloat(i * 8 + 4);
+		}
+	}
+	return new Path2D(pts.data(), (int)pts.size());
+}
@@ -0,0 +1,80 @@
+//
+//  Path2D.h
+//  MSRLWeb
+//
+//  Path2D: a native polyline for assets/lib/pathUtil.ms.  It stores the
+//  cumulative length at every point, so finding the spot a given distance
+//  along the path is a binary search, and it buckets its segments into a
+//  uniform grid (built on first use) so that nearest-point queries only
+//  look at segments near the query point.
+//
+
+#ifndef PATH2D_H
+#define PATH2D_H
+
+#include "Geometry.h"
+#include "MiniscriptTypes.h"
+#include <vector>
+
+// Where a point lies along a path
+struct PathLocation {
+	int index;          // segment (or, at the very end, last point) index
+	double t;           // fraction of the way along that segment
+	double distAtIndex; // path length up to the point at index
+	double distToNext;  // length of the segment (0 at the end)
+	Point2D position;
+
+	double Distance() const { return distAtIndex + distToNext * t; }
+};
+
+class Path2D {
+public:
+	Path2D(const Point2D* pts, int count);
+	~Path2D();
+
+	std::vector<Point2D> points;
+	std::vector<double> cumLength;  // path length from the start to each point
+
+	int Count() const { return (int)points.size(); }
+	double Length() const { return cumLength.empty() ? 0 : cumLength.back(); }
+
+	// The location a given distance along the path (clamped to the ends)
+	PathLocation Locate(double distance) const;
+
+	// Find the nearest point on the path to p, and its distance from p.
+	// Returns the index of the segment it's on (0 for a one-point path),
+	// or -1 if the path is empty.  Ties go to the earliest segment.
+	int Nearest(Point2D p, Point2D* outPoint, double* outDist);
+
+private:
+	void BuildGrid();
+
+	// Segment grid: cell (cx, cy) holds segment indices
+	// gridSegs[gridStart[c]] .. gridSegs[gridStart[c+1]-1], c = cy*gridCols+cx
+	bool gridBuilt;
+	double gridMinX, gridMinY, cellSize;
+	int gridCols, gridRows;
+	std::vector<int> gridStart;
+	std::vector<int> gridSegs;
+	std::vector<unsigned int> visitStamp;   // per segment, to skip repeats
+	unsigned int queryStamp;
+};
+
+// Nearest point to p on a polyline of count points (count > 0), by a
+// linear scan; ties go to the earliest segment, as in pathUtil.ms.
+// Returns the index of the segment, and the point and distance.
+int NearestOnPolyline(const Point2D* pts, int count, Point2D p, Point2D* outPoint, double* outDist);
+
+// Get the Path class (MiniScript intrinsic class)
+MiniScript::ValueDict PathClass();
+
+// Convert between MiniScript Value and Path2D.  ValueToPath2D returns
+// null for anything but a live (not yet unloaded) Path.
+MiniScript::Value Path2DToValue(Path2D* path);
+Path2D* ValueToPath2D(MiniScript::Value value);
+
+// Make a new path from a list of points (maps with x and y, or [x, y]
+// lists) or a RawData of float x,y pairs.  Raises on failure.
+Path2D* ValueToNewPath2D(const char* funcName, MiniScript::Value source);
+
+#endif // PATH2D_H
@@ -0,0 +1,610 @@
+//
+//  Polygon2D.cpp
+//  MSRLWeb
+//
+//  Polygon2D implementation
+//
+
+#include "Polygon2D.h"
+#include "LiveHandles.h"
+#include "RaylibTypes.h"
+#include "RawData.h"
+#include "MiniscriptInterpreter.h"
+#include "macros.h"
+#include <algorithm>
+#include <math.h>
+
+using namespace MiniScript;
+
+static LiveHandles<Polygon2D> livePolygons;
+
+static String kHandle("_handle");
+
+static const double kDegToRad = 3.14159265358979323846 / 180.0;
+
+static inline double Dot(Point2D a, Point2D b) { return a.x * b.x + a.y * b.y; }
+static inline Point2D Sub(Point2D a, Point2D b) { return Point2D{ a.x - b.x, a.y - b.y }; }
+static inline Point2D Neg(Point2D a) { return Point2D{ -a.x, -a.y }; }
+
+//--------------------------------------------------------------------------------
+// Polygon2D implementation
+//--------------------------------------------------------------------------------
+
+Polygon2D::Polygon2D(const Point2D* pts, int count)
+	: x(0), y(0), rotation(0), left(0), top(0), right(0), bottom(0), convex(false) {
+	livePolygons.Add(this);
+
+	// Drop repeated points (including a last point that closes the loop)
+	for (int i = 0; i < count; i++) {
+		if (!local.empty() && pts[i].x == local.back().x && pts[i].y == local.back().y) continue;
+		local.push_back(pts[i]);
+	}
+	while (local.size() > 1 && local.back().x == local.front().x && local.back().y == local.front().y) {
+		local.pop_back();
+	}
+	int n = (int)local.size();
+
+	// Wind counterclockwise (in y-up terms), so (e.y, -e.x) faces out
+	double area2 = 0;
+	for (int i = 0; i < n; i++) {
+		const Point2D& a = local[i];
+		const Point2D& b = local[(i + 1) % n];
+		area2 += a.x * b.y - b.x * a.y;
+	}
+	if (area2 < 0) std::reverse(local.begin(), local.end());
+
+	// Convex if it never turns right, and turns once around in all (a
+	// self-intersecting star turns left at every point, but goes around
+	// more than once)
+	localNormals.resize(n);
+	convex = (n >= 3);
+	double turning = 0;
+	for (int i = 0; i < n; i++) {
+		Point2D e = Sub(local[(i + 1) % n], local[i]);
+		double len = sqrt(Dot(e, e));
+		localNormals[i] = Point2D{ e.y / len, -e.x / len };
+		Point2D next = Sub(local[(i + 2) % n], local[(i + 1) % n]);
+		double cross = e.x * next.y - e.y * next.x;
+		if (cross < -1e-9 * len * sqrt(Dot(next, next))) convex = false;
+		turning += atan2(cross, Dot(e, next));
+	}
+	if (fabs(turning - 2 * 3.14159265358979323846) > 1e-6) convex = false;
+	UpdateWorld();
+}
+
+Polygon2D::~Polygon2D() {
+	livePolygons.Remove(this);
+}
+
+void Polygon2D::SetTransform(double newX, double newY, double newRotation) {
+	x = newX;
+	y = newY;
+	rotation = newRotation;
+	UpdateWorld();
+}
+
+void Polygon2D::UpdateWorld() {
+	int n = (int)local.size();
+	points.resize(n);
+	normals.resize(n);
+	double c = cos(rotation * kDegToRad), s = sin(rotation * kDegToRad);
+	for (int i = 0; i < n; i++) {
+		const Point2D& p = local[i];
+		const Point2D& q = localNormals[i];
+		points[i] = Point2D{ x + p.x * c - p.y * s, y + p.x * s + p.y * c };
+		normals[i] = Point2D{ q.x * c - q.y * s, q.x * s + q.y * c };
+	}
+	left = top = right = bottom = 0;
+	if (n == 0) return;
+	left = right = points[0].x;
+	top = bottom = points[0].y;
+	for (const Point2D& p : points) {
+		left = std::min(left, p.x);
+		right = std::max(right, p.x);
+		top = std::min(top, p.y);
+		bottom = std::max(bottom, p.y);
+	}
+}
+
+bool Polygon2D::Contains(Point2D p) const {
+	if (p.x < left || p.x > right || p.y < top || p.y > bottom) return false;
+	bool inside = false;
+	int n = Count();
+	for (int i = 0, j = n - 1; i < n; j = i++) {
+		const Point2D& a = points[i];
+		const Point2D& b = points[j];
+		if ((a.y > p.y) != (b.y > p.y) && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x) {
+			inside = !inside;
+		}
+	}
+	return inside;
+}
+
+// Largest separation of b from a along a's edge normals (positive: a gap),
+// and which edge of a gives it
+static double MaxSeparation(const Polygon2D& a, const Polygon2D& b, int* outEdge) {
+	double best = -INFINITY;
+	*outEdge = 0;
+	for (int i = 0; i < a.Count(); i++) {
+		const Point2D& n = a.normals[i];
+		double offset = Dot(n, a.points[i]);
+		double sep = INFINITY;
+		for (const Point2D& p : b.points) sep = std::min(sep, Dot(n, p) - offset);
+		if (sep > best) {
+			best = sep;
+			*outEdge = i;
+			if (best > 0) break;
+		}
+	}
+	return best;
+}
+
+bool Polygon2D::Overlaps(const Polygon2D& other) const {
+	if (!BoundsOverlap(other)) return false;
+	int edge;
+	return MaxSeparation(*this, other, &edge) <= 0 && MaxSeparation(other, *this, &edge) <= 0;
+}
+
+// Keep the part of segment in[0]-in[1] where dot(normal, p) <= offset;
+// returns how many points are left (fewer than 2 means it was cut away)
+static int ClipSegment(Point2D out[2], const Point2D in[2], Point2D normal, double offset) {
+	int count = 0;
+	double d0 = Dot(normal, in[0]) - offset, d1 = Dot(normal, in[1]) - offset;
+	if (d0 <= 0) out[count++] = in[0];
+	if (d1 <= 0) out[count++] = in[1];
+	if (d0 * d1 < 0) {
+		double t = d0 / (d0 - d1);
+		out[count++] = Point2D{ in[0].x + t * (in[1].x - in[0].x), in[0].y + t * (in[1].y - in[0].y) };
+	}
+	return count;
+}
+
+bool Polygon2D::Collide(const Polygon2D& other, Contact2D* out) const {
+	if (!BoundsOverlap(other)) return false;
+	int edgeA, edgeB;
+	double sepA = MaxSeparation(*this, other, &edgeA);
+	if (sepA > 0) return false;
+	double sepB = MaxSeparation(other, *this, &edgeB);
+	if (sepB > 0) return false;
+
+	// The reference face is the one with the least penetration (preferring
+	// ours on near-ties, so results don't flicker); the incident edge is the
+	// other polygon's edge facing it most directly
+	const Polygon2D* ref = this;
+	const Polygon2D* inc = &other;
+	int edge = edgeA;
+	bool flip = false;
+	if (sepB > sepA + 1e-9 * std::max(1.0, fabs(sepA))) {
+		ref = &other;
+		inc = this;
+		edge = edgeB;
+		flip = true;
+	}
+	Point2D n = ref->normals[edge];
+	int incEdge = 0;
+	double minDot = INFINITY;
+	for (int i = 0; i < inc->Count(); i++) {
+		double d = Dot(inc->normals[i], n);
+		if (d < minDot) { minDot = d; incEdge = i; }
+	}
+	Point2D incident[2] = { inc->points[incEdge], inc->points[(incEdge + 1) % inc->Count()] };
+
+	// Clip the incident edge to the sides of the reference face
+	Point2D v1 = ref->points[edge], v2 = ref->points[(edge + 1) % ref->Count()];
+	Point2D tangent = Point2D{ -n.y, n.x };
+	if (Dot(tangent, Sub(v2, v1)) < 0) tangent = Neg(tangent);
+	Point2D clip1[2], clip2[2];
+	int count = 0;
+	if (ClipSegment(clip1, incident, Neg(tangent), -Dot(tangent, v1)) == 2 &&
+		ClipSegment(clip2, clip1, tangent, Dot(tangent, v2)) == 2) {
+		double offset = Dot(n, v1);
+		for (int i = 0; i < 2; i++) {
+			if (Dot(n, clip2[i]) - offset <= 0) out->points[count++] = clip2[i];
+		}
+	}
+	if (count == 0) {
+		// Degenerate (e.g. a sliver): use the incident polygon's deepest vertex
+		const Point2D* deepest = &inc->points[0];
+		for (const Point2D& p : inc->points) if (Dot(n, p) < Dot(n, *deepest)) deepest = &p;
+		out->points[count++] = *deepest;
+	}
+	out->count = count;
+	out->normal = flip ? Neg(n) : n;
+	out->depth = -std::max(sepA, sepB);
+	return true;
+}
+
+bool Polygon2D::CollideCircle(Point2D center, double radius, Contact2D* out) const {
+	if (center.x + radius < left || center.x - radius > right ||
+		center.y + radius < top || center.y - radius > bottom) return false;
+
+	// Face the center is furthest outside of (or least inside)
+	int n = Count();
+	int edge = 0;
+	double sep = -INFINITY;
+	for (int i = 0; i < n; i++) {
+		double s = Dot(normals[i], Sub(center, points[i]));
+		if (s > radius) return false;
+		if (s > sep) { sep = s; edge = i; }
+	}
+	Point2D v1 = points[edge], v2 = points[(edge + 1) % n];
+	const Point2D& faceNormal = normals[edge];
+	out->count = 1;
+
+	// Beyond either end of that face, the nearest feature is a vertex
+	if (sep > 0) {
+		const Point2D* corner = nullptr;
+		if (Dot(Sub(center, v1), Sub(v2, v1)) <= 0) corner = &v1;
+		else if (Dot(Sub(center, v2), Sub(v1, v2)) <= 0) corner = &v2;
+		if (corner != nullptr) {
+			Point2D d = Sub(center, *corner);
+			double dist = sqrt(Dot(d, d));
+			if (dist > radius) return false;
+			out->normal = dist > 0 ? Point2D{ d.x / dist, d.y / dist } : faceNormal;
+			out->depth = radius - dist;
+			out->points[0] = *corner;
+			return true;
+		}
+	}
+	out->normal = faceNormal;
+	out->depth = radius - sep;
+	out->points[0] = Point2D{ center.x - faceNormal.x * sep, center.y - faceNormal.y * sep };
+	return true;
+}
+
+// Project a polygon onto an axis
+static void Project(const Polygon2D& poly, Point2D axis, double* lo, double* hi) {
+	*lo = INFINITY;
+	*hi = -INFINITY;
+	for (const Point2D& p : poly.points) {
+		double d = Dot(axis, p);
+		*lo = std::min(*lo, d);
+		*hi = std::max(*hi, d);
+	}
+}
+
+bool Polygon2D::Sweep(const Polygon2D& other, Point2D velocity, double* time, Point2D* normal) const {
+	// Along each separating axis candidate, the other polygon's interval
+	// overlaps ours for a span of time; they touch when all spans overlap
+	double first = -INFINITY, last = INFINITY;
+	Point2D firstNormal = { 0, 0 };
+	for (int pass = 0; pass < 2; pass++) {
+		const std::vector<Point2D>& axes = (pass == 0) ? normals : other.normals;
+		for (const Point2D& axis : axes) {
+			double a0, a1, b0, b1;
+			Project(*this, axis, &a0, &a1);
+			Project(other, axis, &b0, &b1);
+			double speed = Dot(axis, velocity);
+			if (fabs(speed) < 1e-12) {
+				if (b1 < a0 || b0 > a1) return false;
+				continue;
+			}
+			double enter, exit;
+			Point2D side;
+			if (speed > 0) {
+				enter = (a0 - b1) / speed;
+				exit = (a1 - b0) / speed;
+				side = Neg(axis);
+			} else {
+				enter = (a1 - b0) / speed;
+				exit = (a0 - b1) / speed;
+				side = axis;
+			}
+			if (enter > first) { first = enter; firstNormal = side; }
+			last = std::min(last, exit);
+			if (first > last || first > 1 || last < 0) return false;
+		}
+	}
+	if (first < 0) {
+		// Already overlapping
+		Contact2D contact;
+		if (!Collide(other, &contact)) return false;
+		*time = 0;
+		*normal = contact.normal;
+		return true;
+	}
+	*time = first;
+	*normal = firstNormal;
+	return true;
+}
+
+bool Polygon2D::SweepCircle(Point2D center, double radius, Point2D velocity, double* time, Point2D* normal) const {
+	Contact2D contact;
+	if (CollideCircle(center, radius, &contact)) {
+		*time = 0;
+		*normal = contact.normal;
+		return true;
+	}
+
+	// Cast the center against this polygon grown by the radius: its edges
+	// pushed out along their normals, and a circle around each vertex
+	int n = Count();
+	double best = INFINITY;
+	Point2D bestNormal = { 0, 0 };
+	double vv = Dot(velocity, velocity);
+	if (vv == 0) return false;
+	for (int i = 0; i < n; i++) {
+		const Point2D& nrm = normals[i];
+		const Point2D& v1 = points[i];
+		const Point2D& v2 = points[(i + 1) % n];
+		double approach = Dot(nrm, velocity);
+		if (approach < 0) {
+			double t = (radius - Dot(nrm, Sub(center, v1))) / approach;
+			if (t >= 0 && t <= 1 && t < best) {
+				Point2D q = { center.x + velocity.x * t - nrm.x * radius, center.y + velocity.y * t - nrm.y * radius };
+				Point2D e = Sub(v2, v1);
+				double u = Dot(Sub(q, v1), e) / Dot(e, e);
+				if (u >= 0 && u <= 1) { best = t; bestNormal = nrm; }
+			}
+		}
+		Point2D m = Sub(center, v1);
+		double b = Dot(m, velocity), c = Dot(m, m) - radius * radius;
+		double disc = b * b - vv * c;
+		if (b < 0 && disc >= 0) {
+			double t = (-b - sqrt(disc)) / vv;
+			if (t >= 0 && t <= 1 && t < best) {
+				best = t;
+				Point2D d = { m.x + velocity.x * t, m.y + velocity.y * t };
+				double len = sqrt(Dot(d, d));
+				bestNormal = len > 0 ? Point2D{ d.x / len, d.y / len } : nrm;
+			}
+		}
+	}
+	if (best > 1) return false;
+	*time = best;
+	*normal = bestNormal;
+	return true;
+}
+
+//--------------------------------------------------------------------------------
+// Polygon class
+//--------------------------------------------------------------------------------
+
+// Helper: get the Polygon from self
+static Polygon2D* GetPolygon(Context* context) {
+	return livePolygons.FromSelf(context, "Polygon");
+}
+
+// Helper: get the other polygon, checking both are convex
+static Polygon2D* GetOtherConvex(Context* context, const char* funcName, Polygon2D* poly) {
+	Polygon2D* other = ValueToPolygon2D(context->GetVar(String("other")));
+	if (other == nullptr) RuntimeException(String(funcName) + ": Polygon required for other parameter").raise();
+	if (!poly->convex || !other->convex) RuntimeException(String(funcName) + ": polygons must be convex").raise();
+	return other;
+}
+
+// Helper: check self is convex, for the circle tests
+static void RequireConvex(const char* funcName, Polygon2D* poly) {
+	if (!poly->convex) RuntimeException(String(funcName) + ": polygon must be convex").raise();
+}
+
+// Helper: get a point parameter
+static Point2D GetPointParam(Context* context, const char* funcName, const char* name) {
+	Point2D p;
+	if (!ValueToPoint2D(context->GetVar(String(name)), &p)) {
+		RuntimeException(String(funcName) + ": " + name + " must be a map with x and y, or an [x, y] list").raise();
+	}
+	return p;
+}
+
+// Helper: a contact as a map with normal, depth and contacts
+static Value ContactToValue(const Contact2D& contact) {
+	ValueList points;
+	for (int i = 0; i < contact.count; i++) points.Add(Point2DToList(contact.points[i]));
+	ValueDict map;
+	map.SetValue(String("normal"), Point2DToList(contact.normal));
+	map.SetValue(String("depth"), Value(contact.depth));
+	map.SetValue(String("contacts"), Value(points));
+	return Value(map);
+}
+
+// Helper: a sweep result as a map with time and normal
+static Value SweepToValue(double time, Point2D normal) {
+	ValueDict map;
+	map.SetValue(String("time"), Value(time));
+	map.SetValue(String("normal"), Point2DToList(normal));
+	return Value(map);
+}
+
+// Helper: update the map fields that mirror the transform
+static void SyncFields(ValueDict map, Polygon2D* poly) {
+	map.SetValue(String("x"), Value(poly->x));
+	map.SetValue(String("y"), Value(poly->y));
+	map.SetValue(String("rotation"), Value(poly->rotation));
+	map.SetValue(String("bounds"), RectangleToValue(Rectangle{ (float)poly->left, (float)poly->top,
+		(float)(poly->right - poly->left), (float)(poly->bottom - poly->top) }));
+}
+
+ValueDict PolygonClass() {
+	static ValueDict polyClass;
+
+	if (polyClass.Count() > 0) return polyClass;
+
+	polyClass.SetValue(kHandle, Value::zero);
+	polyClass.SetValue(String("count"), Value::zero);
+	polyClass.SetValue(String("convex"), Value::zero);
+	polyClass.SetValue(String("x"), Value::zero);
+	polyClass.SetValue(String("y"), Value::zero);
+	polyClass.SetValue(String("rotation"), Value::zero);
+	polyClass.SetValue(String("bounds"), Value::null);
+
+	Intrinsic* f;
+
+	// Polygon.setTransform
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("x", Value::zero);
+	f->AddParam("y", Value::zero);
+	f->AddParam("rotation", Value::zero);
+	f->code = INTRINSIC_LAMBDA {
+		Value self = context->GetVar(String("self"));
+		Polygon2D* poly = GetPolygon(context);
+		poly->SetTransform(context->GetVar(String("x")).DoubleValue(),
+			context->GetVar(String("y")).DoubleValue(),
+			context->GetVar(String("rotation")).DoubleValue());
+		SyncFields(self.GetDict(), poly);
+		return IntrinsicResult::Null;
+	};
+	polyClass.SetValue(String("setTransform"), f->GetFunc());
+
+	// Polygon.points
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		Polygon2D* poly = GetPolygon(context);
+		ValueList result;
+		for (const Point2D& p : poly->points) result.Add(Point2DToList(p));
+		return IntrinsicResult(Value(result));
+	};
+	polyClass.SetValue(String("points"), f->GetFunc());
+
+	// Polygon.contains
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("point");
+	f->code = INTRINSIC_LAMBDA {
+		Polygon2D* poly = GetPolygon(context);
+		Point2D p = GetPointParam(context, "Polygon.contains", "point");
+		return IntrinsicResult(poly->Contains(p) ? Value::one : Value::zero);
+	};
+	polyClass.SetValue(String("contains"), f->GetFunc());
+
+	// Polygon.overlaps
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("other");
+	f->code = INTRINSIC_LAMBDA {
+		Polygon2D* poly = GetPolygon(context);
+		Polygon2D* other = GetOtherConvex(context, "Polygon.overlaps", poly);
+		return IntrinsicResult(poly->Overlaps(*other) ? Value::one : Value::zero);
+	};
+	polyClass.SetValue(String("overlaps"), f->GetFunc());
+
+	// Polygon.overlapsCircle
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("center");
+	f->AddParam("radius", Value::one);
+	f->code = INTRINSIC_LAMBDA {
+		Polygon2D* poly = GetPolygon(context);
+		RequireConvex("Polygon.overlapsCircle", poly);
+		Point2D center = GetPointParam(context, "Polygon.overlapsCircle", "center");
+		Contact2D contact;
+		bool hit = poly->CollideCircle(center, context->GetVar(String("radius")).DoubleValue(), &contact);
+		return IntrinsicResult(hit ? Value::one : Value::zero);
+	};
+	polyClass.SetValue(String("overlapsCircle"), f->GetFunc());
+
+	// Polygon.collide
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("other");
+	f->code = INTRINSIC_LAMBDA {
+		Polygon2D* poly = GetPolygon(context);
+		Polygon2D* other = GetOtherConvex(context, "Polygon.collide", poly);
+		Contact2D contact;
+		if (!poly->Collide(*other, &contact)) return IntrinsicResult::Null;
+		return IntrinsicResult(ContactToValue(contact));
+	};
+	polyClass.SetValue(String("collide"), f->GetFunc());
+
+	// Polygon.collideCircle
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("center");
+	f->AddParam("radius", Value::one);
+	f->code = INTRINSIC_LAMBDA {
+		Polygon2D* poly = GetPolygon(context);
+		RequireConvex("Polygon.collideCircle", poly);
+		Point2D center = GetPointParam(context, "Polygon.collideCircle", "center");
+		Contact2D contact;
+		if (!poly->CollideCircle(center, context->GetVar(String("radius")).DoubleValue(), &contact)) {
+			return IntrinsicResult::Null;
+		}
+		return IntrinsicResult(ContactToValue(contact));
+	};
+	polyClass.SetValue(String("collideCircle"), f->GetFunc());
+
+	// Polygon.sweep
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("other");
+	f->AddParam("velocity");
+	f->code = INTRINSIC_LAMBDA {
+		Polygon2D* poly = GetPolygon(context);
+		Polygon2D* other = GetOtherConvex(context, "Polygon.sweep", poly);
+		Point2D velocity = GetPointParam(context, "Polygon.sweep", "velocity");
+		double time;
+		Point2D normal;
+		if (!poly->Sweep(*other, velocity, &time, &normal)) return IntrinsicResult::Null;
+		return IntrinsicResult(SweepToValue(time, normal));
+	};
+	polyClass.SetValue(String("sweep"), f->GetFunc());
+
+	// Polygon.sweepCircle
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("center");
+	f->AddParam("radius", Value::one);
+	f->AddParam("velocity");
+	f->code = INTRINSIC_LAMBDA {
+		Polygon2D* poly = GetPolygon(context);
+		RequireConvex("Polygon.sweepCircle", poly);
+		Point2D center = GetPointParam(context, "Polygon.sweepCircle", "center");
+		Point2D velocity = GetPointParam(context, "Polygon.sweepCircle", "velocity");
+		double time;
+		Point2D normal;
+		if (!poly->SweepCircle(center, context->GetVar(String("radius")).DoubleValue(), velocity, &time, &normal)) {
+			return IntrinsicResult::Null;
+		}
+		return IntrinsicResult(SweepToValue(time, normal));
+	};
+	polyClass.SetValue(String("sweepCircle"), f->GetFunc());
+
+	return polyClass;
+}
+
+Value Polygon2DToValue(Polygon2D* poly) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, PolygonClass());
+	map.SetValue(kHandle, Value((long)poly));
+	map.SetValue(String("count"), Value(poly->Count()));
+	map.SetValue(String("convex"), poly->convex ? Value::one : Value::zero);
+	SyncFields(map, poly);
+	return Value(map);
+}
+
+Polygon2D* ValueToPolygon2D(Value value) {
+	return livePolygons.FromValue(value);
+}
+
+Polygon2D* ValueToNewPolygon2D(const char* funcName, Value source) {
+	std::vector<Point2D> pts;
+	Polygon2D* other = ValueToPolygon2D(source);
+	if (other != nullptr) {
+		pts = other->local;
+	} else if (source.type == ValueType::List) {
+		ValueList list = source.GetList();
+		pts.resize(list.Count());
+		for (int i = 0; i < list.Count(); i++) {
+			if (!ValueToPoint2D(list[i], &pts[i])) {
+				RuntimeException(String(funcName) + ": points must be maps with x and y, or [x, y] lists").raise();
+			}
+		}
+	} else {
+		BinaryData* data = ValueToRawData(source);
+		if (data == nullptr) RuntimeException(String(funcName) + ": list of points or RawData required").raise();
+		int count = data->length / 8;
+		pts.resize(count);
+		for (int i = 0; i < count; i++) {
+			pts[i].x = data->GetFloat(i * 8);
+			pts[i].y = data->GetFloat(i * 8 + 4);
+		}
+	}
+	Polygon2D* poly = new Polygon2D(pts.data(), (int)pts.size());
+	if (poly->Count() < 3) {
+		delete poly;
+		RuntimeException(String(funcName) + ": a polygon needs at least 3 distinct points").raise();
+	}
+	return poly;
+}
@@ -0,0 +1,88 @@
+//
+//  Polygon2D.h
+//  MSRLWeb
+//
+//  Polygon2D: a polygon whose vertices, outward edge normals and bounding
+//  box are worked out once, and again only when it is moved or rotated.
+//  Convex polygons can be tested against each other and against circles
+//  with the separating axis theorem, giving a contact manifold (normal,
+//  depth and up to two contact points), or swept to find when a moving
+//  shape first touches.  Point containment works for any simple polygon.
+//
+
+#ifndef POLYGON2D_H
+#define POLYGON2D_H
+
+#include "Geometry.h"
+#include "MiniscriptTypes.h"
+#include <vector>
+
+// Where two shapes touch.  The normal is a unit vector pointing from the
+// first shape toward the second; moving the second by normal * depth
+// separates them.  Contact points are where an edge of one shape reaches
+// into the other.
+struct Contact2D {
+	Point2D normal;
+	double depth;
+	int count;
+	Point2D points[2];
+};
+
+class Polygon2D {
+public:
+	Polygon2D(const Point2D* pts, int count);
+	~Polygon2D();
+
+	// Vertices as given (minus repeats), wound so normals face outward
+	std::vector<Point2D> local;
+	std::vector<Point2D> localNormals;
+
+	// The same after rotating by rotation degrees about the local origin
+	// and moving by x, y.  Normal i belongs to the edge from point i to i+1.
+	std::vector<Point2D> points;
+	std::vector<Point2D> normals;
+	double x, y, rotation;
+
+	// World bounding box
+	double left, top, right, bottom;
+
+	bool convex;
+
+	int Count() const { return (int)points.size(); }
+
+	void SetTransform(double x, double y, double rotation);
+
+	bool Contains(Point2D p) const;
+
+	// These need convex polygons
+	bool Overlaps(const Polygon2D& other) const;
+	bool Collide(const Polygon2D& other, Contact2D* out) const;
+	bool CollideCircle(Point2D center, double radius, Contact2D* out) const;
+
+	// Whether the other shape, moving by velocity (relative to this one),
+	// touches this one during the move; if so, when (0 to 1; 0 if they
+	// already overlap) and the contact normal (from this toward the other)
+	bool Sweep(const Polygon2D& other, Point2D velocity, double* time, Point2D* normal) const;
+	bool SweepCircle(Point2D center, double radius, Point2D velocity, double* time, Point2D* normal) const;
+
+private:
+	void UpdateWorld();
+	bool BoundsOverlap(const Polygon2D& other) const {
+		return left <= other.right && other.left <= right && top <= other.bottom && other.top <= bottom;
+	}
+};
+
+// Get the Polygon class (MiniScript intrinsic class)
+MiniScript::ValueDict PolygonClass();
+
+// Convert between MiniScript Value and Polygon2D.
+// ValueToPolygon2D returns null for anything but a live Polygon.
+MiniScript::Value Polygon2DToValue(Polygon2D* poly);
+Polygon2D* ValueToPolygon2D(MiniScript::Value value);
+
+// Make a new polygon from a list of points (maps with x and y, or [x, y]
+// lists), a RawData of float x,y pairs, or another Polygon.  Raises on
+// failure.
+Polygon2D* ValueToNewPolygon2D(const char* funcName, MiniScript::Value source);
+
+#endif // POLYGON2D_H
@@ -0,0 +1,84 @@
+//
+//  ProgressiveMusic.cpp
+//  MSRLWeb
+//
+//  Progressive music playback via HTML media elements
+//
+
+#include "ProgressiveMusic.h"
+#include <emscripten.h>
+
+EM_JS(int, _PMusicLoad, (const char *url, int looping), {
+	if (!Module._pmusic) Module._pmusic = { next: 1, streams: {} };
+	const audio = new Audio();
+	audio.preload = "auto";
+	audio.loop = !!looping;
+	audio.preservesPitch = false;
+	audio.src = UTF8ToString(url);
+	const id = Module._pmusic.next++;
+	Module._pmusic.streams[id] = audio;
+	return id;
+});
+
+EM_JS(void, _PMusicUnload, (int id), {
+	const audio = Module._pmusic && Module._pmusic.streams[id];
+	if (!audio) return;
+	audio.pause();
+	audio.removeAttribute("src");
+	audio.load();  // aborts any download in progress
+	delete Module._pmusic.streams[id];
+});
+
+EM_JS(void, _PMusicCommand, (int id, int command, float arg), {
+	const audio = Module._pmusic && Module._pmusic.streams[id];
+	if (!audio) return;
+	switch (command) {
+		case 0: audio.currentTime = 0; audio.play().catch(()=>{}); break;  // play
+		case 1: audio.pause(); audio.currentTime = 0; break;                // stop
+		case 2: audio.pause(); break;                                       // pause
+		case 3: audio.play().catch(()=>{}); break;                          // resume
+		case 4: audio.currentTime = arg; break;                             // seek
+		case 5: audio.volume = Math.min(Math.max(arg, 0), 1); break;        // volume
+		case 6: if (arg > 0) audio.playbackRate = arg; break;               // pitch
+	}
+});
+
+EM_JS(float, _PMusicQuery, (int id, int query), {
+	const audio = Module._pmusic && Module._pmusic.streams[id];
+	if (!audio) return 0;
+	switch (query) {
+		case 0: return (!audio.paused && !audio.ended) ? 1 : 0;            // playing
+		case 1: return isFinite(audio.duration) ? audio.duration : 0;      // length
+		case 2: return audio.currentTime;                                   // time played
+		case 3: {                                                           // buffered ahead
+			const t = audio.currentTime;
+			for (let i = 0; i < audio.buffered.length; i++) {
+				if (audio.buffered.start(i) <= t && t <= audio.buffered.end(i)) {
+					return audio.buffered.end(i) - t;
+				}
+			}
+			return 0;
+		}
+		case 4: return audio.readyState >= 3 ? 1 : 0;                      // ready (HAVE_FUTURE_DATA)
+		case 5: return audio.error ? 1 : 0;                                 // error
+	}
+	return 0;
+});
+
+int ProgressiveMusicLoad(const char* url, bool looping) { return _PMusicLoad(url, looping ? 1 : 0); }
+void ProgressiveMusicUnload(int id) { _PMusicUnload(id); }
+
+void ProgressiveMusicPlay(int id) { _PMusicCommand(id, 0, 0); }
+void ProgressiveMusicStop(int id) { _PMusicCommand(id, 1, 0); }
+void ProgressiveMusicPause(int id) { _PMusicCommand(id, 2, 0); }
+void ProgressiveMusicResume(int id) { _PMusicCommand(id, 3, 0); }
+void ProgressiveMusicSeek(int id, float position) { _PMusicCommand(id, 4, position); }
+void ProgressiveMusicSetVolume(int id, float volume) { _PMusicCommand(id, 5, volume); }
+void ProgressiveMusicSetPitch(int id, float pitch) { _PMusicCommand(id, 6, pitch); }
+
+bool ProgressiveMusicIsPlaying(int id) { return _PMusicQuery(id, 0) != 0; }
+float ProgressiveMusicLength(int id) { return _PMusicQuery(id, 1); }
+float ProgressiveMusicTimePlayed(int id) { return _PMusicQuery(id, 2); }
+float ProgressiveMusicBufferedAhead(int id) { return _PMusicQuery(id, 3); }
+bool ProgressiveMusicIsReady(int id) { return _PMusicQuery(id, 4) != 0; }
+bool ProgressiveMusicHasError(int id) { return _PMusicQuery(id, 5) != 0; }
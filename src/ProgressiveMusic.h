@@ -0,0 +1,38 @@
+//
+//  ProgressiveMusic.h
+//  MSRLWeb
+//
+//  Progressive (streamed-while-downloading) music playback.  The browser's
+//  media element fetches the file with HTTP range requests, starts decoding
+//  as soon as the first bytes arrive, and keeps only a bounded window of data
+//  buffered -- none of it in wasm memory.  Each stream is identified by an
+//  integer id (> 0) on the JavaScript side.
+//
+
+#ifndef PROGRESSIVEMUSIC_H
+#define PROGRESSIVEMUSIC_H
+
+// Start loading the given URL; returns the new stream id
+int ProgressiveMusicLoad(const char* url, bool looping);
+
+// Stop and release the stream
+void ProgressiveMusicUnload(int id);
+
+// Playback control (Play restarts from the beginning, like PlayMusicStream)
+void ProgressiveMusicPlay(int id);
+void ProgressiveMusicStop(int id);
+void ProgressiveMusicPause(int id);
+void ProgressiveMusicResume(int id);
+void ProgressiveMusicSeek(int id, float position);
+void ProgressiveMusicSetVolume(int id, float volume);
+void ProgressiveMusicSetPitch(int id, float pitch);
+
+// Status
+bool ProgressiveMusicIsPlaying(int id);
+float ProgressiveMusicLength(int id);        // 0 until the header has been read
+float ProgressiveMusicTimePlayed(int id);
+float ProgressiveMusicBufferedAhead(int id); // seconds downloaded past the play position
+bool ProgressiveMusicIsReady(int id);        // enough data to start playing
+bool ProgressiveMusicHasError(int id);
+
+#endif // PROGRESSIVEMUSIC_H
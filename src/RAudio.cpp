@@ -7,14 +7,153 @@
 
 #include "RaylibIntrinsics.h"
 #include "RaylibTypes.h"
+#include "FrameArena.h"
+#include "AudioStreamQueue.h"
+#include "Synth.h"
+#include "WaveGen.h"
+#include "SoundPool.h"
+#include "AudioHost.h"
+#include "ProgressiveMusic.h"
+#include "AudioEffects.h"
 #include "RawData.h"
 #include "raylib.h"
 #include "MiniscriptInterpreter.h"
 #include "MiniscriptTypes.h"
 #include "macros.h"
+#include <map>
 
 using namespace MiniScript;
 
+// Get sample data for an AudioStream from either a list of numbers or RawData,
+// in the stream's own sample format.  RawData is used in place (no copy); list
+// values are converted into a frame-arena buffer.  frameCount < 0 means "all".
+// Returns the sample pointer and stores the usable frame count in outFrames.
+static const void* GetStreamSamples(const char* funcName, AudioStream stream, Value dataVal, int frameCount, unsigned int* outFrames) {
+	unsigned int bytesPerSample = stream.sampleSize / 8;
+	unsigned int channels = stream.channels > 0 ? stream.channels : 1;
+	unsigned int available = 0;
+	const void* samples = nullptr;
+
+	if (dataVal.type == ValueType::List) {
+		ValueList data = dataVal.GetList();
+		available = data.Count() / channels;
+		int sampleCount = available * channels;
+		if (sampleCount > 0) {
+			if (stream.sampleSize == 8) {
+				unsigned char* buffer = FrameArena::AllocArray<unsigned char>(sampleCount);
+				for (int i = 0; i < sampleCount; i++) buffer[i] = (unsigned char)data[i].IntValue();
+				samples = buffer;
+			} else if (stream.sampleSize == 16) {
+				short* buffer = FrameArena::AllocArray<short>(sampleCount);
+				for (int i = 0; i < sampleCount; i++) buffer[i] = (short)data[i].IntValue();
+				samples = buffer;
+			} else {
+				float* buffer = FrameArena::AllocArray<float>(sampleCount);
+				for (int i = 0; i < sampleCount; i++) buffer[i] = data[i].FloatValue();
+				samples = buffer;
+			}
+		}
+	} else {
+		BinaryData* rawData = ValueToRawData(dataVal);
+		if (rawData == nullptr) {
+			RuntimeException(String(funcName) + ": data must be a list or RawData").raise();
+		}
+		available = rawData->length / (bytesPerSample * channels);
+		samples = rawData->bytes;
+	}
+
+	if (frameCount >= 0 && (unsigned int)frameCount < available) available = frameCount;
+	*outFrames = available;
+	return samples;
+}
+
+// Progressive music maps carry their JavaScript-side stream id in _progressive
+// (see ProgressiveMusic.h); returns 0 for regular raylib Music.
+static int ProgressiveMusicId(Value value) {
+	if (value.type != ValueType::Map) return 0;
+	return value.GetDict().Lookup(String("_progressive"), Value::zero).IntValue();
+}
+
+// Whether a map's __isa is exactly the given class (by reference)
+static bool IsInstanceOf(ValueDict map, ValueDict classMap) {
+	Value isa = map.Lookup(Value::magicIsA, Value::null);
+	return isa.type == ValueType::Map && isa.data.ref == Value(classMap).data.ref;
+}
+
+// Get the AudioStream behind a Sound, Music, or AudioStream handle.  All three
+// heap structs begin with their AudioStream, so the handle can be read as one;
+// any other handle (an Image, say) must not be, so the class is checked first.
+static AudioStream EffectTargetStream(const char* funcName, Value target) {
+	if (ProgressiveMusicId(target)) {
+		RuntimeException(String(funcName) + ": progressive music does not support effects").raise();
+	}
+	AudioStream* streamPtr = nullptr;
+	if (target.type == ValueType::Map) {
+		ValueDict map = target.GetDict();
+		if (IsInstanceOf(map, SoundClass()) || IsInstanceOf(map, MusicClass()) || IsInstanceOf(map, AudioStreamClass())) {
+			streamPtr = (AudioStream*)(long)map.Lookup(String("_handle"), Value::zero).IntValue();
+		}
+	}
+	if (streamPtr == nullptr || !IsAudioStreamValid(*streamPtr)) {
+		RuntimeException(String(funcName) + ": Sound, Music, or AudioStream required").raise();
+	}
+	return *streamPtr;
+}
+
+// Shared by the GenWave* generators: check the output format
+static void CheckGenFormat(const char* funcName, int sampleRate, int sampleSize) {
+	if (sampleSize != 8 && sampleSize != 16 && sampleSize != 32) {
+		RuntimeException(String(funcName) + ": sampleSize must be 8, 16, or 32").raise();
+	}
+	if (sampleRate <= 0) RuntimeException(String(funcName) + ": sampleRate must be > 0").raise();
+}
+
+// Longest wave the GenWave* generators will render, in frames (about three
+// minutes at 44.1 kHz; the float samples alone take 32 MB)
+static const double kMaxGenFrames = 8 * 1024 * 1024;
+
+// Shared by the GenWave* generators: the number of frames for a duration
+static int GenFrameCount(const char* funcName, double duration, int sampleRate) {
+	if (!(duration > 0)) RuntimeException(String(funcName) + ": duration must be > 0").raise();
+	double frames = duration * sampleRate;
+	if (frames > kMaxGenFrames) RuntimeException(String(funcName) + ": duration too long").raise();
+	return (int)frames;
+}
+
+// Shared by the GenWave* generators: return mono float samples as a new Wave,
+// or (if dest is a RawData) write as many as fit into it and return that count
+static Value GenOutput(const char* funcName, const float* samples, int frameCount,
+		int sampleRate, int sampleSize, Value dest) {
+	if (dest.IsNull()) {
+		return WaveToValue(WaveFromFloatSamples(samples, frameCount, sampleRate, sampleSize, 1));
+	}
+	BinaryData* rawData = ValueToRawData(dest);
+	if (rawData == nullptr) RuntimeException(String(funcName) + ": dest must be a RawData").raise();
+	int capacity = rawData->length / (sampleSize / 8);
+	if (frameCount > capacity) frameCount = capacity;
+	if (frameCount > 0) ConvertSamplesFromFloat(samples, rawData->bytes, frameCount, sampleSize);
+	return Value(frameCount);
+}
+
+// Read a list of Waves (for WaveMix and WaveConcat)
+static std::vector<Wave> ValueToWaveList(const char* funcName, Value value) {
+	std::vector<Wave> waves;
+	if (value.type == ValueType::List) {
+		ValueList list = value.GetList();
+		for (int i = 0; i < list.Count(); i++) {
+			Wave wave = ValueToWave(list[i]);
+			if (wave.data == nullptr) RuntimeException(String(funcName) + ": invalid Wave in list").raise();
+			waves.push_back(wave);
+		}
+	}
+	if (waves.empty()) RuntimeException(String(funcName) + ": list of Waves required").raise();
+	return waves;
+}
+
+// Compressed file data for music loaded with LoadMusicStreamFromMemory, which
+// raylib decodes in place and so must outlive the Music (keyed by ctxData)
+static std::map<void*, void*> musicMemory;
+
 void AddRAudioMethods(ValueDict raylibModule) {
 	Intrinsic *i;
 
@@ -71,12 +210,19 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("fileType");
 	i->AddParam("fileData");
-	i->AddParam("dataSize");
+	i->AddParam("dataSize", Value(-1));
 	i->code = INTRINSIC_LAMBDA {
 		String fileType = context->GetVar(String("fileType")).ToString();
-		// Note: This would need a byte array type in MiniScript to be fully useful
-		// For now, we'll skip implementing this
-		return IntrinsicResult::Null;
+		BinaryData* data = ValueToRawData(context->GetVar(String("fileData")));
+		if (data == nullptr || data->bytes == nullptr) {
+			RuntimeException("LoadWaveFromMemory: RawData required for fileData parameter").raise();
+		}
+		int dataSize = context->GetVar(String("dataSize")).IntValue();
+		if (dataSize < 0 || dataSize > data->length) dataSize = data->length;
+		// Waves are fully decoded, so no need to keep the file data around
+		Wave wave = LoadWaveFromMemory(fileType.c_str(), data->bytes, dataSize);
+		if (!IsWaveValid(wave)) return IntrinsicResult::Null;
+		return IntrinsicResult(WaveToValue(wave));
 	};
 	raylibModule.SetValue("LoadWaveFromMemory", i->GetFunc());
 
@@ -280,18 +426,65 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("fileType");
 	i->AddParam("data");
-	i->AddParam("dataSize");
+	i->AddParam("dataSize", Value(-1));
 	i->code = INTRINSIC_LAMBDA {
 		String fileType = context->GetVar(String("fileType")).ToString();
-		// Note: This would need a byte array type in MiniScript to be fully useful
-		// For now, we'll skip implementing this
-		return IntrinsicResult::Null;
+		BinaryData* data = ValueToRawData(context->GetVar(String("data")));
+		if (data == nullptr || data->bytes == nullptr) {
+			RuntimeException("LoadMusicStreamFromMemory: RawData required for data parameter").raise();
+		}
+		int dataSize = context->GetVar(String("dataSize")).IntValue();
+		if (dataSize < 0 || dataSize > data->length) dataSize = data->length;
+
+		// raylib streams from this buffer for the life of the Music, so keep
+		// our own copy rather than depending on the script's RawData
+		unsigned char* copy = (unsigned char*)MemAlloc(dataSize);
+		memcpy(copy, data->bytes, dataSize);
+		Music music = LoadMusicStreamFromMemory(fileType.c_str(), copy, dataSize);
+		if (!IsMusicValid(music)) {
+			MemFree(copy);
+			return IntrinsicResult::Null;
+		}
+		musicMemory[music.ctxData] = copy;
+		return IntrinsicResult(MusicToValue(music));
 	};
 	raylibModule.SetValue("LoadMusicStreamFromMemory", i->GetFunc());
 
+	i = Intrinsic::Create("");
+	i->AddParam("fileName");
+	i->AddParam("looping", Value::one);
+	i->code = INTRINSIC_LAMBDA {
+		String path = context->GetVar(String("fileName")).ToString();
+		bool looping = context->GetVar(String("looping")).BoolValue();
+		ValueDict map;
+		map.SetValue(Value::magicIsA, MusicClass());
+		map.SetValue(String("_handle"), Value::zero);
+		map.SetValue(String("_progressive"), Value(ProgressiveMusicLoad(path.c_str(), looping)));
+		map.SetValue(String("frameCount"), Value::zero);
+		map.SetValue(String("looping"), Value(looping));
+		return IntrinsicResult(map);
+	};
+	raylibModule.SetValue("LoadMusicStreamProgressive", i->GetFunc());
+
 	i = Intrinsic::Create("");
 	i->AddParam("music");
 	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (!pid) return IntrinsicResult::Null;
+		ValueDict result;
+		result.SetValue(String("ready"), Value(ProgressiveMusicIsReady(pid)));
+		result.SetValue(String("error"), Value(ProgressiveMusicHasError(pid)));
+		result.SetValue(String("bufferedAhead"), Value(ProgressiveMusicBufferedAhead(pid)));
+		result.SetValue(String("length"), Value(ProgressiveMusicLength(pid)));
+		return IntrinsicResult(result);
+	};
+	raylibModule.SetValue("GetMusicStreamProgress", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("music");
+	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) return IntrinsicResult(!ProgressiveMusicHasError(pid));
 		Music music = ValueToMusic(context->GetVar(String("music")));
 		return IntrinsicResult(IsMusicValid(music));
 	};
@@ -300,13 +493,27 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("music");
 	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) {
+			ProgressiveMusicUnload(pid);
+			context->GetVar(String("music")).GetDict().SetValue(String("_progressive"), Value::zero);
+			return IntrinsicResult::Null;
+		}
 		Music music = ValueToMusic(context->GetVar(String("music")));
+		DetachAllStreamEffects(music.stream);
 		UnloadMusicStream(music);
+		// Free the compressed data, if it was loaded from memory
+		auto memIt = musicMemory.find(music.ctxData);
+		if (music.ctxData != nullptr && memIt != musicMemory.end()) {
+			MemFree(memIt->second);
+			musicMemory.erase(memIt);
+		}
 		// Also delete the heap-allocated Music
 		ValueDict map = context->GetVar(String("music")).GetDict();
 		Value handleVal = map.Lookup(String("_handle"), Value::zero);
 		Music* musicPtr = (Music*)(long)handleVal.IntValue();
 		if (musicPtr != nullptr) {
+			SetMusicAutoUpdate(musicPtr, false);
 			delete musicPtr;
 		}
 		return IntrinsicResult::Null;
@@ -316,6 +523,8 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("music");
 	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) { ProgressiveMusicPlay(pid); return IntrinsicResult::Null; }
 		Music music = ValueToMusic(context->GetVar(String("music")));
 		PlayMusicStream(music);
 		return IntrinsicResult::Null;
@@ -325,6 +534,8 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("music");
 	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) return IntrinsicResult(ProgressiveMusicIsPlaying(pid));
 		Music music = ValueToMusic(context->GetVar(String("music")));
 		return IntrinsicResult(IsMusicStreamPlaying(music));
 	};
@@ -333,6 +544,8 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("music");
 	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) return IntrinsicResult::Null;  // the browser keeps it fed
 		Music music = ValueToMusic(context->GetVar(String("music")));
 		UpdateMusicStream(music);
 		return IntrinsicResult::Null;
@@ -341,7 +554,37 @@ void AddRAudioMethods(ValueDict raylibModule) {
 
 	i = Intrinsic::Create("");
 	i->AddParam("music");
+	i->AddParam("enabled", Value::one);
 	i->code = INTRINSIC_LAMBDA {
+		if (ProgressiveMusicId(context->GetVar(String("music")))) return IntrinsicResult::Null;  // browser-fed
+		ValueDict map = context->GetVar(String("music")).GetDict();
+		Music* musicPtr = (Music*)(long)map.Lookup(String("_handle"), Value::zero).IntValue();
+		if (musicPtr == nullptr) RuntimeException("SetMusicAutoUpdate: invalid music").raise();
+		SetMusicAutoUpdate(musicPtr, context->GetVar(String("enabled")).BoolValue());
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("SetMusicAutoUpdate", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("music");
+	i->code = INTRINSIC_LAMBDA {
+		ValueDict map = context->GetVar(String("music")).GetDict();
+		Music* musicPtr = (Music*)(long)map.Lookup(String("_handle"), Value::zero).IntValue();
+		MusicAutoUpdateStats stats;
+		if (musicPtr == nullptr || !GetMusicAutoUpdateStats(musicPtr, &stats)) return IntrinsicResult::Null;
+		ValueDict result;
+		result.SetValue(String("updates"), Value((double)stats.updates));
+		result.SetValue(String("underruns"), Value((double)stats.underruns));
+		result.SetValue(String("maxGap"), Value(stats.maxGap));
+		return IntrinsicResult(result);
+	};
+	raylibModule.SetValue("GetMusicAutoUpdateInfo", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("music");
+	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) { ProgressiveMusicStop(pid); return IntrinsicResult::Null; }
 		Music music = ValueToMusic(context->GetVar(String("music")));
 		StopMusicStream(music);
 		return IntrinsicResult::Null;
@@ -351,6 +594,8 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("music");
 	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) { ProgressiveMusicPause(pid); return IntrinsicResult::Null; }
 		Music music = ValueToMusic(context->GetVar(String("music")));
 		PauseMusicStream(music);
 		return IntrinsicResult::Null;
@@ -360,6 +605,8 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("music");
 	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) { ProgressiveMusicResume(pid); return IntrinsicResult::Null; }
 		Music music = ValueToMusic(context->GetVar(String("music")));
 		ResumeMusicStream(music);
 		return IntrinsicResult::Null;
@@ -370,8 +617,10 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i->AddParam("music");
 	i->AddParam("position", Value::zero);
 	i->code = INTRINSIC_LAMBDA {
-		Music music = ValueToMusic(context->GetVar(String("music")));
 		float position = context->GetVar(String("position")).FloatValue();
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) { ProgressiveMusicSeek(pid, position); return IntrinsicResult::Null; }
+		Music music = ValueToMusic(context->GetVar(String("music")));
 		SeekMusicStream(music, position);
 		return IntrinsicResult::Null;
 	};
@@ -381,8 +630,10 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i->AddParam("music");
 	i->AddParam("volume", Value(1.0));
 	i->code = INTRINSIC_LAMBDA {
-		Music music = ValueToMusic(context->GetVar(String("music")));
 		float volume = context->GetVar(String("volume")).FloatValue();
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) { ProgressiveMusicSetVolume(pid, volume); return IntrinsicResult::Null; }
+		Music music = ValueToMusic(context->GetVar(String("music")));
 		SetMusicVolume(music, volume);
 		return IntrinsicResult::Null;
 	};
@@ -392,8 +643,10 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i->AddParam("music");
 	i->AddParam("pitch", Value(1.0));
 	i->code = INTRINSIC_LAMBDA {
-		Music music = ValueToMusic(context->GetVar(String("music")));
 		float pitch = context->GetVar(String("pitch")).FloatValue();
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) { ProgressiveMusicSetPitch(pid, pitch); return IntrinsicResult::Null; }
+		Music music = ValueToMusic(context->GetVar(String("music")));
 		SetMusicPitch(music, pitch);
 		return IntrinsicResult::Null;
 	};
@@ -413,6 +666,8 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("music");
 	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) return IntrinsicResult(Value(ProgressiveMusicLength(pid)));
 		Music music = ValueToMusic(context->GetVar(String("music")));
 		float length = GetMusicTimeLength(music);
 		return IntrinsicResult(Value(length));
@@ -422,6 +677,8 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("music");
 	i->code = INTRINSIC_LAMBDA {
+		int pid = ProgressiveMusicId(context->GetVar(String("music")));
+		if (pid) return IntrinsicResult(Value(ProgressiveMusicTimePlayed(pid)));
 		Music music = ValueToMusic(context->GetVar(String("music")));
 		float timePlayed = GetMusicTimePlayed(music);
 		return IntrinsicResult(Value(timePlayed));
@@ -470,6 +727,7 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i->AddParam("sound");
 	i->code = INTRINSIC_LAMBDA {
 		Sound sound = ValueToSound(context->GetVar(String("sound")));
+		DetachAllStreamEffects(sound.stream);
 		UnloadSound(sound);
 		// Also delete the heap-allocated Sound
 		ValueDict map = context->GetVar(String("sound")).GetDict();
@@ -498,6 +756,31 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	};
 	raylibModule.SetValue("UnloadSoundAlias", i->GetFunc());
 
+	i = Intrinsic::Create("");
+	i->AddParam("source");
+	i->AddParam("voices", Value(4));
+	i->code = INTRINSIC_LAMBDA {
+		Sound source = ValueToSound(context->GetVar(String("source")));
+		if (!IsSoundValid(source)) return IntrinsicResult::Null;
+		int voices = context->GetVar(String("voices")).IntValue();
+		if (voices < 1 || voices > 64) RuntimeException("LoadSoundPool: voices must be 1-64").raise();
+		return IntrinsicResult(SoundPoolToValue(new SoundPool(source, voices)));
+	};
+	raylibModule.SetValue("LoadSoundPool", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("pool");
+	i->code = INTRINSIC_LAMBDA {
+		Value poolVal = context->GetVar(String("pool"));
+		SoundPool* pool = ValueToSoundPool(poolVal);
+		if (pool != nullptr) {
+			delete pool;
+			poolVal.GetDict().SetValue(String("_handle"), Value::zero);
+		}
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadSoundPool", i->GetFunc());
+
 	i = Intrinsic::Create("");
 	i->AddParam("sound");
 	i->code = INTRINSIC_LAMBDA {
@@ -623,6 +906,8 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i->AddParam("stream");
 	i->code = INTRINSIC_LAMBDA {
 		AudioStream stream = ValueToAudioStream(context->GetVar(String("stream")));
+		DetachAudioStreamQueue(stream);
+		DetachAllStreamEffects(stream);
 		UnloadAudioStream(stream);
 		// Also delete the heap-allocated AudioStream
 		ValueDict map = context->GetVar(String("stream")).GetDict();
@@ -638,27 +923,21 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("stream");
 	i->AddParam("data");
+	i->AddParam("frameCount", Value(-1));
 	i->code = INTRINSIC_LAMBDA {
 		AudioStream stream = ValueToAudioStream(context->GetVar(String("stream")));
-		ValueList data = context->GetVar(String("data")).GetList();
-
-#define PROCESS_DATA(TYPE, VALUE) \
-		TYPE *buffer = new TYPE[data.Count()]; \
-		for (long i=0;i<data.Count();++i) { \
-			buffer[i] = static_cast<TYPE>(data.Item(i).VALUE()); \
-		}; \
-		UpdateAudioStream(stream, buffer, data.Count());
-
-		if (stream.sampleSize==8) {
-			PROCESS_DATA(unsigned char, IntValue)
-		} else if (stream.sampleSize==16) {
-			PROCESS_DATA(signed short, IntValue)
+		int frameCount = context->GetVar(String("frameCount")).IntValue();
+		unsigned int frames = 0;
+		const void* samples = GetStreamSamples("UpdateAudioStream", stream, context->GetVar(String("data")), frameCount, &frames);
+		if (frames == 0) return IntrinsicResult::Null;
+
+		// With a queue attached, the callback owns playback; append to the queue
+		AudioStreamQueue* queue = GetAudioStreamQueue(stream);
+		if (queue) {
+			queue->Write(samples, frames);
 		} else {
-			PROCESS_DATA(float, FloatValue)
+			UpdateAudioStream(stream, samples, frames);
 		}
-
-#undef PROCESS_DATA
-
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("UpdateAudioStream", i->GetFunc());
@@ -753,7 +1032,439 @@ void AddRAudioMethods(ValueDict raylibModule) {
 	i->code = INTRINSIC_LAMBDA {
 		int size = context->GetVar(String("size")).IntValue();
 		SetAudioStreamBufferSizeDefault(size);
+		SetAutoUpdateBufferFrames(size);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("SetAudioStreamBufferSizeDefault", i->GetFunc());
+
+	// AudioStream queues (MSRLWeb extension)
+
+	i = Intrinsic::Create("");
+	i->AddParam("stream");
+	i->AddParam("capacityFrames", Value::zero);
+	i->code = INTRINSIC_LAMBDA {
+		AudioStream stream = ValueToAudioStream(context->GetVar(String("stream")));
+		int capacityFrames = context->GetVar(String("capacityFrames")).IntValue();
+		if (capacityFrames <= 0) capacityFrames = stream.sampleRate;  // one second
+		AudioStreamQueue* queue = AttachAudioStreamQueue(stream, capacityFrames);
+		return IntrinsicResult(queue != nullptr);
+	};
+	raylibModule.SetValue("AttachAudioStreamQueue", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("stream");
+	i->code = INTRINSIC_LAMBDA {
+		AudioStream stream = ValueToAudioStream(context->GetVar(String("stream")));
+		DetachAudioStreamQueue(stream);
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("DetachAudioStreamQueue", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("stream");
+	i->AddParam("data");
+	i->AddParam("frameCount", Value(-1));
+	i->code = INTRINSIC_LAMBDA {
+		AudioStream stream = ValueToAudioStream(context->GetVar(String("stream")));
+		AudioStreamQueue* queue = GetAudioStreamQueue(stream);
+		if (!queue) RuntimeException("QueueAudioStreamData: stream has no queue attached").raise();
+		int frameCount = context->GetVar(String("frameCount")).IntValue();
+		unsigned int frames = 0;
+		const void* samples = GetStreamSamples("QueueAudioStreamData", stream, context->GetVar(String("data")), frameCount, &frames);
+		if (frames == 0) return IntrinsicResult(Value::zero);
+		return IntrinsicResult((int)queue->Write(samples, frames));
+	};
+	raylibModule.SetValue("QueueAudioStreamData", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("stream");
+	i->AddParam("reset", Value::zero);
+	i->code = INTRINSIC_LAMBDA {
+		AudioStream stream = ValueToAudioStream(context->GetVar(String("stream")));
+		AudioStreamQueue* queue = GetAudioStreamQueue(stream);
+		if (!queue) return IntrinsicResult::Null;
+		ValueDict result;
+		result.SetValue(String("capacity"), Value((int)queue->Capacity()));
+		result.SetValue(String("queued"), Value((int)queue->QueuedFrames()));
+		result.SetValue(String("free"), Value((int)queue->FreeFrames()));
+		result.SetValue(String("framesPlayed"), Value((double)queue->framesPlayed.load()));
+		result.SetValue(String("silentFrames"), Value((double)queue->silentFrames.load()));
+		result.SetValue(String("underruns"), Value((double)queue->underruns.load()));
+		if (context->GetVar(String("reset")).BoolValue()) {
+			queue->framesPlayed = 0;
+			queue->silentFrames = 0;
+			queue->underruns = 0;
+		}
+		return IntrinsicResult(result);
+	};
+	raylibModule.SetValue("GetAudioStreamQueueInfo", i->GetFunc());
+
+	// Synthesizer (MSRLWeb extension)
+
+	i = Intrinsic::Create("");
+	i->AddParam("params");
+	i->AddParam("sampleRate", Value(44100));
+	i->AddParam("sampleSize", Value(16));
+	i->code = INTRINSIC_LAMBDA {
+		SynthParams params = ValueToSynthParams(context->GetVar(String("params")));
+		int sampleRate = context->GetVar(String("sampleRate")).IntValue();
+		int sampleSize = context->GetVar(String("sampleSize")).IntValue();
+		if (sampleSize != 8 && sampleSize != 16 && sampleSize != 32) {
+			RuntimeException("GenWaveSynth: sampleSize must be 8, 16, or 32").raise();
+		}
+		if (sampleRate <= 0) RuntimeException("GenWaveSynth: sampleRate must be > 0").raise();
+
+		int maxFrames = (int)ceilf(params.Duration() * sampleRate);
+		if (maxFrames < 1) maxFrames = 1;
+		float* samples = FrameArena::AllocArray<float>(maxFrames);
+		SynthVoice voice(params);
+		voice.Trigger();
+		int frameCount = voice.Render(samples, maxFrames, sampleRate);
+		if (frameCount < 1) frameCount = 1;
+
+		Wave wave;
+		wave.frameCount = frameCount;
+		wave.sampleRate = sampleRate;
+		wave.sampleSize = sampleSize;
+		wave.channels = 1;
+		wave.data = MemAlloc(frameCount * (sampleSize / 8));
+		ConvertSamplesFromFloat(samples, wave.data, frameCount, sampleSize);
+		return IntrinsicResult(WaveToValue(wave));
+	};
+	raylibModule.SetValue("GenWaveSynth", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("params");
+	i->code = INTRINSIC_LAMBDA {
+		SynthParams params = ValueToSynthParams(context->GetVar(String("params")));
+		return IntrinsicResult(SynthVoiceToValue(new SynthVoice(params)));
+	};
+	raylibModule.SetValue("LoadSynthVoice", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("voice");
+	i->code = INTRINSIC_LAMBDA {
+		Value voiceVal = context->GetVar(String("voice"));
+		SynthVoice* voice = ValueToSynthVoice(voiceVal);
+		if (voice != nullptr) {
+			delete voice;
+			voiceVal.GetDict().SetValue(String("_handle"), Value::zero);
+		}
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadSynthVoice", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("voice");
+	i->AddParam("params");
+	i->code = INTRINSIC_LAMBDA {
+		SynthVoice* voice = ValueToSynthVoice(context->GetVar(String("voice")));
+		if (!voice) RuntimeException("SetSynthVoiceParams: invalid voice").raise();
+		voice->params = ValueToSynthParams(context->GetVar(String("params")));
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("SetSynthVoiceParams", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("voice");
+	i->AddParam("frequency", Value::zero);
+	i->code = INTRINSIC_LAMBDA {
+		SynthVoice* voice = ValueToSynthVoice(context->GetVar(String("voice")));
+		if (!voice) RuntimeException("PlaySynthVoice: invalid voice").raise();
+		voice->Trigger(context->GetVar(String("frequency")).FloatValue());
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("PlaySynthVoice", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("voice");
+	i->code = INTRINSIC_LAMBDA {
+		SynthVoice* voice = ValueToSynthVoice(context->GetVar(String("voice")));
+		if (voice) voice->Release();
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("ReleaseSynthVoice", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("voice");
+	i->code = INTRINSIC_LAMBDA {
+		SynthVoice* voice = ValueToSynthVoice(context->GetVar(String("voice")));
+		return IntrinsicResult(voice != nullptr && voice->IsActive());
+	};
+	raylibModule.SetValue("IsSynthVoicePlaying", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("voice");
+	i->AddParam("stream");
+	i->AddParam("frameCount", Value(-1));
+	i->code = INTRINSIC_LAMBDA {
+		SynthVoice* voice = ValueToSynthVoice(context->GetVar(String("voice")));
+		if (!voice) RuntimeException("RenderSynthVoice: invalid voice").raise();
+		AudioStream stream = ValueToAudioStream(context->GetVar(String("stream")));
+		int frameCount = context->GetVar(String("frameCount")).IntValue();
+
+		// With a queue attached, render as much as fits (or as requested);
+		// otherwise the caller must say how many frames to hand to raylib.
+		AudioStreamQueue* queue = GetAudioStreamQueue(stream);
+		if (queue) {
+			int space = (int)queue->FreeFrames();
+			if (frameCount < 0 || frameCount > space) frameCount = space;
+		} else if (frameCount < 0) {
+			RuntimeException("RenderSynthVoice: frameCount required when the stream has no queue").raise();
+		}
+		if (frameCount == 0) return IntrinsicResult(Value::zero);
+
+		int channels = stream.channels > 0 ? stream.channels : 1;
+		float* mono = FrameArena::AllocArray<float>(frameCount);
+		voice->Render(mono, frameCount, stream.sampleRate);
+		float* interleaved = mono;
+		if (channels > 1) {
+			interleaved = FrameArena::AllocArray<float>(frameCount * channels);
+			for (int f = 0; f < frameCount; f++) {
+				for (int c = 0; c < channels; c++) interleaved[f * channels + c] = mono[f];
+			}
+		}
+		void* samples = interleaved;
+		if (stream.sampleSize != 32) {
+			samples = FrameArena::Alloc(frameCount * channels * (stream.sampleSize / 8));
+			ConvertSamplesFromFloat(interleaved, samples, frameCount * channels, stream.sampleSize);
+		}
+
+		if (queue) return IntrinsicResult((int)queue->Write(samples, frameCount));
+		UpdateAudioStream(stream, samples, frameCount);
+		return IntrinsicResult(frameCount);
+	};
+	raylibModule.SetValue("RenderSynthVoice", i->GetFunc());
+
+	// Offline wave generation (MSRLWeb extension)
+
+	i = Intrinsic::Create("");
+	i->AddParam("frequency", Value(440));
+	i->AddParam("duration", Value(1));
+	i->AddParam("waveform", "sine");
+	i->AddParam("volume", Value(1));
+	i->AddParam("sampleRate", Value(44100));
+	i->AddParam("sampleSize", Value(16));
+	i->AddParam("dest");
+	i->code = INTRINSIC_LAMBDA {
+		float frequency = context->GetVar(String("frequency")).FloatValue();
+		double duration = context->GetVar(String("duration")).DoubleValue();
+		int waveform = ValueToSynthWaveform(context->GetVar(String("waveform")));
+		float volume = context->GetVar(String("volume")).FloatValue();
+		int sampleRate = context->GetVar(String("sampleRate")).IntValue();
+		int sampleSize = context->GetVar(String("sampleSize")).IntValue();
+		CheckGenFormat("GenWaveTone", sampleRate, sampleSize);
+
+		int frameCount = GenFrameCount("GenWaveTone", duration, sampleRate);
+		float* samples = FrameArena::AllocArray<float>(frameCount);
+		GenToneSamples(samples, frameCount, sampleRate, waveform, frequency, frequency, volume, 0.5f);
+		return IntrinsicResult(GenOutput("GenWaveTone", samples, frameCount, sampleRate, sampleSize,
+			context->GetVar(String("dest"))));
+	};
+	raylibModule.SetValue("GenWaveTone", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("startFrequency", Value(880));
+	i->AddParam("endFrequency", Value(220));
+	i->AddParam("duration", Value(1));
+	i->AddParam("waveform", "sine");
+	i->AddParam("volume", Value(1));
+	i->AddParam("sampleRate", Value(44100));
+	i->AddParam("sampleSize", Value(16));
+	i->AddParam("dest");
+	i->code = INTRINSIC_LAMBDA {
+		float startFrequency = context->GetVar(String("startFrequency")).FloatValue();
+		float endFrequency = context->GetVar(String("endFrequency")).FloatValue();
+		double duration = context->GetVar(String("duration")).DoubleValue();
+		int waveform = ValueToSynthWaveform(context->GetVar(String("waveform")));
+		float volume = context->GetVar(String("volume")).FloatValue();
+		int sampleRate = context->GetVar(String("sampleRate")).IntValue();
+		int sampleSize = context->GetVar(String("sampleSize")).IntValue();
+		CheckGenFormat("GenWaveSweep", sampleRate, sampleSize);
+		if (startFrequency <= 0 || endFrequency <= 0) {
+			RuntimeException("GenWaveSweep: frequencies must be > 0").raise();
+		}
+
+		int frameCount = GenFrameCount("GenWaveSweep", duration, sampleRate);
+		float* samples = FrameArena::AllocArray<float>(frameCount);
+		GenToneSamples(samples, frameCount, sampleRate, waveform, startFrequency, endFrequency, volume, 0.5f);
+		return IntrinsicResult(GenOutput("GenWaveSweep", samples, frameCount, sampleRate, sampleSize,
+			context->GetVar(String("dest"))));
+	};
+	raylibModule.SetValue("GenWaveSweep", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("duration", Value(1));
+	i->AddParam("volume", Value(1));
+	i->AddParam("seed", Value::zero);
+	i->AddParam("sampleRate", Value(44100));
+	i->AddParam("sampleSize", Value(16));
+	i->AddParam("dest");
+	i->code = INTRINSIC_LAMBDA {
+		double duration = context->GetVar(String("duration")).DoubleValue();
+		float volume = context->GetVar(String("volume")).FloatValue();
+		uint32_t seed = (uint32_t)context->GetVar(String("seed")).IntValue();
+		int sampleRate = context->GetVar(String("sampleRate")).IntValue();
+		int sampleSize = context->GetVar(String("sampleSize")).IntValue();
+		CheckGenFormat("GenWaveNoise", sampleRate, sampleSize);
+
+		int frameCount = GenFrameCount("GenWaveNoise", duration, sampleRate);
+		float* samples = FrameArena::AllocArray<float>(frameCount);
+		GenNoiseSamples(samples, frameCount, volume, seed);
+		return IntrinsicResult(GenOutput("GenWaveNoise", samples, frameCount, sampleRate, sampleSize,
+			context->GetVar(String("dest"))));
+	};
+	raylibModule.SetValue("GenWaveNoise", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("waves");
+	i->AddParam("volumes");
+	i->code = INTRINSIC_LAMBDA {
+		std::vector<Wave> waves = ValueToWaveList("WaveMix", context->GetVar(String("waves")));
+		std::vector<float> volumes;
+		Value volumesVal = context->GetVar(String("volumes"));
+		if (volumesVal.type == ValueType::List) {
+			ValueList list = volumesVal.GetList();
+			for (int j = 0; j < list.Count(); j++) volumes.push_back(list[j].FloatValue());
+		}
+		return IntrinsicResult(WaveToValue(MixWaves(waves, volumes)));
+	};
+	raylibModule.SetValue("WaveMix", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("waves");
+	i->AddParam("gap", Value::zero);
+	i->code = INTRINSIC_LAMBDA {
+		std::vector<Wave> waves = ValueToWaveList("WaveConcat", context->GetVar(String("waves")));
+		float gap = context->GetVar(String("gap")).FloatValue();
+		return IntrinsicResult(WaveToValue(ConcatWaves(waves, gap)));
+	};
+	raylibModule.SetValue("WaveConcat", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("wave");
+	i->AddParam("fadeIn", Value::zero);
+	i->AddParam("fadeOut", Value::zero);
+	i->code = INTRINSIC_LAMBDA {
+		Wave wave = ValueToWave(context->GetVar(String("wave")));
+		if (wave.data == nullptr) RuntimeException("WaveFade: invalid wave").raise();
+		int fadeIn = (int)(context->GetVar(String("fadeIn")).FloatValue() * wave.sampleRate);
+		int fadeOut = (int)(context->GetVar(String("fadeOut")).FloatValue() * wave.sampleRate);
+		FadeWave(wave, fadeIn, fadeOut);
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("WaveFade", i->GetFunc());
+
+	// Audio effects (MSRLWeb extension)
+
+	i = Intrinsic::Create("");
+	i->AddParam("type");
+	i->AddParam("params");
+	i->code = INTRINSIC_LAMBDA {
+		String typeName = context->GetVar(String("type")).ToString();
+		AudioEffect* effect = AudioEffect::Create(typeName);
+		if (!effect) RuntimeException(String("LoadAudioEffect: unknown effect type ") + typeName).raise();
+		Value params = context->GetVar(String("params"));
+		if (params.type == ValueType::Map) effect->Configure(params.GetDict());
+		return IntrinsicResult(AudioEffectToValue(effect));
+	};
+	raylibModule.SetValue("LoadAudioEffect", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("effect");
+	i->code = INTRINSIC_LAMBDA {
+		Value effectVal = context->GetVar(String("effect"));
+		AudioEffect* effect = ValueToAudioEffect(effectVal);
+		if (effect) {
+			DetachEffectEverywhere(effect);
+			delete effect;
+			effectVal.GetDict().SetValue(String("_handle"), Value::zero);
+		}
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadAudioEffect", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("effect");
+	i->AddParam("params");
+	i->code = INTRINSIC_LAMBDA {
+		AudioEffect* effect = ValueToAudioEffect(context->GetVar(String("effect")));
+		if (!effect) RuntimeException("SetAudioEffectParams: invalid effect").raise();
+		Value params = context->GetVar(String("params"));
+		if (params.type != ValueType::Map) RuntimeException("SetAudioEffectParams: params map required").raise();
+		effect->Configure(params.GetDict());
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("SetAudioEffectParams", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("effect");
+	i->code = INTRINSIC_LAMBDA {
+		AudioEffect* effect = ValueToAudioEffect(context->GetVar(String("effect")));
+		if (effect) effect->Reset();
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("ResetAudioEffect", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("target");
+	i->AddParam("effect");
+	i->code = INTRINSIC_LAMBDA {
+		AudioStream stream = EffectTargetStream("AttachAudioEffect", context->GetVar(String("target")));
+		AudioEffect* effect = ValueToAudioEffect(context->GetVar(String("effect")));
+		if (!effect) RuntimeException("AttachAudioEffect: invalid effect").raise();
+		return IntrinsicResult(AttachStreamEffect(stream, effect));
+	};
+	raylibModule.SetValue("AttachAudioEffect", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("target");
+	i->AddParam("effect");
+	i->code = INTRINSIC_LAMBDA {
+		AudioStream stream = EffectTargetStream("DetachAudioEffect", context->GetVar(String("target")));
+		AudioEffect* effect = ValueToAudioEffect(context->GetVar(String("effect")));
+		if (effect) DetachStreamEffect(stream, effect);
+		else DetachAllStreamEffects(stream);
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("DetachAudioEffect", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("effect");
+	i->code = INTRINSIC_LAMBDA {
+		AudioEffect* effect = ValueToAudioEffect(context->GetVar(String("effect")));
+		if (!effect) RuntimeException("AttachMasterAudioEffect: invalid effect").raise();
+		AttachMasterEffect(effect);
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("AttachMasterAudioEffect", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("effect");
+	i->code = INTRINSIC_LAMBDA {
+		AudioEffect* effect = ValueToAudioEffect(context->GetVar(String("effect")));
+		if (effect) DetachMasterEffect(effect);
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("DetachMasterAudioEffect", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("effect");
+	i->AddParam("reset", Value::zero);
+	i->code = INTRINSIC_LAMBDA {
+		AudioEffect* effect = ValueToAudioEffect(context->GetVar(String("effect")));
+		if (!effect) return IntrinsicResult::Null;
+		ValueDict result;
+		result.SetValue(String("type"), Value(String(effect->TypeName())));
+		result.SetValue(String("bypass"), Value(effect->bypass ? 1 : 0));
+		result.SetValue(String("framesProcessed"), Value(effect->framesProcessed));
+		result.SetValue(String("processMs"), Value(effect->processMs));
+		result.SetValue(String("cpuPercent"), Value(effect->CpuPercent()));
+		if (context->GetVar(String("reset")).BoolValue()) {
+			effect->processMs = 0;
+			effect->framesProcessed = 0;
+		}
+		return IntrinsicResult(result);
+	};
+	raylibModule.SetValue("GetAudioEffectInfo", i->GetFunc());
 }
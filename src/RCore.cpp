@@ -7,11 +7,17 @@
 
 #include "RaylibIntrinsics.h"
 #include "RaylibTypes.h"
+#include "FrameArena.h"
+#include "InputEvents.h"
+#include "InputMap.h"
+#include "DenseMatrix.h"
+#include "Noise.h"
 #include "RawData.h"
 #include "raylib.h"
 #include "MiniscriptInterpreter.h"
 #include "MiniscriptTypes.h"
 #include <emscripten.h>
+#include <string.h>
 #include "macros.h"
 
 using namespace MiniScript;
@@ -62,6 +68,10 @@ void AddRCoreMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->code = INTRINSIC_LAMBDA {
 		EndDrawing();
+		// Frame is done; recycle binding-layer scratch memory
+		FrameArena::Reset();
+		// EndDrawing polled input for the next frame; evaluate action bindings once
+		UpdateInputMaps();
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("EndDrawing", i->GetFunc());
@@ -161,6 +171,60 @@ void AddRCoreMethods(ValueDict raylibModule) {
 	};
 	raylibModule.SetValue("SetExitKey", i->GetFunc());
 
+	// Input events (MSRLWeb extension)
+
+	i = Intrinsic::Create("");
+	i->AddParam("asRawData", Value::zero);
+	i->code = INTRINSIC_LAMBDA {
+		InputEvent* events;
+		int count;
+		TakeInputEvents(&events, &count);
+		if (context->GetVar(String("asRawData")).BoolValue()) {
+			BinaryData* data = new BinaryData(count * (int)sizeof(InputEvent));
+			if (count > 0) memcpy(data->bytes, events, count * sizeof(InputEvent));
+			return IntrinsicResult(RawDataToValue(data));
+		}
+		ValueList result;
+		for (int j = 0; j < count; j++) {
+			ValueList item;
+			item.Add(Value(events[j].type));
+			item.Add(Value(events[j].code));
+			item.Add(Value(events[j].x));
+			item.Add(Value(events[j].y));
+			item.Add(Value(events[j].time));
+			result.Add(Value(item));
+		}
+		return IntrinsicResult(Value(result));
+	};
+	raylibModule.SetValue("GetInputEvents", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->code = INTRINSIC_LAMBDA {
+		EnableInputEvents();
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("EnableInputEvents", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->code = INTRINSIC_LAMBDA {
+		InputMap* inputMap = new InputMap();
+		return IntrinsicResult(InputMapToValue(inputMap));
+	};
+	raylibModule.SetValue("LoadInputMap", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("inputMap");
+	i->code = INTRINSIC_LAMBDA {
+		Value mapVal = context->GetVar(String("inputMap"));
+		InputMap* inputMap = ValueToInputMap(mapVal);
+		if (inputMap != nullptr) {
+			delete inputMap;
+			mapVal.GetDict().SetValue(String("_handle"), Value::zero);
+		}
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadInputMap", i->GetFunc());
+
 	// Input-related functions: gamepad
 
 	i = Intrinsic::Create("");
@@ -647,6 +711,84 @@ void AddRCoreMethods(ValueDict raylibModule) {
 	};
 	raylibModule.SetValue("GetCameraMatrix2D", i->GetFunc());
 
+	i = Intrinsic::Create("");
+	i->AddParam("source");
+	i->AddParam("columns");
+	i->AddParam("initialValue", 0);
+	i->code = INTRINSIC_LAMBDA {
+		Value source = context->GetVar(String("source"));
+		Value columnsVal = context->GetVar(String("columns"));
+		int columns = columnsVal.IsNull() ? 0 : columnsVal.IntValue();
+		if (source.type == ValueType::Number) {
+			// rows (and columns, defaulting to a square matrix) filled with initialValue
+			int rows = source.IntValue();
+			if (columns == 0) columns = rows;
+			if (rows < 1 || columns < 1) RuntimeException("LoadDenseMatrix: rows and columns must be at least 1").raise();
+			if ((double)rows * columns > 16 * 1024 * 1024) RuntimeException("LoadDenseMatrix: matrix too large").raise();
+			double initialValue = context->GetVar(String("initialValue")).DoubleValue();
+			return IntrinsicResult(DenseMatrixToValue(new DenseMatrix(rows, columns, initialValue)));
+		}
+		return IntrinsicResult(DenseMatrixToValue(ValueToNewDenseMatrix("LoadDenseMatrix", source, columns)));
+	};
+	raylibModule.SetValue("LoadDenseMatrix", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("matrix");
+	i->code = INTRINSIC_LAMBDA {
+		Value matrixVal = context->GetVar(String("matrix"));
+		DenseMatrix* matrix = ValueToDenseMatrix(matrixVal);
+		if (matrix != nullptr) {
+			delete matrix;
+			matrixVal.GetDict().SetValue(String("_handle"), Value::zero);
+		}
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadDenseMatrix", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("type", Value(String("perlin")));
+	i->AddParam("seed", Value::zero);
+	i->AddParam("frequency", Value::one);
+	i->AddParam("fractal", Value(String("none")));
+	i->AddParam("octaves", Value(4));
+	i->AddParam("lacunarity", Value(2));
+	i->AddParam("gain", Value(0.5));
+	i->code = INTRINSIC_LAMBDA {
+		NoiseType type;
+		NoiseFractal fractal;
+		if (!ParseNoiseType(context->GetVar(String("type")).ToString(), &type)) {
+			RuntimeException("LoadNoise: type must be \"perlin\", \"simplex\", \"value\" or \"worley\"").raise();
+		}
+		if (!ParseNoiseFractal(context->GetVar(String("fractal")).ToString(), &fractal)) {
+			RuntimeException("LoadNoise: fractal must be \"none\", \"fbm\" or \"ridged\"").raise();
+		}
+		int octaves = context->GetVar(String("octaves")).IntValue();
+		if (octaves < 1 || octaves > 16) RuntimeException("LoadNoise: octaves must be from 1 to 16").raise();
+		Noise* noise = new Noise();
+		noise->type = type;
+		noise->fractal = fractal;
+		noise->seed = (uint32_t)(int64_t)context->GetVar(String("seed")).DoubleValue();
+		noise->frequency = context->GetVar(String("frequency")).FloatValue();
+		noise->octaves = octaves;
+		noise->lacunarity = context->GetVar(String("lacunarity")).FloatValue();
+		noise->gain = context->GetVar(String("gain")).FloatValue();
+		return IntrinsicResult(NoiseToValue(noise));
+	};
+	raylibModule.SetValue("LoadNoise", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("noise");
+	i->code = INTRINSIC_LAMBDA {
+		Value noiseVal = context->GetVar(String("noise"));
+		Noise* noise = ValueToNoise(noiseVal);
+		if (noise != nullptr) {
+			delete noise;
+			noiseVal.GetDict().SetValue(String("_handle"), Value::zero);
+		}
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadNoise", i->GetFunc());
+
 	i = Intrinsic::Create("");
 	i->AddParam("position");
 	i->AddParam("camera");
@@ -887,4 +1029,24 @@ void AddRCoreMethods(ValueDict raylibModule) {
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("SetTraceLogLevel", i->GetFunc());
+
+	// Diagnostics (MSRLWeb extension)
+
+	i = Intrinsic::Create("");
+	i->AddParam("reset", Value::zero);
+	i->code = INTRINSIC_LAMBDA {
+		FrameArena::Stats stats = FrameArena::GetStats();
+		ValueDict result;
+		result.SetValue(String("allocations"), Value((double)stats.allocations));
+		result.SetValue(String("bytesAllocated"), Value((double)stats.bytesAllocated));
+		result.SetValue(String("blockMallocs"), Value((double)stats.blockMallocs));
+		result.SetValue(String("largeAllocations"), Value((double)stats.largeAllocations));
+		result.SetValue(String("resets"), Value((double)stats.resets));
+		result.SetValue(String("capacity"), Value((double)stats.capacity));
+		result.SetValue(String("frameBytes"), Value((double)stats.frameBytes));
+		result.SetValue(String("highWater"), Value((double)stats.highWater));
+		if (context->GetVar(String("reset")).BoolValue()) FrameArena::ResetStats();
+		return IntrinsicResult(result);
+	};
+	raylibModule.SetValue("GetFrameArenaStats", i->GetFunc());
 }
@@ -7,6 +7,11 @@
 
 #include "RaylibIntrinsics.h"
 #include "RaylibTypes.h"
+#include "CollisionMask.h"
+#include "NavGrid.h"
+#include "Polygon2D.h"
+#include "FrameArena.h"
+#include "Path2D.h"
 #include "raylib.h"
 #include "MiniscriptInterpreter.h"
 #include "MiniscriptTypes.h"
@@ -613,17 +618,20 @@ void AddRShapesMethods(ValueDict raylibModule) {
 	i->AddParam("points");
 	i->code = INTRINSIC_LAMBDA {
 		Vector2 point = ValueToVector2(context->GetVar(String("point")));
-		ValueList pointsList = context->GetVar(String("points")).GetList();
+		Value pointsVal = context->GetVar(String("points"));
+		Polygon2D* poly = ValueToPolygon2D(pointsVal);
+		if (poly != nullptr) return IntrinsicResult(poly->Contains(Point2D{ point.x, point.y }));
+
+		ValueList pointsList = pointsVal.GetList();
 		int pointCount = pointsList.Count();
 		if (pointCount < 3) return IntrinsicResult(Value::zero);
 
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
 
 		bool result = CheckCollisionPointPoly(point, points, pointCount);
-		delete[] points;
 		return IntrinsicResult(result);
 	};
 	raylibModule.SetValue("CheckCollisionPointPoly", i->GetFunc());
@@ -776,14 +784,13 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		int pointCount = pointsList.Count();
 		if (pointCount < 2) return IntrinsicResult::Null;
 
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
 
 		Color color = ValueToColor(context->GetVar(String("color")));
 		DrawLineStrip(points, pointCount, color);
-		delete[] points;
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("DrawLineStrip", i->GetFunc());
@@ -818,7 +825,7 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		int pointCount = pointsList.Count();
 		if (pointCount < 2) return IntrinsicResult::Null;
 
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
@@ -826,7 +833,6 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		float thick = context->GetVar(String("thick")).FloatValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
 		DrawSplineLinear(points, pointCount, thick, color);
-		delete[] points;
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("DrawSplineLinear", i->GetFunc());
@@ -840,7 +846,7 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		int pointCount = pointsList.Count();
 		if (pointCount < 4) return IntrinsicResult::Null;
 
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
@@ -848,7 +854,6 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		float thick = context->GetVar(String("thick")).FloatValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
 		DrawSplineBasis(points, pointCount, thick, color);
-		delete[] points;
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("DrawSplineBasis", i->GetFunc());
@@ -862,7 +867,7 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		int pointCount = pointsList.Count();
 		if (pointCount < 2) return IntrinsicResult::Null;
 
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
@@ -870,7 +875,6 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		float thick = context->GetVar(String("thick")).FloatValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
 		DrawSplineCatmullRom(points, pointCount, thick, color);
-		delete[] points;
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("DrawSplineCatmullRom", i->GetFunc());
@@ -884,7 +888,7 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		int pointCount = pointsList.Count();
 		if (pointCount < 3) return IntrinsicResult::Null;
 
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
@@ -892,7 +896,6 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		float thick = context->GetVar(String("thick")).FloatValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
 		DrawSplineBezierQuadratic(points, pointCount, thick, color);
-		delete[] points;
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("DrawSplineBezierQuadratic", i->GetFunc());
@@ -906,7 +909,7 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		int pointCount = pointsList.Count();
 		if (pointCount < 4) return IntrinsicResult::Null;
 
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
@@ -914,7 +917,6 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		float thick = context->GetVar(String("thick")).FloatValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
 		DrawSplineBezierCubic(points, pointCount, thick, color);
-		delete[] points;
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("DrawSplineBezierCubic", i->GetFunc());
@@ -1116,14 +1118,13 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		int pointCount = pointsList.Count();
 		if (pointCount < 3) return IntrinsicResult::Null;
 
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
 
 		Color color = ValueToColor(context->GetVar(String("color")));
 		DrawTriangleFan(points, pointCount, color);
-		delete[] points;
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("DrawTriangleFan", i->GetFunc());
@@ -1136,14 +1137,13 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		int pointCount = pointsList.Count();
 		if (pointCount < 3) return IntrinsicResult::Null;
 
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
 
 		Color color = ValueToColor(context->GetVar(String("color")));
 		DrawTriangleStrip(points, pointCount, color);
-		delete[] points;
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("DrawTriangleStrip", i->GetFunc());
@@ -1174,4 +1174,118 @@ void AddRShapesMethods(ValueDict raylibModule) {
 		return IntrinsicResult(RectangleToValue(rect));
 	};
 	raylibModule.SetValue("GetShapesTextureRectangle", i->GetFunc());
+
+	// Paths (see pathUtil)
+
+	i = Intrinsic::Create("");
+	i->AddParam("points");
+	i->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(Path2DToValue(ValueToNewPath2D("LoadPath", context->GetVar(String("points")))));
+	};
+	raylibModule.SetValue("LoadPath", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("path");
+	i->code = INTRINSIC_LAMBDA {
+		Value pathVal = context->GetVar(String("path"));
+		Path2D* path = ValueToPath2D(pathVal);
+		if (path != nullptr) {
+			delete path;
+			pathVal.GetDict().SetValue(String("_handle"), Value::zero);
+		}
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadPath", i->GetFunc());
+
+	// Collision masks
+
+	i = Intrinsic::Create("");
+	i->AddParam("image");
+	i->AddParam("threshold", Value(128));
+	i->AddParam("rec");
+	i->code = INTRINSIC_LAMBDA {
+		Image image = ValueToImage(context->GetVar(String("image")));
+		if (image.data == nullptr) RuntimeException("LoadCollisionMask: image required").raise();
+		int threshold = context->GetVar(String("threshold")).IntValue();
+		Value recVal = context->GetVar(String("rec"));
+		Rectangle rec = recVal.IsNull() ? Rectangle{ 0, 0, (float)image.width, (float)image.height } : ValueToRectangle(recVal);
+		return IntrinsicResult(CollisionMaskToValue(new CollisionMask(image, rec, threshold)));
+	};
+	raylibModule.SetValue("LoadCollisionMask", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("mask");
+	i->code = INTRINSIC_LAMBDA {
+		Value maskVal = context->GetVar(String("mask"));
+		CollisionMask* mask = ValueToCollisionMask(maskVal);
+		if (mask != nullptr) {
+			delete mask;
+			maskVal.GetDict().SetValue(String("_handle"), Value::zero);
+		}
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadCollisionMask", i->GetFunc());
+
+	// Navigation grids
+
+	i = Intrinsic::Create("");
+	i->AddParam("width", Value(32));
+	i->AddParam("height", Value(32));
+	i->AddParam("costs", Value::one);
+	i->AddParam("diagonal", Value::one);
+	i->code = INTRINSIC_LAMBDA {
+		int width = context->GetVar(String("width")).IntValue();
+		int height = context->GetVar(String("height")).IntValue();
+		if (width < 1 || height < 1) RuntimeException("LoadNavGrid: width and height must be at least 1").raise();
+		if ((double)width * height > 4 * 1024 * 1024) RuntimeException("LoadNavGrid: grid too large").raise();
+		NavGrid* grid = new NavGrid(width, height, 1, context->GetVar(String("diagonal")).BoolValue());
+		if (!SetNavGridCosts(grid, context->GetVar(String("costs")))) {
+			delete grid;
+			RuntimeException("LoadNavGrid: costs must be a number, or a list or float RawData with one value per cell").raise();
+		}
+		return IntrinsicResult(NavGridToValue(grid));
+	};
+	raylibModule.SetValue("LoadNavGrid", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("grid");
+	i->code = INTRINSIC_LAMBDA {
+		Value gridVal = context->GetVar(String("grid"));
+		NavGrid* grid = ValueToNavGrid(gridVal);
+		if (grid != nullptr) {
+			delete grid;
+			gridVal.GetDict().SetValue(String("_handle"), Value::zero);
+		}
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadNavGrid", i->GetFunc());
+
+	// Polygons
+
+	i = Intrinsic::Create("");
+	i->AddParam("points");
+	i->AddParam("x", Value::zero);
+	i->AddParam("y", Value::zero);
+	i->AddParam("rotation", Value::zero);
+	i->code = INTRINSIC_LAMBDA {
+		Polygon2D* poly = ValueToNewPolygon2D("LoadPolygon", context->GetVar(String("points")));
+		poly->SetTransform(context->GetVar(String("x")).DoubleValue(),
+			context->GetVar(String("y")).DoubleValue(),
+			context->GetVar(String("rotation")).DoubleValue());
+		return IntrinsicResult(Polygon2DToValue(poly));
+	};
+	raylibModule.SetValue("LoadPolygon", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("polygon");
+	i->code = INTRINSIC_LAMBDA {
+		Value polyVal = context->GetVar(String("polygon"));
+		Polygon2D* poly = ValueToPolygon2D(polyVal);
+		if (poly != nullptr) {
+			delete poly;
+			polyVal.GetDict().SetValue(String("_handle"), Value::zero);
+		}
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadPolygon", i->GetFunc());
 }
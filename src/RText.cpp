@@ -7,6 +7,7 @@
 
 #include "RaylibIntrinsics.h"
 #include "RaylibTypes.h"
+#include "FrameArena.h"
 #include "RawData.h"
 #include "raylib.h"
 #include "MiniscriptInterpreter.h"
@@ -19,7 +20,7 @@ using namespace MiniScript;
 // Helper function to extract codepoints from either a list of ints or a UTF-8 string
 // Returns allocated int array of codepoints, or nullptr if value is null
 // Sets codepointCount to the number of codepoints
-// Caller must delete[] the returned array
+// The array comes from the frame arena, so the caller need not free it
 static int* GetCodepointsFromValue(Value value, int* codepointCount) {
 	*codepointCount = 0;
 
@@ -37,7 +38,7 @@ static int* GetCodepointsFromValue(Value value, int* codepointCount) {
 		}
 
 		// Allocate buffer for codepoints
-		int* codepoints = new int[count];
+		int* codepoints = FrameArena::AllocArray<int>(count);
 
 		// Iterate over UTF-8 string and decode each codepoint
 		unsigned char* ptr = (unsigned char*)str.data();
@@ -57,7 +58,7 @@ static int* GetCodepointsFromValue(Value value, int* codepointCount) {
 			return nullptr;
 		}
 
-		int* codepoints = new int[count];
+		int* codepoints = FrameArena::AllocArray<int>(count);
 		for (int i = 0; i < count; i++) {
 			codepoints[i] = list[i].IntValue();
 		}
@@ -105,8 +106,6 @@ void AddRTextMethods(ValueDict raylibModule) {
 
 		Font font = LoadFontEx(path.c_str(), fontSize, codepoints, codepointCount);
 
-		if (codepoints) delete[] codepoints;
-
 		if (!IsFontValid(font)) return IntrinsicResult::Null;
 		return IntrinsicResult(FontToValue(font));
 	};
@@ -449,8 +448,6 @@ void AddRTextMethods(ValueDict raylibModule) {
 
 		Font font = LoadFontFromMemory(fileType.c_str(), data->bytes, data->length, fontSize, codepoints, codepointCount);
 
-		if (codepoints) delete[] codepoints;
-
 		if (!IsFontValid(font)) return IntrinsicResult::Null;
 		return IntrinsicResult(FontToValue(font));
 	};
@@ -482,8 +479,6 @@ void AddRTextMethods(ValueDict raylibModule) {
 		GlyphInfo* glyphs = LoadFontData(data->bytes, data->length, fontSize, codepoints, codepointCount, type);
 #endif /* RAYLIB_VERSION_GT(5, 5) */
 
-		if (codepoints) delete[] codepoints;
-
 		// Convert to MiniScript list
 		ValueList result;
 		if (glyphs) {
@@ -552,7 +547,6 @@ void AddRTextMethods(ValueDict raylibModule) {
 		char* utf8 = LoadUTF8(codepoints, count);
 		String result(utf8);
 		UnloadUTF8(utf8);
-		delete[] codepoints;
 
 		return IntrinsicResult(Value(result));
 	};
@@ -588,7 +582,6 @@ void AddRTextMethods(ValueDict raylibModule) {
 		if (!codepoints || count == 0) return IntrinsicResult::Null;
 
 		DrawTextCodepoints(font, codepoints, count, position, fontSize, spacing, tint);
-		delete[] codepoints;
 
 		return IntrinsicResult::Null;
 	};
@@ -611,8 +604,8 @@ void AddRTextMethods(ValueDict raylibModule) {
 		if (glyphCount == 0 || glyphCount != recsList.Count()) return IntrinsicResult::Null;
 
 		// Convert lists to arrays
-		GlyphInfo* glyphs = new GlyphInfo[glyphCount];
-		Rectangle* recs = new Rectangle[glyphCount];
+		GlyphInfo* glyphs = FrameArena::AllocArray<GlyphInfo>(glyphCount);
+		Rectangle* recs = FrameArena::AllocArray<Rectangle>(glyphCount);
 
 		for (int i = 0; i < glyphCount; i++) {
 			ValueDict glyphDict = glyphsList[i].GetDict();
@@ -625,15 +618,11 @@ void AddRTextMethods(ValueDict raylibModule) {
 			recs[i] = ValueToRectangle(recsList[i]);
 		}
 
-		// GenImageFontAtlas modifies the recs array, so we need to pass a pointer
-		Rectangle** recsPtr = new Rectangle*;
-		*recsPtr = recs;
-
-		Image atlas = GenImageFontAtlas(glyphs, recsPtr, glyphCount, fontSize, padding, packMethod);
-
-		delete[] glyphs;
-		delete[] *recsPtr;
-		delete recsPtr;
+		// GenImageFontAtlas replaces the recs pointer with its own RL_MALLOC'd
+		// array, which we must release with MemFree
+		Rectangle* atlasRecs = recs;
+		Image atlas = GenImageFontAtlas(glyphs, &atlasRecs, glyphCount, fontSize, padding, packMethod);
+		if (atlasRecs && atlasRecs != recs) MemFree(atlasRecs);
 
 		return IntrinsicResult(ImageToValue(atlas));
 	};
@@ -689,9 +678,9 @@ void AddRTextMethods(ValueDict raylibModule) {
 	i->AddParam("text");
 	i->AddParam("search");
 	i->code = INTRINSIC_LAMBDA {
-		const char* text = context->GetVar(String("text")).ToString().c_str();
-		const char* search = context->GetVar(String("search")).ToString().c_str();
-		int result = TextFindIndex(text, search);
+		String textStr = context->GetVar(String("text")).ToString();
+		String searchStr = context->GetVar(String("search")).ToString();
+		int result = TextFindIndex(textStr.c_str(), searchStr.c_str());
 		return IntrinsicResult(result);
 	};
 	raylibModule.SetValue("TextFindIndex", i->GetFunc());
@@ -770,13 +759,18 @@ void AddRTextMethods(ValueDict raylibModule) {
 		String delimiterStr = context->GetVar(String("delimiter")).ToString();
 		if (delimiterStr.LengthB() == 0) return IntrinsicResult(Value::null);
 
+		// Split natively rather than with raylib's TextSplit, whose static
+		// buffers limit the text length and the number of parts
 		char delimiter = delimiterStr.data()[0];
-		int count = 0;
-		const char** parts = (const char**)TextSplit(textStr.c_str(), delimiter, &count);
-
+		const char* text = textStr.c_str();
+		long lenB = textStr.LengthB();
 		ValueList result;
-		for (int i = 0; i < count; i++) {
-			result.Add(Value(String(parts[i])));
+		long start = 0;
+		for (long i = 0; i <= lenB; i++) {
+			if (i == lenB || text[i] == delimiter) {
+				result.Add(Value(String(text + start, i - start)));
+				start = i + 1;
+			}
 		}
 		return IntrinsicResult(result);
 	};
@@ -792,15 +786,14 @@ void AddRTextMethods(ValueDict raylibModule) {
 		int count = textList.Count();
 		if (count == 0) return IntrinsicResult(String());
 
-		char** parts = new char*[count];
+		// Join natively (raylib's TextJoin has a fixed-size buffer)
+		std::string joined;
 		for (int i = 0; i < count; i++) {
+			if (i > 0) joined.append(delimiterStr.c_str(), delimiterStr.LengthB());
 			String str = textList[i].ToString();
-			parts[i] = (char*)str.c_str();
+			joined.append(str.c_str(), str.LengthB());
 		}
-
-		String ret(TextJoin(parts, count, delimiterStr.c_str()));
-		delete[] parts;
-		return IntrinsicResult(ret);
+		return IntrinsicResult(String(joined.c_str(), (long)joined.size()));
 	};
 	raylibModule.SetValue("TextJoin", i->GetFunc());
 
@@ -7,14 +7,37 @@
 
 #include "RaylibIntrinsics.h"
 #include "RaylibTypes.h"
+#include "DynamicTexture.h"
+#include "FrameArena.h"
+#include "ImageFilter.h"
+#include "ImageJob.h"
+#include "ImageRaster.h"
 #include "RawData.h"
 #include "raylib.h"
 #include "MiniscriptInterpreter.h"
 #include "MiniscriptTypes.h"
 #include "macros.h"
+#include <algorithm>
 
 using namespace MiniScript;
 
+// Largest image (in pixels) a GenImage*Job may make
+static const double kMaxJobPixels = 16 * 1024 * 1024;
+
+// Start an image job for one of the GenImage*Job intrinsics, raising if the
+// image is too large or its pixels can't be allocated
+static Value StartImageJob(const char* funcName, ImageJobKind kind, int width, int height, const ImageJobParams& params) {
+	width = std::max(width, 0);
+	height = std::max(height, 0);
+	if ((double)width * height > kMaxJobPixels) RuntimeException(String(funcName) + ": image too large").raise();
+	ImageJob* job = new ImageJob(kind, width, height, params);
+	if (width > 0 && height > 0 && job->image.data == nullptr) {
+		delete job;
+		RuntimeException(String(funcName) + ": out of memory").raise();
+	}
+	return ImageJobToValue(job);
+}
+
 void AddRTexturesMethods(ValueDict raylibModule) {
 	Intrinsic *i;
 
@@ -55,11 +78,14 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i->AddParam("image");
 	i->code = INTRINSIC_LAMBDA {
 		Image img = ValueToImage(context->GetVar(String("image")));
-		UnloadImage(img);
-		// Free the heap-allocated Image struct
 		ValueDict map = context->GetVar(String("image")).GetDict();
 		Value handleVal = map.Lookup(String("_handle"), Value::zero);
 		Image* imgPtr = (Image*)(long)handleVal.IntValue();
+		if (OwnedByDynamicTexture(imgPtr)) {
+			RuntimeException("UnloadImage: this image belongs to a DynamicTexture; use UnloadDynamicTexture").raise();
+		}
+		UnloadImage(img);
+		// Free the heap-allocated Image struct
 		delete imgPtr;
 		return IntrinsicResult::Null;
 	};
@@ -90,16 +116,36 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i->AddParam("texture");
 	i->code = INTRINSIC_LAMBDA {
 		Texture tex = ValueToTexture(context->GetVar(String("texture")));
-		UnloadTexture(tex);
-		// Free the heap-allocated Texture struct
 		ValueDict map = context->GetVar(String("texture")).GetDict();
 		Value handleVal = map.Lookup(String("_handle"), Value::zero);
 		Texture* texPtr = (Texture*)(long)handleVal.IntValue();
+		if (OwnedByDynamicTexture(texPtr)) {
+			RuntimeException("UnloadTexture: this texture belongs to a DynamicTexture; use UnloadDynamicTexture").raise();
+		}
+		UnloadTexture(tex);
+		// Free the heap-allocated Texture struct
 		delete texPtr;
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("UnloadTexture", i->GetFunc());
 
+	i = Intrinsic::Create("");
+	i->AddParam("image");
+	i->code = INTRINSIC_LAMBDA {
+		Image img = ValueToImage(context->GetVar(String("image")));
+		if (img.data == nullptr) RuntimeException("LoadDynamicTexture: image required").raise();
+		return IntrinsicResult(DynamicTextureToValue(new DynamicTexture(img)));
+	};
+	raylibModule.SetValue("LoadDynamicTexture", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("dynamicTexture");
+	i->code = INTRINSIC_LAMBDA {
+		UnloadDynamicTexture(context->GetVar(String("dynamicTexture")));
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadDynamicTexture", i->GetFunc());
+
 	// Texture drawing
 
 	i = Intrinsic::Create("");
@@ -290,9 +336,13 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i->AddParam("image");
 	i->AddParam("crop");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
 		Rectangle crop = ValueToRectangle(context->GetVar(String("crop")));
-		ImageCrop(&img, crop);
+		ImageCrop(image, crop);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageCrop", i->GetFunc());
@@ -302,10 +352,14 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i->AddParam("newWidth");
 	i->AddParam("newHeight");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
 		int newWidth = context->GetVar(String("newWidth")).IntValue();
 		int newHeight = context->GetVar(String("newHeight")).IntValue();
-		ImageResize(&img, newWidth, newHeight);
+		ImageResize(image, newWidth, newHeight);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageResize", i->GetFunc());
@@ -315,10 +369,14 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i->AddParam("newWidth");
 	i->AddParam("newHeight");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
 		int newWidth = context->GetVar(String("newWidth")).IntValue();
 		int newHeight = context->GetVar(String("newHeight")).IntValue();
-		ImageResizeNN(&img, newWidth, newHeight);
+		ImageResizeNN(image, newWidth, newHeight);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageResizeNN", i->GetFunc());
@@ -326,8 +384,12 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("image");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
-		ImageFlipVertical(&img);
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
+		ImageFlipVertical(image);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageFlipVertical", i->GetFunc());
@@ -335,8 +397,12 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("image");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
-		ImageFlipHorizontal(&img);
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
+		ImageFlipHorizontal(image);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageFlipHorizontal", i->GetFunc());
@@ -344,8 +410,12 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("image");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
-		ImageRotateCW(&img);
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
+		ImageRotateCW(image);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageRotateCW", i->GetFunc());
@@ -353,8 +423,12 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("image");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
-		ImageRotateCCW(&img);
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
+		ImageRotateCCW(image);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageRotateCCW", i->GetFunc());
@@ -363,9 +437,13 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i->AddParam("image");
 	i->AddParam("color", ColorToValue(WHITE));
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageColorTint(&img, color);
+		ImageColorTint(image, color);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageColorTint", i->GetFunc());
@@ -373,8 +451,12 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("image");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
-		ImageColorInvert(&img);
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
+		ImageColorInvert(image);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageColorInvert", i->GetFunc());
@@ -382,8 +464,12 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i = Intrinsic::Create("");
 	i->AddParam("image");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
-		ImageColorGrayscale(&img);
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
+		ImageColorGrayscale(image);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageColorGrayscale", i->GetFunc());
@@ -392,9 +478,13 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i->AddParam("image");
 	i->AddParam("contrast");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
 		float contrast = context->GetVar(String("contrast")).FloatValue();
-		ImageColorContrast(&img, contrast);
+		ImageColorContrast(image, contrast);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageColorContrast", i->GetFunc());
@@ -403,9 +493,13 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i->AddParam("image");
 	i->AddParam("brightness");
 	i->code = INTRINSIC_LAMBDA {
-		Image img = ValueToImage(context->GetVar(String("image")));
+		ValueDict imageMap = context->GetVar(String("image")).GetDict();
+		Value handleVal = imageMap.Lookup(String("_handle"), Value::zero);
+		Image* image = (Image*)(long)handleVal.IntValue();
+		if (!image) return IntrinsicResult::Null;
 		int brightness = context->GetVar(String("brightness")).IntValue();
-		ImageColorBrightness(&img, brightness);
+		ImageColorBrightness(image, brightness);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageColorBrightness", i->GetFunc());
@@ -418,7 +512,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	i->code = INTRINSIC_LAMBDA {
 		Image dst = ValueToImage(context->GetVar(String("dst")));
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageClearBackground(&dst, color);
+		RasterClearBackground(&dst, color);
+		MarkImageDirty(dst);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageClearBackground", i->GetFunc());
@@ -434,6 +529,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		int y = context->GetVar(String("y")).IntValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
 		ImageDrawPixel(&dst, x, y, color);
+		MarkImageDirty(dst, Rectangle{ (float)x, (float)y, 1, 1 });
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawPixel", i->GetFunc());
@@ -447,6 +543,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Vector2 position = ValueToVector2(context->GetVar(String("position")));
 		Color color = ValueToColor(context->GetVar(String("color")));
 		ImageDrawPixelV(&dst, position, color);
+		MarkImageDirty(dst, Rectangle{ position.x, position.y, 1, 1 });
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawPixelV", i->GetFunc());
@@ -466,6 +563,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		int endPosY = context->GetVar(String("endPosY")).IntValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
 		ImageDrawLine(&dst, startPosX, startPosY, endPosX, endPosY, color);
+		Vector2 ends[2] = { { (float)startPosX, (float)startPosY }, { (float)endPosX, (float)endPosY } };
+		MarkImageDirty(dst, ends, 2);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawLine", i->GetFunc());
@@ -481,6 +580,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Vector2 end = ValueToVector2(context->GetVar(String("end")));
 		Color color = ValueToColor(context->GetVar(String("color")));
 		ImageDrawLineV(&dst, start, end, color);
+		Vector2 ends[2] = { start, end };
+		MarkImageDirty(dst, ends, 2);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawLineV", i->GetFunc());
@@ -497,7 +598,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		int centerY = context->GetVar(String("centerY")).IntValue();
 		int radius = context->GetVar(String("radius")).IntValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageDrawCircle(&dst, centerX, centerY, radius, color);
+		RasterDrawCircle(&dst, centerX, centerY, radius, color);
+		MarkImageDirty(dst, Rectangle{ (float)(centerX - radius), (float)(centerY - radius), (float)(2*radius), (float)(2*radius) });
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawCircle", i->GetFunc());
@@ -512,7 +614,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Vector2 center = ValueToVector2(context->GetVar(String("center")));
 		int radius = context->GetVar(String("radius")).IntValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageDrawCircleV(&dst, center, radius, color);
+		RasterDrawCircle(&dst, (int)center.x, (int)center.y, radius, color);
+		MarkImageDirty(dst, Rectangle{ (float)((int)center.x - radius), (float)((int)center.y - radius), (float)(2*radius), (float)(2*radius) });
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawCircleV", i->GetFunc());
@@ -531,7 +634,9 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		int width = context->GetVar(String("width")).IntValue();
 		int height = context->GetVar(String("height")).IntValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageDrawRectangle(&dst, posX, posY, width, height, color);
+		Rectangle rec = { (float)posX, (float)posY, (float)width, (float)height };
+		RasterDrawRectangleRec(&dst, rec, color);
+		MarkImageDirty(dst, rec);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawRectangle", i->GetFunc());
@@ -544,7 +649,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Image dst = ValueToImage(context->GetVar(String("dst")));
 		Rectangle rec = ValueToRectangle(context->GetVar(String("rec")));
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageDrawRectangleRec(&dst, rec, color);
+		RasterDrawRectangleRec(&dst, rec, color);
+		MarkImageDirty(dst, rec);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawRectangleRec", i->GetFunc());
@@ -559,7 +665,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Rectangle rec = ValueToRectangle(context->GetVar(String("rec")));
 		int thick = context->GetVar(String("thick")).IntValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageDrawRectangleLines(&dst, rec, thick, color);
+		RasterDrawRectangleLines(&dst, rec, thick, color);
+		MarkImageDirty(dst, rec);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawRectangleLines", i->GetFunc());
@@ -576,7 +683,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Rectangle srcRec = ValueToRectangle(context->GetVar(String("srcRec")));
 		Rectangle dstRec = ValueToRectangle(context->GetVar(String("dstRec")));
 		Color tint = ValueToColor(context->GetVar(String("tint")));
-		ImageDraw(&dst, src, srcRec, dstRec, tint);
+		RasterDraw(&dst, src, srcRec, dstRec, tint);
+		MarkImageDirty(dst, dstRec);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDraw", i->GetFunc());
@@ -595,11 +703,33 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		int posY = context->GetVar(String("posY")).IntValue();
 		int fontSize = context->GetVar(String("fontSize")).IntValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageDrawText(&dst, text.c_str(), posX, posY, fontSize, color);
+		// (spacing 1, as in raylib's ImageDrawText)
+		Rectangle area = RasterDrawTextEx(&dst, GetFontDefault(), text.c_str(), Vector2{ (float)posX, (float)posY }, (float)fontSize, 1.0f, color);
+		MarkImageDirty(dst, area);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawText", i->GetFunc());
 
+	i = Intrinsic::Create("");
+	i->AddParam("size", Value(512));
+	i->AddParam("reps", Value(20));
+	i->code = INTRINSIC_LAMBDA {
+		int size = context->GetVar(String("size")).IntValue();
+		int reps = context->GetVar(String("reps")).IntValue();
+		ValueList result;
+		for (const RasterBenchmarkResult& r : RunRasterBenchmark(size, reps)) {
+			ValueDict row;
+			row.SetValue(String("name"), Value(String(r.name.c_str())));
+			row.SetValue(String("pixels"), Value(r.pixels));
+			row.SetValue(String("native"), Value(r.nativeMPixels));
+			row.SetValue(String("raylib"), Value(r.raylibMPixels));
+			row.SetValue(String("match"), r.match ? Value::one : Value::zero);
+			result.Add(Value(row));
+		}
+		return IntrinsicResult(Value(result));
+	};
+	raylibModule.SetValue("ImageRasterBenchmark", i->GetFunc());
+
 	// Texture configuration
 
 	i = Intrinsic::Create("");
@@ -919,6 +1049,139 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 	};
 	raylibModule.SetValue("GenImageText", i->GetFunc());
 
+	// Image generation jobs (the generators above, a few rows per frame)
+
+	i = Intrinsic::Create("");
+	i->AddParam("width", Value(256));
+	i->AddParam("height", Value(256));
+	i->AddParam("direction", Value::zero);
+	i->AddParam("start", ColorToValue(BLACK));
+	i->AddParam("end", ColorToValue(WHITE));
+	i->code = INTRINSIC_LAMBDA {
+		int width = context->GetVar(String("width")).IntValue();
+		int height = context->GetVar(String("height")).IntValue();
+		ImageJobParams params = {};
+		params.direction = context->GetVar(String("direction")).IntValue();
+		params.colorA = ValueToColor(context->GetVar(String("start")));
+		params.colorB = ValueToColor(context->GetVar(String("end")));
+		return IntrinsicResult(StartImageJob("GenImageGradientLinearJob", ImageJobKind::GradientLinear, width, height, params));
+	};
+	raylibModule.SetValue("GenImageGradientLinearJob", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("width", Value(256));
+	i->AddParam("height", Value(256));
+	i->AddParam("density", Value(0.5));
+	i->AddParam("inner", ColorToValue(WHITE));
+	i->AddParam("outer", ColorToValue(BLACK));
+	i->code = INTRINSIC_LAMBDA {
+		int width = context->GetVar(String("width")).IntValue();
+		int height = context->GetVar(String("height")).IntValue();
+		ImageJobParams params = {};
+		params.density = context->GetVar(String("density")).FloatValue();
+		params.colorA = ValueToColor(context->GetVar(String("inner")));
+		params.colorB = ValueToColor(context->GetVar(String("outer")));
+		return IntrinsicResult(StartImageJob("GenImageGradientRadialJob", ImageJobKind::GradientRadial, width, height, params));
+	};
+	raylibModule.SetValue("GenImageGradientRadialJob", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("width", Value(256));
+	i->AddParam("height", Value(256));
+	i->AddParam("density", Value(0.5));
+	i->AddParam("inner", ColorToValue(WHITE));
+	i->AddParam("outer", ColorToValue(BLACK));
+	i->code = INTRINSIC_LAMBDA {
+		int width = context->GetVar(String("width")).IntValue();
+		int height = context->GetVar(String("height")).IntValue();
+		ImageJobParams params = {};
+		params.density = context->GetVar(String("density")).FloatValue();
+		params.colorA = ValueToColor(context->GetVar(String("inner")));
+		params.colorB = ValueToColor(context->GetVar(String("outer")));
+		return IntrinsicResult(StartImageJob("GenImageGradientSquareJob", ImageJobKind::GradientSquare, width, height, params));
+	};
+	raylibModule.SetValue("GenImageGradientSquareJob", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("width", Value(256));
+	i->AddParam("height", Value(256));
+	i->AddParam("checksX", Value(8));
+	i->AddParam("checksY", Value(8));
+	i->AddParam("col1", ColorToValue(WHITE));
+	i->AddParam("col2", ColorToValue(BLACK));
+	i->code = INTRINSIC_LAMBDA {
+		int width = context->GetVar(String("width")).IntValue();
+		int height = context->GetVar(String("height")).IntValue();
+		ImageJobParams params = {};
+		params.checksX = context->GetVar(String("checksX")).IntValue();
+		params.checksY = context->GetVar(String("checksY")).IntValue();
+		if (params.checksX < 1 || params.checksY < 1) RuntimeException("GenImageCheckedJob: checksX and checksY must be at least 1").raise();
+		params.colorA = ValueToColor(context->GetVar(String("col1")));
+		params.colorB = ValueToColor(context->GetVar(String("col2")));
+		return IntrinsicResult(StartImageJob("GenImageCheckedJob", ImageJobKind::Checked, width, height, params));
+	};
+	raylibModule.SetValue("GenImageCheckedJob", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("width", Value(256));
+	i->AddParam("height", Value(256));
+	i->AddParam("factor", Value(0.5));
+	i->code = INTRINSIC_LAMBDA {
+		int width = context->GetVar(String("width")).IntValue();
+		int height = context->GetVar(String("height")).IntValue();
+		ImageJobParams params = {};
+		params.factor = context->GetVar(String("factor")).FloatValue();
+		return IntrinsicResult(StartImageJob("GenImageWhiteNoiseJob", ImageJobKind::WhiteNoise, width, height, params));
+	};
+	raylibModule.SetValue("GenImageWhiteNoiseJob", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("width", Value(256));
+	i->AddParam("height", Value(256));
+	i->AddParam("tileSize", Value(32));
+	i->code = INTRINSIC_LAMBDA {
+		int width = context->GetVar(String("width")).IntValue();
+		int height = context->GetVar(String("height")).IntValue();
+		ImageJobParams params = {};
+		params.tileSize = context->GetVar(String("tileSize")).IntValue();
+		if (params.tileSize < 1) RuntimeException("GenImageCellularJob: tileSize must be at least 1").raise();
+		return IntrinsicResult(StartImageJob("GenImageCellularJob", ImageJobKind::Cellular, width, height, params));
+	};
+	raylibModule.SetValue("GenImageCellularJob", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("width");
+	i->AddParam("height");
+	i->AddParam("offsetX");
+	i->AddParam("offsetY");
+	i->AddParam("scale");
+	i->code = INTRINSIC_LAMBDA {
+		int width = context->GetVar(String("width")).IntValue();
+		int height = context->GetVar(String("height")).IntValue();
+		ImageJobParams params = {};
+		params.offsetX = context->GetVar(String("offsetX")).IntValue();
+		params.offsetY = context->GetVar(String("offsetY")).IntValue();
+		params.scale = context->GetVar(String("scale")).FloatValue();
+		return IntrinsicResult(StartImageJob("GenImagePerlinNoiseJob", ImageJobKind::PerlinNoise, width, height, params));
+	};
+	raylibModule.SetValue("GenImagePerlinNoiseJob", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("job");
+	i->code = INTRINSIC_LAMBDA {
+		UnloadImageJob(context->GetVar(String("job")));
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("UnloadImageJob", i->GetFunc());
+
+	i = Intrinsic::Create("");
+	i->AddParam("ms", Value(4));
+	i->code = INTRINSIC_LAMBDA {
+		SetImageJobBudget(context->GetVar(String("ms")).DoubleValue());
+		return IntrinsicResult::Null;
+	};
+	raylibModule.SetValue("SetImageJobBudget", i->GetFunc());
+
 	// Validation functions
 
 	i = Intrinsic::Create("");
@@ -1122,6 +1385,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Color color = ValueToColor(context->GetVar(String("color")));
 		float threshold = context->GetVar(String("threshold")).FloatValue();
 		ImageAlphaClear(image, color, threshold);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageAlphaClear", i->GetFunc());
@@ -1136,6 +1400,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		if (!image) return IntrinsicResult::Null;
 		float threshold = context->GetVar(String("threshold")).FloatValue();
 		ImageAlphaCrop(image, threshold);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageAlphaCrop", i->GetFunc());
@@ -1150,6 +1415,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		if (!image) return IntrinsicResult::Null;
 		Image alphaMask = ValueToImage(context->GetVar(String("alphaMask")));
 		ImageAlphaMask(image, alphaMask);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageAlphaMask", i->GetFunc());
@@ -1162,6 +1428,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Image* image = (Image*)(long)handleVal.IntValue();
 		if (!image) return IntrinsicResult::Null;
 		ImageAlphaPremultiply(image);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageAlphaPremultiply", i->GetFunc());
@@ -1178,6 +1445,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Color color = ValueToColor(context->GetVar(String("color")));
 		Color replace = ValueToColor(context->GetVar(String("replace")));
 		ImageColorReplace(image, color, replace);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageColorReplace", i->GetFunc());
@@ -1193,7 +1461,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Image* image = (Image*)(long)handleVal.IntValue();
 		if (!image) return IntrinsicResult::Null;
 		int blurSize = context->GetVar(String("blurSize")).IntValue();
-		ImageBlurGaussian(image, blurSize);
+		FilterBlurGaussian(image, blurSize);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageBlurGaussian", i->GetFunc());
@@ -1214,6 +1483,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		int bBpp = context->GetVar(String("bBpp")).IntValue();
 		int aBpp = context->GetVar(String("aBpp")).IntValue();
 		ImageDither(image, rBpp, gBpp, bBpp, aBpp);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDither", i->GetFunc());
@@ -1228,6 +1498,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		if (!image) return IntrinsicResult::Null;
 		int newFormat = context->GetVar(String("newFormat")).IntValue();
 		ImageFormat(image, newFormat);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageFormat", i->GetFunc());
@@ -1265,17 +1536,41 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		if (!image) return IntrinsicResult::Null;
 		ValueList kernelList = context->GetVar(String("kernel")).GetList();
 		int kernelSize = context->GetVar(String("kernelSize")).IntValue();
+		if (kernelList.Count() == 0) return IntrinsicResult::Null;
 		// Convert kernel list to float array
-		float* kernel = new float[kernelList.Count()];
+		float* kernel = FrameArena::AllocArray<float>(kernelList.Count());
 		for (int i = 0; i < kernelList.Count(); i++) {
 			kernel[i] = kernelList[i].FloatValue();
 		}
-		ImageKernelConvolution(image, kernel, kernelSize);
-		delete[] kernel;
+		FilterKernelConvolution(image, kernel, kernelSize);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageKernelConvolution", i->GetFunc());
 
+	i = Intrinsic::Create("");
+	i->AddParam("width", Value(960));
+	i->AddParam("height", Value(640));
+	i->AddParam("blurSize", Value(8));
+	i->AddParam("reps", Value(5));
+	i->code = INTRINSIC_LAMBDA {
+		int width = context->GetVar(String("width")).IntValue();
+		int height = context->GetVar(String("height")).IntValue();
+		int blurSize = context->GetVar(String("blurSize")).IntValue();
+		int reps = context->GetVar(String("reps")).IntValue();
+		ValueList result;
+		for (const FilterBenchmarkResult& r : RunFilterBenchmark(width, height, blurSize, reps)) {
+			ValueDict row;
+			row.SetValue(String("name"), Value(String(r.name.c_str())));
+			row.SetValue(String("native"), Value(r.nativeMs));
+			row.SetValue(String("raylib"), Value(r.raylibMs));
+			row.SetValue(String("maxDiff"), Value(r.maxDiff));
+			result.Add(Value(row));
+		}
+		return IntrinsicResult(Value(result));
+	};
+	raylibModule.SetValue("ImageFilterBenchmark", i->GetFunc());
+
 	i = Intrinsic::Create("");
 	i->AddParam("image");
 	i->code = INTRINSIC_LAMBDA {
@@ -1284,6 +1579,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Image* image = (Image*)(long)handleVal.IntValue();
 		if (!image) return IntrinsicResult::Null;
 		ImageMipmaps(image);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageMipmaps", i->GetFunc());
@@ -1306,6 +1602,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		int newHeight = context->GetVar(String("newHeight")).IntValue();
 		Color fill = ValueToColor(context->GetVar(String("fill")));
 		ImageResizeCanvas(image, newWidth, newHeight, offsetX, offsetY, fill);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageResizeCanvas", i->GetFunc());
@@ -1320,6 +1617,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		if (!image) return IntrinsicResult::Null;
 		int degrees = context->GetVar(String("degrees")).IntValue();
 		ImageRotate(image, degrees);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageRotate", i->GetFunc());
@@ -1332,6 +1630,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Image* image = (Image*)(long)handleVal.IntValue();
 		if (!image) return IntrinsicResult::Null;
 		ImageToPOT(image, BLACK);
+		MarkImageDirty(*image);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageToPOT", i->GetFunc());
@@ -1354,6 +1653,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		int radius = context->GetVar(String("radius")).IntValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
 		ImageDrawCircleLines(dst, centerX, centerY, radius, color);
+		MarkImageDirty(*dst, Rectangle{ (float)(centerX - radius), (float)(centerY - radius), (float)(2*radius), (float)(2*radius) });
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawCircleLines", i->GetFunc());
@@ -1372,6 +1672,7 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		int radius = context->GetVar(String("radius")).IntValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
 		ImageDrawCircleLinesV(dst, center, radius, color);
+		MarkImageDirty(*dst, Rectangle{ center.x - radius, center.y - radius, (float)(2*radius), (float)(2*radius) });
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawCircleLinesV", i->GetFunc());
@@ -1392,6 +1693,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		int thick = context->GetVar(String("thick")).IntValue();
 		Color color = ValueToColor(context->GetVar(String("color")));
 		ImageDrawLineEx(dst, start, end, thick, color);
+		Vector2 ends[2] = { start, end };
+		MarkImageDirty(*dst, ends, 2, (float)thick + 1);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawLineEx", i->GetFunc());
@@ -1407,7 +1710,10 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		if (!dst) return IntrinsicResult::Null;
 		Rectangle rec = ValueToRectangle(context->GetVar(String("rec")));
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageDrawRectangleV(dst, (Vector2){rec.x, rec.y}, (Vector2){rec.width, rec.height}, color);
+		// (ImageDrawRectangleV truncates to whole pixels)
+		rec = Rectangle{ (float)(int)rec.x, (float)(int)rec.y, (float)(int)rec.width, (float)(int)rec.height };
+		RasterDrawRectangleRec(dst, rec, color);
+		MarkImageDirty(*dst, rec);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawRectangleV", i->GetFunc());
@@ -1431,7 +1737,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		float fontSize = context->GetVar(String("fontSize")).FloatValue();
 		float spacing = context->GetVar(String("spacing")).FloatValue();
 		Color tint = ValueToColor(context->GetVar(String("tint")));
-		ImageDrawTextEx(dst, font, text.c_str(), position, fontSize, spacing, tint);
+		Rectangle area = RasterDrawTextEx(dst, font, text.c_str(), position, fontSize, spacing, tint);
+		MarkImageDirty(*dst, area);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawTextEx", i->GetFunc());
@@ -1451,7 +1758,9 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Vector2 v2 = ValueToVector2(context->GetVar(String("v2")));
 		Vector2 v3 = ValueToVector2(context->GetVar(String("v3")));
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageDrawTriangle(dst, v1, v2, v3, color);
+		RasterDrawTriangle(dst, v1, v2, v3, color);
+		Vector2 corners[3] = { v1, v2, v3 };
+		MarkImageDirty(*dst, corners, 3);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawTriangle", i->GetFunc());
@@ -1475,7 +1784,9 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Color c1 = ValueToColor(context->GetVar(String("c1")));
 		Color c2 = ValueToColor(context->GetVar(String("c2")));
 		Color c3 = ValueToColor(context->GetVar(String("c3")));
-		ImageDrawTriangleEx(dst, v1, v2, v3, c1, c2, c3);
+		RasterDrawTriangleEx(dst, v1, v2, v3, c1, c2, c3);
+		Vector2 corners[3] = { v1, v2, v3 };
+		MarkImageDirty(*dst, corners, 3);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawTriangleEx", i->GetFunc());
@@ -1492,13 +1803,13 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		ValueList pointsList = context->GetVar(String("points")).GetList();
 		int pointCount = pointsList.Count();
 		if (pointCount < 3) return IntrinsicResult::Null;
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageDrawTriangleFan(dst, points, pointCount, color);
-		delete[] points;
+		RasterDrawTriangleFan(dst, points, pointCount, color);
+		MarkImageDirty(*dst, points, pointCount);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawTriangleFan", i->GetFunc());
@@ -1519,6 +1830,8 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		Vector2 v3 = ValueToVector2(context->GetVar(String("v3")));
 		Color color = ValueToColor(context->GetVar(String("color")));
 		ImageDrawTriangleLines(dst, v1, v2, v3, color);
+		Vector2 corners[3] = { v1, v2, v3 };
+		MarkImageDirty(*dst, corners, 3);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawTriangleLines", i->GetFunc());
@@ -1535,13 +1848,13 @@ void AddRTexturesMethods(ValueDict raylibModule) {
 		ValueList pointsList = context->GetVar(String("points")).GetList();
 		int pointCount = pointsList.Count();
 		if (pointCount < 3) return IntrinsicResult::Null;
-		Vector2* points = new Vector2[pointCount];
+		Vector2* points = FrameArena::AllocArray<Vector2>(pointCount);
 		for (int i = 0; i < pointCount; i++) {
 			points[i] = ValueToVector2(pointsList[i]);
 		}
 		Color color = ValueToColor(context->GetVar(String("color")));
-		ImageDrawTriangleStrip(dst, points, pointCount, color);
-		delete[] points;
+		RasterDrawTriangleStrip(dst, points, pointCount, color);
+		MarkImageDirty(*dst, points, pointCount);
 		return IntrinsicResult::Null;
 	};
 	raylibModule.SetValue("ImageDrawTriangleStrip", i->GetFunc());
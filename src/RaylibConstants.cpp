@@ -7,6 +7,8 @@
 
 #include "RaylibIntrinsics.h"
 #include "RaylibTypes.h"
+#include "Synth.h"
+#include "InputEvents.h"
 #include "raylib.h"
 #include "MiniscriptTypes.h"
 
@@ -232,4 +234,27 @@ void AddConstants(ValueDict raylibModule) {
 	raylibModule.SetValue("LOG_ERROR", Value(LOG_ERROR));
 	raylibModule.SetValue("LOG_FATAL", Value(LOG_FATAL));
 	raylibModule.SetValue("LOG_NONE", Value(LOG_NONE));
+
+	// Add synthesizer waveform constants (MSRLWeb extension)
+	raylibModule.SetValue("SYNTH_SQUARE", Value(SYNTH_SQUARE));
+	raylibModule.SetValue("SYNTH_SAWTOOTH", Value(SYNTH_SAWTOOTH));
+	raylibModule.SetValue("SYNTH_TRIANGLE", Value(SYNTH_TRIANGLE));
+	raylibModule.SetValue("SYNTH_SINE", Value(SYNTH_SINE));
+	raylibModule.SetValue("SYNTH_NOISE", Value(SYNTH_NOISE));
+
+	// Add input event types (MSRLWeb extension)
+	raylibModule.SetValue("INPUT_EVENT_KEY_DOWN", Value(INPUT_EVENT_KEY_DOWN));
+	raylibModule.SetValue("INPUT_EVENT_KEY_UP", Value(INPUT_EVENT_KEY_UP));
+	raylibModule.SetValue("INPUT_EVENT_KEY_REPEAT", Value(INPUT_EVENT_KEY_REPEAT));
+	raylibModule.SetValue("INPUT_EVENT_CHAR", Value(INPUT_EVENT_CHAR));
+	raylibModule.SetValue("INPUT_EVENT_MOUSE_DOWN", Value(INPUT_EVENT_MOUSE_DOWN));
+	raylibModule.SetValue("INPUT_EVENT_MOUSE_UP", Value(INPUT_EVENT_MOUSE_UP));
+	raylibModule.SetValue("INPUT_EVENT_MOUSE_WHEEL", Value(INPUT_EVENT_MOUSE_WHEEL));
+	raylibModule.SetValue("INPUT_EVENT_TOUCH_DOWN", Value(INPUT_EVENT_TOUCH_DOWN));
+	raylibModule.SetValue("INPUT_EVENT_TOUCH_MOVE", Value(INPUT_EVENT_TOUCH_MOVE));
+	raylibModule.SetValue("INPUT_EVENT_TOUCH_UP", Value(INPUT_EVENT_TOUCH_UP));
+	raylibModule.SetValue("INPUT_EVENT_GAMEPAD_DOWN", Value(INPUT_EVENT_GAMEPAD_DOWN));
+	raylibModule.SetValue("INPUT_EVENT_GAMEPAD_UP", Value(INPUT_EVENT_GAMEPAD_UP));
+	raylibModule.SetValue("INPUT_EVENT_GAMEPAD_CONNECTED", Value(INPUT_EVENT_GAMEPAD_CONNECTED));
+	raylibModule.SetValue("INPUT_EVENT_GAMEPAD_DISCONNECTED", Value(INPUT_EVENT_GAMEPAD_DISCONNECTED));
 }
@@ -8,6 +8,18 @@
 #include "RaylibIntrinsics.h"
 #include "RaylibTypes.h"
 #include "RawData.h"
+#include "Synth.h"
+#include "SoundPool.h"
+#include "AudioEffects.h"
+#include "InputMap.h"
+#include "CollisionMask.h"
+#include "NavGrid.h"
+#include "Polygon2D.h"
+#include "DenseMatrix.h"
+#include "DynamicTexture.h"
+#include "ImageJob.h"
+#include "Noise.h"
+#include "Path2D.h"
 #include "raylib.h"
 #include "MiniscriptInterpreter.h"
 #include "MiniscriptTypes.h"
@@ -30,6 +42,9 @@ void AddRTexturesMethods(ValueDict raylibModule);
 // And one more for all the constants
 void AddConstants(ValueDict raylibModule);
 
+// Hidden intrinsics backing the assets/lib modules (LibIntrinsics.cpp)
+void AddLibIntrinsics();
+
 // Add intrinsics to the interpreter
 void AddRaylibIntrinsics() {
 	Intrinsic *f;
@@ -59,7 +74,45 @@ void AddRaylibIntrinsics() {
 	f = Intrinsic::Create("AudioStream");
 	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(AudioStreamClass()); };
 
+	f = Intrinsic::Create("SoundPool");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(SoundPoolClass()); };
+
+	f = Intrinsic::Create("SynthVoice");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(SynthVoiceClass()); };
+
+	f = Intrinsic::Create("AudioEffect");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(AudioEffectClass()); };
+
+	f = Intrinsic::Create("InputMap");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(InputMapClass()); };
+
+	f = Intrinsic::Create("DenseMatrix");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(DenseMatrixClass()); };
+
+	f = Intrinsic::Create("Path");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(PathClass()); };
+
+	f = Intrinsic::Create("DynamicTexture");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(DynamicTextureClass()); };
+
+	f = Intrinsic::Create("ImageJob");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(ImageJobClass()); };
+
+	f = Intrinsic::Create("Noise");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(NoiseClass()); };
+
+	f = Intrinsic::Create("CollisionMask");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(CollisionMaskClass()); };
+
+	f = Intrinsic::Create("NavGrid");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(NavGridClass()); };
+
+	f = Intrinsic::Create("Polygon");
+	f->code = INTRINSIC_LAMBDA { return IntrinsicResult(PolygonClass()); };
+
 	// Create and register the main raylib module
+	AddLibIntrinsics();
+
 	f = Intrinsic::Create("raylib");
 	f->code = INTRINSIC_LAMBDA {
 		static ValueDict raylibModule;
@@ -0,0 +1,162 @@
+//
+//  SoundPool.cpp
+//  MSRLWeb
+//
+//  SoundPool implementation
+//
+
+#include "SoundPool.h"
+#include "MiniscriptInterpreter.h"
+#include "macros.h"
+
+using namespace MiniScript;
+
+//--------------------------------------------------------------------------------
+// SoundPool implementation
+//--------------------------------------------------------------------------------
+
+SoundPool::SoundPool(Sound source, int voiceCount)
+	: plays(0), steals(0), peakActive(0) {
+	if (voiceCount < 1) voiceCount = 1;
+	voices.reserve(voiceCount);
+	for (int i = 0; i < voiceCount; i++) {
+		voices.push_back(LoadSoundAlias(source));
+		startedAt.push_back(-1);
+	}
+}
+
+SoundPool::~SoundPool() {
+	for (size_t i = 0; i < voices.size(); i++) {
+		StopSound(voices[i]);
+		UnloadSoundAlias(voices[i]);
+	}
+}
+
+int SoundPool::Play(float volume, float pan, float pitch) {
+	// Prefer a free voice; otherwise steal the one that started first
+	int choice = -1;
+	int oldest = 0;
+	int active = 0;
+	for (int i = 0; i < (int)voices.size(); i++) {
+		if (IsSoundPlaying(voices[i])) {
+			active++;
+			if (startedAt[i] < startedAt[oldest]) oldest = i;
+		} else if (choice < 0) {
+			choice = i;
+		}
+	}
+	if (choice < 0) {
+		choice = oldest;
+		StopSound(voices[choice]);
+		steals++;
+	} else {
+		active++;
+	}
+	if (active > peakActive) peakActive = active;
+
+	Sound voice = voices[choice];
+	SetSoundVolume(voice, volume);
+	SetSoundPan(voice, pan);
+	SetSoundPitch(voice, pitch);
+	PlaySound(voice);
+	startedAt[choice] = plays++;
+	return choice;
+}
+
+void SoundPool::Stop() {
+	for (size_t i = 0; i < voices.size(); i++) StopSound(voices[i]);
+}
+
+int SoundPool::ActiveVoices() const {
+	int count = 0;
+	for (size_t i = 0; i < voices.size(); i++) {
+		if (IsSoundPlaying(voices[i])) count++;
+	}
+	return count;
+}
+
+//--------------------------------------------------------------------------------
+// MiniScript SoundPool class
+//--------------------------------------------------------------------------------
+
+static String kHandle("_handle");
+
+// Helper: get SoundPool from self
+static SoundPool* GetSoundPool(Context* context) {
+	SoundPool* pool = ValueToSoundPool(context->GetVar(String("self")));
+	if (pool == nullptr) RuntimeException("SoundPool required for self parameter").raise();
+	return pool;
+}
+
+ValueDict SoundPoolClass() {
+	static ValueDict poolClass;
+
+	if (poolClass.Count() > 0) return poolClass;
+
+	poolClass.SetValue(kHandle, Value::zero);
+
+	Intrinsic* f;
+
+	// SoundPool.play
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->AddParam("volume", Value(1.0));
+	f->AddParam("pan", Value(0.5));
+	f->AddParam("pitch", Value(1.0));
+	f->code = INTRINSIC_LAMBDA {
+		SoundPool* pool = GetSoundPool(context);
+		float volume = context->GetVar(String("volume")).FloatValue();
+		float pan = context->GetVar(String("pan")).FloatValue();
+		float pitch = context->GetVar(String("pitch")).FloatValue();
+		return IntrinsicResult(pool->Play(volume, pan, pitch));
+	};
+	poolClass.SetValue(String("play"), f->GetFunc());
+
+	// SoundPool.stop
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		GetSoundPool(context)->Stop();
+		return IntrinsicResult::Null;
+	};
+	poolClass.SetValue(String("stop"), f->GetFunc());
+
+	// SoundPool.isPlaying
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		return IntrinsicResult(GetSoundPool(context)->ActiveVoices() > 0);
+	};
+	poolClass.SetValue(String("isPlaying"), f->GetFunc());
+
+	// SoundPool.stats
+	f = Intrinsic::Create("");
+	f->AddParam("self");
+	f->code = INTRINSIC_LAMBDA {
+		SoundPool* pool = GetSoundPool(context);
+		ValueDict result;
+		result.SetValue(String("voices"), Value(pool->VoiceCount()));
+		result.SetValue(String("active"), Value(pool->ActiveVoices()));
+		result.SetValue(String("peakActive"), Value(pool->peakActive));
+		result.SetValue(String("plays"), Value((double)pool->plays));
+		result.SetValue(String("steals"), Value((double)pool->steals));
+		return IntrinsicResult(result);
+	};
+	poolClass.SetValue(String("stats"), f->GetFunc());
+
+	return poolClass;
+}
+
+Value SoundPoolToValue(SoundPool* pool) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, SoundPoolClass());
+	map.SetValue(kHandle, Value((long)pool));
+	return Value(map);
+}
+
+SoundPool* ValueToSoundPool(Value value) {
+	if (value.type != ValueType::Map) return nullptr;
+	ValueDict map = value.GetDict();
+	Value handleVal = map.Lookup(kHandle, Value::zero);
+	return (SoundPool*)(long)handleVal.IntValue();
+}
@@ -0,0 +1,51 @@
+//
+//  SoundPool.h
+//  MSRLWeb
+//
+//  SoundPool: a fixed set of sound aliases sharing one source Sound, so the
+//  same effect can play several overlapping times.  Play picks a free voice,
+//  or steals the one that started longest ago.
+//
+
+#ifndef SOUNDPOOL_H
+#define SOUNDPOOL_H
+
+#include "raylib.h"
+#include "MiniscriptTypes.h"
+#include <vector>
+
+class SoundPool {
+public:
+	// Create voiceCount aliases of source (which must outlive the pool)
+	SoundPool(Sound source, int voiceCount);
+
+	// Unloads the aliases (but not the source sound)
+	~SoundPool();
+
+	// Play on a free voice (or steal the oldest); returns the voice index used
+	int Play(float volume, float pan, float pitch);
+
+	// Stop all voices
+	void Stop();
+
+	int VoiceCount() const { return (int)voices.size(); }
+	int ActiveVoices() const;
+
+	// Statistics
+	long plays;       // total Play calls
+	long steals;      // plays that had to cut off a voice still playing
+	int peakActive;   // most voices seen playing at once
+
+private:
+	std::vector<Sound> voices;
+	std::vector<long> startedAt;  // value of `plays` when each voice last started
+};
+
+// Get the SoundPool class (MiniScript intrinsic class)
+MiniScript::ValueDict SoundPoolClass();
+
+// Convert between MiniScript Value and SoundPool
+MiniScript::Value SoundPoolToValue(SoundPool* pool);
+SoundPool* ValueToSoundPool(MiniScript::Value value);
+
+#endif // SOUNDPOOL_H
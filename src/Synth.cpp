@@ -0,0 +1,251 @@
+//
+//  Synth.cpp
+//  MSRLWeb
+//
+//  Native synthesizer implementation
+//
+
+#include "Synth.h"
+#include "MiniscriptInterpreter.h"
+#include <math.h>
+
+using namespace MiniScript;
+
+static const double kTwoPi = 6.283185307179586;
+
+//--------------------------------------------------------------------------------
+// SynthParams
+//--------------------------------------------------------------------------------
+
+SynthParams::SynthParams()
+	: waveform(SYNTH_SQUARE), frequency(440), sweep(0), minFrequency(20), maxFrequency(20000),
+	  duty(0.5f), dutySweep(0), attack(0.01f), decay(0.1f), sustain(0.5f), hold(0.1f),
+	  release(0.1f), volume(0.5f) {
+}
+
+float SynthParams::Duration() const {
+	return attack + decay + (hold > 0 ? hold : 0) + release;
+}
+
+//--------------------------------------------------------------------------------
+// SynthVoice
+//--------------------------------------------------------------------------------
+
+SynthVoice::SynthVoice(const SynthParams& params)
+	: params(params), stage(IDLE), stageTime(0), level(0), releaseFrom(0),
+	  phase(0), freq(params.frequency), duty(params.duty),
+	  noiseState(0x12345678), noiseValue(0), noiseStep(-1) {
+}
+
+void SynthVoice::Trigger(float frequency) {
+	stage = ATTACK;
+	stageTime = 0;
+	level = 0;
+	phase = 0;
+	freq = (frequency > 0 ? frequency : params.frequency);
+	duty = params.duty;
+	noiseStep = -1;
+}
+
+void SynthVoice::Release() {
+	if (stage == IDLE || stage == RELEASE) return;
+	stage = RELEASE;
+	stageTime = 0;
+	releaseFrom = level;
+}
+
+int SynthVoice::Render(float* out, int frameCount, int sampleRate) {
+	const float dt = 1.0f / sampleRate;
+	const double sweepFactor = pow(2.0, params.sweep * (double)dt);
+	const float dutyStep = params.dutySweep * dt;
+	const float volume = params.volume;
+	int activeFrames = 0;
+
+	for (int i = 0; i < frameCount; i++) {
+		if (stage == IDLE) {
+			out[i] = 0;
+			continue;
+		}
+
+		// Envelope
+		stageTime += dt;
+		switch (stage) {
+			case ATTACK:
+				level = (params.attack > 0 ? stageTime / params.attack : 1);
+				if (stageTime >= params.attack) { stage = DECAY; stageTime = 0; level = 1; }
+				break;
+			case DECAY:
+				level = 1 - (1 - params.sustain) * (params.decay > 0 ? stageTime / params.decay : 1);
+				if (stageTime >= params.decay) { stage = SUSTAIN; stageTime = 0; level = params.sustain; }
+				break;
+			case SUSTAIN:
+				level = params.sustain;
+				if (params.hold >= 0 && stageTime >= params.hold) Release();
+				break;
+			case RELEASE:
+				level = (params.release > 0 ? releaseFrom * (1 - stageTime / params.release) : 0);
+				if (stageTime >= params.release) { stage = IDLE; level = 0; }
+				break;
+			default:
+				break;
+		}
+
+		// Oscillator
+		float sample;
+		switch (params.waveform) {
+			case SYNTH_SAWTOOTH:
+				sample = (float)(2 * phase - 1);
+				break;
+			case SYNTH_TRIANGLE:
+				sample = (float)(phase < 0.5 ? 4 * phase - 1 : 3 - 4 * phase);
+				break;
+			case SYNTH_SINE:
+				sample = (float)sin(kTwoPi * phase);
+				break;
+			case SYNTH_NOISE: {
+				// New random value every sixteenth of a cycle, so pitch still matters
+				int step = (int)(phase * 16);
+				if (step != noiseStep) {
+					noiseStep = step;
+					noiseState ^= noiseState << 13;
+					noiseState ^= noiseState >> 17;
+					noiseState ^= noiseState << 5;
+					noiseValue = (noiseState & 0xFFFF) / 32767.5f - 1;
+				}
+				sample = noiseValue;
+				break;
+			}
+			default:
+				sample = (phase < duty ? 1.0f : -1.0f);
+				break;
+		}
+		out[i] = sample * level * volume;
+		activeFrames = i + 1;
+
+		// Advance phase, pitch sweep and duty sweep
+		phase += freq * dt;
+		if (phase >= 1) phase -= floor(phase);
+		if (params.sweep != 0) {
+			freq *= sweepFactor;
+			if (freq > params.maxFrequency) freq = params.maxFrequency;
+			if (freq < params.minFrequency) {
+				freq = params.minFrequency;
+				if (params.sweep < 0) stage = IDLE;  // falling sweep ends the note
+			}
+		}
+		if (dutyStep != 0) {
+			duty += dutyStep;
+			if (duty < 0.01f) duty = 0.01f;
+			if (duty > 0.99f) duty = 0.99f;
+		}
+	}
+	return activeFrames;
+}
+
+//--------------------------------------------------------------------------------
+// Sample conversion
+//--------------------------------------------------------------------------------
+
+void ConvertSamplesFromFloat(const float* src, void* dest, int sampleCount, int sampleSize) {
+	if (sampleSize == 8) {
+		unsigned char* out = (unsigned char*)dest;
+		for (int i = 0; i < sampleCount; i++) {
+			float s = src[i];
+			if (s > 1) s = 1; else if (s < -1) s = -1;
+			out[i] = (unsigned char)(128 + s * 127);
+		}
+	} else if (sampleSize == 16) {
+		short* out = (short*)dest;
+		for (int i = 0; i < sampleCount; i++) {
+			float s = src[i];
+			if (s > 1) s = 1; else if (s < -1) s = -1;
+			out[i] = (short)(s * 32767);
+		}
+	} else {
+		float* out = (float*)dest;
+		for (int i = 0; i < sampleCount; i++) out[i] = src[i];
+	}
+}
+
+void ConvertSamplesToFloat(const void* src, float* dest, int sampleCount, int sampleSize) {
+	if (sampleSize == 8) {
+		const unsigned char* in = (const unsigned char*)src;
+		for (int i = 0; i < sampleCount; i++) dest[i] = (in[i] - 128) / 127.0f;
+	} else if (sampleSize == 16) {
+		const short* in = (const short*)src;
+		for (int i = 0; i < sampleCount; i++) dest[i] = in[i] / 32767.0f;
+	} else {
+		const float* in = (const float*)src;
+		for (int i = 0; i < sampleCount; i++) dest[i] = in[i];
+	}
+}
+
+//--------------------------------------------------------------------------------
+// MiniScript glue
+//--------------------------------------------------------------------------------
+
+static String kHandle("_handle");
+
+int ValueToSynthWaveform(Value value) {
+	if (value.type != ValueType::String) return value.IntValue();
+	String name = value.ToString().ToLower();
+	if (name == "square") return SYNTH_SQUARE;
+	if (name == "saw" || name == "sawtooth") return SYNTH_SAWTOOTH;
+	if (name == "triangle") return SYNTH_TRIANGLE;
+	if (name == "sine") return SYNTH_SINE;
+	if (name == "noise") return SYNTH_NOISE;
+	RuntimeException(String("Synth: unknown waveform \"") + name + "\"").raise();
+	return SYNTH_SQUARE;
+}
+
+SynthParams ValueToSynthParams(Value value) {
+	SynthParams p;
+	if (value.type != ValueType::Map) return p;
+	ValueDict map = value.GetDict();
+	Value v;
+
+#define READ_PARAM(NAME) \
+	v = map.Lookup(String(#NAME), Value::null); \
+	if (!v.IsNull()) p.NAME = v.FloatValue();
+
+	v = map.Lookup(String("waveform"), Value::null);
+	if (!v.IsNull()) p.waveform = ValueToSynthWaveform(v);
+	READ_PARAM(frequency)
+	READ_PARAM(sweep)
+	READ_PARAM(minFrequency)
+	READ_PARAM(maxFrequency)
+	READ_PARAM(duty)
+	READ_PARAM(dutySweep)
+	READ_PARAM(attack)
+	READ_PARAM(decay)
+	READ_PARAM(sustain)
+	READ_PARAM(hold)
+	READ_PARAM(release)
+	READ_PARAM(volume)
+
+#undef READ_PARAM
+
+	return p;
+}
+
+ValueDict SynthVoiceClass() {
+	static ValueDict map;
+	if (map.Count() == 0) {
+		map.SetValue(kHandle, Value::zero);
+	}
+	return map;
+}
+
+Value SynthVoiceToValue(SynthVoice* voice) {
+	ValueDict map;
+	map.SetValue(Value::magicIsA, SynthVoiceClass());
+	map.SetValue(kHandle, Value((long)voice));
+	return Value(map);
+}
+
+SynthVoice* ValueToSynthVoice(Value value) {
+	if (value.type != ValueType::Map) return nullptr;
+	ValueDict map = value.GetDict();
+	Value handleVal = map.Lookup(kHandle, Value::zero);
+	return (SynthVoice*)(long)handleVal.IntValue();
+}
@@ -0,0 +1,102 @@
+//
+//  Synth.h
+//  MSRLWeb
+//
+//  Simple native synthesizer (sfxr-style): oscillators, ADSR envelope,
+//  pitch sweep and duty cycle.  Renders into Waves offline, or into an
+//  AudioStream a block at a time.
+//
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include "MiniscriptTypes.h"
+#include <stdint.h>
+
+enum SynthWaveform {
+	SYNTH_SQUARE = 0,
+	SYNTH_SAWTOOTH,
+	SYNTH_TRIANGLE,
+	SYNTH_SINE,
+	SYNTH_NOISE
+};
+
+// Parameters describing one sound.  All times are in seconds.
+struct SynthParams {
+	int waveform;         // one of SynthWaveform
+	float frequency;      // starting pitch, in Hz
+	float sweep;          // pitch slide, in octaves per second (negative = falling)
+	float minFrequency;   // sweep never goes below this (a falling sweep ends the note here)
+	float maxFrequency;   // sweep never goes above this
+	float duty;           // square wave duty cycle, 0-1
+	float dutySweep;      // change in duty cycle per second
+	float attack;         // envelope: time to rise from 0 to full level
+	float decay;          // envelope: time to fall from full to sustain level
+	float sustain;        // envelope: sustain level, 0-1
+	float hold;           // envelope: time at sustain level before release (< 0: until released)
+	float release;        // envelope: time to fall from sustain level to 0
+	float volume;         // overall amplitude, 0-1
+
+	SynthParams();
+
+	// Total length of a one-shot render (attack + decay + hold + release)
+	float Duration() const;
+};
+
+// A playing synth voice: oscillator and envelope state
+class SynthVoice {
+public:
+	SynthParams params;
+
+	SynthVoice(const SynthParams& params);
+
+	// Restart the envelope (and pitch) from the beginning.
+	// If frequency > 0, it overrides params.frequency for this note.
+	void Trigger(float frequency = 0);
+
+	// Begin the release stage now
+	void Release();
+
+	// True until the release stage has finished
+	bool IsActive() const { return stage != IDLE; }
+
+	// Render frameCount mono samples in the range -1 to 1.
+	// Returns the number of frames before the voice went idle (the rest is silence).
+	int Render(float* out, int frameCount, int sampleRate);
+
+private:
+	enum Stage { IDLE, ATTACK, DECAY, SUSTAIN, RELEASE };
+	Stage stage;
+	float stageTime;      // seconds spent in the current stage
+	float level;          // current envelope level
+	float releaseFrom;    // level at the start of the release stage
+	double phase;         // oscillator phase, 0-1
+	double freq;          // current frequency, Hz
+	float duty;           // current duty cycle
+	uint32_t noiseState;  // xorshift state for the noise oscillator
+	float noiseValue;     // current noise sample
+	int noiseStep;        // which sixteenth of the cycle noiseValue belongs to
+};
+
+// Convert float samples (-1 to 1) to the given raylib sample size (8, 16 or 32 bits)
+void ConvertSamplesFromFloat(const float* src, void* dest, int sampleCount, int sampleSize);
+
+// Convert samples of the given raylib sample size (8, 16 or 32 bits) to float (-1 to 1)
+void ConvertSamplesToFloat(const void* src, float* dest, int sampleCount, int sampleSize);
+
+// MiniScript glue
+
+// Read a waveform given as a SynthWaveform value or a name ("square", "saw", etc.)
+int ValueToSynthWaveform(MiniScript::Value value);
+
+// Read a parameter map (any missing keys keep their defaults)
+SynthParams ValueToSynthParams(MiniScript::Value value);
+
+// Get the SynthVoice class (MiniScript intrinsic class)
+MiniScript::ValueDict SynthVoiceClass();
+
+// Convert between MiniScript Value and SynthVoice
+MiniScript::Value SynthVoiceToValue(SynthVoice* voice);
+SynthVoice* ValueToSynthVoice(MiniScript::Value value);
+
+#endif // SYNTH_H
@@ -0,0 +1,301 @@
+//
+//  TextUtil.cpp
+//  MSRLWeb
+//
+//  String kernel implementation
+//
+
+#include "TextUtil.h"
+#include <algorithm>
+#include <string.h>
+
+static inline bool IsContinuation(unsigned char b) {
+	return (b & 0xC0) == 0x80;
+}
+
+// Decode the character starting at byte p; sets *charLen to its length in
+// bytes.  A stray byte that isn't valid UTF-8 decodes as itself.
+static unsigned long DecodeAt(const char* s, long lenB, long p, long* charLen) {
+	unsigned char b = (unsigned char)s[p];
+	int extra = 0;
+	unsigned long cp = b;
+	if (b >= 0xF0) { extra = 3; cp = b & 0x07; }
+	else if (b >= 0xE0) { extra = 2; cp = b & 0x0F; }
+	else if (b >= 0xC0) { extra = 1; cp = b & 0x1F; }
+	if (extra == 0 || p + extra >= lenB) {
+		*charLen = 1;
+		return b;
+	}
+	for (int k = 1; k <= extra; k++) {
+		unsigned char c = (unsigned char)s[p + k];
+		if (!IsContinuation(c)) {
+			*charLen = 1;
+			return b;
+		}
+		cp = (cp << 6) | (c & 0x3F);
+	}
+	*charLen = 1 + extra;
+	return cp;
+}
+
+long Utf8CharCount(const char* s, long lenB) {
+	long count = 0;
+	for (long i = 0; i < lenB; i++) {
+		if (!IsContinuation((unsigned char)s[i])) count++;
+	}
+	return count;
+}
+
+long Utf8ByteOffset(const char* s, long lenB, long charIndex) {
+	if (charIndex <= 0) return 0;
+	long count = 0;
+	for (long i = 0; i < lenB; i++) {
+		if (!IsContinuation((unsigned char)s[i])) {
+			if (count == charIndex) return i;
+			count++;
+		}
+	}
+	return lenB;
+}
+
+void Utf8CharOffsets(const char* s, long lenB, std::vector<long>& out) {
+	out.clear();
+	out.reserve(lenB + 1);
+	for (long i = 0; i < lenB; i++) {
+		if (!IsContinuation((unsigned char)s[i])) out.push_back(i);
+	}
+	out.push_back(lenB);
+}
+
+void Utf8Decode(const char* s, long lenB, std::vector<unsigned long>& out) {
+	out.clear();
+	out.reserve(lenB);
+	long charLen;
+	for (long p = 0; p < lenB; p += charLen) out.push_back(DecodeAt(s, lenB, p, &charLen));
+}
+
+bool TextIsNumeric(const char* s, long lenB) {
+	// Same state machine as the script version.  Any non-ASCII character
+	// makes the text non-numeric, so it's enough to look at bytes.
+	enum { kPreNum, kWholePart, kDecPart, kPreExp, kExponent } state = kPreNum;
+	for (long i = 0; i < lenB; i++) {
+		unsigned char c = (unsigned char)s[i];
+		bool digit = (c >= '0' && c <= '9');
+		switch (state) {
+			case kPreNum:
+				if (c <= ' ') continue;
+				if (c == '+' || c == '-' || digit) state = kWholePart;
+				else if (c == '.') state = kDecPart;
+				else return false;
+				break;
+			case kWholePart:
+				if (digit) continue;
+				if (c == '.') state = kDecPart;
+				else if (c == 'E') state = kPreExp;
+				else return false;
+				break;
+			case kDecPart:
+				if (digit) continue;
+				if (c == 'E') state = kPreExp;
+				else return false;
+				break;
+			case kPreExp:
+				if (c == '+' || c == '-' || digit) state = kExponent;
+				else return false;
+				break;
+			case kExponent:
+				if (!digit) return false;
+				break;
+		}
+	}
+	return state != kPreNum && state != kPreExp;
+}
+
+void TextTrimRange(const char* s, long lenB, const char* chars, long charsLenB,
+				   bool left, bool right, long* start, long* end) {
+	// Build the set: a table for ASCII, and a short list for anything else
+	bool ascii[128] = { false };
+	std::vector<unsigned long> others;
+	long charLen;
+	for (long p = 0; p < charsLenB; p += charLen) {
+		unsigned long cp = DecodeAt(chars, charsLenB, p, &charLen);
+		if (cp < 128) ascii[cp] = true;
+		else others.push_back(cp);
+	}
+	auto inSet = [&](unsigned long cp) {
+		if (cp < 128) return ascii[cp];
+		return std::find(others.begin(), others.end(), cp) != others.end();
+	};
+
+	long p0 = 0, p1 = lenB;
+	if (left) {
+		while (p0 < p1 && inSet(DecodeAt(s, lenB, p0, &charLen))) p0 += charLen;
+	}
+	if (right) {
+		while (p1 > p0) {
+			long q = p1 - 1;
+			while (q > p0 && IsContinuation((unsigned char)s[q])) q--;
+			if (!inSet(DecodeAt(s, lenB, q, &charLen))) break;
+			p1 = q;
+		}
+	}
+	*start = p0;
+	*end = p1;
+}
+
+long TextLastIndexOf(const char* s, long lenB, const char* sub, long subLenB, long fromIndex) {
+	if (fromIndex < 0) return -1;
+	if (subLenB == 0) return fromIndex;		// (an empty slice matches anywhere)
+	std::vector<long> offsets;
+	Utf8CharOffsets(s, lenB, offsets);
+	long charCount = (long)offsets.size() - 1;
+	for (long i = std::min(fromIndex, charCount - 1); i >= 0; i--) {
+		long off = offsets[i];
+		if (off + subLenB <= lenB && memcmp(s + off, sub, subLenB) == 0) return i;
+	}
+	return -1;
+}
+
+std::string TextCompress(const char* s, long lenB, const char* run, long runLenB) {
+	std::string result;
+	result.reserve(lenB);
+	if (runLenB == 0) return result.assign(s, lenB);
+	long p = 0;
+	while (p < lenB) {
+		if (p + runLenB <= lenB && memcmp(s + p, run, runLenB) == 0) {
+			result.append(run, runLenB);
+			p += runLenB;
+			while (p + runLenB <= lenB && memcmp(s + p, run, runLenB) == 0) p += runLenB;
+		} else {
+			result += s[p++];
+		}
+	}
+	return result;
+}
+
+std::string TextReverse(const char* s, long lenB) {
+	std::string result;
+	result.reserve(lenB);
+	long end = lenB;
+	while (end > 0) {
+		long start = end - 1;
+		while (start > 0 && IsContinuation((unsigned char)s[start])) start--;
+		result.append(s + start, end - start);
+		end = start;
+	}
+	return result;
+}
+
+std::vector<TextSpan> TextWrap(const char* s, long lenB, long width) {
+	std::vector<TextSpan> result;
+	if (lenB == 0) {
+		result.push_back(TextSpan{ s, 0 });
+		return result;
+	}
+	if (width < 1) width = 1;
+	std::vector<long> offsets;
+	Utf8CharOffsets(s, lenB, offsets);
+	long charCount = (long)offsets.size() - 1;
+	auto span = [&](long fromChar, long toChar) {
+		return TextSpan{ s + offsets[fromChar], offsets[toChar] - offsets[fromChar] };
+	};
+
+	// Each CR-separated part is wrapped on its own (empty parts are dropped)
+	long segStart = 0;
+	while (segStart <= charCount) {
+		long segEnd = segStart;
+		while (segEnd < charCount && s[offsets[segEnd]] != '\r') segEnd++;
+		long pos = segStart;
+		while (pos < segEnd) {
+			if (segEnd - pos <= width) {
+				result.push_back(span(pos, segEnd));
+				break;
+			}
+			long cut = -1;
+			for (long i = width; i >= 0; i--) {
+				if (s[offsets[pos + i]] == ' ') { cut = i; break; }
+			}
+			if (cut >= 0) {
+				result.push_back(span(pos, pos + cut));
+				pos += cut + 1;
+			} else {
+				// no space to cut on, so just cut at width
+				result.push_back(span(pos, pos + width));
+				pos += width;
+			}
+		}
+		segStart = segEnd + 1;
+	}
+	return result;
+}
+
+long TextEditDistance(const char* a, long aLenB, const char* b, long bLenB) {
+	std::vector<unsigned long> s1, s2;
+	Utf8Decode(a, aLenB, s1);
+	Utf8Decode(b, bLenB, s2);
+	long n = (long)s1.size(), m = (long)s2.size();
+	if (n == 0) return m;
+	if (m == 0) return n;
+
+	// One row of the DP table, updated in place
+	std::vector<long> d(m + 1);
+	for (long j = 0; j <= m; j++) d[j] = j;
+	for (long i = 1; i <= n; i++) {
+		long diag = d[0];
+		d[0] = i;
+		for (long j = 1; j <= m; j++) {
+			long cost = (s1[i - 1] == s2[j - 1]) ? 0 : 1;
+			long next = std::min(std::min(d[j] + 1, d[j - 1] + 1), diag + cost);
+			diag = d[j];
+			d[j] = next;
+		}
+	}
+	return d[m];
+}
+
+std::string TextUrlEncode(const char* s, long lenB) {
+	static const char* hexDigits = "0123456789ABCDEF";
+	std::string result;
+	result.reserve(lenB);
+	for (long i = 0; i < lenB; i++) {
+		unsigned char c = (unsigned char)s[i];
+		if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')
+			|| c == '-' || c == '_' || c == '.' || c == '~') {
+			result += (char)c;
+		} else {
+			result += '%';
+			result += hexDigits[c >> 4];
+			result += hexDigits[c & 0x0F];
+		}
+	}
+	return result;
+}
+
+static int HexDigitValue(char c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+std::string TextUrlDecode(const char* s, long lenB) {
+	std::string result;
+	result.reserve(lenB);
+	long i = 0;
+	while (i < lenB) {
+		if (s[i] == '%') {
+			// up to two hex digits (as many as are valid)
+			int value = 0;
+			for (long k = i + 1; k < i + 3 && k < lenB; k++) {
+				int digit = HexDigitValue(s[k]);
+				if (digit < 0) break;
+				value = value * 16 + digit;
+			}
+			result += (char)value;
+			i += 3;
+		} else {
+			result += s[i++];
+		}
+	}
+	return result;
+}
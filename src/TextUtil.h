@@ -0,0 +1,59 @@
+//
+//  TextUtil.h
+//  MSRLWeb
+//
+//  String kernels behind the hidden intrinsics used by
+//  assets/lib/stringUtil.ms.  They work on UTF-8 bytes in place (as held
+//  by a MiniScript String), count characters the way MiniScript does (one
+//  per code point), and have no length limits.
+//
+
+#ifndef TEXTUTIL_H
+#define TEXTUTIL_H
+
+#include "DataFormats.h"
+#include <string>
+#include <vector>
+
+// Number of characters (code points) in UTF-8 text
+long Utf8CharCount(const char* s, long lenB);
+
+// Byte offset of the character at charIndex (clamped to 0..lenB)
+long Utf8ByteOffset(const char* s, long lenB, long charIndex);
+
+// Byte offset of each character, followed by lenB
+void Utf8CharOffsets(const char* s, long lenB, std::vector<long>& out);
+
+// Decode UTF-8 text into code points
+void Utf8Decode(const char* s, long lenB, std::vector<unsigned long>& out);
+
+// Whether the text is a valid number like "-3.1415" (see string.isNumeric)
+bool TextIsNumeric(const char* s, long lenB);
+
+// Narrow [*start, *end) (byte offsets) past any characters in chars, on
+// the left and/or right
+void TextTrimRange(const char* s, long lenB, const char* chars, long charsLenB,
+				   bool left, bool right, long* start, long* end);
+
+// Character index of the last occurrence of sub starting at or before
+// character index fromIndex, or -1 (see string.lastIndexOf)
+long TextLastIndexOf(const char* s, long lenB, const char* sub, long subLenB, long fromIndex);
+
+// Collapse runs of the given substring into one (see string.compress)
+std::string TextCompress(const char* s, long lenB, const char* run, long runLenB);
+
+// Reverse the characters
+std::string TextReverse(const char* s, long lenB);
+
+// Break text into lines at most width characters long, cutting at spaces
+// where possible (see string.wrap).  The spans point into s.
+std::vector<TextSpan> TextWrap(const char* s, long lenB, long width);
+
+// Levenshtein distance between two texts, by character
+long TextEditDistance(const char* a, long aLenB, const char* b, long bLenB);
+
+// URL-encode each byte outside A-Z, a-z, 0-9 and -_.~ as %XX; and back
+std::string TextUrlEncode(const char* s, long lenB);
+std::string TextUrlDecode(const char* s, long lenB);
+
+#endif // TEXTUTIL_H
@@ -0,0 +1,155 @@
+//
+//  WaveGen.cpp
+//  MSRLWeb
+//
+//  Offline wave generation implementation
+//
+
+#include "WaveGen.h"
+#include "Synth.h"
+#include "FrameArena.h"
+#include <math.h>
+#include <string.h>
+
+void GenToneSamples(float* out, int frameCount, int sampleRate, int waveform,
+	float startFrequency, float endFrequency, float volume, float duty) {
+	if (frameCount <= 0) return;
+	float duration = (float)frameCount / sampleRate;
+
+	// A synth voice with a flat envelope held for the whole buffer
+	SynthParams p;
+	p.waveform = waveform;
+	p.frequency = startFrequency;
+	p.duty = duty;
+	p.attack = 0;
+	p.decay = 0;
+	p.sustain = 1;
+	p.hold = duration;
+	p.release = 0;
+	p.volume = volume;
+	if (endFrequency > 0 && endFrequency != startFrequency && startFrequency > 0) {
+		p.sweep = log2f(endFrequency / startFrequency) / duration;
+		// Keep the sweep limits out of the way, so it never ends the note early
+		p.minFrequency = fminf(startFrequency, endFrequency) * 0.5f;
+		p.maxFrequency = fmaxf(startFrequency, endFrequency) * 2;
+	}
+
+	SynthVoice voice(p);
+	voice.Trigger();
+	voice.Render(out, frameCount, sampleRate);
+}
+
+void GenNoiseSamples(float* out, int frameCount, float volume, uint32_t seed) {
+	uint32_t state = (seed != 0 ? seed : 0x12345678);
+	for (int i = 0; i < frameCount; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		out[i] = ((state & 0xFFFF) / 32767.5f - 1) * volume;
+	}
+}
+
+// Scale one frame of a wave by gain (0 to 1), rounding integer samples
+static void ScaleFrame(Wave& wave, int frame, float gain) {
+	int channels = wave.channels;
+	size_t base = (size_t)frame * channels;
+	if (wave.sampleSize == 8) {
+		unsigned char* p = (unsigned char*)wave.data + base;
+		for (int c = 0; c < channels; c++) p[c] = (unsigned char)(128 + lrintf((p[c] - 128) * gain));
+	} else if (wave.sampleSize == 16) {
+		short* p = (short*)wave.data + base;
+		for (int c = 0; c < channels; c++) p[c] = (short)lrintf(p[c] * gain);
+	} else {
+		float* p = (float*)wave.data + base;
+		for (int c = 0; c < channels; c++) p[c] *= gain;
+	}
+}
+
+void FadeWave(Wave wave, int fadeInFrames, int fadeOutFrames) {
+	int frameCount = (int)wave.frameCount;
+	if (fadeInFrames > frameCount) fadeInFrames = frameCount;
+	if (fadeOutFrames > frameCount) fadeOutFrames = frameCount;
+	for (int f = 0; f < fadeInFrames; f++) {
+		ScaleFrame(wave, f, (float)f / fadeInFrames);
+	}
+	for (int f = 0; f < fadeOutFrames; f++) {
+		ScaleFrame(wave, frameCount - 1 - f, (float)f / fadeOutFrames);
+	}
+}
+
+float* WaveToFloatSamples(Wave wave, int sampleRate, int channels, int* outFrameCount) {
+	bool converted = false;
+	if ((int)wave.sampleRate != sampleRate || (int)wave.channels != channels) {
+		wave = WaveCopy(wave);
+		WaveFormat(&wave, sampleRate, 32, channels);
+		converted = true;
+	}
+	int sampleCount = wave.frameCount * wave.channels;
+	float* samples = FrameArena::AllocArray<float>(sampleCount);
+	if (samples) ConvertSamplesToFloat(wave.data, samples, sampleCount, wave.sampleSize);
+	*outFrameCount = wave.frameCount;
+	if (converted) UnloadWave(wave);
+	return samples;
+}
+
+Wave WaveFromFloatSamples(const float* samples, int frameCount, int sampleRate, int sampleSize, int channels) {
+	Wave wave;
+	wave.frameCount = frameCount;
+	wave.sampleRate = sampleRate;
+	wave.sampleSize = sampleSize;
+	wave.channels = channels;
+	int sampleCount = frameCount * channels;
+	wave.data = MemAlloc(sampleCount > 0 ? sampleCount * (sampleSize / 8) : 1);
+	if (sampleCount > 0) ConvertSamplesFromFloat(samples, wave.data, sampleCount, sampleSize);
+	return wave;
+}
+
+Wave MixWaves(const std::vector<Wave>& waves, const std::vector<float>& volumes) {
+	const Wave& first = waves[0];
+	int channels = first.channels;
+
+	std::vector<float*> sources(waves.size());
+	std::vector<int> lengths(waves.size());
+	int frameCount = 0;
+	for (size_t w = 0; w < waves.size(); w++) {
+		sources[w] = WaveToFloatSamples(waves[w], first.sampleRate, channels, &lengths[w]);
+		if (lengths[w] > frameCount) frameCount = lengths[w];
+	}
+
+	float* mix = FrameArena::AllocArray<float>(frameCount * channels);
+	if (mix) memset(mix, 0, frameCount * channels * sizeof(float));
+	for (size_t w = 0; w < waves.size(); w++) {
+		float volume = (w < volumes.size() ? volumes[w] : 1.0f);
+		int count = lengths[w] * channels;
+		const float* src = sources[w];
+		for (int i = 0; i < count; i++) mix[i] += src[i] * volume;
+	}
+	return WaveFromFloatSamples(mix, frameCount, first.sampleRate, first.sampleSize, channels);
+}
+
+Wave ConcatWaves(const std::vector<Wave>& waves, float gapSeconds) {
+	const Wave& first = waves[0];
+	int channels = first.channels;
+	int gapFrames = (gapSeconds > 0 ? (int)(gapSeconds * first.sampleRate) : 0);
+
+	std::vector<float*> sources(waves.size());
+	std::vector<int> lengths(waves.size());
+	int frameCount = 0;
+	for (size_t w = 0; w < waves.size(); w++) {
+		sources[w] = WaveToFloatSamples(waves[w], first.sampleRate, channels, &lengths[w]);
+		frameCount += lengths[w] + (w > 0 ? gapFrames : 0);
+	}
+
+	float* joined = FrameArena::AllocArray<float>(frameCount * channels);
+	int pos = 0;
+	for (size_t w = 0; w < waves.size(); w++) {
+		if (w > 0 && gapFrames > 0) {
+			memset(joined + pos, 0, gapFrames * channels * sizeof(float));
+			pos += gapFrames * channels;
+		}
+		int count = lengths[w] * channels;
+		if (count > 0) memcpy(joined + pos, sources[w], count * sizeof(float));
+		pos += count;
+	}
+	return WaveFromFloatSamples(joined, frameCount, first.sampleRate, first.sampleSize, channels);
+}
@@ -0,0 +1,46 @@
+//
+//  WaveGen.h
+//  MSRLWeb
+//
+//  Offline wave building blocks: tones, sweeps and noise rendered natively
+//  in one call, plus mixing, fading and concatenating existing Waves.
+//  (For real-time voices, see Synth.h.)
+//
+
+#ifndef WAVEGEN_H
+#define WAVEGEN_H
+
+#include "raylib.h"
+#include <stdint.h>
+#include <vector>
+
+// Render a constant-volume tone of the given waveform (SynthWaveform) into
+// frameCount mono samples.  If endFrequency differs from startFrequency, the
+// pitch slides exponentially from one to the other over the whole buffer.
+void GenToneSamples(float* out, int frameCount, int sampleRate, int waveform,
+	float startFrequency, float endFrequency, float volume, float duty);
+
+// Render frameCount mono samples of white noise (same seed gives the same noise)
+void GenNoiseSamples(float* out, int frameCount, float volume, uint32_t seed);
+
+// Apply linear fades (lengths in frames) to a wave in place.  Only the
+// faded frames are touched, and in the wave's own sample format, so the
+// rest of the wave is left bit-for-bit as it was.
+void FadeWave(Wave wave, int fadeInFrames, int fadeOutFrames);
+
+// Get a wave's samples as interleaved floats in the given rate and channel
+// count (converting a copy if needed).  The result is frame-arena memory.
+float* WaveToFloatSamples(Wave wave, int sampleRate, int channels, int* outFrameCount);
+
+// Make a new Wave (data from MemAlloc) from interleaved float samples
+Wave WaveFromFloatSamples(const float* samples, int frameCount, int sampleRate, int sampleSize, int channels);
+
+// Sum waves (each scaled by its volume; missing volumes are 1) into a new Wave
+// as long as the longest, in the format of the first
+Wave MixWaves(const std::vector<Wave>& waves, const std::vector<float>& volumes);
+
+// Join waves end to end (with gapSeconds of silence between) into a new Wave
+// in the format of the first
+Wave ConcatWaves(const std::vector<Wave>& waves, float gapSeconds);
+
+#endif // WAVEGEN_H
@@ -6,6 +6,7 @@
 //
 
 #include "loadfile.h"
+#include "AudioHost.h"
 #include "raylib.h"
 #include <emscripten.h>
 #include <emscripten/fetch.h>
@@ -50,7 +51,19 @@ EM_ASYNC_JS(char*, fetchText, (const char *_url), {
 	});
 });
 
+// The fetches above suspend the whole program (via ASYNCIFY), so top up
+// any auto-updated music first to ride out the wait as long as possible.
+static unsigned char* LoadFileDataHook(const char *fileName, int *dataSize) {
+	UpdateAutoMusicStreams();
+	return fetchData(fileName, dataSize);
+}
+
+static char* LoadFileTextHook(const char *fileName) {
+	UpdateAutoMusicStreams();
+	return fetchText(fileName);
+}
+
 void InstallLoadFileHooks() {
-	SetLoadFileDataCallback(fetchData);
-	SetLoadFileTextCallback(fetchText);
+	SetLoadFileDataCallback(LoadFileDataHook);
+	SetLoadFileTextCallback(LoadFileTextHook);
 }
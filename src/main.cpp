@@ -7,6 +7,9 @@
 #include "MiniscriptIntrinsics.h"
 #include "MiniscriptParser.h"
 #include "RaylibIntrinsics.h"
+#include "FrameArena.h"
+#include "AudioHost.h"
+#include "ImageJob.h"
 #include "loadfile.h"
 #include <emscripten/emscripten.h>
 #include <emscripten/fetch.h>
@@ -296,6 +299,9 @@ void RunScript() {
 //--------------------------------------------------------------------------------
 
 void MainLoop() {
+	// Keep auto-updated music fed, whatever the script is doing
+	UpdateAutoMusicStreams();
+
 	// Start the script when it's loaded but not yet started
 	if (scriptState == LOADING && !scriptSource.empty()) {
 		RunScript();
@@ -305,6 +311,8 @@ void MainLoop() {
 		// Script is running - hand control to MiniScript
 		// MiniScript will handle BeginDrawing/EndDrawing and everything else
 		if (!interpreter->Done()) {
+			// Give background image generation its slice of the frame
+			UpdateImageJobs();
 			try {
 				interpreter->RunUntilDone(0.1, false);  // Run until yield or timeout
 			} catch (MiniscriptException& mse) {
@@ -312,6 +320,11 @@ void MainLoop() {
 				interpreter->vm->Stop();
 				scriptState = ERRORED;
 			}
+			// No intrinsic is mid-call here, so scratch memory can be recycled
+			// even if the script never calls EndDrawing
+			FrameArena::Reset();
+			// Top up music again in case the script ran long
+			UpdateAutoMusicStreams();
 		} else {
 			scriptState = COMPLETE;
 			printf("Script finished\n");